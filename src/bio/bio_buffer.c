@@ -21,6 +21,8 @@
  * portions thereof marked with this legend must also reproduce the markings.
  */
 #define D_LOGFAC	DD_FAC(bio)
+#include <sched.h>
+#include <numa.h>
 #include <spdk/env.h>
 #include <spdk/blob.h>
 #include <spdk/thread.h>
@@ -39,7 +41,8 @@ dma_free_chunk(struct bio_dma_chunk *chunk)
 }
 
 static struct bio_dma_chunk *
-dma_alloc_chunk(unsigned int cnt)
+dma_alloc_chunk(struct bio_dma_buffer *buf, unsigned int cnt,
+		unsigned int class)
 {
 	struct bio_dma_chunk *chunk;
 	ssize_t bytes = (ssize_t)cnt << BIO_DMA_PAGE_SHIFT;
@@ -51,17 +54,143 @@ dma_alloc_chunk(unsigned int cnt)
 		return NULL;
 	}
 
-	chunk->bdc_ptr = spdk_dma_malloc(bytes, BIO_DMA_PAGE_SZ, NULL);
+	chunk->bdc_ptr = spdk_dma_malloc_socket(bytes, BIO_DMA_PAGE_SZ, NULL,
+						buf->bdb_numa_id);
 	if (chunk->bdc_ptr == NULL) {
-		D_ERROR("Failed to allocate %u pages DMA buffer\n", cnt);
+		D_ERROR("Failed to allocate %u pages DMA buffer on socket %d\n",
+			cnt, buf->bdb_numa_id);
 		D_FREE(chunk);
 		return NULL;
 	}
+	chunk->bdc_class = class;
 	D_INIT_LIST_HEAD(&chunk->bdc_link);
 
 	return chunk;
 }
 
+/*
+ * VOS xstreams are bound to the cores of the NUMA node which the NVMe device
+ * is attached to (see dss_numa_node), allocate DMA buffer from that node.
+ */
+static int
+dma_numa_id(void)
+{
+	int cpu, node;
+
+	if (numa_available() < 0)
+		return SPDK_ENV_SOCKET_ID_ANY;
+
+	cpu = sched_getcpu();
+	if (cpu < 0)
+		return SPDK_ENV_SOCKET_ID_ANY;
+
+	node = numa_node_of_cpu(cpu);
+	return node < 0 ? SPDK_ENV_SOCKET_ID_ANY : node;
+}
+
+/* Size class of a huge IOV with @pg_cnt pages */
+static inline unsigned int
+dma_huge_class(unsigned int pg_cnt)
+{
+	unsigned int class;
+
+	D_ASSERT(pg_cnt > bio_chk_sz);
+	for (class = 1; class < BIO_DMA_CLASS_MAX; class++) {
+		if (pg_cnt <= ((uint64_t)bio_chk_sz << class))
+			break;
+	}
+	return class;
+}
+
+/* Get a dedicated chunk for the huge IOV from the cache of its size class */
+static struct bio_dma_chunk *
+dma_huge_get(struct bio_dma_buffer *buf, unsigned int pg_cnt)
+{
+	struct bio_dma_class	*bdl;
+	struct bio_dma_chunk	*chunk;
+	unsigned int		 class = dma_huge_class(pg_cnt);
+
+	if (class == BIO_DMA_CLASS_ONEOFF) {
+		buf->bdb_oneoff_cnt++;
+		return dma_alloc_chunk(buf, pg_cnt, class);
+	}
+
+	bdl = &buf->bdb_classes[class];
+	if (!d_list_empty(&bdl->bdl_idle_list)) {
+		chunk = d_list_entry(bdl->bdl_idle_list.next,
+				     struct bio_dma_chunk, bdc_link);
+		d_list_del_init(&chunk->bdc_link);
+		bdl->bdl_hits++;
+		return chunk;
+	}
+
+	bdl->bdl_misses++;
+	chunk = dma_alloc_chunk(buf, bio_chk_sz << class, class);
+	if (chunk != NULL)
+		bdl->bdl_tot_cnt++;
+
+	return chunk;
+}
+
+static void
+dma_huge_put(struct bio_dma_buffer *buf, struct bio_dma_chunk *chunk)
+{
+	struct bio_dma_class	*bdl;
+
+	D_ASSERT(chunk->bdc_class != 0);
+	if (chunk->bdc_class == BIO_DMA_CLASS_ONEOFF) {
+		dma_free_chunk(chunk);
+		return;
+	}
+
+	bdl = &buf->bdb_classes[chunk->bdc_class];
+	D_ASSERT(bdl->bdl_tot_cnt > 0);
+	if (bdl->bdl_tot_cnt > bio_huge_cached) {
+		dma_free_chunk(chunk);
+		bdl->bdl_tot_cnt--;
+		return;
+	}
+	/* The idle list is in MRU order, the oldest idle chunk is the tail */
+	chunk->bdc_idle_ts = d_timeus_secdiff(0);
+	d_list_add(&chunk->bdc_link, &bdl->bdl_idle_list);
+}
+
+/* Free the idle huge chunks which became idle no later than @idle_ts */
+static void
+dma_huge_shrink(struct bio_dma_buffer *buf, uint64_t idle_ts)
+{
+	struct bio_dma_class	*bdl;
+	struct bio_dma_chunk	*chunk;
+	int			 i;
+
+	for (i = 1; i < BIO_DMA_CLASS_MAX; i++) {
+		bdl = &buf->bdb_classes[i];
+		while (!d_list_empty(&bdl->bdl_idle_list)) {
+			chunk = d_list_entry(bdl->bdl_idle_list.prev,
+					     struct bio_dma_chunk, bdc_link);
+			if (chunk->bdc_idle_ts > idle_ts)
+				break;
+
+			d_list_del_init(&chunk->bdc_link);
+			dma_free_chunk(chunk);
+			D_ASSERT(bdl->bdl_tot_cnt > 0);
+			bdl->bdl_tot_cnt--;
+		}
+	}
+}
+
+/*
+ * Return the huge chunks idle for more than bio_huge_age to SPDK, called on
+ * each NVMe poll, so that a burst of huge IOVs doesn't pin the huge pages.
+ */
+void
+dma_buffer_age(struct bio_dma_buffer *buf, uint64_t now)
+{
+	if (now < bio_huge_age)
+		return;
+
+	dma_huge_shrink(buf, now - bio_huge_age);
+}
 
 static void
 dma_buffer_shrink(struct bio_dma_buffer *buf, unsigned int cnt)
@@ -93,7 +222,7 @@ dma_buffer_grow(struct bio_dma_buffer *buf, unsigned int cnt)
 	}
 
 	for (i = 0; i < cnt; i++) {
-		chunk = dma_alloc_chunk(bio_chk_sz);
+		chunk = dma_alloc_chunk(buf, bio_chk_sz, 0);
 		if (chunk == NULL) {
 			rc = -DER_NOMEM;
 			break;
@@ -106,13 +235,38 @@ dma_buffer_grow(struct bio_dma_buffer *buf, unsigned int cnt)
 	return rc;
 }
 
+void
+dma_buffer_stat(struct bio_dma_buffer *buf, int tgt_id)
+{
+	struct bio_dma_class	*bdl;
+	int			 i;
+
+	for (i = 0; i < BIO_DMA_CLASS_MAX; i++) {
+		bdl = &buf->bdb_classes[i];
+		D_PRINT("DMA BUFFER STAT: tgt[%d] numa[%d] class[%d] "
+			"chk_pages[%u] chk_cnt[%u] hits["DF_U64"] "
+			"misses["DF_U64"] waits["DF_U64"]\n", tgt_id,
+			buf->bdb_numa_id, i, bio_chk_sz << i,
+			i == 0 ? buf->bdb_tot_cnt : bdl->bdl_tot_cnt,
+			bdl->bdl_hits, bdl->bdl_misses, bdl->bdl_waits);
+	}
+	D_PRINT("DMA BUFFER STAT: tgt[%d] oneoff["DF_U64"]\n", tgt_id,
+		buf->bdb_oneoff_cnt);
+}
+
 void
 dma_buffer_destroy(struct bio_dma_buffer *buf)
 {
+	int	i;
+
 	D_ASSERT(d_list_empty(&buf->bdb_used_list));
 	D_ASSERT(buf->bdb_active_iods == 0);
 	dma_buffer_shrink(buf, buf->bdb_tot_cnt);
 
+	dma_huge_shrink(buf, UINT64_MAX);
+	for (i = 1; i < BIO_DMA_CLASS_MAX; i++)
+		D_ASSERT(buf->bdb_classes[i].bdl_tot_cnt == 0);
+
 	D_ASSERT(buf->bdb_tot_cnt == 0);
 	buf->bdb_cur_chk = NULL;
 	ABT_mutex_free(&buf->bdb_mutex);
@@ -125,7 +279,7 @@ struct bio_dma_buffer *
 dma_buffer_create(unsigned int init_cnt)
 {
 	struct bio_dma_buffer *buf;
-	int rc;
+	int i, rc;
 
 	D_ALLOC_PTR(buf);
 	if (buf == NULL)
@@ -136,6 +290,9 @@ dma_buffer_create(unsigned int init_cnt)
 	buf->bdb_cur_chk = NULL;
 	buf->bdb_tot_cnt = 0;
 	buf->bdb_active_iods = 0;
+	buf->bdb_numa_id = dma_numa_id();
+	for (i = 0; i < BIO_DMA_CLASS_MAX; i++)
+		D_INIT_LIST_HEAD(&buf->bdb_classes[i].bdl_idle_list);
 
 	rc = ABT_mutex_create(&buf->bdb_mutex);
 	if (rc != ABT_SUCCESS) {
@@ -220,7 +377,7 @@ iod_dma_buf(struct bio_desc *biod)
 static inline bool
 dma_chunk_is_huge(struct bio_dma_chunk *chunk)
 {
-	return d_list_empty(&chunk->bdc_link);
+	return chunk->bdc_class != 0;
 }
 
 /*
@@ -259,7 +416,7 @@ iod_release_buffer(struct bio_desc *biod)
 			chunk->bdc_ref, dma_chunk_is_huge(chunk));
 
 		if (dma_chunk_is_huge(chunk)) {
-			dma_free_chunk(chunk);
+			dma_huge_put(bdb, chunk);
 		} else if (chunk->bdc_ref == 0) {
 			chunk->bdc_pg_idx = 0;
 			if (chunk == bdb->bdb_cur_chk)
@@ -371,6 +528,7 @@ chunk_get_idle(struct bio_dma_buffer *bdb, struct bio_desc *biod)
 
 	if (d_list_empty(&bdb->bdb_idle_list)) {
 		if (bdb->bdb_tot_cnt == bio_chk_cnt_max) {
+			bdb->bdb_classes[0].bdl_waits++;
 			D_CRIT("Maximum per-xstream DMA buffer isn't big "
 			       "enough (chk_sz:%u chk_cnt:%u iods:%u) to "
 			       "sustain the workload.\n", bio_chk_sz,
@@ -380,9 +538,12 @@ chunk_get_idle(struct bio_dma_buffer *bdb, struct bio_desc *biod)
 			return NULL;
 		}
 
+		bdb->bdb_classes[0].bdl_misses++;
 		rc = dma_buffer_grow(bdb, 1);
 		if (rc != 0)
 			return NULL;
+	} else {
+		bdb->bdb_classes[0].bdl_hits++;
 	}
 
 	D_ASSERT(!d_list_empty(&bdb->bdb_idle_list));
@@ -498,21 +659,23 @@ dma_map_one(struct bio_desc *biod, struct bio_iov *biov,
 	pg_off = off & ((uint64_t)BIO_DMA_PAGE_SZ - 1);
 
 	/*
-	 * For huge IOV, we'll bypass our per-xstream DMA buffer cache and
-	 * allocate chunk from the SPDK reserved huge pages directly, this
-	 * kind of huge chunk will be freed immediately on I/O completion.
+	 * For huge IOV, we'll bypass the regular chunks and take a dedicated
+	 * chunk from the cache of its size class, the huge chunk is put back
+	 * to the cache (or freed if the class has too many chunks) on I/O
+	 * completion. IOV exceeding the max class is allocated from the SPDK
+	 * reserved huge pages directly and freed on I/O completion.
 	 *
 	 * We assume the contiguous huge IOV is quite rare, so there won't
 	 * be high contention over the SPDK huge page cache.
 	 */
 	if (pg_cnt > bio_chk_sz) {
-		chk = dma_alloc_chunk(pg_cnt);
+		chk = dma_huge_get(bdb, pg_cnt);
 		if (chk == NULL)
 			return -DER_NOMEM;
 
 		rc = iod_add_chunk(biod, chk);
 		if (rc) {
-			dma_free_chunk(chk);
+			dma_huge_put(bdb, chk);
 			return rc;
 		}
 		bio_iov_set_raw_buf(biov, chk->bdc_ptr + pg_off);
@@ -646,6 +809,137 @@ skip_media_error:
 		ABT_eventual_set(biod->bd_dma_done, NULL, 0);
 }
 
+static void
+rw_req_completion(void *cb_arg, int err)
+{
+	struct bio_rw_req	*req = cb_arg;
+	struct bio_xs_context	*xs_ctxt = req->brq_ctxt->bic_xs_ctxt;
+	unsigned int		 i;
+
+	D_ASSERT(xs_ctxt->bxc_rw_inflights > 0);
+	xs_ctxt->bxc_rw_inflights--;
+
+	/* Each merged region holds an inflight of its io descriptor */
+	for (i = 0; i < req->brq_iov_cnt; i++)
+		rw_completion(req->brq_biods[i], err);
+
+	D_FREE(req);
+}
+
+static void
+rw_req_submit(struct bio_xs_context *xs_ctxt, struct bio_rw_req *req)
+{
+	struct bio_io_context	*ctxt = req->brq_ctxt;
+	uint64_t		 off = page2io_unit(ctxt, req->brq_pg_idx);
+	uint64_t		 len = page2io_unit(ctxt, req->brq_pg_cnt);
+
+	D_DEBUG(DB_IO, "%s blob:%p iovs:%u, pg_idx:"DF_U64", pg_cnt:"DF_U64
+		"\n", req->brq_update ? "Write" : "Read", ctxt->bic_blob,
+		req->brq_iov_cnt, req->brq_pg_idx, req->brq_pg_cnt);
+
+	xs_ctxt->bxc_rw_inflights++;
+	if (req->brq_iov_cnt == 1 && req->brq_update)
+		spdk_blob_io_write(ctxt->bic_blob, xs_ctxt->bxc_io_channel,
+				   req->brq_iovs[0].iov_base, off, len,
+				   rw_req_completion, req);
+	else if (req->brq_iov_cnt == 1)
+		spdk_blob_io_read(ctxt->bic_blob, xs_ctxt->bxc_io_channel,
+				  req->brq_iovs[0].iov_base, off, len,
+				  rw_req_completion, req);
+	else if (req->brq_update)
+		spdk_blob_io_writev(ctxt->bic_blob, xs_ctxt->bxc_io_channel,
+				    req->brq_iovs, req->brq_iov_cnt, off, len,
+				    rw_req_completion, req);
+	else
+		spdk_blob_io_readv(ctxt->bic_blob, xs_ctxt->bxc_io_channel,
+				   req->brq_iovs, req->brq_iov_cnt, off, len,
+				   rw_req_completion, req);
+}
+
+/* Submit all the queued blob I/Os of the xstream */
+void
+bio_rw_flush(struct bio_xs_context *xs_ctxt)
+{
+	struct bio_rw_req	*req, *tmp;
+
+	d_list_for_each_entry_safe(req, tmp, &xs_ctxt->bxc_rw_queue,
+				   brq_link) {
+		d_list_del(&req->brq_link);
+		rw_req_submit(xs_ctxt, req);
+	}
+	xs_ctxt->bxc_rw_queued = 0;
+}
+
+/*
+ * Queue a DMA region for submission. It's merged into a queued blob I/O of
+ * the same blob and direction if they are contiguous on the blob, so small
+ * I/Os from concurrent ULTs can be submitted as one vectored blob I/O.
+ */
+static void
+rw_enqueue(struct bio_desc *biod, void *payload, uint64_t pg_idx,
+	   uint64_t pg_cnt)
+{
+	struct bio_xs_context	*xs_ctxt = biod->bd_ctxt->bic_xs_ctxt;
+	struct bio_rw_req	*req;
+	unsigned int		 i;
+
+	d_list_for_each_entry(req, &xs_ctxt->bxc_rw_queue, brq_link) {
+		if (req->brq_ctxt != biod->bd_ctxt ||
+		    req->brq_update != biod->bd_update ||
+		    req->brq_iov_cnt == BIO_RW_IOV_MAX)
+			continue;
+
+		if (req->brq_pg_idx + req->brq_pg_cnt == pg_idx) {
+			i = req->brq_iov_cnt;
+			goto merge;
+		}
+
+		if (pg_idx + pg_cnt == req->brq_pg_idx) {
+			memmove(&req->brq_iovs[1], &req->brq_iovs[0],
+				sizeof(req->brq_iovs[0]) * req->brq_iov_cnt);
+			memmove(&req->brq_biods[1], &req->brq_biods[0],
+				sizeof(req->brq_biods[0]) * req->brq_iov_cnt);
+			req->brq_pg_idx = pg_idx;
+			i = 0;
+			goto merge;
+		}
+	}
+
+	D_ALLOC_PTR(req);
+	if (req == NULL) {
+		/* Submit the region alone */
+		if (biod->bd_update)
+			spdk_blob_io_write(biod->bd_ctxt->bic_blob,
+				xs_ctxt->bxc_io_channel, payload,
+				page2io_unit(biod->bd_ctxt, pg_idx),
+				page2io_unit(biod->bd_ctxt, pg_cnt),
+				rw_completion, biod);
+		else
+			spdk_blob_io_read(biod->bd_ctxt->bic_blob,
+				xs_ctxt->bxc_io_channel, payload,
+				page2io_unit(biod->bd_ctxt, pg_idx),
+				page2io_unit(biod->bd_ctxt, pg_cnt),
+				rw_completion, biod);
+		return;
+	}
+
+	req->brq_ctxt = biod->bd_ctxt;
+	req->brq_update = biod->bd_update;
+	req->brq_pg_idx = pg_idx;
+	d_list_add_tail(&req->brq_link, &xs_ctxt->bxc_rw_queue);
+	xs_ctxt->bxc_rw_queued++;
+	i = 0;
+merge:
+	req->brq_iovs[i].iov_base = payload;
+	req->brq_iovs[i].iov_len = pg_cnt << BIO_DMA_PAGE_SHIFT;
+	req->brq_biods[i] = biod;
+	req->brq_pg_cnt += pg_cnt;
+	req->brq_iov_cnt++;
+
+	if (xs_ctxt->bxc_rw_queued >= BIO_RW_QUEUE_MAX)
+		bio_rw_flush(xs_ctxt);
+}
+
 static void
 dma_rw(struct bio_desc *biod, bool prep)
 {
@@ -707,16 +1001,7 @@ dma_rw(struct bio_desc *biod, bool prep)
 				biod->bd_update ? "Write" : "Read",
 				blob, payload, pg_idx, pg_cnt);
 
-			if (biod->bd_update)
-				spdk_blob_io_write(blob, channel, payload,
-					page2io_unit(biod->bd_ctxt, pg_idx),
-					page2io_unit(biod->bd_ctxt, pg_cnt),
-					rw_completion, biod);
-			else
-				spdk_blob_io_read(blob, channel, payload,
-					page2io_unit(biod->bd_ctxt, pg_idx),
-					page2io_unit(biod->bd_ctxt, pg_cnt),
-					rw_completion, biod);
+			rw_enqueue(biod, payload, pg_idx, pg_cnt);
 			continue;
 		}
 
@@ -750,6 +1035,13 @@ dma_rw(struct bio_desc *biod, bool prep)
 		}
 	}
 
+	/*
+	 * Submit at once if the device isn't busy, otherwise leave the I/Os
+	 * queued for merging with others until next bio_nvme_poll().
+	 */
+	if (xs_ctxt->bxc_rw_inflights < bio_rw_qd)
+		bio_rw_flush(xs_ctxt);
+
 	if (xs_ctxt->bxc_tgt_id == -1) {
 		D_DEBUG(DB_IO, "Self poll completion, blob:%p\n", blob);
 		xs_poll_completion(xs_ctxt, &biod->bd_inflights);
@@ -49,6 +49,38 @@ struct bio_dma_chunk {
 	unsigned int	 bdc_pg_idx;
 	/* Being used by how many I/O descriptors */
 	unsigned int	 bdc_ref;
+	/* Size class of the chunk, see bio_dma_class */
+	unsigned int	 bdc_class;
+	/* When the huge chunk became idle, in microseconds */
+	uint64_t	 bdc_idle_ts;
+};
+
+/*
+ * DMA chunks are size-classed, class 0 is the regular chunk of bio_chk_sz
+ * pages which is shared by I/O descriptors, class N (N > 0) is the huge
+ * chunk of (bio_chk_sz << N) pages dedicated for single huge IOV. Idle huge
+ * chunks are cached (up to bio_huge_cached per class) to avoid calling
+ * spdk_dma_malloc() on I/O path, and freed once idle for bio_huge_age. IOV
+ * larger than the max class still falls back to one-off allocation.
+ */
+#define BIO_DMA_CLASS_MAX	4
+#define BIO_DMA_HUGE_CACHED	2
+#define BIO_DMA_HUGE_AGE	10	/* seconds */
+/* Class of the one-off chunk, it's never put in any idle list */
+#define BIO_DMA_CLASS_ONEOFF	BIO_DMA_CLASS_MAX
+
+/* Per size class DMA buffer usage statistics */
+struct bio_dma_class {
+	/* Idle chunks of this class */
+	d_list_t		 bdl_idle_list;
+	/* Total chunks of this class (idle & used) */
+	unsigned int		 bdl_tot_cnt;
+	/* Chunk requests satisfied by idle chunks */
+	uint64_t		 bdl_hits;
+	/* Chunk requests which have to allocate new chunk */
+	uint64_t		 bdl_misses;
+	/* Chunk requests which have to wait for buffer being released */
+	uint64_t		 bdl_waits;
 };
 
 /*
@@ -63,6 +95,15 @@ struct bio_dma_buffer {
 	unsigned int		 bdb_active_iods;
 	ABT_cond		 bdb_wait_iods;
 	ABT_mutex		 bdb_mutex;
+	/* NUMA node where the DMA chunks are allocated */
+	int			 bdb_numa_id;
+	/*
+	 * Per size class chunk lists & stats, regular chunks are kept in
+	 * bdb_idle_list & bdb_used_list, bdb_classes[0] only has the stats.
+	 */
+	struct bio_dma_class	 bdb_classes[BIO_DMA_CLASS_MAX];
+	/* One-off allocations for IOV larger than the max class */
+	uint64_t		 bdb_oneoff_cnt;
 };
 
 enum bio_bs_state {
@@ -134,6 +175,34 @@ struct bio_xs_context {
 	d_list_t		 bxc_io_ctxts;
 	struct spdk_bdev_desc	*bxc_desc; /* for io stat only, read-only */
 	uint64_t		 bxc_io_stat_age;
+	/* Blob I/Os queued for submission, see bio_rw_req */
+	d_list_t		 bxc_rw_queue;
+	unsigned int		 bxc_rw_queued;
+	/* Blob I/Os submitted and not completed yet */
+	unsigned int		 bxc_rw_inflights;
+};
+
+/* Maximum number of DMA regions merged into one blob I/O */
+#define BIO_RW_IOV_MAX		32
+/* Maximum number of queued blob I/Os per xstream */
+#define BIO_RW_QUEUE_MAX	64
+
+/*
+ * Blob I/O in the per-xstream submission queue. DMA regions contiguous on
+ * the blob, from one or more io descriptors, are merged into one vectored
+ * blob I/O.
+ */
+struct bio_rw_req {
+	d_list_t		 brq_link; /* link to bxc_rw_queue */
+	struct bio_io_context	*brq_ctxt;
+	/* Start page and page count on the blob */
+	uint64_t		 brq_pg_idx;
+	uint64_t		 brq_pg_cnt;
+	unsigned int		 brq_iov_cnt;
+	bool			 brq_update;
+	/* DMA regions and the io descriptors they belong to */
+	struct iovec		 brq_iovs[BIO_RW_IOV_MAX];
+	struct bio_desc		*brq_biods[BIO_RW_IOV_MAX];
 };
 
 /* Per VOS instance I/O context */
@@ -232,6 +301,9 @@ struct media_error_msg {
 /* bio_xstream.c */
 extern unsigned int	bio_chk_sz;
 extern unsigned int	bio_chk_cnt_max;
+extern unsigned int	bio_huge_cached;
+extern uint64_t		bio_huge_age;
+extern unsigned int	bio_rw_qd;
 extern uint64_t		io_stat_period;
 void xs_poll_completion(struct bio_xs_context *ctxt, unsigned int *inflights);
 int get_bdev_type(struct spdk_bdev *bdev);
@@ -239,8 +311,11 @@ int get_bdev_type(struct spdk_bdev *bdev);
 /* bio_buffer.c */
 void dma_buffer_destroy(struct bio_dma_buffer *buf);
 struct bio_dma_buffer *dma_buffer_create(unsigned int init_cnt);
+void dma_buffer_stat(struct bio_dma_buffer *buf, int tgt_id);
+void dma_buffer_age(struct bio_dma_buffer *buf, uint64_t now);
 void bio_memcpy(struct bio_desc *biod, uint16_t media, void *media_addr,
 		void *addr, ssize_t n);
+void bio_rw_flush(struct bio_xs_context *ctxt);
 
 /* bio_monitor.c */
 int bio_init_health_monitoring(struct bio_blobstore *bb,
@@ -437,6 +437,9 @@ bio_xs_io_stat(struct bio_xs_context *ctxt, uint64_t now)
 			stat.write_latency_ticks);
 	}
 
+	if (ctxt->bxc_dma_buf != NULL)
+		dma_buffer_stat(ctxt->bxc_dma_buf, ctxt->bxc_tgt_id);
+
 	ctxt->bxc_io_stat_age = now;
 }
 
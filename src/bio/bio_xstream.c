@@ -50,6 +50,7 @@ void spdk_set_thread(struct spdk_thread *thread);
 #define DAOS_DMA_CHUNK_MB	32		/* 32MB DMA chunks */
 #define DAOS_DMA_CHUNK_CNT_INIT	2		/* Per-xstream init chunks */
 #define DAOS_DMA_CHUNK_CNT_MAX	32		/* Per-xstream max chunks */
+#define DAOS_RW_QD_DEF		8		/* See bio_rw_qd */
 
 /* Chunk size of DMA buffer in pages */
 unsigned int bio_chk_sz;
@@ -57,6 +58,15 @@ unsigned int bio_chk_sz;
 unsigned int bio_chk_cnt_max;
 /* Per-xstream initial DMA buffer size (in chunk count) */
 static unsigned int bio_chk_cnt_init;
+/* Max idle huge chunks cached per size class, see bio_dma_class */
+unsigned int bio_huge_cached;
+/* Idle huge chunks are freed after this long (in microseconds) */
+uint64_t bio_huge_age;
+/*
+ * Blob I/Os are submitted at once if the xstream has fewer in flight than
+ * this, otherwise they are queued to be merged and submitted on next poll.
+ */
+unsigned int bio_rw_qd;
 
 struct bio_bdev {
 	d_list_t		 bb_link;
@@ -156,6 +166,16 @@ bio_nvme_init(const char *storage_path, const char *nvme_conf, int shm_id,
 
 	bio_chk_sz = (size_mb << 20) >> BIO_DMA_PAGE_SHIFT;
 
+	env = getenv("NVME_RW_QD");
+	bio_rw_qd = env ? atoi(env) : DAOS_RW_QD_DEF;
+
+	env = getenv("NVME_DMA_HUGE_CACHED");
+	bio_huge_cached = env ? atoi(env) : BIO_DMA_HUGE_CACHED;
+
+	env = getenv("NVME_DMA_HUGE_AGE");
+	bio_huge_age = env ? atoi(env) : BIO_DMA_HUGE_AGE;
+	bio_huge_age *= (NSEC_PER_SEC / NSEC_PER_USEC);
+
 	env = getenv("IO_STAT_PERIOD");
 	io_stat_period = env ? atoi(env) : 0;
 	io_stat_period *= (NSEC_PER_SEC / NSEC_PER_USEC);
@@ -214,6 +234,13 @@ bio_nvme_poll(struct bio_xs_context *ctxt)
 	if (ctxt == NULL)
 		return 0;
 
+	/* Submit the blob I/Os queued since last poll */
+	bio_rw_flush(ctxt);
+
+	/* Return the huge DMA chunks idle for long */
+	if (ctxt->bxc_dma_buf != NULL)
+		dma_buffer_age(ctxt->bxc_dma_buf, now);
+
 	rc = spdk_thread_poll(ctxt->bxc_thread, 0, 0);
 
 	/* Print SPDK I/O stats for each xstream */
@@ -784,6 +811,9 @@ bio_xsctxt_free(struct bio_xs_context *ctxt)
 	if (ctxt == NULL)
 		return;
 
+	D_ASSERT(d_list_empty(&ctxt->bxc_rw_queue));
+	D_ASSERT(ctxt->bxc_rw_inflights == 0);
+
 	if (ctxt->bxc_io_channel != NULL) {
 		spdk_bs_free_io_channel(ctxt->bxc_io_channel);
 		ctxt->bxc_io_channel = NULL;
@@ -877,6 +907,7 @@ bio_xsctxt_alloc(struct bio_xs_context **pctxt, int tgt_id)
 		return -DER_NOMEM;
 
 	D_INIT_LIST_HEAD(&ctxt->bxc_io_ctxts);
+	D_INIT_LIST_HEAD(&ctxt->bxc_rw_queue);
 	ctxt->bxc_tgt_id = tgt_id;
 
 	ABT_mutex_lock(nvme_glb.bd_mutex);
@@ -135,6 +135,18 @@ struct dfs {
 	/** Optional Prefix to account for when resolving an absolute path */
 	char			*prefix;
 	daos_size_t		prefix_len;
+	/** Optional dentry cache for dfs_lookup (see dfs_set_dcache) */
+	struct d_hash_table	*dcache;
+	/** Lifetime of a dentry cache entry, in seconds */
+	uint32_t		dcache_ttl;
+	/** Number of records in the dentry cache, protected by lock */
+	uint32_t		dcache_nr;
+	/**
+	 * Generation of the dentry cache, bumped (under lock) by every local
+	 * change of an entry, so a lookup racing with it does not cache the
+	 * entry it fetched before the change.
+	 */
+	uint64_t		dcache_gen;
 };
 
 struct dfs_entry {
@@ -358,6 +370,259 @@ out:
 	return rc;
 }
 
+/** Max size of a dentry cache key: parent object ID followed by entry name */
+#define DCACHE_KEY_MAX	(sizeof(daos_obj_id_t) + DFS_MAX_PATH)
+/** Max number of records in the dentry cache of a mount */
+#define DCACHE_NR_MAX	(1 << 14)
+
+/** dentry cache record */
+struct dfs_dentry {
+	/** link in dfs::dcache */
+	d_list_t		dd_link;
+	/** cached entry, including the symlink value if any */
+	struct dfs_entry	dd_entry;
+	/** time (monotonic, in seconds) after which the record is stale */
+	uint64_t		dd_expire;
+	/** reference count, protected by the hash table lock */
+	uint32_t		dd_ref;
+	/** key length and key, which is allocated with the record */
+	uint32_t		dd_klen;
+	char			dd_key[0];
+};
+
+static inline struct dfs_dentry *
+dcache_obj(d_list_t *rlink)
+{
+	return container_of(rlink, struct dfs_dentry, dd_link);
+}
+
+static bool
+dcache_key_cmp(struct d_hash_table *htable, d_list_t *rlink, const void *key,
+	       unsigned int ksize)
+{
+	struct dfs_dentry *dd = dcache_obj(rlink);
+
+	return dd->dd_klen == ksize && memcmp(dd->dd_key, key, ksize) == 0;
+}
+
+static void
+dcache_rec_addref(struct d_hash_table *htable, d_list_t *rlink)
+{
+	dcache_obj(rlink)->dd_ref++;
+}
+
+static bool
+dcache_rec_decref(struct d_hash_table *htable, d_list_t *rlink)
+{
+	struct dfs_dentry *dd = dcache_obj(rlink);
+
+	D_ASSERT(dd->dd_ref > 0);
+	dd->dd_ref--;
+	return dd->dd_ref == 0;
+}
+
+static void
+dcache_rec_free(struct d_hash_table *htable, d_list_t *rlink)
+{
+	struct dfs_dentry	*dd = dcache_obj(rlink);
+	dfs_t			*dfs = htable->ht_priv;
+
+	D_MUTEX_LOCK(&dfs->lock);
+	D_ASSERT(dfs->dcache_nr > 0);
+	dfs->dcache_nr--;
+	D_MUTEX_UNLOCK(&dfs->lock);
+
+	D_FREE(dd->dd_entry.value);
+	D_FREE(dd);
+}
+
+static d_hash_table_ops_t dcache_hash_ops = {
+	.hop_key_cmp	= dcache_key_cmp,
+	.hop_rec_addref	= dcache_rec_addref,
+	.hop_rec_decref	= dcache_rec_decref,
+	.hop_rec_free	= dcache_rec_free,
+};
+
+static unsigned int
+dcache_key(daos_obj_id_t parent, const char *name, char *key)
+{
+	size_t len = strnlen(name, DFS_MAX_PATH);
+
+	memcpy(key, &parent, sizeof(parent));
+	memcpy(key + sizeof(parent), name, len);
+	return sizeof(parent) + len;
+}
+
+/**
+ * Look up entry \a name of directory \a parent in the dentry cache. On a hit,
+ * copy the entry (and a duplicate of its symlink value) to \a entry and
+ * return true.
+ */
+static bool
+dcache_lookup(dfs_t *dfs, daos_obj_id_t parent, const char *name,
+	      struct dfs_entry *entry)
+{
+	struct dfs_dentry	*dd;
+	d_list_t		*rlink;
+	char			key[DCACHE_KEY_MAX];
+	unsigned int		klen;
+	uint64_t		now;
+	bool			hit = false;
+
+	if (dfs->dcache == NULL)
+		return false;
+
+	klen = dcache_key(parent, name, key);
+	rlink = d_hash_rec_find(dfs->dcache, key, klen);
+	if (rlink == NULL)
+		return false;
+
+	dd = dcache_obj(rlink);
+	if (daos_gettime_coarse(&now) == 0 && now < dd->dd_expire) {
+		*entry = dd->dd_entry;
+		entry->value = NULL;
+		hit = true;
+		if (dd->dd_entry.value != NULL) {
+			D_STRNDUP(entry->value, dd->dd_entry.value,
+				  PATH_MAX - 1);
+			if (entry->value == NULL)
+				hit = false;
+		}
+	}
+	d_hash_rec_decref(dfs->dcache, rlink);
+
+	/** drop stale records so that the next lookup refetches them */
+	if (!hit)
+		d_hash_rec_delete(dfs->dcache, key, klen);
+	return hit;
+}
+
+static uint64_t
+dcache_gen(dfs_t *dfs)
+{
+	uint64_t gen;
+
+	D_MUTEX_LOCK(&dfs->lock);
+	gen = dfs->dcache_gen;
+	D_MUTEX_UNLOCK(&dfs->lock);
+	return gen;
+}
+
+/**
+ * Cache \a entry as entry \a name of directory \a parent, unless an entry
+ * has been changed locally since generation \a gen, when \a entry was
+ * fetched, or the cache is full. Best effort.
+ */
+static void
+dcache_insert(dfs_t *dfs, daos_obj_id_t parent, const char *name,
+	      struct dfs_entry *entry, uint64_t gen)
+{
+	struct dfs_dentry	*dd;
+	char			key[DCACHE_KEY_MAX];
+	unsigned int		klen;
+	uint64_t		now;
+	int			rc;
+
+	if (dfs->dcache == NULL || daos_gettime_coarse(&now) != 0)
+		return;
+
+	klen = dcache_key(parent, name, key);
+	D_ALLOC(dd, sizeof(*dd) + klen);
+	if (dd == NULL)
+		return;
+	D_INIT_LIST_HEAD(&dd->dd_link);
+	dd->dd_entry = *entry;
+	dd->dd_entry.value = NULL;
+	if (entry->value != NULL) {
+		D_STRNDUP(dd->dd_entry.value, entry->value, PATH_MAX - 1);
+		if (dd->dd_entry.value == NULL) {
+			D_FREE(dd);
+			return;
+		}
+	}
+	dd->dd_expire = now + dfs->dcache_ttl;
+	dd->dd_klen = klen;
+	memcpy(dd->dd_key, key, klen);
+
+	/** replace any existing record of the same entry */
+	d_hash_rec_delete(dfs->dcache, key, klen);
+
+	D_MUTEX_LOCK(&dfs->lock);
+	if (gen != dfs->dcache_gen || dfs->dcache_nr >= DCACHE_NR_MAX) {
+		D_MUTEX_UNLOCK(&dfs->lock);
+		D_FREE(dd->dd_entry.value);
+		D_FREE(dd);
+		return;
+	}
+	rc = d_hash_rec_insert(dfs->dcache, dd->dd_key, dd->dd_klen,
+			       &dd->dd_link, true);
+	if (rc == 0)
+		dfs->dcache_nr++;
+	D_MUTEX_UNLOCK(&dfs->lock);
+
+	if (rc != 0) {
+		D_FREE(dd->dd_entry.value);
+		D_FREE(dd);
+	}
+}
+
+/**
+ * Invalidate the cached entry \a name of directory \a parent, if any. It is
+ * called once the entry has been changed, and also stops the lookups that
+ * fetched the entry before the change from caching it.
+ */
+static void
+dcache_invalidate(dfs_t *dfs, daos_obj_id_t parent, const char *name)
+{
+	char		key[DCACHE_KEY_MAX];
+	unsigned int	klen;
+
+	if (dfs->dcache == NULL)
+		return;
+
+	D_MUTEX_LOCK(&dfs->lock);
+	dfs->dcache_gen++;
+	D_MUTEX_UNLOCK(&dfs->lock);
+
+	klen = dcache_key(parent, name, key);
+	d_hash_rec_delete(dfs->dcache, key, klen);
+}
+
+static void
+dcache_destroy(dfs_t *dfs)
+{
+	if (dfs->dcache == NULL)
+		return;
+
+	d_hash_table_destroy(dfs->dcache, true /* force */);
+	dfs->dcache = NULL;
+	D_ASSERT(dfs->dcache_nr == 0);
+	dfs->dcache_ttl = 0;
+}
+
+/**
+ * Fetch entry \a name of directory \a parent through the dentry cache, with
+ * the symlink value.
+ */
+static int
+lookup_entry(dfs_t *dfs, dfs_obj_t *parent, const char *name, bool *exists,
+	     struct dfs_entry *entry)
+{
+	uint64_t	gen;
+	int		rc;
+
+	if (dcache_lookup(dfs, parent->oid, name, entry)) {
+		*exists = true;
+		return 0;
+	}
+
+	gen = dcache_gen(dfs);
+	rc = fetch_entry(parent->oh, DAOS_TX_NONE, name, true, exists, entry);
+	if (rc == 0 && *exists)
+		dcache_insert(dfs, parent->oid, name, entry, gen);
+	return rc;
+}
+
 static int
 remove_entry(dfs_t *dfs, daos_handle_t th, daos_handle_t parent_oh,
 	     const char *name, struct dfs_entry entry)
@@ -1217,6 +1482,7 @@ dfs_umount(dfs_t *dfs)
 	if (dfs->prefix)
 		D_FREE(dfs->prefix);
 
+	dcache_destroy(dfs);
 	D_MUTEX_DESTROY(&dfs->lock);
 	D_FREE(dfs);
 
@@ -1458,6 +1724,27 @@ dfs_set_prefix(dfs_t *dfs, const char *prefix)
 	return 0;
 }
 
+int
+dfs_set_dcache(dfs_t *dfs, uint32_t ttl)
+{
+	int rc;
+
+	if (dfs == NULL || !dfs->mounted)
+		return EINVAL;
+
+	dcache_destroy(dfs);
+	if (ttl == 0)
+		return 0;
+
+	rc = d_hash_table_create(0 /* feats */, 10 /* bits */, dfs /* priv */,
+				 &dcache_hash_ops, &dfs->dcache);
+	if (rc)
+		return daos_der2errno(rc);
+	dfs->dcache_ttl = ttl;
+
+	return 0;
+}
+
 int
 dfs_get_file_oh(dfs_obj_t *obj, daos_handle_t *oh)
 {
@@ -1670,6 +1957,7 @@ dfs_remove(dfs_t *dfs, dfs_obj_t *parent, const char *name, bool force,
 	}
 
 	rc = remove_entry(dfs, th, parent->oh, name, entry);
+	dcache_invalidate(dfs, parent->oid, name);
 	if (rc)
 		D_GOTO(out, rc);
 
@@ -1751,8 +2039,7 @@ dfs_lookup_loop:
 			return rc;
 
 		entry.chunk_size = 0;
-		rc = fetch_entry(parent.oh, DAOS_TX_NONE, token, true,
-				 &exists, &entry);
+		rc = lookup_entry(dfs, &parent, token, &exists, &entry);
 		if (rc)
 			D_GOTO(err_obj, rc);
 
@@ -1825,6 +2112,9 @@ dfs_lookup_loop:
 				}
 
 				parent.oh = sym->oh;
+				parent.mode = sym->mode;
+				oid_cp(&parent.oid, sym->oid);
+				oid_cp(&parent.parent_oid, sym->parent_oid);
 				D_FREE(sym);
 				D_FREE(entry.value);
 				obj->value = NULL;
@@ -2980,6 +3270,7 @@ dfs_chmod(dfs_t *dfs, dfs_obj_t *parent, const char *name, mode_t mode)
 	sgl.sg_iovs	= &sg_iov;
 
 	rc = daos_obj_update(oh, th, 0, &dkey, 1, &iod, &sgl, NULL);
+	dcache_invalidate(dfs, parent->oid, name);
 	if (rc) {
 		D_ERROR("Failed to update mode (rc = %d)\n", rc);
 		D_GOTO(out, rc = daos_der2errno(rc));
@@ -3091,6 +3382,7 @@ dfs_osetattr(dfs_t *dfs, dfs_obj_t *obj, struct stat *stbuf, int flags)
 	sgl.sg_iovs	= &sg_iovs[i];
 
 	rc = daos_obj_update(oh, th, 0, &dkey, 1, &iod, &sgl, NULL);
+	dcache_invalidate(dfs, obj->parent_oid, obj->name);
 	if (rc) {
 		D_ERROR("Failed to update attr (rc = %d)\n", rc);
 		D_GOTO(out_obj, rc = daos_der2errno(rc));
@@ -3362,6 +3654,8 @@ dfs_move(dfs_t *dfs, dfs_obj_t *parent, char *name, dfs_obj_t *new_parent,
 	}
 
 out:
+	dcache_invalidate(dfs, parent->oid, name);
+	dcache_invalidate(dfs, new_parent->oid, new_name);
 	if (entry.value) {
 		D_ASSERT(S_ISLNK(entry.mode));
 		D_FREE(entry.value);
@@ -3461,6 +3755,8 @@ dfs_exchange(dfs_t *dfs, dfs_obj_t *parent1, char *name1, dfs_obj_t *parent2,
 	}
 
 out:
+	dcache_invalidate(dfs, parent1->oid, name1);
+	dcache_invalidate(dfs, parent2->oid, name2);
 	if (entry1.value) {
 		D_ASSERT(S_ISLNK(entry1.mode));
 		D_FREE(entry1.value);
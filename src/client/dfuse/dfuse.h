@@ -35,6 +35,7 @@
 #include "daos_fs.h"
 
 #include "dfuse_common.h"
+#include "dfuse_da.h"
 
 #define DFUSE_UNS_POOL_ATTR "user.uns.pool"
 #define DFUSE_UNS_CONTAINER_ATTR "user.uns.container"
@@ -69,8 +70,24 @@ struct dfuse_projection_info {
 	struct d_hash_table		dpi_iet;
 	struct d_hash_table		dpi_irt;
 	ATOMIC uint64_t			dpi_ino_next;
+	/** Descriptor allocator for the types below */
+	struct dfuse_da			dpi_da;
+	/** Pool of dpi_max_read sized buffers for reads */
+	struct dfuse_da_type		*dpi_read_da;
 };
 
+/** A pre-allocated read buffer, see dfuse_read_buf_init() */
+struct dfuse_read_buf {
+	d_list_t			drb_list;
+	/** Buffer of drb_size bytes */
+	void				*drb_buf;
+	size_t				drb_size;
+};
+
+/* Create the pool of read buffers, called once at startup */
+int
+dfuse_read_buf_init(struct dfuse_projection_info *fs_handle);
+
 /*
  * Max number of 4k (fuse buffer size for readdir) blocks that need offset
  * tracking in the readdir implementation. Since in readdir implementation we
@@ -336,6 +353,20 @@ struct fuse_lowlevel_ops *dfuse_get_fuse_ops();
 	} while (0)
 
 
+#define DFUSE_REPLY_DATA(desc, req, buf, size)				\
+	do {								\
+		struct fuse_bufvec __fb = FUSE_BUFVEC_INIT(size);	\
+		int __rc;						\
+		DFUSE_TRA_DEBUG(desc, "Returning data(%p %#zx)",	\
+				buf, size);				\
+		__fb.buf[0].mem = (buf);				\
+		__rc = fuse_reply_data(req, &__fb, FUSE_BUF_SPLICE_MOVE); \
+		if (__rc != 0)						\
+			DFUSE_TRA_ERROR(desc,				\
+					"fuse_reply_data returned %d:%s", \
+					__rc, strerror(-__rc));		\
+	} while (0)
+
 #define DFUSE_REPLY_WRITE(desc, req, bytes)				\
 	do {								\
 		int __rc;						\
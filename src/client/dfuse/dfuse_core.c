@@ -173,6 +173,12 @@ dfuse_start(struct dfuse_info *dfuse_info, struct dfuse_dfs *dfs)
 
 	atomic_fetch_add(&fs_handle->dpi_ino_next, 2);
 
+	/* Reads fall back to temporary buffers if the pool is unavailable */
+	rc = dfuse_read_buf_init(fs_handle);
+	if (rc != -DER_SUCCESS)
+		DFUSE_TRA_WARNING(fs_handle, "Failed to create read buffers: %d",
+				  rc);
+
 	args.argc = 4;
 
 	args.allocated = 1;
@@ -249,6 +255,7 @@ err:
 	DFUSE_TRA_ERROR(fs_handle, "Failed");
 	D_FREE(fuse_ops);
 	D_FREE(ie);
+	dfuse_da_destroy(&fs_handle->dpi_da);
 	D_FREE(fs_handle);
 	return -DER_INVAL;
 }
@@ -365,5 +372,7 @@ dfuse_destroy_fuse(struct dfuse_projection_info *fs_handle)
 		rcp = EINVAL;
 	}
 
+	dfuse_da_destroy(&fs_handle->dpi_da);
+
 	return rcp;
 }
@@ -104,6 +104,8 @@ dfuse_da_destroy(struct dfuse_da *da)
 				"Failed to destroy lock %d %s",
 				rc, strerror(rc));
 	DFUSE_TRA_DOWN(da);
+	/* Make a second destroy, e.g. from an error path, a no-op */
+	da->init = false;
 }
 
 /* Helper function for migrating objects from pending list to free list.
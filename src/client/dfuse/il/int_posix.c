@@ -107,6 +107,8 @@ entry_array_close(void *arg) {
 
 	DFUSE_LOG_INFO("entry %p closing array fd_count %d",
 		       entry, ioil_ioc.ioc_open_fd_count);
+	ioil_wb_fini(entry);
+	ioil_ra_fini(entry);
 	daos_array_close(entry->fd_aoh, NULL);
 
 	ioil_ioc.ioc_open_fd_count -= 1;
@@ -196,7 +198,9 @@ static pthread_once_t init_links_flag = PTHREAD_ONCE_INIT;
 /* This is also called from dfuse_fopen() */
 static void init_links(void)
 {
-	FOREACH_INTERCEPT(IOIL_FORWARD_MAP_OR_FAIL);
+	FOREACH_SINGLE_INTERCEPT(IOIL_FORWARD_MAP_OR_FAIL);
+	FOREACH_ALIASED_INTERCEPT(IOIL_FORWARD_MAP_OR_FAIL);
+	FOREACH_OPTIONAL_INTERCEPT(IOIL_FORWARD_MAP);
 }
 
 static __attribute__((constructor)) void
@@ -232,6 +236,8 @@ ioil_init(void)
 	if (rc)
 		return;
 
+	ioil_wb_setup();
+
 	ioil_ioc.ioc_initialized = true;
 }
 
@@ -240,6 +246,8 @@ ioil_fini(void)
 {
 	ioil_ioc.ioc_initialized = false;
 
+	ioil_wb_cleanup();
+
 	if (ioil_ioc.ioc_open_fd_count > 0) {
 		CONT_CLOSE(ioil_ioc);
 		POOL_DISCONNECT(ioil_ioc);
@@ -412,6 +420,15 @@ check_ioctl_on_open(int fd, struct fd_entry *entry, int flags, int status)
 	if (rc)
 		D_GOTO(cont_close, 0);
 
+	/* Read-ahead is only an optimization so carry on without it */
+	rc = ioil_ra_init(entry);
+	if (rc != 0)
+		DFUSE_LOG_INFO("Failed to allocate read-ahead state %d", rc);
+
+	rc = ioil_wb_init(entry);
+	if (rc != 0)
+		DFUSE_LOG_INFO("Failed to allocate write-back state %d", rc);
+
 	rc = vector_set(&fd_table, fd, entry);
 	if (rc != 0) {
 		DFUSE_LOG_INFO("Failed to track IOF file fd=%d., disabling kernel bypass",
@@ -427,6 +444,8 @@ check_ioctl_on_open(int fd, struct fd_entry *entry, int flags, int status)
 	return true;
 
 array_close:
+	ioil_wb_fini(entry);
+	ioil_ra_fini(entry);
 	daos_array_close(entry->fd_aoh, NULL);
 
 cont_close:
@@ -527,6 +546,7 @@ DFUSE_PUBLIC int
 dfuse_close(int fd)
 {
 	struct fd_entry *entry;
+	int wb_rc = 0;
 	int rc;
 
 	rc = vector_remove(&fd_table, fd, &entry);
@@ -537,13 +557,21 @@ dfuse_close(int fd)
 	DFUSE_LOG_INFO("close(fd=%d) intercepted, bypass=%s",
 		       fd, bypass_status[entry->fd_status]);
 
+	/* Report any failure to write back buffered data, as NFS does */
+	wb_rc = ioil_wb_sync(entry);
+
 	/* This will drop a reference which will cause the array to be closed
 	 * when the last duplicated fd is closed
 	 */
 	vector_decref(&fd_table, entry);
 
 do_real_close:
-	return __real_close(fd);
+	rc = __real_close(fd);
+	if (rc == 0 && wb_rc != 0) {
+		errno = daos_der2errno(wb_rc);
+		rc = -1;
+	}
+	return rc;
 }
 
 DFUSE_PUBLIC ssize_t
@@ -699,8 +727,10 @@ dfuse_lseek(int fd, off_t offset, int whence)
 		new_offset = entry->fd_pos + offset;
 	} else {
 		/* Let the system handle SEEK_END as well as non-standard
-		 * values such as SEEK_DATA and SEEK_HOLE
+		 * values such as SEEK_DATA and SEEK_HOLE, once it knows the
+		 * real file size.
 		 */
+		ioil_wb_flush(entry);
 		new_offset = __real_lseek(fd, offset, whence);
 		if (new_offset >= 0)
 			entry->fd_pos = new_offset;
@@ -870,6 +900,8 @@ dfuse_mmap(void *address, size_t length, int prot, int flags, int fd,
 
 		if (entry->fd_pos != 0)
 			__real_lseek(fd, entry->fd_pos, SEEK_SET);
+		/* The kernel has to see everything written so far */
+		ioil_wb_flush(entry);
 		/* Disable kernel bypass */
 		entry->fd_status = DFUSE_IO_DIS_MMAP;
 
@@ -892,7 +924,13 @@ dfuse_fsync(int fd)
 	DFUSE_LOG_INFO("fsync(fd=%d) intercepted, bypass=%s",
 		       fd, bypass_status[entry->fd_status]);
 
+	/* Report any earlier failure to write back buffered data */
+	rc = ioil_wb_sync(entry);
 	vector_decref(&fd_table, entry);
+	if (rc != 0) {
+		errno = daos_der2errno(rc);
+		return -1;
+	}
 
 do_real_fsync:
 	return __real_fsync(fd);
@@ -912,12 +950,113 @@ dfuse_fdatasync(int fd)
 		       "bypass=%s",
 		       fd, bypass_status[entry->fd_status]);
 
+	/* Report any earlier failure to write back buffered data */
+	rc = ioil_wb_sync(entry);
 	vector_decref(&fd_table, entry);
+	if (rc != 0) {
+		errno = daos_der2errno(rc);
+		return -1;
+	}
 
 do_real_fdatasync:
 	return __real_fdatasync(fd);
 }
 
+DFUSE_PUBLIC int
+dfuse_ftruncate(int fd, off_t length)
+{
+	struct fd_entry *entry;
+	int rc;
+
+	rc = vector_get(&fd_table, fd, &entry);
+	if (rc != 0)
+		goto do_real_ftruncate;
+
+	DFUSE_LOG_INFO("ftruncate(fd=%d, length=%zd) intercepted, bypass=%s",
+		       fd, length, bypass_status[entry->fd_status]);
+
+	/* Buffered data must not land after the truncate, and prefetched data
+	 * past the new size is stale.
+	 */
+	ioil_wb_flush(entry);
+	ioil_ra_invalidate(entry);
+	vector_decref(&fd_table, entry);
+
+do_real_ftruncate:
+	return __real_ftruncate(fd, length);
+}
+
+/* Make buffered writes visible to the kernel before it reports st_size */
+static void
+stat_flush(int fd)
+{
+	struct fd_entry *entry;
+	int rc;
+
+	rc = vector_get(&fd_table, fd, &entry);
+	if (rc != 0)
+		return;
+
+	DFUSE_LOG_INFO("fstat(fd=%d) intercepted, bypass=%s",
+		       fd, bypass_status[entry->fd_status]);
+
+	ioil_wb_flush(entry);
+	vector_decref(&fd_table, entry);
+}
+
+/* Forward fstat() to libc, which only exports it from glibc 2.33 on */
+static int
+real_fstat(int fd, struct stat *buf)
+{
+#ifdef IOIL_PRELOAD
+	if (__real_fstat == NULL) {
+#ifdef _STAT_VER
+		if (__real___fxstat != NULL)
+			return __real___fxstat(_STAT_VER, fd, buf);
+#endif
+		errno = ENOSYS;
+		return -1;
+	}
+#endif
+	return __real_fstat(fd, buf);
+}
+
+DFUSE_PUBLIC int
+dfuse___fxstat(int ver, int fd, struct stat *buf)
+{
+	stat_flush(fd);
+
+#ifdef IOIL_PRELOAD
+	/* Binaries built against older glibc still call __fxstat(), which
+	 * newer versions no longer let dlsym() find.
+	 */
+	if (__real___fxstat == NULL)
+		return real_fstat(fd, buf);
+#endif
+	return __real___fxstat(ver, fd, buf);
+}
+
+DFUSE_PUBLIC int
+dfuse_fstat(int fd, struct stat *buf)
+{
+	stat_flush(fd);
+
+	return real_fstat(fd, buf);
+}
+
+DFUSE_PUBLIC int
+dfuse_fstat64(int fd, struct stat64 *buf)
+{
+	stat_flush(fd);
+
+#ifdef IOIL_PRELOAD
+	/* struct stat and struct stat64 are the same on 64-bit targets */
+	if (__real_fstat64 == NULL)
+		return real_fstat(fd, (struct stat *)buf);
+#endif
+	return __real_fstat64(fd, buf);
+}
+
 DFUSE_PUBLIC int dfuse_dup(int oldfd)
 {
 	struct fd_entry *entry = NULL;
@@ -972,6 +1111,9 @@ dfuse_fdopen(int fd, const char *mode)
 		if (entry->fd_pos != 0)
 			__real_lseek(fd, entry->fd_pos, SEEK_SET);
 
+		/* The kernel has to see everything written so far */
+		ioil_wb_flush(entry);
+
 		/* Disable kernel bypass */
 		entry->fd_status = DFUSE_IO_DIS_STREAM;
 
@@ -1004,6 +1146,8 @@ dfuse_fcntl(int fd, int cmd, ...)
 			       "F_SETFL not supported for kernel bypass", fd);
 
 		if (!drop_reference_if_disabled(entry)) {
+			/* The kernel has to see everything written so far */
+			ioil_wb_flush(entry);
 			/* Disable kernel bypass */
 			entry->fd_status = DFUSE_IO_DIS_FCNTL;
 			vector_decref(&fd_table, entry);
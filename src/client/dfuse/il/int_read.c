@@ -22,14 +22,195 @@
  */
 
 #define D_LOGFAC DD_FAC(il)
+#include <pthread.h>
+#include <fcntl.h>
 #include "dfuse_common.h"
 #include "intercept.h"
 #include "daos.h"
 #include "daos_array.h"
 
+/* Size of each read-ahead window */
+#define IOIL_RA_SIZE		(1024 * 1024)
+/* Number of back-to-back sequential reads before read-ahead starts */
+#define IOIL_RA_SEQ_MIN		2
+
+/* A buffer of file data starting at rw_off, rw_len bytes are valid */
+struct ioil_ra_win {
+	char			*rw_buf;
+	off_t			rw_off;
+	size_t			rw_len;
+};
+
+/* Per open file read-ahead state.
+ *
+ * Two windows are kept, reads are served from the current one while the
+ * other is the target of an asynchronous daos_array_read() for the data
+ * that follows it.  Once a read reaches the prefetched range the windows
+ * are swapped and the next prefetch is launched, so a sequential reader
+ * always has one window of I/O in flight ahead of it.  The windows are only
+ * allocated once a sequential stream is detected.
+ *
+ * The file size is cached so that reads within the known size do not
+ * need a daos_array_get_size() call, it is refreshed whenever a read
+ * extends beyond it so files being appended to elsewhere are still seen
+ * to grow.
+ */
+struct ioil_ra {
+	pthread_mutex_t		ra_lock;
+	daos_size_t		ra_size;
+	bool			ra_size_valid;
+	/* Offset the next read has to start at to be sequential */
+	off_t			ra_next;
+	int			ra_seq;
+	struct ioil_ra_win	ra_win[2];
+	/* Index of the window reads are served from */
+	int			ra_cur;
+	/* Prefetch in flight into ra_win[!ra_cur], the descriptors have to
+	 * remain valid until the event completes.
+	 */
+	bool			ra_inflight;
+	daos_event_t		ra_ev;
+	daos_array_iod_t	ra_iod;
+	daos_range_t		ra_rg;
+	d_sg_list_t		ra_sgl;
+	d_iov_t			ra_iov;
+};
+
+int
+ioil_ra_init(struct fd_entry *entry)
+{
+	struct ioil_ra	*ra;
+	int		rc;
+
+	entry->fd_ra = NULL;
+
+	if ((entry->fd_flags & O_ACCMODE) == O_WRONLY)
+		return 0;
+
+	D_ALLOC_PTR(ra);
+	if (ra == NULL)
+		return ENOMEM;
+
+	rc = pthread_mutex_init(&ra->ra_lock, NULL);
+	if (rc != 0) {
+		D_FREE(ra);
+		return rc;
+	}
+
+	entry->fd_ra = ra;
+	return 0;
+}
+
+/* Allocate the windows on first use, must be called with ra_lock held */
+static bool
+ra_win_alloc(struct ioil_ra *ra)
+{
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		if (ra->ra_win[i].rw_buf != NULL)
+			continue;
+
+		D_ALLOC(ra->ra_win[i].rw_buf, IOIL_RA_SIZE);
+		if (ra->ra_win[i].rw_buf == NULL)
+			return false;
+	}
+	return true;
+}
+
+/* Complete any prefetch in flight, must be called with ra_lock held */
+static void
+ra_wait(struct ioil_ra *ra)
+{
+	struct ioil_ra_win	*win = &ra->ra_win[ra->ra_cur ^ 1];
+	bool			flag = false;
+	int			rc;
+
+	if (!ra->ra_inflight)
+		return;
+
+	rc = daos_event_test(&ra->ra_ev, DAOS_EQ_WAIT, &flag);
+	if (rc == 0)
+		rc = ra->ra_ev.ev_error;
+	if (rc == 0) {
+		win->rw_off = ra->ra_rg.rg_idx;
+		win->rw_len = ra->ra_rg.rg_len;
+	} else {
+		DFUSE_LOG_INFO("read-ahead failed "DF_RC, DP_RC(rc));
+		win->rw_len = 0;
+	}
+
+	daos_event_fini(&ra->ra_ev);
+	ra->ra_inflight = false;
+}
+
+static void
+ra_drop(struct ioil_ra *ra)
+{
+	ra_wait(ra);
+	ra->ra_win[0].rw_len = 0;
+	ra->ra_win[1].rw_len = 0;
+	ra->ra_size_valid = false;
+	ra->ra_seq = 0;
+}
+
+void
+ioil_ra_invalidate(struct fd_entry *entry)
+{
+	struct ioil_ra *ra = entry->fd_ra;
+
+	if (ra == NULL)
+		return;
+
+	pthread_mutex_lock(&ra->ra_lock);
+	ra_drop(ra);
+	pthread_mutex_unlock(&ra->ra_lock);
+}
+
+void
+ioil_ra_fini(struct fd_entry *entry)
+{
+	struct ioil_ra *ra = entry->fd_ra;
+
+	if (ra == NULL)
+		return;
+
+	ra_wait(ra);
+	pthread_mutex_destroy(&ra->ra_lock);
+	D_FREE(ra->ra_win[0].rw_buf);
+	D_FREE(ra->ra_win[1].rw_buf);
+	D_FREE(ra);
+	entry->fd_ra = NULL;
+}
+
+/* Return the file size, using the cached value if the read is within it */
+static int
+get_size(struct fd_entry *entry, struct ioil_ra *ra, off_t end,
+	 daos_size_t *size)
+{
+	int rc;
+
+	if (ra && ra->ra_size_valid && (daos_size_t)end <= ra->ra_size) {
+		*size = ra->ra_size;
+		return 0;
+	}
+
+	rc = daos_array_get_size(entry->fd_aoh, DAOS_TX_NONE, size, NULL);
+	if (rc) {
+		D_ERROR("daos_array_get_size() failed "DF_RC"\n", DP_RC(rc));
+		return rc;
+	}
+
+	if (ra) {
+		ra->ra_size = *size;
+		ra->ra_size_valid = true;
+	}
+	return 0;
+}
+
 static ssize_t
-read_bulk(char *buff, size_t len, off_t position,
-	  struct fd_entry *entry, int *errcode)
+read_sync(char *buff, size_t len, off_t position, struct fd_entry *entry,
+	  struct ioil_ra *ra, int *errcode)
 {
 	daos_array_iod_t	iod;
 	daos_size_t		array_size;
@@ -39,12 +220,8 @@ read_bulk(char *buff, size_t len, off_t position,
 	d_sg_list_t		sgl = {};
 	int rc;
 
-	DFUSE_TRA_INFO(entry, "%#zx-%#zx ", position, position + len - 1);
-
-	rc = daos_array_get_size(entry->fd_aoh, DAOS_TX_NONE, &array_size,
-				 NULL);
+	rc = get_size(entry, ra, position + len, &array_size);
 	if (rc) {
-		D_ERROR("daos_array_get_size() failed "DF_RC"\n", DP_RC(rc));
 		*errcode = daos_der2errno(rc);
 		return -1;
 	}
@@ -78,6 +255,137 @@ read_bulk(char *buff, size_t len, off_t position,
 	return len;
 }
 
+/* Copy as much of the request as possible from the read-ahead windows,
+ * switching to the prefetched window if the read has reached it.
+ */
+static size_t
+ra_copy(struct ioil_ra *ra, char *buff, size_t len, off_t position)
+{
+	struct ioil_ra_win	*win = &ra->ra_win[ra->ra_cur];
+	size_t			count;
+
+	if (position < win->rw_off || position >= win->rw_off + win->rw_len) {
+		if (!ra->ra_inflight || position < ra->ra_rg.rg_idx ||
+		    position >= ra->ra_rg.rg_idx + ra->ra_rg.rg_len)
+			return 0;
+
+		ra_wait(ra);
+		ra->ra_cur ^= 1;
+		win = &ra->ra_win[ra->ra_cur];
+		if (win->rw_len == 0)
+			return 0;
+	}
+
+	count = win->rw_off + win->rw_len - position;
+	if (count > len)
+		count = len;
+	memcpy(buff, win->rw_buf + (position - win->rw_off), count);
+	return count;
+}
+
+/* Launch an asynchronous read of the window following the current one */
+static void
+ra_prefetch(struct fd_entry *entry, struct ioil_ra *ra, off_t next)
+{
+	struct ioil_ra_win	*win = &ra->ra_win[ra->ra_cur];
+	daos_size_t		array_size;
+	off_t			start = next;
+	int			rc;
+
+	if (ra->ra_inflight || !ra_win_alloc(ra))
+		return;
+
+	if (next >= win->rw_off && next < win->rw_off + win->rw_len)
+		start = win->rw_off + win->rw_len;
+
+	rc = get_size(entry, ra, start + 1, &array_size);
+	if (rc || start >= array_size)
+		return;
+
+	/* The other window is about to be overwritten */
+	win = &ra->ra_win[ra->ra_cur ^ 1];
+	win->rw_len = 0;
+
+	ra->ra_rg.rg_idx = start;
+	ra->ra_rg.rg_len = array_size - start;
+	if (ra->ra_rg.rg_len > IOIL_RA_SIZE)
+		ra->ra_rg.rg_len = IOIL_RA_SIZE;
+	ra->ra_iod.arr_nr = 1;
+	ra->ra_iod.arr_rgs = &ra->ra_rg;
+	d_iov_set(&ra->ra_iov, win->rw_buf, ra->ra_rg.rg_len);
+	ra->ra_sgl.sg_nr = 1;
+	ra->ra_sgl.sg_iovs = &ra->ra_iov;
+
+	rc = daos_event_init(&ra->ra_ev, DAOS_HDL_INVAL, NULL);
+	if (rc)
+		return;
+
+	rc = daos_array_read(entry->fd_aoh, DAOS_TX_NONE, &ra->ra_iod,
+			     &ra->ra_sgl, NULL, &ra->ra_ev);
+	if (rc) {
+		DFUSE_TRA_INFO(entry, "read-ahead not started "DF_RC"",
+			       DP_RC(rc));
+		daos_event_fini(&ra->ra_ev);
+		return;
+	}
+
+	DFUSE_TRA_DEBUG(entry, "read-ahead %#zx-%#zx", ra->ra_rg.rg_idx,
+			ra->ra_rg.rg_idx + ra->ra_rg.rg_len - 1);
+	ra->ra_inflight = true;
+}
+
+static ssize_t
+read_bulk(char *buff, size_t len, off_t position,
+	  struct fd_entry *entry, int *errcode)
+{
+	struct ioil_ra	*ra = entry->fd_ra;
+	size_t		done = 0;
+	ssize_t		bytes_read;
+	size_t		count;
+
+	DFUSE_TRA_INFO(entry, "%#zx-%#zx ", position, position + len - 1);
+
+	/* Data still in the write-back buffer has to be visible to reads */
+	ioil_wb_flush(entry);
+
+	if (ra == NULL)
+		return read_sync(buff, len, position, entry, NULL, errcode);
+
+	pthread_mutex_lock(&ra->ra_lock);
+
+	if (position == ra->ra_next)
+		ra->ra_seq++;
+	else
+		ra->ra_seq = 0;
+
+	while (done < len) {
+		count = ra_copy(ra, buff + done, len - done, position + done);
+		if (count == 0)
+			break;
+		done += count;
+	}
+
+	if (done < len) {
+		bytes_read = read_sync(buff + done, len - done,
+				       position + done, entry, ra, errcode);
+		if (bytes_read < 0 && done == 0) {
+			pthread_mutex_unlock(&ra->ra_lock);
+			return -1;
+		}
+		if (bytes_read > 0)
+			done += bytes_read;
+	}
+
+	ra->ra_next = position + done;
+
+	if (ra->ra_seq >= IOIL_RA_SEQ_MIN)
+		ra_prefetch(entry, ra, ra->ra_next);
+
+	pthread_mutex_unlock(&ra->ra_lock);
+
+	return done;
+}
+
 ssize_t ioil_do_pread(char *buff, size_t len, off_t position,
 		      struct fd_entry *entry, int *errcode)
 {
@@ -22,14 +22,216 @@
  */
 
 #define D_LOGFAC DD_FAC(il)
+#include <pthread.h>
+#include <fcntl.h>
+#include <time.h>
+#include <inttypes.h>
+#include <gurt/list.h>
 #include "dfuse_common.h"
 #include "intercept.h"
 #include "daos.h"
 #include "daos_array.h"
 
-ssize_t
-ioil_do_writex(const char *buff, size_t len, off_t position,
-	       struct fd_entry *entry, int *errcode)
+/* Write-back is opt-in, D_IL_WB_SIZE sets the per-file buffer size in bytes
+ * and D_IL_WB_AGE the maximum time in milliseconds data is held for before a
+ * background flush is started.
+ */
+#define IOIL_WB_SIZE_MAX	(16 * 1024 * 1024)
+#define IOIL_WB_AGE_DEFAULT	100
+
+static size_t	ioil_wb_size;
+static uint64_t	ioil_wb_age;
+
+/* Per open file write-back state.
+ *
+ * Contiguous writes smaller than the buffer are copied into wb_buf[wb_cur]
+ * and acknowledged immediately.  Once the buffer is full, has been holding
+ * data for D_IL_WB_AGE, or a non-contiguous write arrives it is written back
+ * with an asynchronous daos_array_write() and the other buffer starts
+ * filling, so at most one flush is ever in flight and writes reach DAOS in
+ * the order they were made.
+ *
+ * Errors from a background flush cannot be returned to the write() that
+ * buffered the data so they are kept in wb_rc and reported by the next
+ * fsync, fdatasync or close on the file, as the kernel does for write-back
+ * errors.
+ */
+struct ioil_wb {
+	pthread_mutex_t		wb_lock;
+	/* Link in ioil_wb_list, for the flusher thread */
+	d_list_t		wb_link;
+	daos_handle_t		wb_aoh;
+	char			*wb_buf[2];
+	int			wb_cur;
+	off_t			wb_off;
+	size_t			wb_len;
+	/* Time the buffered data was first written, in milliseconds */
+	uint64_t		wb_start;
+	int			wb_rc;
+	bool			wb_inflight;
+	daos_event_t		wb_ev;
+	daos_array_iod_t	wb_iod;
+	daos_range_t		wb_rg;
+	d_sg_list_t		wb_sgl;
+	d_iov_t			wb_iov;
+};
+
+/* All write-back buffers, the flusher thread walks the list every half
+ * D_IL_WB_AGE and starts a flush of any buffer that is old enough.  It only
+ * try-locks the buffers, so it never waits for the application.
+ */
+static D_LIST_HEAD(ioil_wb_list);
+static pthread_mutex_t	ioil_wb_list_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	ioil_wb_list_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t	ioil_wb_thread;
+static bool		ioil_wb_thread_started;
+static bool		ioil_wb_stop;
+
+static void wb_wait(struct ioil_wb *wb, bool block);
+static void wb_submit(struct ioil_wb *wb);
+
+static uint64_t
+wb_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static void *
+wb_flusher(void *arg)
+{
+	struct ioil_wb	*wb;
+	struct timespec	 ts;
+	uint64_t	 now;
+
+	pthread_mutex_lock(&ioil_wb_list_lock);
+	while (!ioil_wb_stop) {
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_nsec += (ioil_wb_age / 2 + 1) * 1000000;
+		ts.tv_sec += ts.tv_nsec / 1000000000;
+		ts.tv_nsec %= 1000000000;
+		pthread_cond_timedwait(&ioil_wb_list_cond, &ioil_wb_list_lock,
+				       &ts);
+
+		now = wb_now();
+		d_list_for_each_entry(wb, &ioil_wb_list, wb_link) {
+			if (pthread_mutex_trylock(&wb->wb_lock) != 0)
+				continue;
+			/* Don't block the list on a slow flush */
+			wb_wait(wb, false);
+			if (!wb->wb_inflight && wb->wb_len != 0 &&
+			    now - wb->wb_start >= ioil_wb_age)
+				wb_submit(wb);
+			pthread_mutex_unlock(&wb->wb_lock);
+		}
+	}
+	pthread_mutex_unlock(&ioil_wb_list_lock);
+	return NULL;
+}
+
+/* The flusher isn't copied to a forked child, let it start another one */
+static void
+wb_atfork_child(void)
+{
+	pthread_mutex_init(&ioil_wb_list_lock, NULL);
+	ioil_wb_thread_started = false;
+}
+
+void
+ioil_wb_setup(void)
+{
+	unsigned int size = 0;
+	unsigned int age = IOIL_WB_AGE_DEFAULT;
+
+	d_getenv_int("D_IL_WB_SIZE", &size);
+	d_getenv_int("D_IL_WB_AGE", &age);
+
+	if (size > IOIL_WB_SIZE_MAX)
+		size = IOIL_WB_SIZE_MAX;
+
+	ioil_wb_size = size;
+	ioil_wb_age = age;
+
+	if (ioil_wb_size != 0 && ioil_wb_age != 0)
+		pthread_atfork(NULL, NULL, wb_atfork_child);
+
+	if (ioil_wb_size != 0)
+		DFUSE_LOG_INFO("write-back enabled, size %zu age %"PRIu64" ms",
+			       ioil_wb_size, ioil_wb_age);
+}
+
+void
+ioil_wb_cleanup(void)
+{
+	pthread_mutex_lock(&ioil_wb_list_lock);
+	ioil_wb_stop = true;
+	pthread_cond_signal(&ioil_wb_list_cond);
+	pthread_mutex_unlock(&ioil_wb_list_lock);
+
+	if (ioil_wb_thread_started) {
+		pthread_join(ioil_wb_thread, NULL);
+		ioil_wb_thread_started = false;
+	}
+}
+
+int
+ioil_wb_init(struct fd_entry *entry)
+{
+	struct ioil_wb	*wb;
+	int		i;
+	int		rc;
+
+	entry->fd_wb = NULL;
+
+	if (ioil_wb_size == 0 || (entry->fd_flags & O_ACCMODE) == O_RDONLY)
+		return 0;
+
+	D_ALLOC_PTR(wb);
+	if (wb == NULL)
+		return ENOMEM;
+
+	for (i = 0; i < 2; i++) {
+		D_ALLOC(wb->wb_buf[i], ioil_wb_size);
+		if (wb->wb_buf[i] == NULL)
+			D_GOTO(err, rc = ENOMEM);
+	}
+
+	rc = pthread_mutex_init(&wb->wb_lock, NULL);
+	if (rc != 0)
+		D_GOTO(err, rc);
+
+	wb->wb_aoh = entry->fd_aoh;
+
+	pthread_mutex_lock(&ioil_wb_list_lock);
+	/* Without the flusher data is still written back at the other flush
+	 * points, so carry on if it can't be started.
+	 */
+	if (!ioil_wb_thread_started && ioil_wb_age != 0 && !ioil_wb_stop) {
+		rc = pthread_create(&ioil_wb_thread, NULL, wb_flusher, NULL);
+		if (rc == 0)
+			ioil_wb_thread_started = true;
+		else
+			DFUSE_LOG_INFO("Failed to start write-back flusher %d",
+				       rc);
+	}
+	d_list_add(&wb->wb_link, &ioil_wb_list);
+	pthread_mutex_unlock(&ioil_wb_list_lock);
+
+	entry->fd_wb = wb;
+	return 0;
+
+err:
+	D_FREE(wb->wb_buf[0]);
+	D_FREE(wb->wb_buf[1]);
+	D_FREE(wb);
+	return rc;
+}
+
+static ssize_t
+write_sync(const char *buff, size_t len, off_t position,
+	   struct fd_entry *entry, int *errcode)
 {
 	daos_array_iod_t	iod;
 	daos_range_t		rg;
@@ -59,6 +261,180 @@ ioil_do_writex(const char *buff, size_t len, off_t position,
 	return len;
 }
 
+/* Complete the flush in flight, if any, must be called with wb_lock held.
+ * Without \a block it only reaps a flush that has already completed.
+ */
+static void
+wb_wait(struct ioil_wb *wb, bool block)
+{
+	bool	flag = false;
+	int	rc;
+
+	if (!wb->wb_inflight)
+		return;
+
+	rc = daos_event_test(&wb->wb_ev, block ? DAOS_EQ_WAIT : DAOS_EQ_NOWAIT,
+			     &flag);
+	if (rc == 0 && !flag)
+		return;
+	if (rc == 0)
+		rc = wb->wb_ev.ev_error;
+	if (rc != 0) {
+		DFUSE_LOG_ERROR("write-back of %#zx-%#zx failed "DF_RC,
+				wb->wb_rg.rg_idx,
+				wb->wb_rg.rg_idx + wb->wb_rg.rg_len - 1,
+				DP_RC(rc));
+		if (wb->wb_rc == 0)
+			wb->wb_rc = rc;
+	}
+
+	daos_event_fini(&wb->wb_ev);
+	wb->wb_inflight = false;
+}
+
+/* Start writing back the buffered data, must be called with wb_lock held */
+static void
+wb_submit(struct ioil_wb *wb)
+{
+	int rc;
+
+	if (wb->wb_len == 0)
+		return;
+
+	wb_wait(wb, true);
+
+	wb->wb_rg.rg_idx = wb->wb_off;
+	wb->wb_rg.rg_len = wb->wb_len;
+	wb->wb_iod.arr_nr = 1;
+	wb->wb_iod.arr_rgs = &wb->wb_rg;
+	d_iov_set(&wb->wb_iov, wb->wb_buf[wb->wb_cur], wb->wb_len);
+	wb->wb_sgl.sg_nr = 1;
+	wb->wb_sgl.sg_iovs = &wb->wb_iov;
+
+	wb->wb_cur ^= 1;
+	wb->wb_len = 0;
+
+	rc = daos_event_init(&wb->wb_ev, DAOS_HDL_INVAL, NULL);
+	if (rc)
+		goto sync;
+
+	rc = daos_array_write(wb->wb_aoh, DAOS_TX_NONE, &wb->wb_iod,
+			      &wb->wb_sgl, NULL, &wb->wb_ev);
+	if (rc) {
+		daos_event_fini(&wb->wb_ev);
+		goto sync;
+	}
+
+	wb->wb_inflight = true;
+	return;
+
+sync:
+	rc = daos_array_write(wb->wb_aoh, DAOS_TX_NONE, &wb->wb_iod,
+			      &wb->wb_sgl, NULL, NULL);
+	if (rc && wb->wb_rc == 0)
+		wb->wb_rc = rc;
+}
+
+void
+ioil_wb_flush(struct fd_entry *entry)
+{
+	struct ioil_wb *wb = entry->fd_wb;
+
+	if (wb == NULL)
+		return;
+
+	pthread_mutex_lock(&wb->wb_lock);
+	wb_submit(wb);
+	wb_wait(wb, true);
+	pthread_mutex_unlock(&wb->wb_lock);
+}
+
+int
+ioil_wb_sync(struct fd_entry *entry)
+{
+	struct ioil_wb	*wb = entry->fd_wb;
+	int		rc;
+
+	if (wb == NULL)
+		return 0;
+
+	pthread_mutex_lock(&wb->wb_lock);
+	wb_submit(wb);
+	wb_wait(wb, true);
+	rc = wb->wb_rc;
+	wb->wb_rc = 0;
+	pthread_mutex_unlock(&wb->wb_lock);
+
+	return rc;
+}
+
+void
+ioil_wb_fini(struct fd_entry *entry)
+{
+	struct ioil_wb *wb = entry->fd_wb;
+
+	if (wb == NULL)
+		return;
+
+	pthread_mutex_lock(&ioil_wb_list_lock);
+	d_list_del(&wb->wb_link);
+	pthread_mutex_unlock(&ioil_wb_list_lock);
+
+	wb_submit(wb);
+	wb_wait(wb, true);
+	pthread_mutex_destroy(&wb->wb_lock);
+	D_FREE(wb->wb_buf[0]);
+	D_FREE(wb->wb_buf[1]);
+	D_FREE(wb);
+	entry->fd_wb = NULL;
+}
+
+ssize_t
+ioil_do_writex(const char *buff, size_t len, off_t position,
+	       struct fd_entry *entry, int *errcode)
+{
+	struct ioil_wb	*wb = entry->fd_wb;
+	ssize_t		bytes_written = len;
+
+	/* Any prefetched data or cached size may now be stale */
+	ioil_ra_invalidate(entry);
+
+	if (wb == NULL)
+		return write_sync(buff, len, position, entry, errcode);
+
+	pthread_mutex_lock(&wb->wb_lock);
+
+	/* Large writes go straight to DAOS once earlier data is written */
+	if (len >= ioil_wb_size) {
+		wb_submit(wb);
+		wb_wait(wb, true);
+		bytes_written = write_sync(buff, len, position, entry,
+					   errcode);
+		goto out;
+	}
+
+	if (wb->wb_len != 0 && (position != wb->wb_off + wb->wb_len ||
+				wb->wb_len + len > ioil_wb_size))
+		wb_submit(wb);
+
+	if (wb->wb_len == 0) {
+		wb->wb_off = position;
+		wb->wb_start = wb_now();
+	}
+
+	DFUSE_TRA_DEBUG(entry, "buffered %#zx-%#zx", position,
+			position + len - 1);
+	memcpy(wb->wb_buf[wb->wb_cur] + wb->wb_len, buff, len);
+	wb->wb_len += len;
+
+	if (wb->wb_len == ioil_wb_size)
+		wb_submit(wb);
+
+out:
+	pthread_mutex_unlock(&wb->wb_lock);
+	return bytes_written;
+}
+
 ssize_t
 ioil_do_pwritev(const struct iovec *iov, int count, off_t position,
 		struct fd_entry *entry, int *errcode)
@@ -26,6 +26,7 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <sys/uio.h>
+#include <sys/stat.h>
 #include "dfuse_log.h"
 #include "ioil_io.h"
 #include "ioil_api.h"
@@ -52,6 +53,7 @@
 	ACTION(off_t,   lseek,     (int, off_t, int))                         \
 	ACTION(ssize_t, preadv,    (int, const struct iovec *, int, off_t))   \
 	ACTION(ssize_t, pwritev,   (int, const struct iovec *, int, off_t))   \
+	ACTION(int,     ftruncate, (int, off_t))                              \
 	ACTION(void *,  mmap,      (void *, size_t, int, int, int, off_t))
 
 #define FOREACH_SINGLE_INTERCEPT(ACTION)                                      \
@@ -68,8 +70,18 @@
 	ACTION(int,     fcntl,     (int fd, int cmd, ...))                    \
 	ACTION(FILE *,  fdopen,    (int, const char *))
 
+/* Functions libc might not export. glibc 2.33 and later export fstat() and
+ * fstat64(), and keep __fxstat() only for binaries built against older
+ * versions, which implement fstat() in libc_nonshared.a by calling it.
+ */
+#define FOREACH_OPTIONAL_INTERCEPT(ACTION)                                    \
+	ACTION(int,     __fxstat,  (int, int, struct stat *))                 \
+	ACTION(int,     fstat,     (int, struct stat *))                      \
+	ACTION(int,     fstat64,   (int, struct stat64 *))
+
 #define FOREACH_INTERCEPT(ACTION)            \
 	FOREACH_SINGLE_INTERCEPT(ACTION)     \
+	FOREACH_OPTIONAL_INTERCEPT(ACTION)   \
 	FOREACH_ALIASED_INTERCEPT(ACTION)
 
 #ifdef IOIL_PRELOAD
@@ -100,6 +112,15 @@
 		}                                                           \
 	} while (0);
 
+/* Initialize the __real_##name function pointer, it is NULL if not found */
+#define IOIL_FORWARD_MAP(type, name, params)                                \
+	do {                                                                \
+		if (__real_##name != NULL)                                  \
+			break;                                              \
+		__real_##name = (__typeof__(__real_##name))dlsym(RTLD_NEXT, \
+								 #name);    \
+	} while (0);
+
 #else /* !IOIL_PRELOAD */
 #define IOIL_FORWARD_DECL(type, name, params)  \
 	extern type __real_##name params;
@@ -108,6 +129,8 @@
 
 #define IOIL_FORWARD_MAP_OR_FAIL(type, name, params) (void)0;
 
+#define IOIL_FORWARD_MAP(type, name, params) (void)0;
+
 #define IOIL_DECLARE_ALIAS(type, name, params) \
 	DFUSE_PUBLIC type __wrap_##name params \
 		__attribute__((weak, alias("dfuse_" #name)));
@@ -118,13 +141,41 @@
 
 #endif /* IOIL_PRELOAD */
 
+struct ioil_ra;
+struct ioil_wb;
+
 struct fd_entry {
 	daos_handle_t	fd_aoh;
+	/** Read-ahead state, shared by all dup()s of the descriptor, NULL if
+	 * read-ahead is disabled.
+	 */
+	struct ioil_ra	*fd_ra;
+	/** Write-back buffer, NULL unless enabled with D_IL_WB_SIZE */
+	struct ioil_wb	*fd_wb;
 	off_t		fd_pos;
 	int		fd_flags;
 	int		fd_status;
 };
 
+int
+ioil_ra_init(struct fd_entry *entry);
+void
+ioil_ra_fini(struct fd_entry *entry);
+void
+ioil_ra_invalidate(struct fd_entry *entry);
+void
+ioil_wb_setup(void);
+void
+ioil_wb_cleanup(void);
+int
+ioil_wb_init(struct fd_entry *entry);
+void
+ioil_wb_fini(struct fd_entry *entry);
+void
+ioil_wb_flush(struct fd_entry *entry);
+int
+ioil_wb_sync(struct fd_entry *entry);
+
 ssize_t
 ioil_do_pread(char *buff, size_t len, off_t position,
 	      struct fd_entry *entry, int *errcode);
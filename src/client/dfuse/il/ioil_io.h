@@ -27,6 +27,7 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <sys/uio.h>
+#include <sys/stat.h>
 #include <stdio.h>
 #include "ioil_defines.h"
 
@@ -46,6 +47,10 @@ DFUSE_PUBLIC ssize_t dfuse_readv(int, const struct iovec *, int);
 DFUSE_PUBLIC ssize_t dfuse_writev(int, const struct iovec *, int);
 DFUSE_PUBLIC int dfuse_fsync(int);
 DFUSE_PUBLIC int dfuse_fdatasync(int);
+DFUSE_PUBLIC int dfuse_ftruncate(int, off_t);
+DFUSE_PUBLIC int dfuse___fxstat(int, int, struct stat *);
+DFUSE_PUBLIC int dfuse_fstat(int, struct stat *);
+DFUSE_PUBLIC int dfuse_fstat64(int, struct stat64 *);
 DFUSE_PUBLIC int dfuse_dup(int);
 DFUSE_PUBLIC int dfuse_dup2(int, int);
 DFUSE_PUBLIC int dfuse_fcntl(int fd, int cmd, ...);
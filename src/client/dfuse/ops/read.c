@@ -24,21 +24,91 @@
 #include "dfuse_common.h"
 #include "dfuse.h"
 
+/* Maximum number of read buffers in existence, i.e. of concurrent reads served
+ * from the pool; any more are served from a temporary allocation.
+ */
+#define DFUSE_READ_BUF_MAX	16
+
+static void
+dfuse_read_buf_setup(void *arg, void *handle)
+{
+	struct dfuse_read_buf		*rb = arg;
+	struct dfuse_projection_info	*fs_handle = handle;
+
+	rb->drb_size = fs_handle->dpi_max_read;
+}
+
+/* Allocate the buffer on first use; it is then kept for the lifetime of the
+ * descriptor so that subsequent reads neither allocate nor fault in pages.
+ */
+static bool
+dfuse_read_buf_reset(void *arg)
+{
+	struct dfuse_read_buf *rb = arg;
+
+	if (!rb->drb_buf)
+		D_ALLOC(rb->drb_buf, rb->drb_size);
+	return rb->drb_buf != NULL;
+}
+
+static void
+dfuse_read_buf_release(void *arg)
+{
+	struct dfuse_read_buf *rb = arg;
+
+	D_FREE(rb->drb_buf);
+}
+
+int
+dfuse_read_buf_init(struct dfuse_projection_info *fs_handle)
+{
+	struct dfuse_da_reg reg = {.init = dfuse_read_buf_setup,
+				   .reset = dfuse_read_buf_reset,
+				   .release = dfuse_read_buf_release,
+				   .max_desc = DFUSE_READ_BUF_MAX,
+				   .max_free_desc = DFUSE_READ_BUF_MAX,
+				   POOL_TYPE_INIT(dfuse_read_buf, drb_list)};
+	int rc;
+
+	rc = dfuse_da_init(&fs_handle->dpi_da, fs_handle);
+	if (rc != -DER_SUCCESS)
+		return rc;
+
+	fs_handle->dpi_read_da = dfuse_da_register(&fs_handle->dpi_da, &reg);
+	if (!fs_handle->dpi_read_da) {
+		dfuse_da_destroy(&fs_handle->dpi_da);
+		return -DER_NOMEM;
+	}
+	return -DER_SUCCESS;
+}
+
 void
 dfuse_cb_read(fuse_req_t req, fuse_ino_t ino, size_t len, off_t position,
 	      struct fuse_file_info *fi)
 {
+	struct dfuse_projection_info	*fs_handle = fuse_req_userdata(req);
 	struct dfuse_obj_hdl		*oh = (struct dfuse_obj_hdl *)fi->fh;
+	struct dfuse_read_buf		*rb = NULL;
 	d_iov_t				iov = {};
 	d_sg_list_t			sgl = {};
 	daos_size_t			size;
 	void				*buff;
 	int				rc;
 
-	D_ALLOC(buff, len);
-	if (!buff) {
-		DFUSE_REPLY_ERR_RAW(NULL, req, ENOMEM);
-		return;
+	/* Use a pooled buffer if one is free, otherwise fall back to a
+	 * temporary allocation rather than block the request.
+	 */
+	if (fs_handle->dpi_read_da && len <= fs_handle->dpi_max_read)
+		rb = dfuse_da_acquire(fs_handle->dpi_read_da);
+	if (rb) {
+		DFUSE_TRA_UP(rb, oh, "read_buf");
+		buff = rb->drb_buf;
+	} else {
+		D_ALLOC(buff, len);
+		if (!buff) {
+			DFUSE_REPLY_ERR_RAW(NULL, req, ENOMEM);
+			return;
+		}
 	}
 
 	sgl.sg_nr = 1;
@@ -47,8 +117,14 @@ dfuse_cb_read(fuse_req_t req, fuse_ino_t ino, size_t len, off_t position,
 
 	rc = dfs_read(oh->doh_dfs, oh->doh_obj, &sgl, position, &size, NULL);
 	if (rc == 0)
-		DFUSE_REPLY_BUF(oh, req, buff, size);
+		DFUSE_REPLY_DATA(oh, req, buff, size);
 	else
 		DFUSE_REPLY_ERR_RAW(oh, req, rc);
-	D_FREE(buff);
+
+	if (rb) {
+		dfuse_da_release(fs_handle->dpi_read_da, rb);
+		dfuse_da_restock(fs_handle->dpi_read_da);
+	} else {
+		D_FREE(buff);
+	}
 }
@@ -30,6 +30,7 @@
 #include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
+#include <sys/wait.h>
 #include <unistd.h>
 #include <stdbool.h>
 #include <fcntl.h>
@@ -242,6 +243,143 @@ done:
 	free(buf2);
 }
 
+/* Read a file sequentially in small chunks so that the read-ahead windows are
+ * used, overwriting part of it through the same descriptor half way through
+ * to check that data prefetched before the write is not returned.
+ */
+static void do_seq_read_test(const char *fname)
+{
+	size_t len = 3 * 1024 * 1024 + 123;
+	size_t chunk = 4096;
+	size_t offset;
+	ssize_t bytes;
+	char *buf;
+	char *rbuf = NULL;
+	size_t i;
+	int fd = -1;
+
+	buf = malloc(len);
+	CU_ASSERT_GOTO(buf != NULL, done);
+
+	rbuf = malloc(chunk);
+	CU_ASSERT_GOTO(rbuf != NULL, done);
+
+	for (i = 0; i < len; i++)
+		buf[i] = i % 251;
+
+	CU_ASSERT_GOTO(do_large_write(fname, buf, len), done);
+
+	fd = open(fname, O_RDWR);
+	CU_ASSERT_GOTO(fd != -1, done);
+
+	for (offset = 0; offset < len; offset += bytes) {
+		if (offset == 128 * chunk) {
+			memset(buf + offset + chunk, 'r', chunk);
+			bytes = pwrite(fd, buf + offset + chunk, chunk,
+				       offset + chunk);
+			CU_ASSERT_EQUAL(bytes, chunk);
+		}
+		bytes = read(fd, rbuf, chunk);
+		CU_ASSERT_GOTO(bytes > 0, done);
+		CU_ASSERT_GOTO(memcmp(buf + offset, rbuf, bytes) == 0, done);
+	}
+	CU_ASSERT_EQUAL(offset, len);
+
+	bytes = read(fd, rbuf, chunk);
+	CU_ASSERT_EQUAL(bytes, 0);
+done:
+	if (fd != -1)
+		close(fd);
+	free(buf);
+	free(rbuf);
+}
+
+/* Write a file in chunks small enough to stay in the write-back buffer,
+ * checking that the data is visible to reads and fstat() on the same
+ * descriptor straight away, to another descriptor once it is older than
+ * D_IL_WB_AGE, and that fsync() and close() succeed.
+ */
+static void do_wb_test(const char *fname)
+{
+	size_t chunk = 1000;
+	size_t len = 24 * chunk;
+	struct stat stat_info;
+	ssize_t bytes;
+	char *buf;
+	char *rbuf = NULL;
+	size_t i;
+	int fd = -1;
+	int fd2 = -1;
+	int rc;
+
+	buf = malloc(len);
+	CU_ASSERT_GOTO(buf != NULL, done);
+
+	rbuf = malloc(len);
+	CU_ASSERT_GOTO(rbuf != NULL, done);
+
+	for (i = 0; i < len; i++)
+		buf[i] = i % 241;
+
+	fd = open(fname, O_RDWR | O_CREAT | O_TRUNC, 0600);
+	CU_ASSERT_GOTO(fd != -1, done);
+
+	for (i = 0; i < 16; i++) {
+		bytes = write(fd, buf + i * chunk, chunk);
+		CU_ASSERT_EQUAL(bytes, chunk);
+	}
+
+	/* Read after write through the same descriptor */
+	bytes = pread(fd, rbuf, 16 * chunk, 0);
+	printf("Read %zd bytes, expected %zu\n", bytes, 16 * chunk);
+	CU_ASSERT_EQUAL(bytes, 16 * chunk);
+	CU_ASSERT(memcmp(buf, rbuf, 16 * chunk) == 0);
+
+	rc = fstat(fd, &stat_info);
+	CU_ASSERT_EQUAL(rc, 0);
+	CU_ASSERT_EQUAL(stat_info.st_size, 16 * chunk);
+
+	/* Left alone, buffered data is written back after D_IL_WB_AGE */
+	for (i = 16; i < 20; i++) {
+		bytes = write(fd, buf + i * chunk, chunk);
+		CU_ASSERT_EQUAL(bytes, chunk);
+	}
+	usleep(500 * 1000);
+
+	fd2 = open(fname, O_RDONLY);
+	CU_ASSERT_GOTO(fd2 != -1, done);
+
+	bytes = pread(fd2, rbuf, len, 0);
+	printf("Read %zd bytes, expected %zu\n", bytes, 20 * chunk);
+	CU_ASSERT_EQUAL(bytes, 20 * chunk);
+	CU_ASSERT(memcmp(buf, rbuf, 20 * chunk) == 0);
+
+	for (i = 20; i < 24; i++) {
+		bytes = write(fd, buf + i * chunk, chunk);
+		CU_ASSERT_EQUAL(bytes, chunk);
+	}
+
+	rc = fsync(fd);
+	printf("fsync returned %d\n", rc);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	bytes = pread(fd2, rbuf, len, 0);
+	CU_ASSERT_EQUAL(bytes, len);
+	CU_ASSERT(memcmp(buf, rbuf, len) == 0);
+
+	rc = close(fd);
+	fd = -1;
+	printf("close returned %d\n", rc);
+	CU_ASSERT_EQUAL(rc, 0);
+done:
+	if (fd != -1)
+		close(fd);
+	if (fd2 != -1)
+		close(fd2);
+	free(buf);
+	free(rbuf);
+}
+
 static void do_misc_tests(const char *fname, size_t len)
 {
 	struct stat stat_info;
@@ -446,9 +584,49 @@ void sanity(void)
 	do_read_tests(buf, len);
 	do_misc_tests(buf, len);
 	do_large_io_test(buf, len);
+	do_seq_read_test(buf);
+	free(buf);
+}
+
+/* Sanity test of the write-back buffer, run by write_back() below */
+static void wb_sanity(void)
+{
+	char *buf;
+	int rc;
+
+	rc = asprintf(&buf, "%s/wb_sanity", mount_dir);
+	CU_ASSERT_NOT_EQUAL_FATAL(rc, -1);
+
+	unlink(buf);
+	do_wb_test(buf);
+	unlink(buf);
 	free(buf);
 }
 
+/* The write-back settings are read when the library is loaded, so run the
+ * write-back test in a new process which has them set.
+ */
+void write_back(void)
+{
+	char *args[] = {"test_ioil", "wb", NULL};
+	int status;
+	pid_t pid;
+
+	fflush(stdout);
+	pid = fork();
+	CU_ASSERT_NOT_EQUAL_FATAL(pid, -1);
+	if (pid == 0) {
+		setenv("D_IL_WB_SIZE", "65536", 1);
+		setenv("D_IL_WB_AGE", "50", 1);
+		execv("/proc/self/exe", args);
+		_exit(127);
+	}
+
+	CU_ASSERT_EQUAL(waitpid(pid, &status, 0), pid);
+	printf("write-back test exited with status %#x\n", status);
+	CU_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
 int main(int argc, char **argv)
 {
 	int failures;
@@ -468,7 +646,16 @@ int main(int argc, char **argv)
 		return CU_get_error();
 	}
 
-	if (!CU_add_test(pSuite, "libioil sanity test", sanity)) {
+	if (argc > 1 && strcmp(argv[1], "wb") == 0) {
+		if (!CU_add_test(pSuite, "libioil write-back sanity test",
+				 wb_sanity)) {
+			CU_cleanup_registry();
+			printf("CU_add_test() failed\n");
+			return CU_get_error();
+		}
+	} else if (!CU_add_test(pSuite, "libioil sanity test", sanity) ||
+		   !CU_add_test(pSuite, "libioil write-back test",
+				write_back)) {
 		CU_cleanup_registry();
 		printf("CU_add_test() failed\n");
 		return CU_get_error();
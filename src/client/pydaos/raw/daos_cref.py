@@ -87,6 +87,16 @@ class PoolSpace(ctypes.Structure):
                 ("ps_ntargets", ctypes.c_uint32),
                 ("ps_padding", ctypes.c_uint32)]
 
+class PoolObjCache(ctypes.Structure):
+    """ Structure to represent Pool object cache statistics """
+    _fields_ = [("poc_hits", ctypes.c_uint64),
+                ("poc_misses", ctypes.c_uint64),
+                ("poc_evictions", ctypes.c_uint64),
+                ("poc_size", ctypes.c_uint64),
+                ("poc_cached", ctypes.c_uint64),
+                ("poc_resizes", ctypes.c_uint32),
+                ("poc_ntargets", ctypes.c_uint32)]
+
 class PoolInfo(ctypes.Structure):
     """ Structure to represent information about a pool """
     _fields_ = [("pi_uuid", ctypes.c_ubyte * 16),
@@ -97,7 +107,8 @@ class PoolInfo(ctypes.Structure):
                 ("pi_leader", ctypes.c_uint32),
                 ("pi_bits", ctypes.c_uint64),
                 ("pi_space", PoolSpace),
-                ("pi_rebuild_st", RebuildStatus)]
+                ("pi_rebuild_st", RebuildStatus),
+                ("pi_obj_cache", PoolObjCache)]
 
 
 class DaosPropertyEntry(ctypes.Structure):
@@ -29,6 +29,7 @@
  */
 #define D_LOGFAC	DD_FAC(tree)
 
+#include <pthread.h>
 #include <daos_errno.h>
 #include <daos/btree.h>
 #include <daos/dtx.h>
@@ -112,6 +113,33 @@ struct btr_trace {
 /** backtrace depth */
 #define BTR_TRACE_MAX		40
 
+/** A DRAM copy of a non-leaf node */
+struct btr_ncache_slot {
+	/** pmemobj pool uuid of the node */
+	uint64_t			 ns_pool;
+	/** offset of the node, UMOFF_NULL for an empty slot */
+	umem_off_t			 ns_off;
+	/** allocated size of ns_buf */
+	unsigned int			 ns_size;
+	/** copy of the node */
+	char				*ns_buf;
+};
+
+/**
+ * Per-thread DRAM copies of non-leaf nodes of trees in SCM, so a probe only
+ * reads the leaf from SCM. It is shared by all trees and handles, since a
+ * tree in SCM is only accessed by the xstream that owns it. Nodes are cached
+ * in a direct-mapped array indexed by the hash of the pool and node offset,
+ * and a node is dropped when it is added to a transaction, allocated or
+ * freed (see btr_node_tx_add, btr_node_alloc and btr_node_free).
+ */
+struct btr_node_cache {
+	/** number of cache slots */
+	unsigned int			 nc_nr;
+	/** cache slots */
+	struct btr_ncache_slot		 nc_slots[0];
+};
+
 /**
  * Context for btree operations.
  * NB: object cache will retain this data structure.
@@ -152,6 +180,34 @@ struct btr_context {
 /** size of print buffer */
 #define BTR_PRINT_BUF			128
 
+/**
+ * Nodes of BTR_FEAT_UINT_KEY tree with up to this number of records are
+ * searched by a linear scan instead of binary search, it can be changed
+ * by environment variable DAOS_BTR_SCAN_MAX, zero disables the scan.
+ */
+#define BTR_SCAN_MAX_DEF		64
+
+static unsigned int btr_scan_max = BTR_SCAN_MAX_DEF;
+
+/**
+ * Number of non-leaf nodes of trees in SCM cached in DRAM by each thread, it
+ * is set by environment variable DAOS_BTR_NODE_CACHE, the cache is disabled
+ * by default.
+ */
+static unsigned int btr_ncache_nr;
+
+/** Node cache of the thread, created on the first probe */
+static __thread struct btr_node_cache *btr_ncache;
+
+static pthread_once_t btr_env_once = PTHREAD_ONCE_INIT;
+
+static void
+btr_env_init(void)
+{
+	d_getenv_int("DAOS_BTR_SCAN_MAX", &btr_scan_max);
+	d_getenv_int("DAOS_BTR_NODE_CACHE", &btr_ncache_nr);
+}
+
 static int btr_class_init(umem_off_t root_off,
 			  struct btr_root *root, unsigned int tree_class,
 			  uint64_t *tree_feats, struct umem_attr *uma,
@@ -292,6 +348,8 @@ btr_context_create(umem_off_t root_off, struct btr_root *root,
 	unsigned int		 depth;
 	int			 rc;
 
+	(void)pthread_once(&btr_env_once, btr_env_init);
+
 	D_ALLOC_PTR(tcx);
 	if (tcx == NULL)
 		return -DER_NOMEM;
@@ -600,6 +658,104 @@ btr_node_size(struct btr_context *tcx)
 		tcx->tc_tins.ti_root->tr_node_size * btr_rec_size(tcx);
 }
 
+static struct btr_ncache_slot *
+btr_ncache_slot(struct btr_node_cache *nc, uint64_t pool, umem_off_t nd_off)
+{
+	return &nc->nc_slots[d_hash_murmur64((unsigned char *)&nd_off,
+					     sizeof(nd_off), pool) %
+			     nc->nc_nr];
+}
+
+/**
+ * Return the node at \a nd_off for probe. A non-leaf node is returned from
+ * the node cache (and copied into it on miss), so the returned node must be
+ * treated as read-only. The cache is only an optimization, so failure of
+ * allocation is ignored.
+ */
+static struct btr_node *
+btr_ncache_node(struct btr_context *tcx, umem_off_t nd_off)
+{
+	struct btr_node_cache	*nc = btr_ncache;
+	struct btr_ncache_slot	*slot;
+	struct btr_node		*nd;
+	uint64_t		 pool;
+	unsigned int		 size;
+
+	if (btr_ncache_nr == 0 || !btr_has_tx(tcx))
+		return btr_off2ptr(tcx, nd_off);
+
+	if (nc == NULL) {
+		D_ALLOC(nc, offsetof(struct btr_node_cache,
+				     nc_slots[btr_ncache_nr]));
+		if (nc == NULL)
+			return btr_off2ptr(tcx, nd_off);
+		nc->nc_nr = btr_ncache_nr;
+		btr_ncache = nc;
+	}
+
+	pool = umem_get_uuid(btr_umm(tcx));
+	slot = btr_ncache_slot(nc, pool, nd_off);
+	if (slot->ns_off == nd_off && slot->ns_pool == pool)
+		return (struct btr_node *)slot->ns_buf;
+
+	/* Do not cache a node changed by an inflight transaction, it could
+	 * be rolled back after the copy.
+	 */
+	nd = btr_off2ptr(tcx, nd_off);
+	if ((nd->tn_flags & BTR_NODE_LEAF) ||
+	    pmemobj_tx_stage() != TX_STAGE_NONE)
+		return nd;
+
+	/* non-leaf nodes always have the full size */
+	size = sizeof(struct btr_node) + tcx->tc_order * btr_rec_size(tcx);
+	if (slot->ns_size < size) {
+		D_FREE(slot->ns_buf);
+		slot->ns_off = UMOFF_NULL;
+		slot->ns_size = 0;
+		D_ALLOC(slot->ns_buf, size);
+		if (slot->ns_buf == NULL)
+			return nd;
+		slot->ns_size = size;
+	}
+
+	memcpy(slot->ns_buf, nd, size);
+	slot->ns_pool = pool;
+	slot->ns_off = nd_off;
+	return (struct btr_node *)slot->ns_buf;
+}
+
+/** Drop the cached copy of the node at \a nd_off, which is being changed */
+static void
+btr_ncache_drop(struct btr_context *tcx, umem_off_t nd_off)
+{
+	struct btr_node_cache	*nc = btr_ncache;
+	struct btr_ncache_slot	*slot;
+	uint64_t		 pool;
+
+	if (nc == NULL || !btr_has_tx(tcx))
+		return;
+
+	pool = umem_get_uuid(btr_umm(tcx));
+	slot = btr_ncache_slot(nc, pool, nd_off);
+	if (slot->ns_off == nd_off && slot->ns_pool == pool)
+		slot->ns_off = UMOFF_NULL;
+}
+
+void
+dbtree_ncache_fini(void)
+{
+	struct btr_node_cache	*nc = btr_ncache;
+	int			 i;
+
+	if (nc == NULL)
+		return;
+
+	for (i = 0; i < nc->nc_nr; i++)
+		D_FREE(nc->nc_slots[i].ns_buf);
+	D_FREE(nc);
+	btr_ncache = NULL;
+}
+
 static int
 btr_node_alloc(struct btr_context *tcx, umem_off_t *nd_off_p)
 {
@@ -611,6 +767,8 @@ btr_node_alloc(struct btr_context *tcx, umem_off_t *nd_off_p)
 		return btr_umm(tcx)->umm_nospc_rc;
 
 	D_DEBUG(DB_TRACE, "Allocate new node "DF_X64"\n", nd_off);
+	/* the offset may have been cached for a freed node */
+	btr_ncache_drop(tcx, nd_off);
 	nd = btr_off2ptr(tcx, nd_off);
 	nd->tn_child = BTR_NODE_NULL;
 
@@ -623,6 +781,7 @@ btr_node_free(struct btr_context *tcx, umem_off_t nd_off)
 {
 	int	rc;
 	D_DEBUG(DB_TRACE, "Free node "DF_X64"\n", nd_off);
+	btr_ncache_drop(tcx, nd_off);
 	rc = umem_free(btr_umm(tcx), nd_off);
 	if (rc != 0)
 		D_ERROR("Failed to free node: %s\n", strerror(errno));
@@ -633,6 +792,8 @@ btr_node_free(struct btr_context *tcx, umem_off_t nd_off)
 static int
 btr_node_tx_add(struct btr_context *tcx, umem_off_t nd_off)
 {
+	/* the node is going to be changed, e.g. by a split or a merge */
+	btr_ncache_drop(tcx, nd_off);
 	return umem_tx_add(btr_umm(tcx), nd_off, btr_node_size(tcx));
 }
 
@@ -1267,24 +1428,21 @@ done:
 	return rc;
 }
 
+/**
+ * Compare \a key with the record at \a at of node \a nd, which could be the
+ * cached copy of a non-leaf node.
+ */
 static int
-btr_cmp(struct btr_context *tcx, umem_off_t nd_off,
-	int at, char *hkey, d_iov_t *key)
+btr_node_cmp(struct btr_context *tcx, struct btr_node *nd,
+	     int at, char *hkey, d_iov_t *key)
 {
 	struct btr_record *rec;
 	int		   cmp;
 
-	if (UMOFF_IS_NULL(nd_off)) { /* compare the leaf trace */
-		struct btr_trace *trace = &tcx->tc_traces[BTR_TRACE_MAX - 1];
-
-		nd_off = trace->tr_node;
-		at = trace->tr_at;
-	}
-
-	rec = btr_node_rec_at(tcx, nd_off, at);
+	rec = btr_rec_at(tcx, &nd->tn_recs[0], at);
 	if (btr_is_direct_key(tcx)) {
 		/* For direct keys, resolve the offset in the record */
-		if (!btr_node_is_leaf(tcx, nd_off))
+		if (!(nd->tn_flags & BTR_NODE_LEAF))
 			rec = btr_node_rec_at(tcx, rec->rec_node[0], 0);
 
 		cmp = btr_key_cmp(tcx, rec, key);
@@ -1305,6 +1463,57 @@ btr_cmp(struct btr_context *tcx, umem_off_t nd_off,
 	return cmp;
 }
 
+static int
+btr_cmp(struct btr_context *tcx, umem_off_t nd_off,
+	int at, char *hkey, d_iov_t *key)
+{
+	if (UMOFF_IS_NULL(nd_off)) { /* compare the leaf trace */
+		struct btr_trace *trace = &tcx->tc_traces[BTR_TRACE_MAX - 1];
+
+		nd_off = trace->tr_node;
+		at = trace->tr_at;
+	}
+
+	return btr_node_cmp(tcx, btr_off2ptr(tcx, nd_off), at, hkey, key);
+}
+
+/**
+ * Linear scan of the integer keys of a node, which is used in lieu of binary
+ * search for BTR_FEAT_UINT_KEY trees. Keys are compared inline without any
+ * callback and the loop has no data dependent branch, so it can be unrolled
+ * or vectorized by the compiler, and it walks the node sequentially.
+ *
+ * It returns the position of the first key which is not smaller than \a hkey
+ * (or the last key if all keys are smaller), \a cmp_p returns the comparison
+ * result at that position, the same as btr_cmp().
+ */
+static int
+btr_node_scan_ukey(struct btr_context *tcx, struct btr_node *nd, char *hkey,
+		   int *cmp_p)
+{
+	char		*addr = (char *)&nd[1];
+	uint64_t	 key = *(uint64_t *)hkey;
+	uint64_t	 rkey;
+	int		 size = btr_rec_size(tcx);
+	int		 keyn = nd->tn_keyn;
+	int		 at = 0;
+	int		 i;
+
+	for (i = 0; i < keyn; i++) {
+		rkey = ((struct btr_record *)&addr[size * i])->rec_ukey[0];
+		at += (rkey < key);
+	}
+
+	if (at == keyn) {
+		*cmp_p = BTR_CMP_LT;
+		return keyn - 1;
+	}
+
+	rkey = ((struct btr_record *)&addr[size * at])->rec_ukey[0];
+	*cmp_p = (rkey == key) ? BTR_CMP_EQ : BTR_CMP_GT;
+	return at;
+}
+
 bool
 btr_probe_valid(dbtree_probe_opc_t opc)
 {
@@ -1367,7 +1576,7 @@ btr_probe(struct btr_context *tcx, dbtree_probe_opc_t probe_opc,
 		if (next_level) { /* search a new level of the tree */
 			next_level = false;
 			start	= 0;
-			nd	= btr_off2ptr(tcx, nd_off);
+			nd	= btr_ncache_node(tcx, nd_off);
 			end	= nd->tn_keyn - 1;
 
 			D_DEBUG(DB_TRACE,
@@ -1382,11 +1591,16 @@ btr_probe(struct btr_context *tcx, dbtree_probe_opc_t probe_opc,
 		} else if (probe_opc == BTR_PROBE_LAST) {
 			at = start = end;
 			cmp = BTR_CMP_LT;
+
+		} else if (btr_is_int_key(tcx) && nd->tn_keyn <= btr_scan_max) {
+			D_ASSERT(probe_opc & BTR_PROBE_SPEC);
+			at = btr_node_scan_ukey(tcx, nd, hkey, &cmp);
+			start = end = at;
 		} else {
 			D_ASSERT(probe_opc & BTR_PROBE_SPEC);
 			/* binary search */
 			at = (start + end) / 2;
-			cmp = btr_cmp(tcx, nd_off, at, hkey, key);
+			cmp = btr_node_cmp(tcx, nd, at, hkey, key);
 		}
 
 		if (cmp == BTR_CMP_ERR) {
@@ -1405,7 +1619,7 @@ btr_probe(struct btr_context *tcx, dbtree_probe_opc_t probe_opc,
 			continue;
 		}
 
-		if (btr_node_is_leaf(tcx, nd_off))
+		if (nd->tn_flags & BTR_NODE_LEAF)
 			break;
 
 		/* NB: cmp is BTR_CMP_LT or BTR_CMP_EQ means search the record
@@ -1415,8 +1629,11 @@ btr_probe(struct btr_context *tcx, dbtree_probe_opc_t probe_opc,
 		btr_trace_set(tcx, level, nd_off, at);
 		btr_trace_debug(tcx, &tcx->tc_trace[level], "probe child\n");
 
-		/* Search the next level. */
-		nd_off = btr_node_child_at(tcx, nd_off, at);
+		/* Search the next level, read the child from \a nd which
+		 * could be the cached copy.
+		 */
+		nd_off = (at == 0) ? nd->tn_child :
+			 btr_rec_at(tcx, &nd->tn_recs[0], at - 1)->rec_off;
 		next_level = true;
 		level++;
 	}
@@ -2003,6 +2220,207 @@ dbtree_upsert(daos_handle_t toh, dbtree_probe_opc_t opc, uint32_t intent,
 	return btr_tx_end(tcx, rc);
 }
 
+/**
+ * Walk down the rightmost path of the tree, the leaf trace points to the
+ * position right after the last record. Unlike btr_probe(BTR_PROBE_LAST),
+ * it never checks record availability, so it is only used by bulk load.
+ */
+static void
+btr_bulk_probe(struct btr_context *tcx)
+{
+	struct btr_root	*root = tcx->tc_tins.ti_root;
+	struct btr_node	*nd;
+	umem_off_t	 nd_off;
+	int		 level;
+
+	btr_context_set_depth(tcx, root->tr_depth);
+	nd_off = root->tr_node;
+	for (level = 0; level < tcx->tc_depth; level++) {
+		nd = btr_off2ptr(tcx, nd_off);
+		btr_trace_set(tcx, level, nd_off, nd->tn_keyn);
+		if (btr_node_is_leaf(tcx, nd_off))
+			break;
+
+		nd_off = btr_node_child_at(tcx, nd_off, nd->tn_keyn);
+	}
+	D_ASSERT(level == tcx->tc_depth - 1);
+}
+
+/**
+ * Append \a rec to the rightmost node at \a level. If the node has already
+ * reached the fill target \a fill, instead of splitting it in the middle,
+ * start a new rightmost node with \a rec and pass its separator to the
+ * parent, so the left node is never touched again by the rest of the load.
+ */
+static int
+btr_bulk_append(struct btr_context *tcx, int level, struct btr_record *rec,
+		unsigned int fill)
+{
+	struct btr_trace	*trace = &tcx->tc_trace[level];
+	struct btr_record	*rec_last;
+	struct btr_node		*nd;
+	struct btr_node		*nd_right;
+	umem_off_t		 off_right;
+	int			 rc;
+
+	nd = btr_off2ptr(tcx, trace->tr_node);
+	if (nd->tn_keyn < fill)
+		return btr_node_insert_rec(tcx, trace, rec);
+
+	rc = btr_node_alloc(tcx, &off_right);
+	if (rc != 0)
+		return rc;
+
+	nd_right = btr_off2ptr(tcx, off_right);
+	nd_right->tn_keyn = 1;
+
+	if (btr_node_is_leaf(tcx, trace->tr_node)) {
+		D_DEBUG(DB_TRACE, "Start a new leaf node\n");
+		btr_node_set(tcx, off_right, BTR_NODE_LEAF);
+		btr_rec_copy(tcx, btr_node_rec_at(tcx, off_right, 0), rec, 1);
+		/* the new record is also the separator of the new leaf */
+		if (btr_is_direct_key(tcx))
+			rec->rec_node[0] = off_right;
+	} else {
+		/* The last child of the full node moves to the new node
+		 * together with \a rec, the last key of the full node
+		 * bubbles up as the separator.
+		 */
+		D_DEBUG(DB_TRACE, "Start a new non-leaf node\n");
+		if (btr_has_tx(tcx)) {
+			rc = btr_node_tx_add(tcx, trace->tr_node);
+			if (rc != 0)
+				return rc;
+		}
+		D_ASSERT(nd->tn_keyn > 1);
+		rec_last = btr_node_rec_at(tcx, trace->tr_node,
+					   nd->tn_keyn - 1);
+		nd_right->tn_child = rec_last->rec_off;
+		btr_rec_copy(tcx, btr_node_rec_at(tcx, off_right, 0), rec, 1);
+		btr_rec_copy(tcx, rec, rec_last, 1);
+		nd->tn_keyn--;
+	}
+
+	rec->rec_off = off_right;
+	if (level == 0)
+		return btr_root_grow(tcx, trace->tr_node, rec);
+
+	return btr_bulk_append(tcx, level - 1, rec, fill);
+}
+
+/**
+ * Insert or update one record of a bulk load. The record is appended to
+ * the rightmost leaf if its key is larger than all keys in the tree,
+ * otherwise it is inserted through the regular upsert path.
+ */
+static int
+btr_bulk_insert(struct btr_context *tcx, d_iov_t *key, d_iov_t *val,
+		unsigned int fill)
+{
+	struct btr_record	*rec;
+	struct btr_trace	*trace;
+	struct btr_node		*nd;
+	union btr_rec_buf	 rec_buf = {0};
+	int			 cmp;
+	int			 rc;
+
+	if (btr_root_empty(tcx) || tcx->tc_tins.ti_root->tr_depth == 0) {
+		btr_context_set_depth(tcx, 0);
+		return btr_upsert(tcx, BTR_PROBE_EQ, DAOS_INTENT_UPDATE,
+				  key, val);
+	}
+
+	btr_bulk_probe(tcx);
+	trace = &tcx->tc_trace[tcx->tc_depth - 1];
+	nd = btr_off2ptr(tcx, trace->tr_node);
+
+	rec = &rec_buf.rb_rec;
+	btr_hkey_gen(tcx, key, &rec->rec_hkey[0]);
+
+	cmp = BTR_CMP_UNKNOWN;
+	if (nd->tn_keyn > 0)
+		cmp = btr_cmp(tcx, trace->tr_node, nd->tn_keyn - 1,
+			      &rec->rec_hkey[0], key);
+	if (cmp != BTR_CMP_LT) {
+		D_DEBUG(DB_TRACE, "Unsorted key, fall back to upsert\n");
+		return btr_upsert(tcx, BTR_PROBE_EQ, DAOS_INTENT_UPDATE,
+				  key, val);
+	}
+
+	rc = btr_rec_alloc(tcx, key, val, rec);
+	if (rc != 0) {
+		D_DEBUG(DB_TRACE, "Failed to create new record: "DF_RC"\n",
+			DP_RC(rc));
+		return rc;
+	}
+
+	/* the root leaf can be resized, leave it to the generic insert */
+	if (tcx->tc_depth == 1)
+		return btr_node_insert_rec(tcx, trace, rec);
+
+	return btr_bulk_append(tcx, tcx->tc_depth - 1, rec, fill);
+}
+
+/**
+ * Load records into the tree from a stream sorted in key order. Records
+ * are appended to the rightmost edge of the tree, a node is closed once it
+ * reaches \a fill percent of its capacity, and all changes are made within
+ * a single transaction. Records which are not in order are inserted (or
+ * updated) by the regular upsert path, so an unsorted stream is still
+ * loaded correctly, just slower.
+ *
+ * \param toh		[IN]	Tree open handle.
+ * \param next		[IN]	Callback to fetch the next record.
+ * \param arg		[IN]	Argument of \a next.
+ * \param fill		[IN]	Fill factor of nodes in percent, (0, 100].
+ *
+ * \return		0	success
+ *			-ve	error code
+ */
+int
+dbtree_bulk_load(daos_handle_t toh, dbtree_bulk_cb_t next, void *arg,
+		 unsigned int fill)
+{
+	struct btr_context *tcx;
+	d_iov_t		    key;
+	d_iov_t		    val;
+	unsigned int	    fill_nr;
+	int		    rc;
+
+	tcx = btr_hdl2tcx(toh);
+	if (tcx == NULL)
+		return -DER_NO_HDL;
+
+	if (fill == 0 || fill > 100)
+		return -DER_INVAL;
+
+	/* non-leaf nodes give away one key when a new node is started */
+	fill_nr = MAX((tcx->tc_order - 1) * fill / 100, 2);
+
+	rc = btr_tx_begin(tcx);
+	if (rc != 0)
+		return rc;
+
+	while (1) {
+		rc = next(arg, &key, &val);
+		if (rc != 0) {
+			if (rc > 0)
+				rc = 0;
+			break;
+		}
+
+		rc = btr_bulk_insert(tcx, &key, &val, fill_nr);
+		if (rc != 0) {
+			D_DEBUG(DB_TRACE, "Bulk load failed: "DF_RC"\n",
+				DP_RC(rc));
+			break;
+		}
+	}
+	tcx->tc_probe_rc = PROBE_RC_UNKNOWN; /* path changed */
+
+	return btr_tx_end(tcx, rc);
+}
+
 /**
  * Delete the leaf record pointed by @cur_tr from the current node, then fill
  * the deletion gap by shifting remainded records on the specified direction.
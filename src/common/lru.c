@@ -110,7 +110,8 @@ daos_lru_cache_create(int bits, uint32_t feats,
 	if (lru_cache == NULL)
 		return -DER_NOMEM;
 
-	rc = d_hash_table_create_inplace(feats, max(4, bits - 3),
+	rc = d_hash_table_create_inplace(feats & ~DAOS_LRU_FT_CLOCK,
+					 max(4, bits - 3),
 					 NULL, &lru_ops,
 					 &lru_cache->dlc_htable);
 	if (rc)
@@ -122,9 +123,11 @@ daos_lru_cache_create(int bits, uint32_t feats,
 		lru_cache->dlc_csize = 0;
 
 	lru_cache->dlc_ops = ops;
+	lru_cache->dlc_clock = !!(feats & DAOS_LRU_FT_CLOCK);
 
 	D_INIT_LIST_HEAD(&lru_cache->dlc_idle_list);
 	D_INIT_LIST_HEAD(&lru_cache->dlc_busy_list);
+	lru_cache->dlc_hand = &lru_cache->dlc_idle_list;
 
 	*lcache = lru_cache;
 exit:
@@ -144,6 +147,9 @@ daos_lru_cache_destroy(struct daos_lru_cache *lcache)
 	 * if there are busy references.
 	 */
 	D_DEBUG(DB_TRACE, "refs_held :%u\n", lcache->dlc_busy_nr);
+	D_DEBUG(DB_TRACE, "hits "DF_U64", misses "DF_U64", evictions "DF_U64
+		"\n", lcache->dlc_stats.dls_hits, lcache->dlc_stats.dls_misses,
+		lcache->dlc_stats.dls_evictions);
 	D_ASSERTF(lcache->dlc_busy_nr == 0, "busy=%d", lcache->dlc_busy_nr);
 
 	d_hash_table_debug(&lcache->dlc_htable);
@@ -151,6 +157,47 @@ daos_lru_cache_destroy(struct daos_lru_cache *lcache)
 	D_FREE(lcache);
 }
 
+/* Remove an item from the CLOCK ring, moving the hand off it if needed */
+static void
+lru_clock_del(struct daos_lru_cache *lcache, struct daos_llink *llink)
+{
+	if (lcache->dlc_hand == &llink->ll_qlink)
+		lcache->dlc_hand = llink->ll_qlink.next;
+	if (lcache->dlc_last == llink)
+		lcache->dlc_last = NULL;
+	d_list_del_init(&llink->ll_qlink);
+}
+
+static void
+lru_clock_evict(struct daos_lru_cache *lcache, daos_lru_cond_cb_t cond,
+		void *args)
+{
+	struct daos_llink *llink;
+	struct daos_llink *tmp;
+	unsigned int	   busy = 0;
+	unsigned int	   idle = 0;
+
+	d_list_for_each_entry_safe(llink, tmp, &lcache->dlc_idle_list,
+				   ll_qlink) {
+		if (cond != NULL && !cond(llink, args))
+			continue;
+
+		if (llink->ll_ref > 1) {
+			/* will be evicted later in daos_lru_ref_release */
+			daos_lru_ref_evict(llink);
+			busy++;
+			continue;
+		}
+
+		lru_clock_del(lcache, llink);
+		d_hash_rec_delete_at(&lcache->dlc_htable, &llink->ll_hlink);
+		lcache->dlc_idle_nr--;
+		idle++;
+	}
+	D_DEBUG(DB_TRACE, "Marked %d busy items as evicted, evicted %d idle\n",
+		busy, idle);
+}
+
 void
 daos_lru_cache_evict(struct daos_lru_cache *lcache,
 		     daos_lru_cond_cb_t cond, void *args)
@@ -159,6 +206,11 @@ daos_lru_cache_evict(struct daos_lru_cache *lcache,
 	struct daos_llink *tmp;
 	unsigned int	   cntr;
 
+	if (lcache->dlc_clock) {
+		lru_clock_evict(lcache, cond, args);
+		return;
+	}
+
 	cntr = 0;
 	d_list_for_each_entry(llink, &lcache->dlc_busy_list, ll_qlink) {
 		if (cond == NULL || cond(llink, args)) {
@@ -220,6 +272,53 @@ lru_hash_search(struct daos_lru_cache *lcache, void *key,
 	return hash2lru_link(hlink);
 }
 
+/* CLOCK fast path, the item used last is the most likely to be wanted */
+static struct daos_llink *
+lru_clock_last(struct daos_lru_cache *lcache, void *key,
+	       unsigned int key_size)
+{
+	struct daos_llink *llink = lcache->dlc_last;
+
+	if (llink == NULL || llink->ll_evicted ||
+	    !llink->ll_ops->lop_cmp_keys(key, key_size, llink))
+		return NULL;
+
+	llink->ll_ref++; /* +1 for caller */
+	return llink;
+}
+
+/* Advance the CLOCK hand to the first idle item without the reference bit,
+ * clearing the bit on idle items it passes.  Must only be called if there
+ * is at least one idle item, so that at most two sweeps are needed.
+ */
+static struct daos_llink *
+lru_clock_victim(struct daos_lru_cache *lcache)
+{
+	struct daos_llink	*llink;
+	d_list_t		*pos = lcache->dlc_hand;
+
+	D_ASSERT(lcache->dlc_idle_nr > 0);
+	while (1) {
+		if (pos == &lcache->dlc_idle_list) {
+			pos = pos->next;
+			continue;
+		}
+
+		llink = d_list_entry(pos, struct daos_llink, ll_qlink);
+		pos = pos->next;
+		if (llink->ll_ref > 1)
+			continue;
+
+		if (llink->ll_accessed) {
+			llink->ll_accessed = 0;
+			continue;
+		}
+
+		lcache->dlc_hand = pos;
+		return llink;
+	}
+}
+
 static inline void
 lru_mark_busy(struct daos_lru_cache *lcache, struct daos_llink *llink)
 {
@@ -230,7 +329,14 @@ lru_mark_busy(struct daos_lru_cache *lcache, struct daos_llink *llink)
 	D_DEBUG(DB_TRACE, "Ref to get busy held: %u, filled :%u\n",
 		lcache->dlc_busy_nr, lcache->dlc_idle_nr);
 
-	if (d_list_empty(&llink->ll_qlink)) { /* new item */
+	if (lcache->dlc_clock) {
+		/* Items stay on the ring wherever they were inserted */
+		if (d_list_empty(&llink->ll_qlink))
+			d_list_add_tail(&llink->ll_qlink,
+					&lcache->dlc_idle_list);
+		else
+			lcache->dlc_idle_nr--;
+	} else if (d_list_empty(&llink->ll_qlink)) { /* new item */
 		d_list_add(&llink->ll_qlink, &lcache->dlc_busy_list);
 	} else {
 		lcache->dlc_idle_nr--;
@@ -251,18 +357,27 @@ daos_lru_ref_hold(struct daos_lru_cache *lcache, void *key,
 	if (lcache->dlc_ops->lop_print_key)
 		lcache->dlc_ops->lop_print_key(key, key_size);
 
-	llink = lru_fast_search(lcache, &lcache->dlc_busy_list, key, key_size);
-	if (llink)
-		D_GOTO(found, rc = 0);
-
-	llink = lru_fast_search(lcache, &lcache->dlc_idle_list, key, key_size);
-	if (llink)
-		D_GOTO(found, rc = 0);
+	if (lcache->dlc_clock) {
+		llink = lru_clock_last(lcache, key, key_size);
+		if (llink)
+			D_GOTO(hit, rc = 0);
+	} else {
+		llink = lru_fast_search(lcache, &lcache->dlc_busy_list, key,
+					key_size);
+		if (llink)
+			D_GOTO(hit, rc = 0);
+
+		llink = lru_fast_search(lcache, &lcache->dlc_idle_list, key,
+					key_size);
+		if (llink)
+			D_GOTO(hit, rc = 0);
+	}
 
 	llink = lru_hash_search(lcache, key, key_size);
 	if (llink)
-		D_GOTO(found, rc = 0);
+		D_GOTO(hit, rc = 0);
 
+	lcache->dlc_stats.dls_misses++;
 	if (!create_args)
 		D_GOTO(out, rc = -DER_NONEXIST);
 
@@ -274,6 +389,7 @@ daos_lru_ref_hold(struct daos_lru_cache *lcache, void *key,
 
 	D_DEBUG(DB_TRACE, "Inserting into LRU Hash table\n");
 	llink->ll_evicted = 0;
+	llink->ll_accessed = 0;
 	llink->ll_ref	  = 1; /* 1 for caller */
 	llink->ll_ops	  = lcache->dlc_ops;
 	D_INIT_LIST_HEAD(&llink->ll_qlink);
@@ -281,10 +397,18 @@ daos_lru_ref_hold(struct daos_lru_cache *lcache, void *key,
 	rc = d_hash_rec_insert(&lcache->dlc_htable, key, key_size,
 			       &llink->ll_hlink, true);
 	D_ASSERT(rc == 0);
+	goto found;
+hit:
+	lcache->dlc_stats.dls_hits++;
 found:
 	if (llink->ll_ref == 2) /* 1 for hash, 1 for the first holder */
 		lru_mark_busy(lcache, llink);
 
+	if (lcache->dlc_clock) {
+		llink->ll_accessed = 1;
+		lcache->dlc_last = llink;
+	}
+
 	*rlink = llink;
 out:
 	return rc;
@@ -306,10 +430,15 @@ daos_lru_ref_release(struct daos_lru_cache *lcache, struct daos_llink *llink)
 
 		if (llink->ll_evicted) {
 			D_DEBUG(DB_TRACE, "Evict %p from LRU cache\n", llink);
-			d_list_del_init(&llink->ll_qlink);
+			if (lcache->dlc_clock)
+				lru_clock_del(lcache, llink);
+			else
+				d_list_del_init(&llink->ll_qlink);
 			/* be freed within hash callback */
 			d_hash_rec_delete_at(&lcache->dlc_htable,
 					     &llink->ll_hlink);
+		} else if (lcache->dlc_clock) {
+			lcache->dlc_idle_nr++;
 		} else {
 			D_DEBUG(DB_TRACE,
 				"Moving %p to the idle list\n", llink);
@@ -324,13 +453,18 @@ daos_lru_ref_release(struct daos_lru_cache *lcache, struct daos_llink *llink)
 		D_DEBUG(DB_TRACE, "Evicting from object cache :%d, %d\n",
 			lcache->dlc_idle_nr, lcache->dlc_busy_nr);
 
-		/** evict from the tail of the list */
 		D_ASSERT(!d_list_empty(&lcache->dlc_idle_list));
-		llink = container_of(lcache->dlc_idle_list.prev,
-				     struct daos_llink, ll_qlink);
-
-		d_list_del_init(&llink->ll_qlink);
+		if (lcache->dlc_clock) {
+			llink = lru_clock_victim(lcache);
+			lru_clock_del(lcache, llink);
+		} else {
+			/** evict from the tail of the list */
+			llink = container_of(lcache->dlc_idle_list.prev,
+					     struct daos_llink, ll_qlink);
+			d_list_del_init(&llink->ll_qlink);
+		}
 		lcache->dlc_idle_nr--;
+		lcache->dlc_stats.dls_evictions++;
 		/* NB. hash entry free could yield */
 		d_hash_rec_delete_at(&lcache->dlc_htable, &llink->ll_hlink);
 	}
@@ -874,6 +874,94 @@ ik_btr_drain(void **state)
 	}
 }
 
+struct ik_bulk_arg {
+	uint64_t	ba_key;
+	uint64_t	ba_end;
+	char		ba_val[32];
+};
+
+static int
+ik_bulk_next(void *arg, d_iov_t *key, d_iov_t *val)
+{
+	struct ik_bulk_arg *ba = arg;
+
+	if (ba->ba_key > ba->ba_end)
+		return 1;
+
+	sprintf(ba->ba_val, DF_U64, ba->ba_key);
+	d_iov_set(key, &ba->ba_key, sizeof(ba->ba_key));
+	d_iov_set(val, ba->ba_val, strlen(ba->ba_val) + 1);
+	ba->ba_key++;
+	return 0;
+}
+
+/**
+ * bulk load test:
+ * 1) bulk load the first half of @key_nr keys into the empty tree
+ * 2) bulk load the rest, starting from keys which are already in the tree
+ * 3) lookup and delete all keys
+ */
+static void
+ik_btr_bulk_load(void **state)
+{
+	struct ik_bulk_arg	 ba;
+	unsigned int		*arr;
+	char			 buf[64];
+	unsigned int		 key_nr;
+	int			 i;
+	int			 rc;
+
+	key_nr = atoi(tst_fn_val.optval);
+	if (key_nr < 2 || key_nr > (1U << 28)) {
+		D_PRINT("Invalid key number: %d\n", key_nr);
+		fail();
+	}
+
+	D_PRINT("Bulk load %d records.\n", key_nr / 2);
+	ba.ba_key = 1;
+	ba.ba_end = key_nr / 2;
+	rc = dbtree_bulk_load(ik_toh, ik_bulk_next, &ba, 80);
+	if (rc != 0)
+		fail_msg("Failed to bulk load: %s\n", d_errstr(rc));
+
+	D_PRINT("Bulk load %d records with overlap.\n",
+		key_nr - key_nr / 4);
+	ba.ba_key = key_nr / 4 + 1;
+	ba.ba_end = key_nr;
+	rc = dbtree_bulk_load(ik_toh, ik_bulk_next, &ba, 100);
+	if (rc != 0)
+		fail_msg("Failed to bulk load: %s\n", d_errstr(rc));
+
+	ik_btr_query(NULL);
+
+	D_ALLOC_ARRAY(arr, key_nr);
+	if (arr == NULL)
+		fail_msg("Array allocation failed");
+
+	D_PRINT("Batch lookup %d records.\n", key_nr);
+	ik_btr_gen_keys(arr, key_nr);
+	for (i = 0; i < key_nr; i++) {
+		sprintf(buf, "%d", arr[i]);
+		tst_fn_val.opc = BTR_OPC_LOOKUP;
+		tst_fn_val.optval = buf;
+		tst_fn_val.input = false;
+		ik_btr_kv_operate(NULL);
+	}
+
+	D_PRINT("Batch delete %d records.\n", key_nr);
+	for (i = 0; i < key_nr; i++) {
+		sprintf(buf, "%d", arr[i]);
+		tst_fn_val.opc = BTR_OPC_DELETE;
+		tst_fn_val.optval = buf;
+		tst_fn_val.input = false;
+		ik_btr_kv_operate(NULL);
+	}
+	D_FREE(arr);
+
+	if (dbtree_is_empty(ik_toh) != 1)
+		fail_msg("Tree is not empty after deleting all keys\n");
+}
+
 static int
 run_btree_open_create_test(void)
 {
@@ -976,6 +1064,18 @@ run_btree_drain_test(void)
 				btree_drain_test, NULL, NULL);
 }
 
+static int
+run_btree_bulk_load_test(void)
+{
+	static const struct CMUnitTest btree_bulk_load_test[] = {
+		{ "BTR009: btree_bulk_load test", ik_btr_bulk_load, NULL, NULL},
+		{ NULL, NULL, NULL, NULL }
+	};
+
+	return cmocka_run_group_tests_name("btree bulk load test",
+				btree_bulk_load_test, NULL, NULL);
+}
+
 static struct option btr_ops[] = {
 	{ "create",	required_argument,	NULL,	'C'	},
 	{ "destroy",	no_argument,		NULL,	'D'	},
@@ -991,6 +1091,7 @@ static struct option btr_ops[] = {
 	{ "iterate",	required_argument,	NULL,	'i'	},
 	{ "batch",	required_argument,	NULL,	'b'	},
 	{ "perf",	required_argument,	NULL,	'p'	},
+	{ "bulk",	required_argument,	NULL,	'l'	},
 	{ NULL,		0,			NULL,	0	},
 };
 
@@ -1017,7 +1118,7 @@ main(int argc, char **argv)
 	optind = 0;
 
 	/* Check for -m option first */
-	while ((opt = getopt_long(argc, argv, "tmC:Deocqu:d:r:f:i:b:p:",
+	while ((opt = getopt_long(argc, argv, "tmC:Deocqu:d:r:f:i:b:p:l:",
 				  btr_ops, NULL)) != -1) {
 		if (opt == 'm') {
 			D_PRINT("Using pmem\n");
@@ -1049,7 +1150,7 @@ main(int argc, char **argv)
 	/* start over */
 	optind = 0;
 
-	while ((opt = getopt_long(argc, argv, "tmC:Deocqu:d:r:f:i:b:p:",
+	while ((opt = getopt_long(argc, argv, "tmC:Deocqu:d:r:f:i:b:p:l:",
 				  btr_ops, NULL)) != -1) {
 		tst_fn_val.optval = optarg;
 		tst_fn_val.input = true;
@@ -1101,6 +1202,9 @@ main(int argc, char **argv)
 		case 'p':
 			rc = run_btree_perf_test();
 			break;
+		case 'l':
+			rc = run_btree_bulk_load_test();
+			break;
 		default:
 			D_PRINT("Unsupported command %c\n", opt);
 		case 'm':
@@ -1112,6 +1216,7 @@ main(int argc, char **argv)
 		if (rc != 0)
 			break;
 	}
+	dbtree_ncache_fini();
 	daos_debug_fini();
 	rc += utest_utx_destroy(ik_utx);
 	if (rc != 0)
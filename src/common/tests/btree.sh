@@ -32,6 +32,7 @@ EOF
 
 PERF=""
 UINT=""
+DIRECT=""
 while [ $# -gt 0 ]; do
     case "$1" in
     -s)
@@ -57,6 +58,7 @@ while [ $# -gt 0 ]; do
         ;;
     direct)
         BTR=$DAOS_DIR/build/src/common/tests/btree_direct
+        DIRECT="on"
         KEYS=${KEYS:-"delta,lambda,kappa,omega,beta,alpha,epsilon"}
         RECORDS=${RECORDS:-"omega:loaded,delta:that,kappa:dice,beta:knows,epsilon:the,lambda:are,alpha:Everybody"}
 
@@ -103,15 +105,42 @@ run_test()
         -b "$BAT_NUM"                               \
         -D
 
+        echo "B+tree batch operations test with node cache..."
+        DAOS_BTR_NODE_CACHE=16                      \
+        "${VCMD[@]}" "$BTR" "${DYN}" "${PMEM}" -C "${UINT}${IPL}o:$ORDER" \
+        -c                                          \
+        -o                                          \
+        -b "$BAT_NUM"                               \
+        -D
+
         echo "B+tree drain test..."
         "${VCMD[@]}" "$BTR" "${DYN}" "${PMEM}" -C "${UINT}${IPL}o:$ORDER" \
         -e -D
 
+        # btree_direct has no bulk load (-l) test
+        if [ -z "${DIRECT}" ]; then
+            echo "B+tree bulk load test..."
+            "${VCMD[@]}" "$BTR" "${DYN}" "${PMEM}" -C "${UINT}${IPL}o:$ORDER" \
+            -l "$BAT_NUM"                           \
+            -D
+        fi
+
     else
         echo "B+tree performance test..."
         "${VCMD[@]}" "$BTR" "${DYN}" "${PMEM}" -C "${UINT}${IPL}o:$ORDER" \
         -p "$BAT_NUM"                               \
         -D
+
+        if [ -n "${DIRECT}" ]; then
+            echo "B+tree lookup latency test..."
+            DAOS_BTR_SCAN_MAX=0                     \
+            "${VCMD[@]}" "$BTR" "${PMEM}" -C "${IPL}o:$ORDER" \
+            -L "$BAT_NUM"                           \
+            -D
+            "${VCMD[@]}" "$BTR" "${PMEM}" -C "${IPL}o:$ORDER" \
+            -L "$BAT_NUM"                           \
+            -D
+        fi
     fi
 }
 
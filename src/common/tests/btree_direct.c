@@ -73,6 +73,7 @@ struct sk_rec {
 };
 
 #define SK_TREE_CLASS	100
+#define SK_UKEY_CLASS	(SK_TREE_CLASS + 1)
 #define POOL_NAME "/mnt/daos/btree-direct-test"
 #define POOL_SIZE ((1024 * 1024  * 1024ULL))
 
@@ -297,6 +298,128 @@ static btr_ops_t sk_ops = {
 	.to_rec_stat	= sk_rec_stat,
 };
 
+/**
+ * Record of the uint key tree used by the lookup latency test, the key itself
+ * is stored in the btr_record by the tree.
+ */
+struct uk_rec {
+	uint64_t	ur_val;
+};
+
+static int
+uk_rec_alloc(struct btr_instance *tins, d_iov_t *key_iov,
+	     d_iov_t *val_iov, struct btr_record *rec)
+{
+	struct uk_rec		*urec;
+	umem_off_t		 urec_off;
+
+	if (val_iov->iov_len != sizeof(urec->ur_val))
+		return -DER_INVAL;
+
+	urec_off = umem_zalloc(&tins->ti_umm, sizeof(*urec));
+	D_ASSERT(!UMOFF_IS_NULL(urec_off)); /* lazy bone... */
+
+	urec = umem_off2ptr(&tins->ti_umm, urec_off);
+	memcpy(&urec->ur_val, val_iov->iov_buf, sizeof(urec->ur_val));
+
+	rec->rec_off = urec_off;
+	return 0;
+}
+
+static int
+uk_rec_free(struct btr_instance *tins, struct btr_record *rec, void *args)
+{
+	if (args != NULL) {
+		umem_off_t *rec_ret = (umem_off_t *) args;
+		 /** Provide the buffer to user */
+		*rec_ret	= rec->rec_off;
+		return 0;
+	}
+	umem_free(&tins->ti_umm, rec->rec_off);
+
+	return 0;
+}
+
+static int
+uk_rec_fetch(struct btr_instance *tins, struct btr_record *rec,
+	     d_iov_t *key_iov, d_iov_t *val_iov)
+{
+	struct uk_rec	*urec;
+	size_t		 size = sizeof(urec->ur_val);
+
+	if (key_iov == NULL && val_iov == NULL)
+		return -EINVAL;
+
+	urec = (struct uk_rec *)umem_off2ptr(&tins->ti_umm, rec->rec_off);
+	if (key_iov != NULL) {
+		key_iov->iov_len = size;
+		if (key_iov->iov_buf == NULL)
+			key_iov->iov_buf = &rec->rec_ukey[0];
+		else if (key_iov->iov_buf_len >= size)
+			memcpy(key_iov->iov_buf, &rec->rec_ukey[0], size);
+	}
+
+	if (val_iov != NULL) {
+		val_iov->iov_len = size;
+		if (val_iov->iov_buf == NULL)
+			val_iov->iov_buf = &urec->ur_val;
+		else if (val_iov->iov_buf_len >= size)
+			memcpy(val_iov->iov_buf, &urec->ur_val, size);
+	}
+	return 0;
+}
+
+static char *
+uk_rec_string(struct btr_instance *tins, struct btr_record *rec,
+	      bool leaf, char *buf, int buf_len)
+{
+	struct uk_rec	*urec;
+
+	if (!leaf) { /* NB: no record body on intermediate node */
+		snprintf(buf, buf_len, DF_U64, rec->rec_ukey[0]);
+		return buf;
+	}
+
+	urec = (struct uk_rec *)umem_off2ptr(&tins->ti_umm, rec->rec_off);
+	snprintf(buf, buf_len, DF_U64":"DF_U64, rec->rec_ukey[0],
+		 urec->ur_val);
+	return buf;
+}
+
+static int
+uk_rec_update(struct btr_instance *tins, struct btr_record *rec,
+	      d_iov_t *key, d_iov_t *val_iov)
+{
+	struct umem_instance	*umm = &tins->ti_umm;
+	struct uk_rec		*urec;
+
+	if (val_iov->iov_len != sizeof(urec->ur_val))
+		return -DER_INVAL;
+
+	urec = umem_off2ptr(umm, rec->rec_off);
+	umem_tx_add(umm, rec->rec_off, sizeof(*urec));
+	memcpy(&urec->ur_val, val_iov->iov_buf, sizeof(urec->ur_val));
+	return 0;
+}
+
+static int
+uk_rec_stat(struct btr_instance *tins, struct btr_record *rec,
+	    struct btr_rec_stat *stat)
+{
+	stat->rs_ksize = sizeof(rec->rec_ukey[0]);
+	stat->rs_vsize = sizeof(struct uk_rec);
+	return 0;
+}
+
+static btr_ops_t uk_ops = {
+	.to_rec_alloc	= uk_rec_alloc,
+	.to_rec_free	= uk_rec_free,
+	.to_rec_fetch	= uk_rec_fetch,
+	.to_rec_update	= uk_rec_update,
+	.to_rec_string	= uk_rec_string,
+	.to_rec_stat	= uk_rec_stat,
+};
+
 #define SK_SEP		','
 #define SK_SEP_VAL	':'
 
@@ -1035,6 +1158,84 @@ sk_btr_perf(void **state)
 	D_FREE(kv);
 }
 
+/**
+ * Lookup latency of a BTR_FEAT_UINT_KEY tree with the same order, the node
+ * search method can be switched by environment variable DAOS_BTR_SCAN_MAX
+ * (zero means binary search), so the results of both can be compared.
+ */
+static void
+sk_btr_lookup_perf(void **state)
+{
+	daos_handle_t	 toh;
+	umem_off_t	 root_off = UMOFF_NULL;
+	uint64_t	*arr;
+	d_iov_t		 key_iov;
+	d_iov_t		 val_iov;
+	char		*env;
+	double		 then;
+	double		 now;
+	unsigned int	 key_nr;
+	int		 i;
+	int		 rc;
+
+	key_nr = atoi(tst_fn_val.optval);
+
+	if (key_nr == 0 || key_nr > (1U << 28)) {
+		D_PRINT("Invalid key number: %d\n", key_nr);
+		fail();
+	}
+
+	env = getenv("DAOS_BTR_SCAN_MAX");
+	D_PRINT("Btree lookup latency test, order=%u, keys=%u, scan max=%s\n",
+		sk_order, key_nr, env == NULL ? "default" : env);
+
+	rc = dbtree_create(SK_UKEY_CLASS, BTR_FEAT_UINT_KEY, sk_order, sk_uma,
+			   &root_off, &toh);
+	if (rc != 0)
+		fail_msg("Failed to create tree: %d\n", rc);
+
+	D_ALLOC_ARRAY(arr, key_nr);
+	if (arr == NULL)
+		fail_msg("Array allocation failed\n");
+
+	for (i = 0; i < key_nr; i++)
+		arr[i] = i + 1;
+
+	for (i = key_nr; i > 1; i--) {
+		uint64_t	tmp;
+		int		j;
+
+		j = rand() % i;
+		tmp = arr[j];
+		arr[j] = arr[i - 1];
+		arr[i - 1] = tmp;
+	}
+
+	for (i = 0; i < key_nr; i++) {
+		d_iov_set(&key_iov, &arr[i], sizeof(arr[i]));
+		d_iov_set(&val_iov, &arr[i], sizeof(arr[i]));
+		rc = dbtree_update(toh, &key_iov, &val_iov);
+		if (rc != 0)
+			fail_msg("Failed to update "DF_U64": %d\n", arr[i], rc);
+	}
+
+	then = dts_time_now();
+	for (i = key_nr - 1; i >= 0; i--) {
+		d_iov_set(&key_iov, &arr[i], sizeof(arr[i]));
+		d_iov_set(&val_iov, NULL, 0);
+		rc = dbtree_lookup(toh, &key_iov, &val_iov);
+		if (rc != 0)
+			fail_msg("Failed to lookup "DF_U64": %d\n", arr[i], rc);
+	}
+	now = dts_time_now();
+	D_PRINT("lookup = %10.2f ns\n", (now - then) * 1e9 / key_nr);
+
+	D_FREE(arr);
+	rc = dbtree_destroy(toh, NULL);
+	if (rc != 0)
+		fail_msg("Failed to destroy tree: %d\n", rc);
+}
+
 static int
 run_btree_direct_open_create_test(void)
 {
@@ -1125,6 +1326,19 @@ run_btree_direct_kv_operate_test(void)
 				btree_direct_kv_operate_test, NULL, NULL);
 }
 
+static int
+run_btree_direct_lookup_perf_test(void)
+{
+	static const struct CMUnitTest btree_direct_lookup_perf_test[] = {
+		{ "BTD008: btree_direct_lookup_perf test",
+			sk_btr_lookup_perf, NULL, NULL},
+		{ NULL, NULL, NULL, NULL }
+	};
+
+	return cmocka_run_group_tests_name("btree direct lookup perf test",
+				btree_direct_lookup_perf_test, NULL, NULL);
+}
+
 static struct option btr_ops[] = {
 	{ "create",	required_argument,	NULL,	'C'	},
 	{ "destroy",	no_argument,		NULL,	'D'	},
@@ -1138,6 +1352,7 @@ static struct option btr_ops[] = {
 	{ "iterate",	required_argument,	NULL,	'i'	},
 	{ "batch",	required_argument,	NULL,	'b'	},
 	{ "perf",	required_argument,	NULL,	'p'	},
+	{ "latency",	required_argument,	NULL,	'L'	},
 	{ NULL,		0,			NULL,	0	},
 };
 
@@ -1163,10 +1378,14 @@ main(int argc, char **argv)
 	rc = dbtree_class_register(SK_TREE_CLASS, BTR_FEAT_DIRECT_KEY, &sk_ops);
 	D_ASSERT(rc == 0);
 
+	/* integer key tree with the same record format for lookup latency */
+	rc = dbtree_class_register(SK_UKEY_CLASS, BTR_FEAT_UINT_KEY, &uk_ops);
+	D_ASSERT(rc == 0);
+
 	optind = 0;
 
 	/* Check for -m option first */
-	while ((opt = getopt_long(argc, argv, "mC:Docqu:d:r:f:i:b:p:", btr_ops,
+	while ((opt = getopt_long(argc, argv, "mC:Docqu:d:r:f:i:b:p:L:", btr_ops,
 				  NULL)) != -1) {
 		if (opt == 'm') {
 			D_PRINT("Using pmem\n");
@@ -1190,7 +1409,7 @@ main(int argc, char **argv)
 	optind = 0;
 
 	D_PRINT("--------------------------------------\n");
-	while ((opt = getopt_long(argc, argv, "mC:Docqu:d:r:f:i:b:p:", btr_ops,
+	while ((opt = getopt_long(argc, argv, "mC:Docqu:d:r:f:i:b:p:L:", btr_ops,
 				  NULL)) != -1) {
 		tst_fn_val.optval = optarg;
 		tst_fn_val.input = true;
@@ -1238,6 +1457,9 @@ main(int argc, char **argv)
 		case 'p':
 			rc = run_btree_direct_perf_test();
 			break;
+		case 'L':
+			rc = run_btree_direct_lookup_perf_test();
+			break;
 		default:
 			D_PRINT("Unsupported command %c\n", opt);
 		case 'm':
@@ -1249,6 +1471,7 @@ main(int argc, char **argv)
 			break;
 		D_PRINT("--------------------------------------\n");
 	}
+	dbtree_ncache_fini();
 	daos_debug_fini();
 	rc += utest_utx_destroy(sk_utx);
 	if (rc != 0)
@@ -113,17 +113,22 @@ main(int argc, char **argv)
 	uint64_t		*keys;
 	struct daos_llink	*link_ret[3] = {NULL};
 	struct daos_lru_cache	*tcache = NULL;
+	struct daos_lru_stats	stats;
+	uint32_t		feats = D_HASH_FT_RWLOCK;
 
 	rc = daos_debug_init(NULL);
 	if (rc != 0)
 		return rc;
 
 	if (argc < 3) {
-		D_ERROR("<exec><size bits(^2)><num_keys>\n");
+		D_ERROR("<exec><size bits(^2)><num_keys>[clock]\n");
 		exit(-1);
 	}
 
-	rc = daos_lru_cache_create(atoi(argv[1]), D_HASH_FT_RWLOCK,
+	if (argc > 3 && strcmp(argv[3], "clock") == 0)
+		feats |= DAOS_LRU_FT_CLOCK;
+
+	rc = daos_lru_cache_create(atoi(argv[1]), feats,
 				   &uint_ref_llink_ops,
 				   &tcache);
 	if (rc)
@@ -169,6 +174,11 @@ main(int argc, char **argv)
 	daos_lru_ref_release(tcache, link_ret[1]);
 	D_PRINT("Completed ref release for key: %"PRIu64"\n",
 		keys[1]);
+
+	daos_lru_cache_stats(tcache, &stats);
+	D_PRINT("hits "DF_U64" misses "DF_U64" evictions "DF_U64"\n",
+		stats.dls_hits, stats.dls_misses, stats.dls_evictions);
+	D_ASSERT(stats.dls_hits + stats.dls_misses == num_keys + 2);
 exit:
 	daos_lru_cache_destroy(tcache);
 	if (keys)
@@ -34,10 +34,23 @@
 #include <daos_srv/daos_server.h>
 #include "dtx_internal.h"
 
+/* The max count of the committable DTXs to be piggy-backed on a dispatched
+ * modification, zero to disable piggy-backing. Set by DAOS_DTX_PIGGYBACK.
+ */
+uint32_t dtx_piggyback_count;
+
 struct dtx_batched_commit_args {
 	d_list_t		 dbca_link;
 	struct ds_cont_child	*dbca_cont;
 	void			*dbca_deregistering;
+	/* Observed rate (DTXs per second) of adding committable DTXs. */
+	uint64_t		 dbca_rate;
+	/* Committable DTXs added since dbca_time. */
+	uint64_t		 dbca_added;
+	/* Committable count at last check. */
+	uint64_t		 dbca_last_cnt;
+	/* Time (in second) of last rate sample. */
+	uint64_t		 dbca_time;
 };
 
 void
@@ -82,10 +95,19 @@ dtx_free_committable(struct dtx_entry *dtes)
 	D_FREE(dtes);
 }
 
+static inline void
+dtx_batched_list_del(struct dss_module_info *dmi,
+		     struct dtx_batched_commit_args *dbca)
+{
+	D_ASSERT(dmi->dmi_dtx_batched_nr > 0);
+	d_list_del_init(&dbca->dbca_link);
+	dmi->dmi_dtx_batched_nr--;
+}
+
 static inline void
 dtx_free_dbca(struct dtx_batched_commit_args *dbca)
 {
-	d_list_del(&dbca->dbca_link);
+	D_ASSERT(d_list_empty(&dbca->dbca_link));
 	ds_cont_child_put(dbca->dbca_cont);
 	D_FREE_PTR(dbca);
 }
@@ -122,17 +144,94 @@ dtx_flush_on_deregister(struct dss_module_info *dmi,
 	 * dtx_batched_commit_deregister() set force flush and wait for
 	 * flush done, then free the dbca.
 	 */
-	d_list_del_init(&dbca->dbca_link);
+	dtx_batched_list_del(dmi, dbca);
 	rc = ABT_future_set(future, NULL);
 	D_ASSERTF(rc == ABT_SUCCESS, "ABT_future_set failed for DTX "
 		  "flush on "DF_UUID": rc = %d\n", DP_UUID(cont->sc_uuid), rc);
 }
 
+/**
+ * Sample the rate of adding committable DTXs into the container, and adapt
+ * the count threshold of batched commit to it: commit the DTXs added during
+ * DTX_BATCHED_INTERVAL together, bounded by [DTX_BATCHED_CNT_MIN,
+ * DTX_THRESHOLD_COUNT]. Then the committable table of a busy container will
+ * not keep growing until the fixed threshold, and a quiet container is not
+ * left to the age threshold either.
+ */
+static void
+dtx_batched_adapt(struct dtx_batched_commit_args *dbca, uint64_t count)
+{
+	struct ds_cont_child	*cont = dbca->dbca_cont;
+	uint64_t		 now = 0;
+	uint64_t		 thresh;
+
+	if (count > dbca->dbca_last_cnt)
+		dbca->dbca_added += count - dbca->dbca_last_cnt;
+	dbca->dbca_last_cnt = count;
+
+	daos_gettime_coarse(&now);
+	if (dbca->dbca_time == 0) {
+		dbca->dbca_time = now;
+		return;
+	}
+
+	if (now <= dbca->dbca_time)
+		return;
+
+	dbca->dbca_rate = (dbca->dbca_rate * 3 +
+			   dbca->dbca_added / (now - dbca->dbca_time)) / 4;
+	dbca->dbca_added = 0;
+	dbca->dbca_time = now;
+
+	thresh = dbca->dbca_rate * DTX_BATCHED_INTERVAL;
+	if (thresh < DTX_BATCHED_CNT_MIN)
+		thresh = DTX_BATCHED_CNT_MIN;
+	else if (thresh > DTX_THRESHOLD_COUNT)
+		thresh = DTX_THRESHOLD_COUNT;
+
+	if (cont->sc_dtx_batched_cnt != thresh)
+		D_DEBUG(DB_TRACE, DF_UUID": DTX batched commit threshold %u -> "
+			DF_U64", rate "DF_U64"/s\n", DP_UUID(cont->sc_uuid),
+			cont->sc_dtx_batched_cnt, thresh, dbca->dbca_rate);
+	cont->sc_dtx_batched_cnt = thresh;
+}
+
+/**
+ * Wakeup the sleeping batched commit ULT if the container has accumulated
+ * enough committable DTXs for a batch, or unconditionally if \a cont is NULL.
+ */
+static void
+dtx_batched_commit_wakeup(struct ds_cont_child *cont)
+{
+	struct dss_sleep_ult	*dsu;
+	struct dtx_stat		 stat = { 0 };
+
+	dsu = dss_get_module_info()->dmi_dtx_batched_ult;
+	if (dsu == NULL || d_list_empty(&dsu->dsu_list))
+		return;
+
+	if (cont != NULL) {
+		vos_dtx_stat(cont->sc_hdl, &stat);
+		if (stat.dtx_committable_count < cont->sc_dtx_batched_cnt)
+			return;
+	}
+
+	dss_ult_wakeup(dsu);
+}
+
 void
 dtx_batched_commit(void *arg)
 {
 	struct dss_module_info		*dmi = dss_get_module_info();
 	struct dtx_batched_commit_args	*dbca;
+	struct dss_sleep_ult		*dsu;
+	int				 idle = 0;
+
+	/* If failed to create the sleep ULT, then just yield when idle. */
+	dsu = dss_sleep_ult_create();
+	if (dsu == NULL)
+		D_WARN("Fail to create sleep ULT for DTX batched commit\n");
+	dmi->dmi_dtx_batched_ult = dsu;
 
 	while (1) {
 		struct ds_cont_child		*cont;
@@ -148,13 +247,20 @@ dtx_batched_commit(void *arg)
 		cont = dbca->dbca_cont;
 		if (dbca->dbca_deregistering != NULL) {
 			dtx_flush_on_deregister(dmi, dbca);
+			idle = 0;
 			goto check;
 		}
 
 		d_list_move_tail(&dbca->dbca_link, &dmi->dmi_dtx_batched_list);
 		vos_dtx_stat(cont->sc_hdl, &stat);
+		dtx_batched_adapt(dbca, stat.dtx_committable_count);
+		idle++;
 
-		if ((stat.dtx_committable_count > DTX_THRESHOLD_COUNT) ||
+		/* Let test verify commit by piggy-backing alone */
+		if (DAOS_FAIL_CHECK(DAOS_DTX_NO_BATCHED_COMMIT))
+			goto aggregate;
+
+		if ((stat.dtx_committable_count >= cont->sc_dtx_batched_cnt) ||
 		    (stat.dtx_oldest_committable_time != 0 &&
 		     dtx_hlc_age2sec(stat.dtx_oldest_committable_time) >
 		     DTX_COMMIT_THRESHOLD_AGE)) {
@@ -162,6 +268,7 @@ dtx_batched_commit(void *arg)
 						DTX_THRESHOLD_COUNT, NULL,
 						DAOS_EPOCH_MAX, &dtes);
 			if (rc > 0) {
+				idle = 0;
 				rc = dtx_commit(cont->sc_pool->spc_uuid,
 					cont->sc_uuid, dtes, rc,
 					cont->sc_pool->spc_map_version);
@@ -172,11 +279,13 @@ dtx_batched_commit(void *arg)
 					goto check;
 				}
 
-				if (!cont->sc_dtx_aggregating)
-					vos_dtx_stat(cont->sc_hdl, &stat);
+				vos_dtx_stat(cont->sc_hdl, &stat);
+				dbca->dbca_last_cnt =
+					stat.dtx_committable_count;
 			}
 		}
 
+aggregate:
 		if (!cont->sc_dtx_aggregating &&
 		    (stat.dtx_committed_count >= DTX_AGG_THRESHOLD_CNT_UPPER ||
 		     (stat.dtx_committed_count > DTX_AGG_THRESHOLD_CNT_LOWER &&
@@ -186,7 +295,7 @@ dtx_batched_commit(void *arg)
 			ds_cont_child_get(cont);
 			cont->sc_dtx_aggregating = 1;
 			rc = dss_ult_create(dtx_aggregate, cont,
-				DSS_ULT_AGGREGATE, DSS_TGT_SELF, 0, NULL);
+				DSS_ULT_DTX, DSS_TGT_SELF, 0, NULL);
 			if (rc != 0) {
 				cont->sc_dtx_aggregating = 0;
 				ds_cont_child_put(cont);
@@ -196,12 +305,28 @@ dtx_batched_commit(void *arg)
 check:
 		if (dss_xstream_exiting(dmi->dmi_xstream))
 			break;
-		ABT_thread_yield();
+
+		/* Nothing to be committed in the whole round, sleep until
+		 * some container has enough committable DTXs, or some
+		 * container is deregistering, or the oldest committable
+		 * DTX may become too old.
+		 */
+		if (dsu != NULL && idle >= dmi->dmi_dtx_batched_nr) {
+			idle = 0;
+			dss_ult_sleep(dsu, DTX_BATCHED_SLEEP_MAX);
+		} else {
+			ABT_thread_yield();
+		}
 	}
 
+	dmi->dmi_dtx_batched_ult = NULL;
+	if (dsu != NULL)
+		dss_sleep_ult_destroy(dsu);
+
 	while (!d_list_empty(&dmi->dmi_dtx_batched_list)) {
 		dbca = d_list_entry(dmi->dmi_dtx_batched_list.next,
 				    struct dtx_batched_commit_args, dbca_link);
+		dtx_batched_list_del(dmi, dbca);
 		dtx_free_dbca(dbca);
 	}
 }
@@ -238,6 +363,61 @@ dtx_handle_init(struct dtx_id *dti, daos_unit_oid_t *oid, daos_handle_t coh,
 	dth->dth_actived = 0;
 }
 
+/**
+ * Piggy-back the committable DTXs of the same object (shard) on the DTX to
+ * be dispatched. The non-leader replicas of the same object shard are the
+ * targets of both, they will commit them together with the modification,
+ * then the batched commit ULT needs not to send DTX_COMMIT RPCs for them.
+ * The DTXs already in \a dti_cos (potential conflicts) are not duplicated,
+ * the piggy-backed ones are appended after them. The leader only commits
+ * the piggy-backed DTXs locally after all the non-leaders have succeeded,
+ * see dtx_leader_end().
+ *
+ * \return	The new count of the \a dti_cos array, or negative value
+ *		if error.
+ */
+static int
+dtx_cos_piggyback(daos_handle_t coh, daos_unit_oid_t *oid,
+		  struct dtx_id **dti_cos, int dti_cos_count)
+{
+	struct dtx_entry	*dtes = NULL;
+	struct dtx_id		*dtis;
+	int			 count = dti_cos_count;
+	int			 rc;
+	int			 i;
+	int			 j;
+
+	rc = vos_dtx_fetch_committable(coh, dtx_piggyback_count - count, oid,
+				       DAOS_EPOCH_MAX, &dtes);
+	if (rc <= 0)
+		return rc < 0 ? rc : count;
+
+	D_ALLOC_ARRAY(dtis, count + rc);
+	if (dtis == NULL) {
+		dtx_free_committable(dtes);
+		return -DER_NOMEM;
+	}
+
+	if (count > 0)
+		memcpy(dtis, *dti_cos, sizeof(*dtis) * count);
+
+	for (i = 0; i < rc; i++) {
+		for (j = 0; j < dti_cos_count; j++) {
+			if (daos_dti_equal(&dtis[j], &dtes[i].dte_xid))
+				break;
+		}
+
+		if (j == dti_cos_count)
+			dtis[count++] = dtes[i].dte_xid;
+	}
+
+	dtx_free_committable(dtes);
+	D_FREE(*dti_cos);
+	*dti_cos = dtis;
+
+	return count;
+}
+
 /**
  * Prepare the leader DTX handle in DRAM.
  *
@@ -268,6 +448,9 @@ dtx_leader_begin(struct dtx_id *dti, daos_unit_oid_t *oid, daos_handle_t coh,
 	int			 dti_cos_count = 0;
 	int			 i;
 
+	dlh->dlh_dti_cos = NULL;
+	dlh->dlh_dti_cos_count = 0;
+
 	/* Single replica case. */
 	if (tgts_cnt == 0) {
 		if (!daos_is_zero_dti(dti))
@@ -319,6 +502,25 @@ dtx_leader_begin(struct dtx_id *dti, daos_unit_oid_t *oid, daos_handle_t coh,
 		return -DER_INPROGRESS;
 	}
 
+	dlh->dlh_dti_cos = dti_cos;
+	dlh->dlh_dti_cos_count = dti_cos_count;
+
+	if (dti_cos_count < dtx_piggyback_count) {
+		int	rc;
+
+		/* Failing to piggy-back is harmless, the batched commit
+		 * ULT will commit them later.
+		 */
+		rc = dtx_cos_piggyback(coh, oid, &dti_cos, dti_cos_count);
+		if (rc < 0) {
+			D_WARN("Fail to piggy-back committable DTXs on "DF_DTI
+			       ": rc = "DF_RC"\n", DP_DTI(dti), DP_RC(rc));
+		} else {
+			dlh->dlh_dti_cos = dti_cos;
+			dlh->dlh_dti_cos_count = rc;
+		}
+	}
+
 init:
 	dtx_handle_init(dti, oid, coh, epoch, dkey_hash, pm_ver, intent,
 			NULL, dti_cos, dti_cos_count, true,
@@ -494,6 +696,12 @@ found:
 		       sizeof(struct dtx_id) * commit_cnt);
 		dth->dth_dti_cos_count = dti_cos_count;
 		dth->dth_dti_cos = dti_cos;
+
+		/* The piggy-backed DTXs were in the freed buffer, the retry
+		 * only carries the conflicting ones, the others stay in CoS.
+		 */
+		dlh->dlh_dti_cos = dti_cos;
+		dlh->dlh_dti_cos_count = dti_cos_count;
 	}
 
 	if (abort_cnt > 0) {
@@ -616,6 +824,23 @@ dtx_leader_end(struct dtx_leader_handle *dlh, struct ds_cont_child *cont,
 		       "Try to commit it sychronously.\n",
 		       DP_UUID(cont->sc_uuid), DP_DTI(&dth->dth_xid), rc);
 		dth->dth_sync = 1;
+	} else {
+		dtx_batched_commit_wakeup(cont);
+	}
+
+	/* All the non-leaders have received and committed the piggy-backed
+	 * DTXs, it is safe to commit them locally and drop them from CoS.
+	 */
+	if (dlh->dlh_dti_cos_count > dth->dth_dti_cos_count) {
+		rc = vos_dtx_commit(dth->dth_coh,
+				    dlh->dlh_dti_cos + dth->dth_dti_cos_count,
+				    dlh->dlh_dti_cos_count -
+				    dth->dth_dti_cos_count);
+		if (rc != 0)
+			D_WARN(DF_UUID": Fail to commit piggy-backed DTXs for "
+			       DF_DTI": rc = "DF_RC"\n",
+			       DP_UUID(cont->sc_uuid), DP_DTI(&dth->dth_xid),
+			       DP_RC(rc));
 	}
 
 	if (dth->dth_sync) {
@@ -647,7 +872,10 @@ out:
 
 	D_ASSERTF(result <= 0, "unexpected return value %d\n", result);
 
+	/* dth_dti_cos is the head of dlh_dti_cos, free it only once. */
 	D_FREE(dth->dth_dti_cos);
+	dlh->dlh_dti_cos = NULL;
+	dlh->dlh_dti_cos_count = 0;
 	D_FREE(dlh->dlh_subs);
 
 	return result;
@@ -762,7 +990,9 @@ dtx_batched_commit_register(struct ds_cont_child *cont)
 
 	ds_cont_child_get(cont);
 	dbca->dbca_cont = cont;
+	cont->sc_dtx_batched_cnt = DTX_BATCHED_CNT_MIN;
 	d_list_add_tail(&dbca->dbca_link, head);
+	dss_get_module_info()->dmi_dtx_batched_nr++;
 	return 0;
 }
 
@@ -800,6 +1030,7 @@ dtx_batched_commit_deregister(struct ds_cont_child *cont)
 		}
 
 		dbca->dbca_deregistering = future;
+		dtx_batched_commit_wakeup(NULL);
 		rc = ABT_future_wait(future);
 		D_ASSERTF(rc == ABT_SUCCESS, "ABT_future_wait failed "
 			  "for DTX flush (2) on "DF_UUID": rc = %d\n",
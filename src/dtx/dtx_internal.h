@@ -89,6 +89,37 @@ CRT_RPC_DECLARE(dtx, DAOS_ISEQ_DTX, DAOS_OSEQ_DTX);
  */
 #define DTX_AGG_THRESHOLD_AGE_LOWER	3600
 
+/* The lower bound of the adaptive count threshold for batched commit, the
+ * upper bound is DTX_THRESHOLD_COUNT.
+ */
+#define DTX_BATCHED_CNT_MIN		(1 << 5)
+
+/* The batched commit aims to commit the DTXs of a container about once per
+ * such interval (in second), so the count threshold follows the observed
+ * update rate: the DTXs added during one interval are committed together.
+ */
+#define DTX_BATCHED_INTERVAL		1
+
+/* The max time (in second) for the batched commit ULT to sleep when there
+ * is nothing to be committed or aggregated.
+ */
+#define DTX_BATCHED_SLEEP_MAX		5
+
+/* The upper limit of DAOS_DTX_PIGGYBACK: the max count of the DTXs carried
+ * by the modification RPC that is dispatched from the leader to non-leader
+ * replicas, including the ones that potentially conflict with it.
+ */
+#define DTX_PIGGYBACK_COUNT		(1 << 4)
+
+/* The default of DAOS_DTX_PIGGYBACK. Each replicated modification then costs
+ * one more scan of the object's committable DTXs on the leader and up to
+ * 8 * 16 bytes more in the dispatched RPC, in exchange for most non-leader
+ * commits of a steady update stream being done without DTX_COMMIT RPCs.
+ */
+#define DTX_PIGGYBACK_COUNT_DEF		(1 << 3)
+
+extern uint32_t dtx_piggyback_count;
+
 extern struct crt_proto_format dtx_proto_fmt;
 extern btr_ops_t dbtree_dtx_cf_ops;
 
@@ -121,7 +121,15 @@ dtx_init(void)
 
 	rc = dbtree_class_register(DBTREE_CLASS_DTX_CF, BTR_FEAT_UINT_KEY,
 				   &dbtree_dtx_cf_ops);
-	return rc;
+	if (rc != 0)
+		return rc;
+
+	dtx_piggyback_count = DTX_PIGGYBACK_COUNT_DEF;
+	d_getenv_int("DAOS_DTX_PIGGYBACK", &dtx_piggyback_count);
+	if (dtx_piggyback_count > DTX_PIGGYBACK_COUNT)
+		dtx_piggyback_count = DTX_PIGGYBACK_COUNT;
+
+	return 0;
 }
 
 static int
@@ -135,7 +143,7 @@ dtx_setup(void)
 {
 	int	rc;
 
-	rc = dss_ult_create_all(dtx_batched_commit, NULL, true);
+	rc = dss_ult_create_all(dtx_batched_commit, NULL, DSS_ULT_DTX, true);
 	if (rc != 0)
 		D_ERROR("Failed to create DTX batched commit ULT: "DF_RC"\n",
 			DP_RC(rc));
@@ -503,6 +503,18 @@ int  dbtree_upsert(daos_handle_t toh, dbtree_probe_opc_t opc, uint32_t intent,
 		   d_iov_t *key, d_iov_t *val);
 int  dbtree_delete(daos_handle_t toh, dbtree_probe_opc_t opc,
 		   d_iov_t *key, void *args);
+
+/**
+ * Prototype of dbtree_bulk_load() callback, it returns the next record of
+ * the input stream in \a key and \a val.
+ *
+ *   - if rc == 0, the record is loaded and dbtree_bulk_load() continues;
+ *   - if rc == 1, the stream is exhausted, dbtree_bulk_load() returns 0;
+ *   - otherwise, dbtree_bulk_load() stops and returns rc.
+ */
+typedef int (*dbtree_bulk_cb_t)(void *arg, d_iov_t *key, d_iov_t *val);
+int  dbtree_bulk_load(daos_handle_t toh, dbtree_bulk_cb_t next, void *arg,
+		      unsigned int fill);
 int  dbtree_query(daos_handle_t toh, struct btr_attr *attr,
 		  struct btr_stat *stat);
 int  dbtree_is_empty(daos_handle_t toh);
@@ -567,4 +579,11 @@ enum {
 int dbtree_overhead_get(int alloc_overhead, unsigned int tclass, uint64_t feats,
 			int tree_order, struct daos_tree_overhead *ovhd);
 
+/**
+ * Free the DRAM node cache of the calling thread, see DAOS_BTR_NODE_CACHE.
+ * It should be called by each xstream that accessed trees in SCM before it
+ * exits.
+ */
+void dbtree_ncache_fini(void);
+
 #endif /* __DAOS_BTREE_H__ */
@@ -573,6 +573,8 @@ enum {
 #define DAOS_DTX_LOST_RPC_REQUEST	(DAOS_FAIL_UNIT_TEST_GROUP_LOC | 0x33)
 #define DAOS_DTX_LOST_RPC_REPLY		(DAOS_FAIL_UNIT_TEST_GROUP_LOC | 0x34)
 #define DAOS_DTX_LONG_TIME_RESEND	(DAOS_FAIL_UNIT_TEST_GROUP_LOC | 0x35)
+#define DAOS_DTX_NO_BATCHED_COMMIT	(DAOS_FAIL_UNIT_TEST_GROUP_LOC | 0x36)
+#define DAOS_DTX_NONLEADER_REJECT	(DAOS_FAIL_UNIT_TEST_GROUP_LOC | 0x37)
 
 #define DAOS_VC_DIFF_REC		(DAOS_FAIL_UNIT_TEST_GROUP_LOC | 0x40)
 #define DAOS_VC_DIFF_DKEY		(DAOS_FAIL_UNIT_TEST_GROUP_LOC | 0x41)
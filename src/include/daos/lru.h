@@ -52,6 +52,8 @@ struct daos_llink {
 	unsigned int		ll_ref:30;
 	/** has been evicted */
 	unsigned int		ll_evicted:1;
+	/** CLOCK reference bit, set on access and cleared by the hand */
+	unsigned int		ll_accessed:1;
 	/**
 	 * ops to allocate and free reference
 	 * for this llink.
@@ -59,6 +61,22 @@ struct daos_llink {
 	struct daos_llink_ops	*ll_ops;
 };
 
+/**
+ * Use CLOCK replacement instead of strict LRU, see daos_lru_cache_create().
+ * This is above all the D_HASH_FT_* bits and is never passed to the hash.
+ */
+#define DAOS_LRU_FT_CLOCK	(1U << 24)
+
+/** Cache statistics, see daos_lru_cache_stats() */
+struct daos_lru_stats {
+	/** lookups which found the item in the cache */
+	uint64_t		dls_hits;
+	/** lookups which did not, whether or not the item was created */
+	uint64_t		dls_misses;
+	/** idle items dropped to keep the cache within its size */
+	uint64_t		dls_evictions;
+};
+
 /**
  * LRU cache implementation using d_hash_table
  * and d_list_t
@@ -70,23 +88,37 @@ struct daos_lru_cache {
 	uint32_t		dlc_idle_nr;
 	/* # busy items in the LRU (referenced by caller) */
 	uint32_t		dlc_busy_nr;
-	/* Queue head, holds idle refs (no refcnt) */
+	/* Queue head, holds idle refs (no refcnt), or all refs for CLOCK */
 	d_list_t		dlc_idle_list;
-	/** list head of busy items in the LRU */
+	/** list head of busy items in the LRU, unused for CLOCK */
 	d_list_t		dlc_busy_list;
+	/** CLOCK hand, next link of dlc_idle_list to be examined */
+	d_list_t		*dlc_hand;
+	/** CLOCK: most recently used item, checked before the hash */
+	struct daos_llink	*dlc_last;
+	/** DAOS_LRU_FT_CLOCK is set */
+	bool			dlc_clock;
 	/* Holds all refs but needs lookup */
 	struct d_hash_table	dlc_htable;
 	/* ops to allocate and free reference */
 	struct daos_llink_ops	*dlc_ops;
+	/** hit/miss/eviction counters */
+	struct daos_lru_stats	dlc_stats;
 };
 
 /**
  * Create a DAOS LRU cache
  * This function creates an LRU cache in DRAM
  *
+ * With DAOS_LRU_FT_CLOCK set in \a feats all items stay on a single ring
+ * and taking or dropping a reference only sets a bit, instead of moving the
+ * item between the busy and idle lists.  Items are evicted by a CLOCK hand
+ * which skips busy items and gives recently used ones a second chance.
+ *
  * \param bits		[IN]	power2(bits) is the size
  *				of the LRU cache
- * \feats feats		[IN]	Feature bits for DHASH, see DHASH_FT_*
+ * \feats feats		[IN]	Feature bits for DHASH, see DHASH_FT_*,
+ *				and DAOS_LRU_FT_CLOCK
  * \param ops		[IN]	DAOS LRU callbacks
  * \param lcache	[OUT]	Newly created LRU cache
  *
@@ -107,6 +139,34 @@ daos_lru_cache_create(int bits, uint32_t feats,
 void
 daos_lru_cache_destroy(struct daos_lru_cache *lcache);
 
+/**
+ * Return the hit/miss/eviction counters of an LRU cache.
+ *
+ * \param lcache	[IN]	DAOS LRU cache
+ * \param stats		[OUT]	Counters since the cache was created
+ */
+static inline void
+daos_lru_cache_stats(struct daos_lru_cache *lcache,
+		     struct daos_lru_stats *stats)
+{
+	*stats = lcache->dlc_stats;
+}
+
+/**
+ * Change the number of items an LRU cache may hold.  Shrinking does not
+ * evict anything immediately, idle items are dropped as references are
+ * released.  The hash table is not resized, so a cache that may grow should
+ * be created with the bits of its max size and then shrunk.
+ *
+ * \param lcache	[IN]	DAOS LRU cache
+ * \param csize		[IN]	New cache size
+ */
+static inline void
+daos_lru_cache_resize(struct daos_lru_cache *lcache, uint32_t csize)
+{
+	lcache->dlc_csize = csize;
+}
+
 typedef bool (*daos_lru_cond_cb_t)(struct daos_llink *llink, void *args);
 
 /**
@@ -377,6 +377,10 @@ enum daos_io_flags {
 	DIOF_TO_SPEC_SHARD	= 0x2,
 	/* The operation (enumeration) has specified epoch. */
 	DIOF_WITH_SPEC_EPOCH	= 0x4,
+	/* The fetch is to read EC cells for degraded-mode recovery, the iods
+	 * are per-target VOS extents and need not be reassembled.
+	 */
+	DIOF_EC_RECOV		= 0x8,
 };
 
 /**
@@ -163,6 +163,23 @@ dfs_global2local(daos_handle_t poh, daos_handle_t coh, int flags, d_iov_t glob,
 int
 dfs_set_prefix(dfs_t *dfs, const char *prefix);
 
+/**
+ * Optionally enable a dentry cache on the dfs mount, so that dfs_lookup of
+ * paths under hot directories does not fetch every path component from the
+ * server every time. Entries (including their attributes) are cached for
+ * \a ttl seconds; local dfs_remove, dfs_move, dfs_exchange, dfs_chmod and
+ * dfs_osetattr invalidate the entries they modify, but modifications from
+ * other clients are visible only once the cached entries expire.
+ *
+ * \param[in]	dfs	Pointer to the mounted file system.
+ * \param[in]	ttl	Lifetime of cached entries in seconds.
+ *			Passing 0 disables and empties the cache.
+ *
+ * \return		0 on success, errno code on failure.
+ */
+int
+dfs_set_dcache(dfs_t *dfs, uint32_t ttl);
+
 /**
  * Convert from a dfs_obj_t to a daos_obj_id_t.
  *
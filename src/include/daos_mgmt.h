@@ -355,6 +355,18 @@ enum {
 	DMG_KEY_FAIL_VALUE,
 	DMG_KEY_FAIL_NUM,
 	DMG_KEY_REBUILD_THROTTLING,
+	/* Scheduling weight of DTX resync */
+	DMG_KEY_URGENT_WEIGHT,
+	/* Scheduling weight of object requests other than I/O */
+	DMG_KEY_PRIV_WEIGHT,
+	/* Scheduling weight of object I/O and other requests */
+	DMG_KEY_IO_WEIGHT,
+	/* Scheduling weight of DTX batched commit and DTX aggregation */
+	DMG_KEY_DTX_WEIGHT,
+	/* Scheduling weight of VOS aggregation */
+	DMG_KEY_AGG_WEIGHT,
+	/* Scheduling weight of VOS GC */
+	DMG_KEY_GC_WEIGHT,
 	DMG_KEY_NUM,
 };
 
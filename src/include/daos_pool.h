@@ -131,17 +131,40 @@ struct daos_rebuild_status {
 	uint64_t		rs_size;
 };
 
+/**
+ * VOS object cache statistics, summed over the pool's targets.  Each target
+ * has one object cache shared by all the pools it serves.
+ */
+struct daos_pool_obj_cache {
+	/** # lookups which found the object cached */
+	uint64_t		poc_hits;
+	/** # lookups which had to load the object from SCM */
+	uint64_t		poc_misses;
+	/** # idle objects dropped to keep the caches within their size */
+	uint64_t		poc_evictions;
+	/** # objects the caches may currently hold */
+	uint64_t		poc_size;
+	/** # objects currently cached */
+	uint64_t		poc_cached;
+	/** # times adaptive sizing resized a cache */
+	uint32_t		poc_resizes;
+	/* Target(VOS) count */
+	uint32_t		poc_ntargets;
+};
+
 /**
  * Pool info query bits.
  * The basic pool info like fields from pi_uuid to pi_leader will always be
- * queried for each daos_pool_query() calling. But the pi_space and
- * pi_rebuild_st are optional based on pi_mask's value.
+ * queried for each daos_pool_query() calling. But the pi_space,
+ * pi_rebuild_st and pi_obj_cache are optional based on pi_mask's value.
  */
 enum daos_pool_info_bit {
 	/** true to query pool space usage */
 	DPI_SPACE		= 1ULL << 0,
 	/** true to query rebuild status */
 	DPI_REBUILD_STATUS	= 1ULL << 1,
+	/** true to query object cache statistics */
+	DPI_OBJ_CACHE		= 1ULL << 2,
 	/** query all above optional info */
 	DPI_ALL			= -1,
 };
@@ -168,6 +191,8 @@ typedef struct {
 	struct daos_pool_space		pi_space;
 	/** rebuild status */
 	struct daos_rebuild_status	pi_rebuild_st;
+	/** object cache statistics */
+	struct daos_pool_obj_cache	pi_obj_cache;
 } daos_pool_info_t;
 
 /** DAOS pool container information */
@@ -74,6 +74,8 @@ struct ds_cont_child {
 				 sc_stopping:1;
 	/* Aggregate ULT */
 	struct dss_sleep_ult	 *sc_agg_ult;
+	/* Committable DTX count to trigger batched commit, adaptive */
+	uint32_t		 sc_dtx_batched_cnt;
 
 	/*
 	 * Snapshot delete HLC (0 means no change), which is used
@@ -153,23 +153,38 @@ void dss_register_key(struct dss_module_key *key);
 void dss_unregister_key(struct dss_module_key *key);
 
 /**
- * Different type of ES pools, there are 4 pools for now
+ * Different type of ES pools, each pool is a scheduling class with its own
+ * token bucket, see dss_parameters_set() for tuning the scheduling weight of
+ * each pool and dss_sched_charge() for charging the bytes of I/O.
  *
  *  DSS_POOL_URGENT	The highest priority pool. ULTs in this pool will be
  *			scheduled firstly.
- *  DSS_POOL_PRIV	Private pool: I/O requests will be added to this pool.
- *  DSS_POOL_SHARE	Shared pool: Other requests and ULT created during
- *			processing rpc.
+ *  DSS_POOL_PRIV	Private pool: Object requests other than I/O.
+ *  DSS_POOL_SHARE	Shared pool: Object I/O, other requests and ULT
+ *			created during processing rpc.
  *  DSS_POOL_REBUILD	rebuild pool: pools specially for rebuild tasks.
+ *  DSS_POOL_DTX	DTX pool: DTX batched commit and DTX aggregation.
+ *  DSS_POOL_AGGREGATE	aggregation pool: VOS aggregation.
+ *  DSS_POOL_GC		GC pool: VOS garbage collection.
  */
 enum {
 	DSS_POOL_URGENT,
 	DSS_POOL_PRIV,
 	DSS_POOL_SHARE,
 	DSS_POOL_REBUILD,
+	DSS_POOL_DTX,
+	DSS_POOL_AGGREGATE,
+	DSS_POOL_GC,
 	DSS_POOL_CNT,
 };
 
+/**
+ * Charge \a bytes of I/O done by the calling ULT to the token bucket of the
+ * scheduling class \a pool of current xstream. The ULT itself is charged one
+ * token (op) when it's scheduled, the bytes are charged on top of that.
+ */
+void dss_sched_charge(int pool, daos_size_t bytes);
+
 #define DSS_XS_NAME_LEN		64
 
 /* Opaque xstream configuration data */
@@ -189,6 +204,10 @@ struct dss_module_info {
 	/* the cart context id */
 	int			dmi_ctx_id;
 	d_list_t		dmi_dtx_batched_list;
+	/* number of containers in dmi_dtx_batched_list */
+	int			dmi_dtx_batched_nr;
+	/* the DTX batched commit ULT, sleeping when nothing to commit */
+	struct dss_sleep_ult	*dmi_dtx_batched_ult;
 };
 
 extern struct dss_module_key	daos_srv_modkey;
@@ -340,6 +359,10 @@ enum dss_ult_type {
 	DSS_ULT_REBUILD,
 	/** aggregation ULT */
 	DSS_ULT_AGGREGATE,
+	/** DTX batched commit and DTX aggregation ULT */
+	DSS_ULT_DTX,
+	/** GC ULT */
+	DSS_ULT_GC,
 	/** drpc listener ULT */
 	DSS_ULT_DRPC_LISTENER,
 	/** drpc handler ULT */
@@ -356,7 +379,8 @@ void dss_abt_pool_choose_cb_register(unsigned int mod_id,
 				     dss_abt_pool_choose_cb_t cb);
 int dss_ult_create(void (*func)(void *), void *arg, int ult_type, int tgt_id,
 		   size_t stack_size, ABT_thread *ult);
-int dss_ult_create_all(void (*func)(void *), void *arg, bool main);
+int dss_ult_create_all(void (*func)(void *), void *arg, int ult_type,
+		       bool main);
 int dss_ult_create_execute(int (*func)(void *), void *arg,
 			   void (*user_cb)(void *), void *cb_args,
 			   int ult_type, int tgt_id, size_t stack_size);
@@ -110,7 +110,10 @@ struct dtx_leader_handle {
 	/* result for the distribute transaction */
 	int				dlh_result;
 
-	/* The array of the DTX COS entries */
+	/* The array of the DTX COS entries to be dispatched: the potential
+	 * conflicts (dth_dti_cos of dlh_handle, same buffer) followed by the
+	 * piggy-backed committable DTXs.
+	 */
 	uint32_t			dlh_dti_cos_count;
 	struct dtx_id			*dlh_dti_cos;
 
@@ -440,6 +440,14 @@ struct evt_policy_ops {
 	int	(*po_rect_weight)(struct evt_context *tcx,
 				  const struct evt_rect *rect,
 				  struct evt_weight *weight);
+	/**
+	 * Compare rectangles \a rt1 and \a rt2 in a node with MBR \a mbr,
+	 * this is the order of entries within a node.
+	 */
+	int	(*po_cmp_rect)(struct evt_context *tcx,
+			       const struct evt_rect *mbr,
+			       const struct evt_rect *rt1,
+			       const struct evt_rect *rt2);
 
 	/** TODO: add more member functions */
 };
@@ -511,6 +519,21 @@ int evt_drain(daos_handle_t toh, int *credits, bool *destroyed);
  */
 int evt_insert(daos_handle_t toh, const struct evt_entry_in *entry);
 
+/**
+ * Rebuild an opened tree bottom up from its leaf records, packing them into
+ * nodes of \a fill percent of the tree order with Sort-Tile-Recursive, so
+ * nodes are full and cover close extents and epochs. Leaf records and their
+ * data are kept in place.
+ *
+ * The tree is left unchanged if it is already dense enough, or too large
+ * to be rebuilt in a single transaction.
+ *
+ * \param toh		[IN]	The tree open handle
+ * \param fill		[IN]	Percentage of the tree order to fill nodes
+ *				with, 1 to 100
+ */
+int evt_pack(daos_handle_t toh, unsigned int fill);
+
 /**
  * Delete an extent \a rect from an opened tree.
  *
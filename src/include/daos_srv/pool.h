@@ -103,6 +103,15 @@ struct ds_pool_child {
 	uint64_t	spc_rebuild_end_hlc;
 	uint32_t	spc_map_version;
 	int		spc_ref;
+
+	/* Bulk handle of the whole SCM mapping of the vos_pool, it's created
+	 * on first use by ds_pool_child_scm_bulk().
+	 */
+	crt_bulk_t	spc_scm_bulk;
+	void		*spc_scm_base;
+	daos_size_t	spc_scm_size;
+	/* Don't retry registration if the SCM can't be registered */
+	bool		spc_scm_bulk_failed;
 };
 
 /*
@@ -122,6 +131,8 @@ struct pool_prop_ugm {
 struct ds_pool_child *ds_pool_child_lookup(const uuid_t uuid);
 struct ds_pool_child *ds_pool_child_get(struct ds_pool_child *child);
 void ds_pool_child_put(struct ds_pool_child *child);
+int ds_pool_child_scm_bulk(struct ds_pool_child *child, crt_context_t ctx,
+			   crt_bulk_t *bulk, void **base, daos_size_t *size);
 
 int ds_pool_bcast_create(crt_context_t ctx, struct ds_pool *pool,
 			 enum daos_module_id module, crt_opcode_t opcode,
@@ -132,6 +143,7 @@ int ds_pool_map_buf_get(uuid_t uuid, d_iov_t *iov, uint32_t *map_ver);
 
 int ds_pool_tgt_exclude_out(uuid_t pool_uuid, struct pool_target_id_list *list);
 int ds_pool_tgt_exclude(uuid_t pool_uuid, struct pool_target_id_list *list);
+int ds_pool_tgt_add_in(uuid_t pool_uuid, struct pool_target_id_list *list);
 
 int ds_pool_tgt_map_update(struct ds_pool *pool, struct pool_buf *buf,
 			   unsigned int map_version);
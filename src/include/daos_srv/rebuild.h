@@ -32,12 +32,21 @@
 #define REBUILD_ENV            "DAOS_REBUILD"
 #define REBUILD_ENV_DISABLED   "no"
 
+/* Rebuild operations */
+typedef enum {
+	/* rebuild the data of the failed (DOWN) targets on the spare ones */
+	RB_OP_FAIL,
+	/* move the data back to the reintegrated (UP) targets */
+	RB_OP_REINT,
+} daos_rebuild_opc_t;
+
 bool is_rebuild_container(uuid_t pool_uuid, uuid_t coh_uuid);
 bool is_rebuild_pool(uuid_t pool_uuid, uuid_t poh_uuid);
 
 int ds_rebuild_schedule(const uuid_t uuid, uint32_t map_ver,
 			struct pool_target_id_list *tgts_failed,
-			d_rank_list_t *svc_list);
+			d_rank_list_t *svc_list, daos_rebuild_opc_t rebuild_op,
+			daos_epoch_t delta_epoch);
 int ds_rebuild_query(uuid_t pool_uuid,
 		     struct daos_rebuild_status *status);
 int ds_rebuild_regenerate_task(struct ds_pool *pool, d_rank_list_t *svc_list);
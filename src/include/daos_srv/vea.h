@@ -139,7 +139,9 @@ struct vea_stat {
 	uint64_t	vs_resrv_large;	/* Number of large reserve */
 	uint64_t	vs_resrv_small;	/* Number of small reserve */
 	uint64_t	vs_resrv_vec;	/* Number of vector reserve */
+	uint64_t	vs_resrv_cache;	/* Number of I/O stream cache reserve */
 	uint32_t	vs_largest_blks;/* Largest free frag size in blocks */
+	uint32_t	vs_frag_idx;	/* Fragmentation index in percent */
 };
 
 struct vea_space_info;
@@ -219,6 +221,21 @@ int vea_hint_load(struct vea_hint_df *phd, struct vea_hint_context **thc);
  */
 void vea_hint_unload(struct vea_hint_context *thc);
 
+/**
+ * Enable the reservation cache of an I/O stream. When there is reservation
+ * of the I/O stream in flight, the subsequent reserve will reserve extra
+ * @blk_cnt blocks, and the following reserves of the I/O stream will be
+ * satisfied by these pre-reserved blocks without searching free extents.
+ * The unused pre-reserved blocks are returned on publish or cancel once
+ * there isn't any reservation of the I/O stream in flight.
+ *
+ * \param thc     [IN]	In-memory hint context
+ * \param blk_cnt [IN]	Blocks to be pre-reserved, 0 to disable the cache
+ *
+ * \return		N/A
+ */
+void vea_hint_set_cache(struct vea_hint_context *thc, uint32_t blk_cnt);
+
 /**
  * Reserve an extent on block device, if the block device is too fragmented
  * to satisfy a contiguous reservation, an extent vector could be reserved.
@@ -316,6 +333,18 @@ int vea_get_ext_vector(struct vea_space_info *vsi, uint64_t blk_off,
 int vea_query(struct vea_space_info *vsi, struct vea_attr *attr,
 	      struct vea_stat *stat);
 
+/**
+ * Query the fragmentation index of the free space, which is the percentage
+ * of transient free blocks scattered in the free extents not larger than
+ * the large extent threshold (va_large_thresh). It's maintained along with
+ * the compound index, so the query is cheap enough for the hot path.
+ *
+ * \param vsi       [IN]	In-memory compund index
+ *
+ * \return			Fragmentation index, 0 ~ 100
+ */
+unsigned int vea_frag_index(struct vea_space_info *vsi);
+
 /**
  * Force flushing the free extents in aging buffer and make them available
  * for allocation immediately.
@@ -339,6 +339,47 @@ vos_pool_close(daos_handle_t poh);
 int
 vos_pool_query(daos_handle_t poh, vos_pool_info_t *pinfo);
 
+/**
+ * Get the address range where the SCM of the pool is mapped, the range stays
+ * valid until the pool is closed. Caller can register the range for RDMA, so
+ * the SCM-resident data can be transferred without registering the memory on
+ * each I/O.
+ *
+ * \param poh	[IN]	Pool open handle
+ * \param addr	[OUT]	Start address of the SCM mapping
+ * \param size	[OUT]	Size of the SCM mapping
+ *
+ * \return		Zero on success, -DER_NOSYS if data isn't stored in SCM,
+ *			other negative value if error
+ */
+int
+vos_pool_scm_map(daos_handle_t poh, void **addr, daos_size_t *size);
+
+/**
+ * Begin a transaction on a VOSP, so that the updates made by the calling ULT
+ * until vos_pool_tx_end() are committed or aborted as a whole. The ULT must
+ * not yield in between, and an error of any update aborts the whole
+ * transaction.
+ *
+ * \param poh	[IN]	Pool open handle
+ *
+ * \return		Zero on success, negative value if error
+ */
+int
+vos_pool_tx_begin(daos_handle_t poh);
+
+/**
+ * End the transaction begun by vos_pool_tx_begin(), committing it if \a err is
+ * zero, and aborting it otherwise.
+ *
+ * \param poh	[IN]	Pool open handle
+ * \param err	[IN]	Zero, or the error to abort the transaction with
+ *
+ * \return		Zero if committed, negative value if aborted
+ */
+int
+vos_pool_tx_end(daos_handle_t poh, int err);
+
 /**
  * Create a container within a VOSP
  *
@@ -927,6 +968,30 @@ enum vos_pool_opc {
 int
 vos_pool_ctl(daos_handle_t poh, enum vos_pool_opc opc);
 
+/** Object cache statistics of a target */
+struct vos_obj_cache_stats {
+	/** lookups which found the object cached */
+	uint64_t	ocs_hits;
+	/** lookups which had to load the object from SCM */
+	uint64_t	ocs_misses;
+	/** idle objects dropped to keep the cache within its size */
+	uint64_t	ocs_evictions;
+	/** number of objects the cache may currently hold */
+	uint32_t	ocs_size;
+	/** number of objects currently cached */
+	uint32_t	ocs_cached;
+	/** number of times adaptive sizing changed ocs_size */
+	uint32_t	ocs_resizes;
+};
+
+/**
+ * Query the object cache statistics of the calling xstream's target.
+ *
+ * \param stats	[OUT]	object cache statistics
+ */
+void
+vos_obj_cache_stats_get(struct vos_obj_cache_stats *stats);
+
 int
 vos_gc_run(int *credits);
 int
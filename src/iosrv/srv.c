@@ -105,10 +105,36 @@ dss_ctx_nr_get(void)
 
 static void dss_gc_ult(void *args);
 
-#define FIRST_DEFAULT_SCHEDULE_RATIO	80
-#define REBUILD_DEFAULT_SCHEDULE_RATIO	30
-unsigned int	dss_rebuild_res_percentage = REBUILD_DEFAULT_SCHEDULE_RATIO;
-unsigned int	dss_first_res_percentage = FIRST_DEFAULT_SCHEDULE_RATIO;
+/*
+ * Weights of the ULT pools for token bucket scheduling, see
+ * dss_sched_pool_pick(). The rebuild weight is a percentage.
+ */
+static unsigned int dss_sched_weights[DSS_POOL_CNT] = DSS_SCHED_WEIGHTS_DEF;
+
+/* Upper limit of the weights set by dss_parameters_set() */
+#define DSS_SCHED_WEIGHT_MAX	10000
+
+static int
+dss_sched_key2pool(unsigned int key_id)
+{
+	switch (key_id) {
+	case DMG_KEY_URGENT_WEIGHT:
+		return DSS_POOL_URGENT;
+	case DMG_KEY_PRIV_WEIGHT:
+		return DSS_POOL_PRIV;
+	case DMG_KEY_IO_WEIGHT:
+		return DSS_POOL_SHARE;
+	case DMG_KEY_DTX_WEIGHT:
+		return DSS_POOL_DTX;
+	case DMG_KEY_AGG_WEIGHT:
+		return DSS_POOL_AGGREGATE;
+	case DMG_KEY_GC_WEIGHT:
+		return DSS_POOL_GC;
+	default:
+		D_ASSERTF(0, "bad key_id %u\n", key_id);
+		return -DER_INVAL;
+	}
+}
 
 #define DSS_SYS_XS_NAME_FMT	"daos_sys_%d"
 #define DSS_TGT_XS_NAME_FMT	"daos_tgt_%d_xs_%d"
@@ -133,6 +159,8 @@ static struct dss_xstream_data	xstream_data;
 
 struct sched_data {
     uint32_t event_freq;
+    /* Tokens left for each pool, negative for the debt of charged I/O */
+    int64_t tokens[DSS_POOL_CNT];
 };
 
 static int
@@ -180,54 +208,58 @@ unit_pop(ABT_pool *pools, int pool_idx, ABT_pool *pool)
 	return ABT_UNIT_NULL;
 }
 
+/**
+ * Choose ULT from the pools by token buckets.
+ *
+ * The pools are checked in priority order (the order of DSS_POOL_*), and a
+ * ULT is popped from the first pool which has pending ULTs and tokens left.
+ * Each scheduled ULT costs one token, and the bytes of I/O are charged to
+ * the pool by dss_sched_charge(). Once all the pools with pending ULTs run
+ * out of tokens, the buckets are refilled by their weights. So the pools
+ * share the xstream according to the weights when they are all busy, and the
+ * share unused by idle pools will be taken by the busy pools.
+ */
 static ABT_unit
-normal_unit_pop(ABT_pool *pools, ABT_pool *pool)
+dss_sched_unit_pop(struct sched_data *data, ABT_pool *pools, ABT_pool *pool)
 {
-	ABT_unit unit;
+	size_t		cnt[DSS_POOL_CNT];
+	ABT_unit	unit;
+	int		i, rc;
 
-	/* Let's pop I/O request ULT first */
-	unit = unit_pop(pools, DSS_POOL_PRIV, pool);
-	if (unit != ABT_UNIT_NULL)
-		return unit;
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		rc = ABT_pool_get_size(pools[i], &cnt[i]);
+		if (rc != ABT_SUCCESS)
+			return ABT_UNIT_NULL;
+	}
 
-	/* Other request and collective ULT or created ULT */
-	unit = unit_pop(pools, DSS_POOL_SHARE, pool);
-	if (unit != ABT_UNIT_NULL)
-		return unit;
+	while ((i = dss_sched_pool_pick(data->tokens, cnt,
+					dss_sched_weights)) >= 0) {
+		unit = unit_pop(pools, i, pool);
+		if (unit != ABT_UNIT_NULL) {
+			data->tokens[i]--;
+			return unit;
+		}
+		cnt[i] = 0;
+	}
 
 	return ABT_UNIT_NULL;
 }
 
-/**
- * Choose ULT from the pool.
- * Firstly with dss_first_res_percentage to schedule the task in
- * DSS_POOL_URGENT, then with dss_rebuild_res_percentage (of left) to
- * schedule rebuild task.
- */
-static ABT_unit
-dss_sched_unit_pop(ABT_pool *pools, ABT_pool *pool)
+void
+dss_sched_charge(int pool, daos_size_t bytes)
 {
-	size_t		cnt;
-	int		rc;
+	struct dss_xstream	*dx = dss_get_module_info()->dmi_xstream;
+	struct sched_data	*data;
+	int			 rc;
 
-	/* pop highest priority pool first */
-	rc = ABT_pool_get_size(pools[DSS_POOL_URGENT], &cnt);
-	if (rc != ABT_SUCCESS)
-		return ABT_UNIT_NULL;
-	if (cnt != 0 && rand() % 100 <= dss_first_res_percentage)
-		return unit_pop(pools, DSS_POOL_URGENT, pool);
+	if (dx == NULL || bytes < DSS_SCHED_TOKEN_BYTES)
+		return;
 
-	/* then pop other pools */
-	rc = ABT_pool_get_size(pools[DSS_POOL_REBUILD], &cnt);
+	rc = ABT_sched_get_data(dx->dx_sched, (void **)&data);
 	if (rc != ABT_SUCCESS)
-		return ABT_UNIT_NULL;
-
-	if (cnt == 0 || rand() % 100 >= dss_rebuild_res_percentage)
-		return normal_unit_pop(pools, pool);
-	else
-		return unit_pop(pools, DSS_POOL_REBUILD, pool);
+		return;
 
-	return ABT_UNIT_NULL;
+	dss_sched_tokens_charge(data->tokens, pool, bytes);
 }
 
 static struct dss_xstream *
@@ -359,7 +391,7 @@ dss_sched_run(ABT_sched sched)
 
 	while (1) {
 		/* Execute one work unit from the scheduler's pool */
-		unit = dss_sched_unit_pop(pools, &pool);
+		unit = dss_sched_unit_pop(p_data, pools, &pool);
 		if (unit != ABT_UNIT_NULL && pool != ABT_UNIT_NULL)
 			ABT_xstream_run_unit(unit, pool);
 		if (++work_count >= p_data->event_freq) {
@@ -525,6 +557,7 @@ dss_srv_handler(void *arg)
 	dmi->dmi_tgt_id	= dx->dx_tgt_id;
 	dmi->dmi_ctx_id	= -1;
 	D_INIT_LIST_HEAD(&dmi->dmi_dtx_batched_list);
+	dmi->dmi_dtx_batched_nr = 0;
 
 	if (dx->dx_comm) {
 		/* create private transport context */
@@ -587,7 +620,7 @@ dss_srv_handler(void *arg)
 			D_GOTO(tse_fini, rc);
 		}
 
-		rc = ABT_thread_create(dx->dx_pools[DSS_POOL_SHARE],
+		rc = ABT_thread_create(dx->dx_pools[DSS_POOL_GC],
 				       dss_gc_ult, NULL,
 				       ABT_THREAD_ATTR_NULL, NULL);
 		if (rc != ABT_SUCCESS) {
@@ -759,11 +792,10 @@ dss_start_one_xstream(hwloc_cpuset_t cpus, int xs_id)
 
 		/* for DSS_POOL_URGENT, now the only usage is for dtx_resync,
 		 * that creates ULT in DSS_XS_SELF. So ABT_POOL_ACCESS_PRIV
-		 * is fine.
+		 * is fine. The GC ULT is created by the xstream itself too.
 		 */
-		access = (i == DSS_POOL_SHARE || i == DSS_POOL_REBUILD ||
-			  i == DSS_POOL_URGENT) ?
-			 ABT_POOL_ACCESS_MPSC : ABT_POOL_ACCESS_PRIV;
+		access = (i == DSS_POOL_PRIV || i == DSS_POOL_GC) ?
+			 ABT_POOL_ACCESS_PRIV : ABT_POOL_ACCESS_MPSC;
 
 		rc = ABT_pool_create_basic(ABT_POOL_FIFO, access, ABT_TRUE,
 					   &dx->dx_pools[i]);
@@ -1172,6 +1204,7 @@ dss_ult_create(void (*func)(void *), void *arg, int ult_type, int tgt_idx,
  *
  * \param[in] func	function to be executed
  * \param[in] arg	argument to be passed to \a func
+ * \param[in] ult_type	ULT type (enum dss_ult_type), selects the ULT pool
  * \param[in] main	only create ULT on main XS or not.
  * \return		Success or negative error code
  *			0
@@ -1179,7 +1212,7 @@ dss_ult_create(void (*func)(void *), void *arg, int ult_type, int tgt_idx,
  *			-DER_INVAL
  */
 int
-dss_ult_create_all(void (*func)(void *), void *arg, bool main)
+dss_ult_create_all(void (*func)(void *), void *arg, int ult_type, bool main)
 {
 	struct dss_xstream      *dx;
 	int			 i;
@@ -1190,8 +1223,8 @@ dss_ult_create_all(void (*func)(void *), void *arg, bool main)
 		if (main && !dx->dx_main_xs)
 			continue;
 
-		rc = ABT_thread_create(dx->dx_pools[DSS_POOL_SHARE], func, arg,
-				       ABT_THREAD_ATTR_NULL,
+		rc = ABT_thread_create(dx->dx_pools[dss_ult_pool(ult_type)],
+				       func, arg, ABT_THREAD_ATTR_NULL,
 				       NULL /* new thread */);
 		if (rc != ABT_SUCCESS) {
 			rc = dss_abterr2der(rc);
@@ -1636,6 +1669,7 @@ dss_thread_collective(int (*func)(void *), void *arg, int flag)
 int
 dss_parameters_set(unsigned int key_id, uint64_t value)
 {
+	int i;
 	int rc = 0;
 
 	switch (key_id) {
@@ -1647,6 +1681,7 @@ dss_parameters_set(unsigned int key_id, uint64_t value)
 		break;
 	case DMG_KEY_FAIL_NUM:
 		daos_fail_num_set(value);
+		break;
 	case DMG_KEY_REBUILD_THROTTLING:
 		if (value >= 100) {
 			D_ERROR("invalid value "DF_U64"\n", value);
@@ -1654,7 +1689,23 @@ dss_parameters_set(unsigned int key_id, uint64_t value)
 			break;
 		}
 		D_WARN("set rebuild percentage to "DF_U64"\n", value);
-		dss_rebuild_res_percentage = value;
+		dss_sched_weights[DSS_POOL_REBUILD] = value;
+		break;
+	case DMG_KEY_URGENT_WEIGHT:
+	case DMG_KEY_PRIV_WEIGHT:
+	case DMG_KEY_IO_WEIGHT:
+	case DMG_KEY_DTX_WEIGHT:
+	case DMG_KEY_AGG_WEIGHT:
+	case DMG_KEY_GC_WEIGHT:
+		/* Don't allow hanging any pool other than rebuild */
+		if (value == 0 || value > DSS_SCHED_WEIGHT_MAX) {
+			D_ERROR("invalid value "DF_U64"\n", value);
+			rc = -DER_INVAL;
+			break;
+		}
+		i = dss_sched_key2pool(key_id);
+		D_WARN("set pool %d weight to "DF_U64"\n", i, value);
+		dss_sched_weights[i] = value;
 		break;
 	default:
 		D_ERROR("invalid key_id %d\n", key_id);
@@ -1778,6 +1829,13 @@ failed:
 	return rc;
 }
 
+/**
+ * Bumped by dss_dump_ABT_state(), the GC ULT of each target notices the
+ * change and logs the target's VOS object cache statistics from its own
+ * xstream.
+ */
+static volatile int	dss_stats_gen;
+
 void
 dss_dump_ABT_state()
 {
@@ -1834,9 +1892,7 @@ dss_dump_ABT_state()
 				"DAOS xstream %p, ABT xstream %p, sched %p\n",
 				rc, dx, dx->dx_xstream, dx->dx_sched);
 
-		/* only DSS_POOL_CNT (DSS_POOL_PRIV/DSS_POOL_SHARE/
-		 * DSS_POOL_REBUILD) per sched/xstream
-		 */
+		/* only DSS_POOL_CNT pools per sched/xstream */
 		rc = ABT_sched_get_num_pools(dx->dx_sched, &num_pools);
 		if (rc != ABT_SUCCESS) {
 			D_ERROR("ABT_sched_get_num_pools() error, rc = %d, for "
@@ -1882,6 +1938,21 @@ dss_dump_ABT_state()
 		 */
 	}
 	ABT_mutex_unlock(xstream_data.xd_mutex);
+
+	dss_stats_gen++;
+}
+
+static void
+dss_dump_vos_stats(struct dss_xstream *dxs)
+{
+	struct vos_obj_cache_stats	stats;
+
+	vos_obj_cache_stats_get(&stats);
+	D_PRINT("target %d: object cache hits "DF_U64" misses "DF_U64
+		" evictions "DF_U64" cached %u/%u resizes %u\n",
+		dxs->dx_tgt_id, stats.ocs_hits, stats.ocs_misses,
+		stats.ocs_evictions, stats.ocs_cached, stats.ocs_size,
+		stats.ocs_resizes);
 }
 
 void
@@ -1928,10 +1999,15 @@ static void
 dss_gc_ult(void *args)
 {
 	 struct dss_xstream *dxs  = dss_get_xstream();
+	 int		     stats_gen = dss_stats_gen;
 
 	 while (!dss_xstream_exiting(dxs)) {
 		/* -1 means GC will run until there is nothing to do */
 		dss_gc_run(DAOS_HDL_INVAL, -1);
+		if (stats_gen != dss_stats_gen) {
+			stats_gen = dss_stats_gen;
+			dss_dump_vos_stats(dxs);
+		}
 		ABT_thread_yield();
 	 }
 }
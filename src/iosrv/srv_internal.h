@@ -148,6 +148,8 @@ dss_ult_xs(int ult_type, int tgt_id)
 		return 1;
 	case DSS_ULT_REBUILD:
 	case DSS_ULT_AGGREGATE:
+	case DSS_ULT_DTX:
+	case DSS_ULT_GC:
 		return DSS_MAIN_XS_ID(tgt_id);
 	default:
 		D_ASSERTF(0, "bad ult_type %d.\n", ult_type);
@@ -177,16 +179,118 @@ dss_ult_pool(int ult_type)
 	case DSS_ULT_RDB:
 	case DSS_ULT_MISC:
 	case DSS_ULT_DRPC_HANDLER:
-	case DSS_ULT_AGGREGATE:
 		return DSS_POOL_SHARE;
 	case DSS_ULT_REBUILD:
 		return DSS_POOL_REBUILD;
+	case DSS_ULT_DTX:
+		return DSS_POOL_DTX;
+	case DSS_ULT_AGGREGATE:
+		return DSS_POOL_AGGREGATE;
+	case DSS_ULT_GC:
+		return DSS_POOL_GC;
 	default:
 		D_ASSERTF(0, "bad ult_type %d.\n", ult_type);
 		return -DER_INVAL;
 	}
 }
 
+/** Bytes of I/O charged as one token, see dss_sched_charge() */
+#define DSS_SCHED_TOKEN_BYTES	(32UL << 10)
+
+/**
+ * Default scheduling weights of the ULT pools, i.e. the number of tokens
+ * refilled to the bucket of each pool in a scheduling period. The weight of
+ * DSS_POOL_REBUILD is instead the percentage of the xstream given to rebuild
+ * when other pools are busy too, see dss_sched_pool_pick().
+ */
+#define DSS_SCHED_WEIGHTS_DEF {			\
+	[DSS_POOL_URGENT]	= 80,		\
+	[DSS_POOL_PRIV]		= 50,		\
+	[DSS_POOL_SHARE]	= 50,		\
+	[DSS_POOL_REBUILD]	= 30,		\
+	[DSS_POOL_DTX]		= 20,		\
+	[DSS_POOL_AGGREGATE]	= 10,		\
+	[DSS_POOL_GC]		= 10,		\
+}
+
+/**
+ * Charge \a bytes of I/O to the token bucket of \a pool, the bucket can go
+ * into debt which has to be paid back by later refills.
+ */
+static inline void
+dss_sched_tokens_charge(int64_t *tokens, int pool, uint64_t bytes)
+{
+	D_ASSERT(pool >= 0 && pool < DSS_POOL_CNT);
+	tokens[pool] -= bytes / DSS_SCHED_TOKEN_BYTES;
+}
+
+/**
+ * Pick the ULT pool to schedule from by the token buckets.
+ *
+ * The first pool in priority order which has pending ULTs and tokens left is
+ * picked. If all the pools with pending ULTs run out of tokens, the buckets
+ * of all pools are refilled by their weights, as many times as needed to pay
+ * the debt of one busy pool, and each bucket is capped by its weight, so an
+ * idle pool can't save up tokens. The caller consumes one token of the
+ * picked pool once a ULT is popped from it.
+ *
+ * The rebuild weight is computed on refill from the weights of the other busy
+ * pools, so rebuild gets weights[DSS_POOL_REBUILD] percent of the xstream
+ * whatever the other busy pools are, and 0 hangs rebuild.
+ *
+ * \param[in,out] tokens	tokens left in each pool
+ * \param[in]	cnt		number of pending ULTs in each pool
+ * \param[in]	weights		scheduling weight of each pool
+ *
+ * \return			pool index to schedule from, or -1 if none
+ */
+static inline int
+dss_sched_pool_pick(int64_t *tokens, const size_t *cnt,
+		    const unsigned int *weights)
+{
+	int64_t		w[DSS_POOL_CNT];
+	int64_t		refills = 0;
+	int64_t		n;
+	uint64_t	others = 0;
+	unsigned int	pct = weights[DSS_POOL_REBUILD];
+	int		i;
+
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		if (cnt[i] != 0 && tokens[i] > 0)
+			return i;
+	}
+
+	D_ASSERT(pct < 100);
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		w[i] = weights[i];
+		if (i != DSS_POOL_REBUILD && cnt[i] != 0)
+			others += weights[i];
+	}
+	if (pct != 0 && others != 0)
+		w[DSS_POOL_REBUILD] = max((pct * others + (100 - pct) / 2) /
+					  (100 - pct), 1);
+
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		if (cnt[i] == 0 || w[i] == 0)
+			continue;
+		/* refills to get the bucket back to at least one token */
+		n = (w[i] - tokens[i]) / w[i];
+		if (refills == 0 || n < refills)
+			refills = n;
+	}
+	if (refills == 0)
+		return -1;
+
+	for (i = 0; i < DSS_POOL_CNT; i++)
+		tokens[i] = min(tokens[i] + refills * w[i], w[i]);
+
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		if (cnt[i] != 0 && tokens[i] > 0)
+			return i;
+	}
+	return -1;
+}
+
 /**
  * get the VOS target ID of xstream.
  *
@@ -0,0 +1,318 @@
+/*
+ * (C) Copyright 2020 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. 8F-30005.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+
+/*
+ * Unit tests for the token bucket scheduling of the ULT pools
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <abt.h>
+#include "../srv_internal.h"
+
+static const unsigned int sched_weights[DSS_POOL_CNT] = DSS_SCHED_WEIGHTS_DEF;
+
+#define SCHED_BUSY	(1UL << 20)
+
+/*
+ * Schedule @nr ULTs from the pools with pending ULTs in @cnt, the number of
+ * ULTs scheduled from each pool is returned in @sched.
+ */
+static void
+sched_run(int64_t *tokens, size_t *cnt, const unsigned int *weights,
+	  int nr, int *sched)
+{
+	int	i, idx;
+
+	memset(sched, 0, sizeof(*sched) * DSS_POOL_CNT);
+	for (i = 0; i < nr; i++) {
+		idx = dss_sched_pool_pick(tokens, cnt, weights);
+		assert_true(idx >= 0 && idx < DSS_POOL_CNT);
+		assert_true(cnt[idx] > 0 && tokens[idx] > 0);
+		tokens[idx]--;
+		cnt[idx]--;
+		sched[idx]++;
+	}
+}
+
+/* Sum of the weights of the busy pools other than rebuild */
+static unsigned int
+sched_others_total(const unsigned int *weights, const size_t *cnt)
+{
+	unsigned int	total = 0;
+	int		i;
+
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		if (i != DSS_POOL_REBUILD && cnt[i] != 0)
+			total += weights[i];
+	}
+	return total;
+}
+
+/* Busy pools share the xstream by weight, period by period */
+static void
+test_sched_share_by_weight(void **state)
+{
+	int64_t		tokens[DSS_POOL_CNT] = { 0 };
+	size_t		cnt[DSS_POOL_CNT] = { 0 };
+	int		sched[DSS_POOL_CNT];
+	unsigned int	total;
+	int		i, period;
+
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		if (i != DSS_POOL_REBUILD)
+			cnt[i] = SCHED_BUSY;
+	}
+	total = sched_others_total(sched_weights, cnt);
+
+	for (period = 0; period < 3; period++) {
+		sched_run(tokens, cnt, sched_weights, total, sched);
+		for (i = 0; i < DSS_POOL_CNT; i++) {
+			if (i == DSS_POOL_REBUILD) {
+				assert_int_equal(sched[i], 0);
+				continue;
+			}
+			assert_int_equal(sched[i], sched_weights[i]);
+			assert_int_equal(tokens[i], 0);
+		}
+	}
+}
+
+/* Pools are scheduled in priority order within a period */
+static void
+test_sched_priority_order(void **state)
+{
+	int64_t		tokens[DSS_POOL_CNT] = { 0 };
+	size_t		cnt[DSS_POOL_CNT] = { 0 };
+	int		sched[DSS_POOL_CNT];
+	int		i, done = 0;
+
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		if (i != DSS_POOL_REBUILD)
+			cnt[i] = SCHED_BUSY;
+	}
+
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		if (i == DSS_POOL_REBUILD)
+			continue;
+		sched_run(tokens, cnt, sched_weights, sched_weights[i],
+			  sched);
+		assert_int_equal(sched[i], sched_weights[i]);
+		done += sched_weights[i];
+	}
+	assert_int_equal(done, sched_others_total(sched_weights, cnt));
+}
+
+/* Refill happens only once all the busy pools run out of tokens */
+static void
+test_sched_refill(void **state)
+{
+	int64_t		tokens[DSS_POOL_CNT] = { 0 };
+	size_t		cnt[DSS_POOL_CNT] = { 0 };
+	int		sched[DSS_POOL_CNT];
+	unsigned int	rebuild;
+	int		idx;
+
+	cnt[DSS_POOL_URGENT] = SCHED_BUSY;
+	cnt[DSS_POOL_SHARE] = SCHED_BUSY;
+	/* rounded to the nearest */
+	rebuild = (sched_weights[DSS_POOL_REBUILD] *
+		   sched_others_total(sched_weights, cnt) +
+		   (100 - sched_weights[DSS_POOL_REBUILD]) / 2) /
+		  (100 - sched_weights[DSS_POOL_REBUILD]);
+	cnt[DSS_POOL_REBUILD] = SCHED_BUSY;
+
+	/* The first pick refills the empty buckets */
+	sched_run(tokens, cnt, sched_weights,
+		  sched_weights[DSS_POOL_URGENT] +
+		  sched_weights[DSS_POOL_SHARE] + rebuild, sched);
+	assert_int_equal(sched[DSS_POOL_URGENT],
+			 sched_weights[DSS_POOL_URGENT]);
+	assert_int_equal(sched[DSS_POOL_SHARE],
+			 sched_weights[DSS_POOL_SHARE]);
+	assert_int_equal(sched[DSS_POOL_REBUILD], rebuild);
+	/* Tokens of the idle pools are left, and don't block the refill */
+	assert_int_equal(tokens[DSS_POOL_PRIV], sched_weights[DSS_POOL_PRIV]);
+	assert_int_equal(tokens[DSS_POOL_GC], sched_weights[DSS_POOL_GC]);
+
+	idx = dss_sched_pool_pick(tokens, cnt, sched_weights);
+	assert_int_equal(idx, DSS_POOL_URGENT);
+	assert_int_equal(tokens[DSS_POOL_URGENT],
+			 sched_weights[DSS_POOL_URGENT]);
+	assert_int_equal(tokens[DSS_POOL_REBUILD], rebuild);
+	/* Idle pools don't save up tokens across refills */
+	assert_int_equal(tokens[DSS_POOL_PRIV], sched_weights[DSS_POOL_PRIV]);
+}
+
+/* A single busy pool takes the whole xstream */
+static void
+test_sched_idle_share(void **state)
+{
+	int64_t		tokens[DSS_POOL_CNT] = { 0 };
+	size_t		cnt[DSS_POOL_CNT] = { 0 };
+	int		sched[DSS_POOL_CNT];
+	int		nr = 1000;
+
+	cnt[DSS_POOL_REBUILD] = SCHED_BUSY;
+	sched_run(tokens, cnt, sched_weights, nr, sched);
+	assert_int_equal(sched[DSS_POOL_REBUILD], nr);
+
+	memset(tokens, 0, sizeof(tokens));
+	cnt[DSS_POOL_REBUILD] = 0;
+	cnt[DSS_POOL_GC] = SCHED_BUSY;
+	sched_run(tokens, cnt, sched_weights, nr, sched);
+	assert_int_equal(sched[DSS_POOL_GC], nr);
+}
+
+/* Nothing is scheduled when no pool has pending ULTs */
+static void
+test_sched_idle(void **state)
+{
+	int64_t		tokens[DSS_POOL_CNT] = { 0 };
+	size_t		cnt[DSS_POOL_CNT] = { 0 };
+
+	assert_int_equal(dss_sched_pool_pick(tokens, cnt, sched_weights), -1);
+}
+
+/* Rebuild gets its percentage of the xstream whatever pools are busy */
+static void
+test_sched_rebuild_percentage(void **state)
+{
+	static const unsigned int pcts[] = { 1, 10, 30, 50, 90 };
+	static const int busy_sets[][DSS_POOL_CNT] = {
+		{ [DSS_POOL_SHARE] = 1 },
+		{ [DSS_POOL_SHARE] = 1, [DSS_POOL_GC] = 1 },
+		{ [DSS_POOL_URGENT] = 1, [DSS_POOL_PRIV] = 1,
+		  [DSS_POOL_SHARE] = 1, [DSS_POOL_DTX] = 1,
+		  [DSS_POOL_AGGREGATE] = 1, [DSS_POOL_GC] = 1 },
+	};
+	unsigned int	weights[DSS_POOL_CNT];
+	int64_t		tokens[DSS_POOL_CNT];
+	size_t		cnt[DSS_POOL_CNT];
+	int		sched[DSS_POOL_CNT];
+	int		nr = 100000;
+	int		i, j, k, pml;
+
+	memcpy(weights, sched_weights, sizeof(weights));
+	for (i = 0; i < ARRAY_SIZE(pcts); i++) {
+		weights[DSS_POOL_REBUILD] = pcts[i];
+		for (j = 0; j < ARRAY_SIZE(busy_sets); j++) {
+			memset(tokens, 0, sizeof(tokens));
+			for (k = 0; k < DSS_POOL_CNT; k++)
+				cnt[k] = busy_sets[j][k] ? SCHED_BUSY : 0;
+			cnt[DSS_POOL_REBUILD] = SCHED_BUSY;
+
+			sched_run(tokens, cnt, weights, nr, sched);
+			/* in permille, 1% error for the rounded weight */
+			pml = sched[DSS_POOL_REBUILD] * 1000LL / nr;
+			print_message("rebuild %u%%, busy set %d: %d/1000\n",
+				      pcts[i], j, pml);
+			assert_true(abs(pml - (int)pcts[i] * 10) <= 10);
+		}
+	}
+}
+
+/* Zero percentage hangs the rebuild pool only */
+static void
+test_sched_rebuild_zero(void **state)
+{
+	unsigned int	weights[DSS_POOL_CNT];
+	int64_t		tokens[DSS_POOL_CNT] = { 0 };
+	size_t		cnt[DSS_POOL_CNT] = { 0 };
+	int		sched[DSS_POOL_CNT];
+	int		i, nr;
+
+	memcpy(weights, sched_weights, sizeof(weights));
+	weights[DSS_POOL_REBUILD] = 0;
+
+	cnt[DSS_POOL_REBUILD] = SCHED_BUSY;
+	assert_int_equal(dss_sched_pool_pick(tokens, cnt, weights), -1);
+
+	for (i = 0; i < DSS_POOL_CNT; i++)
+		cnt[i] = SCHED_BUSY;
+	nr = sched_others_total(weights, cnt) * 3;
+	sched_run(tokens, cnt, weights, nr, sched);
+	assert_int_equal(sched[DSS_POOL_REBUILD], 0);
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		if (i != DSS_POOL_REBUILD)
+			assert_int_equal(sched[i], weights[i] * 3);
+	}
+}
+
+/* Charged bytes are paid back by refills, other busy pools take the share */
+static void
+test_sched_charge(void **state)
+{
+	int64_t		tokens[DSS_POOL_CNT] = { 0 };
+	size_t		cnt[DSS_POOL_CNT] = { 0 };
+	uint64_t	bytes = 10 << 20;
+	int64_t		debt = bytes / DSS_SCHED_TOKEN_BYTES;
+	int64_t		refills;
+	int		idx, gc = 0;
+
+	/* Less than a token isn't charged */
+	dss_sched_tokens_charge(tokens, DSS_POOL_SHARE,
+				DSS_SCHED_TOKEN_BYTES - 1);
+	assert_int_equal(tokens[DSS_POOL_SHARE], 0);
+
+	cnt[DSS_POOL_SHARE] = SCHED_BUSY;
+	cnt[DSS_POOL_GC] = SCHED_BUSY;
+
+	idx = dss_sched_pool_pick(tokens, cnt, sched_weights);
+	assert_int_equal(idx, DSS_POOL_SHARE);
+	tokens[idx]--;
+	dss_sched_tokens_charge(tokens, DSS_POOL_SHARE, bytes);
+	assert_int_equal(tokens[DSS_POOL_SHARE],
+			 sched_weights[DSS_POOL_SHARE] - 1 - debt);
+
+	/* GC runs until I/O paid back its debt */
+	while ((idx = dss_sched_pool_pick(tokens, cnt, sched_weights)) ==
+	       DSS_POOL_GC) {
+		tokens[idx]--;
+		gc++;
+	}
+	assert_int_equal(idx, DSS_POOL_SHARE);
+	/* including the first refill, before the charge */
+	refills = (debt + 1) / sched_weights[DSS_POOL_SHARE];
+	assert_int_equal(gc, refills * sched_weights[DSS_POOL_GC]);
+}
+
+int
+main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_sched_share_by_weight),
+		cmocka_unit_test(test_sched_priority_order),
+		cmocka_unit_test(test_sched_refill),
+		cmocka_unit_test(test_sched_idle_share),
+		cmocka_unit_test(test_sched_idle),
+		cmocka_unit_test(test_sched_rebuild_percentage),
+		cmocka_unit_test(test_sched_rebuild_zero),
+		cmocka_unit_test(test_sched_charge),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
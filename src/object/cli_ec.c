@@ -28,6 +28,8 @@
 #define D_LOGFAC	DD_FAC(object)
 
 #include <daos/common.h>
+#include <daos/container.h>
+#include <daos/task.h>
 #include <daos_task.h>
 #include <daos_types.h>
 #include "obj_rpc.h"
@@ -2013,3 +2015,1169 @@ ec_mult_data_targets(uint32_t fw_cnt, daos_obj_id_t oid)
 		return true;
 	return false;
 }
+
+/**
+ * EC degraded fetch.
+ *
+ * When some data targets of the EC object are unavailable, the fetch cannot be
+ * served by the reassembled per-target request. Instead the client fetches
+ * the covered stripes from k surviving targets (data and parity cells) and
+ * decodes the missing data cells with ISA-L, then fills the user's sgl.
+ *
+ * Single values are not encoded yet, they are fetched from the first
+ * available one of the first data target and the parity targets.
+ *
+ * Partial stripe updates are not encoded either, they are replicated to the
+ * parity targets at the original (unmapped) VOS index. So for each covered
+ * stripe, the parity cell and the replica are probed on the first available
+ * parity target:
+ * - parity only: the stripe is decoded from the surviving cells;
+ * - replica only: the lost cells are copied from the replica;
+ * - both: the visible extents of the parity target are listed with their
+ *   epochs. Partial updates older than the parity are covered by it. If any
+ *   is newer, the surviving data cells are fetched again at the epoch of the
+ *   parity, the stripe is decoded from them, and the newer partial updates
+ *   are copied from the replica over the decoded cells.
+ */
+
+/** Max number of extents listed at a time, below the kds bulk limit */
+#define OBJ_EC_RECOV_LIST_NR	64
+
+/** Visible partial update of a covered stripe on er_rep_tgt */
+struct obj_ec_recov_ext {
+	/** the extent, clipped to the stripe */
+	daos_recx_t		 ere_recx;
+	/** epoch of the extent */
+	daos_epoch_t		 ere_epoch;
+	/** stripe index relative to eri_stripe_start */
+	uint64_t		 ere_stripe;
+};
+
+/** Source data cells of a stripe fetched again at the epoch of the parity */
+struct obj_ec_recov_refetch {
+	daos_handle_t		 ref_th;
+	daos_iod_t		 ref_iods[OBJ_EC_MAX_K];
+	d_sg_list_t		 ref_sgls[OBJ_EC_MAX_K];
+	d_iov_t			 ref_iovs[OBJ_EC_MAX_K];
+	daos_recx_t		 ref_recxs[OBJ_EC_MAX_K];
+};
+
+/** Per-iod state of EC degraded fetch */
+struct obj_ec_recov_iod {
+	/** the first stripe covered by user's recxs */
+	uint64_t		 eri_stripe_start;
+	/** number of stripes covered by user's recxs */
+	uint64_t		 eri_stripe_nr;
+	/** bytes of one cell */
+	uint64_t		 eri_cell_bytes;
+	/**
+	 * Stripe buffer, (k + p) cells for each stripe. The buffer is target
+	 * major, i.e. all the cells of target 0 are followed by all the cells
+	 * of target 1 and so on, so that each target's cells can be fetched
+	 * as one VOS extent.
+	 */
+	unsigned char		*eri_buf;
+	/** probed parity cell of each stripe, from er_rep_tgt */
+	unsigned char		*eri_pbuf;
+	/** replica of partial updates of each stripe, from er_rep_tgt */
+	unsigned char		*eri_rbuf;
+	/** probe iods of the stripes, the parity cell and the replica */
+	daos_iod_t		*eri_ciods;
+	/** epoch of the parity cell of each stripe, from the listing */
+	daos_epoch_t		*eri_pepochs;
+	/** visible partial updates of the stripes, from the listing */
+	struct obj_ec_recov_ext	*eri_exts;
+	uint32_t		 eri_ext_nr;
+	/**
+	 * Source data cells at the epoch of the parity, same layout as the
+	 * data cells of eri_buf.
+	 */
+	unsigned char		*eri_obuf;
+};
+
+struct obj_ec_recov {
+	struct daos_oclass_attr	*er_oca;
+	struct obj_ec_codec	*er_codec;
+	/** user's iods and sgls */
+	daos_iod_t		*er_uiods;
+	d_sg_list_t		*er_usgls;
+	uint32_t		 er_iod_nr;
+	/** target to fetch single values from */
+	uint32_t		 er_single_tgt;
+	/** parity target to probe the parity and partial replicas on */
+	uint32_t		 er_rep_tgt;
+	/** number of lost data targets to be recovered */
+	uint32_t		 er_err_nr;
+	/** the lost data targets to be recovered */
+	unsigned char		 er_err_list[OBJ_EC_MAX_P];
+	/** the k surviving targets used as decoding source */
+	uint32_t		 er_src[OBJ_EC_MAX_K];
+	/** GF tables generated from the decode matrix */
+	unsigned char		*er_gftbls;
+	struct obj_ec_recov_iod	*er_riods;
+	/**
+	 * Per fetch target iods/sgls, er_iod_nr items for each of the source
+	 * targets, er_fiod_nrs[i] is the number of valid iods for the i-th one.
+	 */
+	daos_iod_t		*er_fiods;
+	d_sg_list_t		*er_fsgls;
+	d_iov_t			*er_fiovs;
+	daos_recx_t		*er_frecxs;
+	uint32_t		 er_fiod_nrs[OBJ_EC_MAX_K];
+	/**
+	 * iods/sgls to probe er_rep_tgt, two for each covered stripe: the
+	 * parity cell and the replica.
+	 */
+	daos_iod_t		*er_ciods;
+	d_sg_list_t		*er_csgls;
+	d_iov_t			*er_ciovs;
+	daos_recx_t		*er_crecxs;
+	uint32_t		 er_ciod_nr;
+	/** arguments of user's fetch, for the listing and the refetch */
+	daos_handle_t		 er_oh;
+	daos_handle_t		 er_th;
+	daos_key_t		*er_dkey;
+	uint32_t		 er_start_shard;
+	/** the iod whose extents are being listed on er_rep_tgt */
+	uint32_t		 er_list_iod;
+	uint32_t		 er_listing:1;
+	uint32_t		 er_list_nr;
+	daos_size_t		 er_list_size;
+	daos_anchor_t		 er_anchor;
+	daos_anchor_t		 er_dkey_anchor;
+	daos_recx_t		 er_lrecxs[OBJ_EC_RECOV_LIST_NR];
+	daos_epoch_range_t	 er_leprs[OBJ_EC_RECOV_LIST_NR];
+	/** stripes whose source cells are fetched at the parity epoch */
+	struct obj_ec_recov_refetch *er_refetches;
+	uint32_t		 er_refetch_nr;
+};
+
+static void
+obj_ec_recov_free(struct obj_ec_recov *recov)
+{
+	daos_handle_t	th;
+	int		i;
+
+	if (recov == NULL)
+		return;
+
+	if (recov->er_riods != NULL) {
+		for (i = 0; i < recov->er_iod_nr; i++) {
+			if (recov->er_riods[i].eri_buf != NULL)
+				D_FREE(recov->er_riods[i].eri_buf);
+			if (recov->er_riods[i].eri_pbuf != NULL)
+				D_FREE(recov->er_riods[i].eri_pbuf);
+			if (recov->er_riods[i].eri_rbuf != NULL)
+				D_FREE(recov->er_riods[i].eri_rbuf);
+			if (recov->er_riods[i].eri_pepochs != NULL)
+				D_FREE(recov->er_riods[i].eri_pepochs);
+			if (recov->er_riods[i].eri_exts != NULL)
+				D_FREE(recov->er_riods[i].eri_exts);
+			if (recov->er_riods[i].eri_obuf != NULL)
+				D_FREE(recov->er_riods[i].eri_obuf);
+		}
+		D_FREE(recov->er_riods);
+	}
+	if (recov->er_refetches != NULL) {
+		for (i = 0; i < recov->er_refetch_nr; i++) {
+			th = recov->er_refetches[i].ref_th;
+			if (!daos_handle_is_inval(th))
+				dc_tx_local_close(th);
+		}
+		D_FREE(recov->er_refetches);
+	}
+	if (recov->er_gftbls != NULL)
+		D_FREE(recov->er_gftbls);
+	if (recov->er_fiods != NULL)
+		D_FREE(recov->er_fiods);
+	if (recov->er_fsgls != NULL)
+		D_FREE(recov->er_fsgls);
+	if (recov->er_fiovs != NULL)
+		D_FREE(recov->er_fiovs);
+	if (recov->er_frecxs != NULL)
+		D_FREE(recov->er_frecxs);
+	if (recov->er_ciods != NULL)
+		D_FREE(recov->er_ciods);
+	if (recov->er_csgls != NULL)
+		D_FREE(recov->er_csgls);
+	if (recov->er_ciovs != NULL)
+		D_FREE(recov->er_ciovs);
+	if (recov->er_crecxs != NULL)
+		D_FREE(recov->er_crecxs);
+	D_FREE(recov);
+}
+
+/**
+ * Select the k surviving targets and generate the GF tables to decode the
+ * lost data cells from them.
+ */
+static int
+obj_ec_recov_tables_init(struct obj_ec_recov *recov, uint8_t *lost_bitmap)
+{
+	struct daos_oclass_attr	*oca = recov->er_oca;
+	unsigned char		*en_matrix = recov->er_codec->ec_en_matrix;
+	unsigned char		*b_matrix = NULL;
+	unsigned char		*d_matrix = NULL;
+	unsigned char		*c_matrix = NULL;
+	uint32_t		 k = obj_ec_data_tgt_nr(oca);
+	uint32_t		 m = obj_ec_tgt_nr(oca);
+	uint32_t		 i, j, r;
+	int			 rc = 0;
+
+	for (i = 0, r = 0; i < m && r < k; i++) {
+		if (isset(lost_bitmap, i))
+			continue;
+		recov->er_src[r++] = i;
+	}
+	if (r < k) {
+		D_ERROR("only %d targets available, %d needed.\n", r, k);
+		return -DER_IO;
+	}
+
+	D_ALLOC(b_matrix, k * k);
+	D_ALLOC(d_matrix, k * k);
+	D_ALLOC(c_matrix, k * recov->er_err_nr);
+	D_ALLOC(recov->er_gftbls, k * recov->er_err_nr * 32);
+	if (b_matrix == NULL || d_matrix == NULL || c_matrix == NULL ||
+	    recov->er_gftbls == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	/* the rows of the encode matrix for the surviving targets */
+	for (r = 0; r < k; r++)
+		for (j = 0; j < k; j++)
+			b_matrix[k * r + j] =
+				en_matrix[k * recov->er_src[r] + j];
+
+	/* a Cauchy matrix is always invertible */
+	if (gf_invert_matrix(b_matrix, d_matrix, k) < 0) {
+		D_ERROR("failed to invert the decode matrix.\n");
+		D_GOTO(out, rc = -DER_INVAL);
+	}
+
+	/* data cells' encode rows are identity, so decode rows are that of
+	 * the inverted matrix.
+	 */
+	for (i = 0; i < recov->er_err_nr; i++)
+		for (j = 0; j < k; j++)
+			c_matrix[k * i + j] =
+				d_matrix[k * recov->er_err_list[i] + j];
+
+	ec_init_tables(k, recov->er_err_nr, c_matrix, recov->er_gftbls);
+
+out:
+	if (b_matrix != NULL)
+		D_FREE(b_matrix);
+	if (d_matrix != NULL)
+		D_FREE(d_matrix);
+	if (c_matrix != NULL)
+		D_FREE(c_matrix);
+	return rc;
+}
+
+static inline unsigned char *
+obj_ec_recov_cell(struct obj_ec_recov_iod *riod, uint32_t tgt, uint64_t stripe)
+{
+	return riod->eri_buf +
+	       (tgt * riod->eri_stripe_nr + stripe) * riod->eri_cell_bytes;
+}
+
+/** Source data cell \a tgt of \a stripe at the epoch of the parity */
+static inline unsigned char *
+obj_ec_recov_ocell(struct obj_ec_recov_iod *riod, uint32_t tgt,
+		   uint64_t stripe)
+{
+	return riod->eri_obuf +
+	       (tgt * riod->eri_stripe_nr + stripe) * riod->eri_cell_bytes;
+}
+
+static int
+obj_ec_recov_iod_init(struct obj_ec_recov *recov, uint32_t iod_idx)
+{
+	struct daos_oclass_attr	*oca = recov->er_oca;
+	struct obj_ec_recov_iod	*riod = &recov->er_riods[iod_idx];
+	daos_iod_t		*iod = &recov->er_uiods[iod_idx];
+	uint64_t		 stripe_rec_nr = obj_ec_stripe_rec_nr(oca);
+	uint64_t		 start = UINT64_MAX;
+	uint64_t		 end = 0;
+	uint32_t		 i;
+
+	if (iod->iod_type != DAOS_IOD_ARRAY)
+		return 0;
+
+	if (iod->iod_size == DAOS_REC_ANY) {
+		D_ERROR("EC degraded fetch does not support size query.\n");
+		return -DER_NOSYS;
+	}
+
+	for (i = 0; i < iod->iod_nr; i++) {
+		start = min(start, iod->iod_recxs[i].rx_idx);
+		end = max(end, iod->iod_recxs[i].rx_idx +
+			       iod->iod_recxs[i].rx_nr);
+	}
+	if (start >= end)
+		return 0;
+
+	riod->eri_stripe_start = start / stripe_rec_nr;
+	riod->eri_stripe_nr = roundup(end, stripe_rec_nr) / stripe_rec_nr -
+			      riod->eri_stripe_start;
+	riod->eri_cell_bytes = obj_ec_cell_bytes(iod, oca);
+	D_ALLOC(riod->eri_buf, obj_ec_tgt_nr(oca) * riod->eri_stripe_nr *
+			       riod->eri_cell_bytes);
+	D_ALLOC(riod->eri_pbuf, riod->eri_stripe_nr * riod->eri_cell_bytes);
+	D_ALLOC(riod->eri_rbuf, obj_ec_data_tgt_nr(oca) * riod->eri_stripe_nr *
+				riod->eri_cell_bytes);
+	if (riod->eri_buf == NULL || riod->eri_pbuf == NULL ||
+	    riod->eri_rbuf == NULL)
+		return -DER_NOMEM;
+
+	recov->er_ciod_nr += 2 * riod->eri_stripe_nr;
+	return 0;
+}
+
+/** Generate the iods and sgls to fetch the source cells from each target */
+static int
+obj_ec_recov_fetch_init(struct obj_ec_recov *recov)
+{
+	struct daos_oclass_attr	*oca = recov->er_oca;
+	struct obj_ec_recov_iod	*riod;
+	uint32_t		 k = obj_ec_data_tgt_nr(oca);
+	uint32_t		 iod_nr = recov->er_iod_nr;
+	uint64_t		 cell_rec_nr = obj_ec_cell_rec_nr(oca);
+	daos_iod_t		*uiod, *fiod;
+	d_sg_list_t		*fsgl;
+	uint32_t		 i, j, idx, tgt;
+
+	D_ALLOC_ARRAY(recov->er_fiods, k * iod_nr);
+	D_ALLOC_ARRAY(recov->er_fsgls, k * iod_nr);
+	D_ALLOC_ARRAY(recov->er_fiovs, k * iod_nr);
+	D_ALLOC_ARRAY(recov->er_frecxs, k * iod_nr);
+	if (recov->er_fiods == NULL || recov->er_fsgls == NULL ||
+	    recov->er_fiovs == NULL || recov->er_frecxs == NULL)
+		return -DER_NOMEM;
+
+	for (i = 0; i < k; i++) {
+		tgt = recov->er_src[i];
+		for (j = 0, idx = i * iod_nr; j < iod_nr; j++) {
+			uiod = &recov->er_uiods[j];
+			riod = &recov->er_riods[j];
+			fiod = &recov->er_fiods[idx];
+			fsgl = &recov->er_fsgls[idx];
+
+			if (uiod->iod_type != DAOS_IOD_ARRAY) {
+				if (tgt != recov->er_single_tgt)
+					continue;
+				/* fetch single value to user's buffer */
+				*fiod = *uiod;
+				*fsgl = recov->er_usgls[j];
+				idx++;
+				continue;
+			}
+			if (riod->eri_buf == NULL)
+				continue;
+
+			*fiod = *uiod;
+			fiod->iod_eprs = NULL;
+			fiod->iod_csums = NULL;
+			fiod->iod_nr = 1;
+			fiod->iod_recxs = &recov->er_frecxs[idx];
+			/* each target's cells are contiguous in VOS index */
+			fiod->iod_recxs->rx_idx =
+				riod->eri_stripe_start * cell_rec_nr;
+			if (tgt >= k)
+				fiod->iod_recxs->rx_idx |= PARITY_INDICATOR;
+			fiod->iod_recxs->rx_nr =
+				riod->eri_stripe_nr * cell_rec_nr;
+
+			d_iov_set(&recov->er_fiovs[idx],
+				  obj_ec_recov_cell(riod, tgt, 0),
+				  riod->eri_stripe_nr * riod->eri_cell_bytes);
+			fsgl->sg_nr = 1;
+			fsgl->sg_nr_out = 0;
+			fsgl->sg_iovs = &recov->er_fiovs[idx];
+			idx++;
+		}
+		recov->er_fiod_nrs[i] = idx - i * iod_nr;
+	}
+
+	return 0;
+}
+
+/**
+ * Generate the iods and sgls to probe the parity cell and the replica of
+ * partial updates of each covered stripe on er_rep_tgt.
+ */
+static int
+obj_ec_recov_check_init(struct obj_ec_recov *recov)
+{
+	struct daos_oclass_attr	*oca = recov->er_oca;
+	struct obj_ec_recov_iod	*riod;
+	uint64_t		 stripe_rec_nr = obj_ec_stripe_rec_nr(oca);
+	uint64_t		 cell_rec_nr = obj_ec_cell_rec_nr(oca);
+	uint64_t		 stripe_bytes;
+	uint64_t		 stripe;
+	daos_iod_t		*uiod, *ciod;
+	uint32_t		 i, idx = 0;
+	uint64_t		 s;
+
+	if (recov->er_ciod_nr == 0)
+		return 0;
+
+	D_ALLOC_ARRAY(recov->er_ciods, recov->er_ciod_nr);
+	D_ALLOC_ARRAY(recov->er_csgls, recov->er_ciod_nr);
+	D_ALLOC_ARRAY(recov->er_ciovs, recov->er_ciod_nr);
+	D_ALLOC_ARRAY(recov->er_crecxs, recov->er_ciod_nr);
+	if (recov->er_ciods == NULL || recov->er_csgls == NULL ||
+	    recov->er_ciovs == NULL || recov->er_crecxs == NULL)
+		return -DER_NOMEM;
+
+	for (i = 0; i < recov->er_iod_nr; i++) {
+		uiod = &recov->er_uiods[i];
+		riod = &recov->er_riods[i];
+		if (uiod->iod_type != DAOS_IOD_ARRAY || riod->eri_buf == NULL)
+			continue;
+
+		stripe_bytes = obj_ec_data_tgt_nr(oca) * riod->eri_cell_bytes;
+		riod->eri_ciods = &recov->er_ciods[idx];
+		for (s = 0; s < riod->eri_stripe_nr; s++, idx += 2) {
+			stripe = riod->eri_stripe_start + s;
+
+			/* the parity cell of the stripe */
+			ciod = &recov->er_ciods[idx];
+			*ciod = *uiod;
+			ciod->iod_eprs = NULL;
+			ciod->iod_csums = NULL;
+			ciod->iod_nr = 1;
+			ciod->iod_recxs = &recov->er_crecxs[idx];
+			ciod->iod_recxs->rx_idx = (stripe * cell_rec_nr) |
+						  PARITY_INDICATOR;
+			ciod->iod_recxs->rx_nr = cell_rec_nr;
+			d_iov_set(&recov->er_ciovs[idx],
+				  riod->eri_pbuf + s * riod->eri_cell_bytes,
+				  riod->eri_cell_bytes);
+			recov->er_csgls[idx].sg_nr = 1;
+			recov->er_csgls[idx].sg_iovs = &recov->er_ciovs[idx];
+
+			/* the replica of partial updates of the stripe */
+			ciod = &recov->er_ciods[idx + 1];
+			*ciod = *uiod;
+			ciod->iod_eprs = NULL;
+			ciod->iod_csums = NULL;
+			ciod->iod_nr = 1;
+			ciod->iod_recxs = &recov->er_crecxs[idx + 1];
+			ciod->iod_recxs->rx_idx = stripe * stripe_rec_nr;
+			ciod->iod_recxs->rx_nr = stripe_rec_nr;
+			d_iov_set(&recov->er_ciovs[idx + 1],
+				  riod->eri_rbuf + s * stripe_bytes,
+				  stripe_bytes);
+			recov->er_csgls[idx + 1].sg_nr = 1;
+			recov->er_csgls[idx + 1].sg_iovs =
+				&recov->er_ciovs[idx + 1];
+		}
+	}
+	D_ASSERT(idx == recov->er_ciod_nr);
+
+	return 0;
+}
+
+/** Copy the recovered data of \a iod_idx to user's sgl */
+static void
+obj_ec_recov_sgl_fill(struct obj_ec_recov *recov, uint32_t iod_idx)
+{
+	struct daos_oclass_attr	*oca = recov->er_oca;
+	struct obj_ec_recov_iod	*riod = &recov->er_riods[iod_idx];
+	daos_iod_t		*uiod = &recov->er_uiods[iod_idx];
+	d_sg_list_t		*usgl = &recov->er_usgls[iod_idx];
+	uint64_t		 stripe_rec_nr = obj_ec_stripe_rec_nr(oca);
+	uint64_t		 cell_bytes = riod->eri_cell_bytes;
+	uint64_t		 stripe_bytes = obj_ec_data_tgt_nr(oca) *
+						cell_bytes;
+	uint64_t		 off, left, cell_off, nob;
+	uint64_t		 stripe, iov_off = 0;
+	uint32_t		 i, iov_idx = 0, tgt;
+	d_iov_t			*iov;
+
+	usgl->sg_nr_out = 0;
+	for (i = 0; i < uiod->iod_nr && iov_idx < usgl->sg_nr; i++) {
+		/* byte offset relative to the first covered stripe */
+		off = (uiod->iod_recxs[i].rx_idx -
+		       riod->eri_stripe_start * stripe_rec_nr) *
+		      uiod->iod_size;
+		left = uiod->iod_recxs[i].rx_nr * uiod->iod_size;
+		while (left > 0 && iov_idx < usgl->sg_nr) {
+			iov = &usgl->sg_iovs[iov_idx];
+			stripe = off / stripe_bytes;
+			tgt = (off % stripe_bytes) / cell_bytes;
+			cell_off = off % cell_bytes;
+			nob = min(left, cell_bytes - cell_off);
+			nob = min(nob, iov->iov_buf_len - iov_off);
+			memcpy(iov->iov_buf + iov_off,
+			       obj_ec_recov_cell(riod, tgt, stripe) + cell_off,
+			       nob);
+			if (iov_off == 0)
+				usgl->sg_nr_out++;
+			iov_off += nob;
+			iov->iov_len = iov_off;
+			if (iov_off == iov->iov_buf_len) {
+				iov_idx++;
+				iov_off = 0;
+			}
+			off += nob;
+			left -= nob;
+		}
+	}
+}
+
+/** Whether the probe found both the parity and the replica of \a stripe */
+static inline bool
+obj_ec_recov_mixed(struct obj_ec_recov_iod *riod, uint64_t stripe)
+{
+	return riod->eri_ciods[2 * stripe].iod_size != 0 &&
+	       riod->eri_ciods[2 * stripe + 1].iod_size != 0;
+}
+
+static bool
+obj_ec_recov_iod_mixed(struct obj_ec_recov *recov, uint32_t iod_idx)
+{
+	struct obj_ec_recov_iod	*riod = &recov->er_riods[iod_idx];
+	uint64_t		 s;
+
+	if (riod->eri_ciods == NULL)
+		return false;
+
+	for (s = 0; s < riod->eri_stripe_nr; s++) {
+		if (obj_ec_recov_mixed(riod, s))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Whether \a stripe has both parity and partial updates newer than the
+ * parity, i.e. the current surviving cells cannot be decoded with the parity.
+ */
+static bool
+obj_ec_recov_stale(struct obj_ec_recov_iod *riod, uint64_t stripe)
+{
+	struct obj_ec_recov_ext	*ext;
+	uint32_t		 i;
+
+	if (!obj_ec_recov_mixed(riod, stripe))
+		return false;
+
+	for (i = 0; i < riod->eri_ext_nr; i++) {
+		ext = &riod->eri_exts[i];
+		if (ext->ere_stripe == stripe &&
+		    ext->ere_epoch > riod->eri_pepochs[stripe])
+			return true;
+	}
+	return false;
+}
+
+static int
+obj_ec_recov_ext_add(struct obj_ec_recov_iod *riod, uint64_t idx, uint64_t nr,
+		     daos_epoch_t epoch, uint64_t stripe)
+{
+	struct obj_ec_recov_ext	*exts;
+
+	D_REALLOC_ARRAY(exts, riod->eri_exts, riod->eri_ext_nr + 1);
+	if (exts == NULL)
+		return -DER_NOMEM;
+	riod->eri_exts = exts;
+
+	exts[riod->eri_ext_nr].ere_recx.rx_idx = idx;
+	exts[riod->eri_ext_nr].ere_recx.rx_nr = nr;
+	exts[riod->eri_ext_nr].ere_epoch = epoch;
+	exts[riod->eri_ext_nr].ere_stripe = stripe;
+	riod->eri_ext_nr++;
+	return 0;
+}
+
+/**
+ * Take the epochs of the parity cells and the partial updates of the covered
+ * stripes from the extents listed on er_rep_tgt.
+ */
+static int
+obj_ec_recov_list_merge(struct obj_ec_recov *recov)
+{
+	struct daos_oclass_attr	*oca = recov->er_oca;
+	struct obj_ec_recov_iod	*riod = &recov->er_riods[recov->er_list_iod];
+	uint64_t		 stripe_rec_nr = obj_ec_stripe_rec_nr(oca);
+	uint64_t		 cell_rec_nr = obj_ec_cell_rec_nr(oca);
+	uint64_t		 first = riod->eri_stripe_start;
+	uint64_t		 last = first + riod->eri_stripe_nr;
+	uint64_t		 start, end, s;
+	daos_recx_t		*recx;
+	daos_epoch_t		 epoch;
+	uint32_t		 i;
+	int			 rc;
+
+	for (i = 0; i < recov->er_list_nr; i++) {
+		recx = &recov->er_lrecxs[i];
+		epoch = recov->er_leprs[i].epr_lo;
+
+		if (recx->rx_idx & PARITY_INDICATOR) {
+			start = recx->rx_idx & ~PARITY_INDICATOR;
+			end = start + recx->rx_nr;
+			for (s = max(start / cell_rec_nr, first);
+			     s < last && s * cell_rec_nr < end; s++)
+				riod->eri_pepochs[s - first] =
+					max(riod->eri_pepochs[s - first],
+					    epoch);
+			continue;
+		}
+
+		start = recx->rx_idx;
+		end = start + recx->rx_nr;
+		for (s = max(start / stripe_rec_nr, first);
+		     s < last && s * stripe_rec_nr < end; s++) {
+			rc = obj_ec_recov_ext_add(riod,
+					max(start, s * stripe_rec_nr),
+					min(end, (s + 1) * stripe_rec_nr) -
+					max(start, s * stripe_rec_nr),
+					epoch, s - first);
+			if (rc != 0)
+				return rc;
+		}
+	}
+
+	if (daos_anchor_is_eof(&recov->er_anchor)) {
+		memset(&recov->er_anchor, 0, sizeof(recov->er_anchor));
+		recov->er_list_iod++;
+	}
+	return 0;
+}
+
+static int obj_ec_recov_step(tse_task_t *task);
+
+/**
+ * List the next page of the extents of er_list_iod on er_rep_tgt, another
+ * step task consumes it.
+ *
+ * \return	1 if the step tasks are registered as dependencies of \a task,
+ *		negative error otherwise.
+ */
+static int
+obj_ec_recov_list(tse_task_t *task, struct obj_ec_recov *recov)
+{
+	struct obj_ec_recov_iod	*riod = &recov->er_riods[recov->er_list_iod];
+	daos_iod_t		*uiod = &recov->er_uiods[recov->er_list_iod];
+	tse_sched_t		*sched = tse_task2sched(task);
+	daos_obj_list_recx_t	*list_args;
+	tse_task_t		*list_task;
+	tse_task_t		*step_task;
+	int			 rc;
+
+	if (riod->eri_pepochs == NULL) {
+		D_ALLOC_ARRAY(riod->eri_pepochs, riod->eri_stripe_nr);
+		if (riod->eri_pepochs == NULL)
+			return -DER_NOMEM;
+	}
+
+	recov->er_listing = 1;
+	recov->er_list_nr = OBJ_EC_RECOV_LIST_NR;
+	recov->er_list_size = 0;
+	/* the reply overwrites the dkey anchor, route it every time */
+	daos_anchor_set_flags(&recov->er_dkey_anchor, DIOF_TO_SPEC_SHARD);
+	dc_obj_shard2anchor(&recov->er_dkey_anchor,
+			    recov->er_start_shard + recov->er_rep_tgt);
+
+	rc = dc_obj_list_recx_task_create(recov->er_oh, recov->er_th,
+					  recov->er_dkey, &uiod->iod_name,
+					  DAOS_IOD_ARRAY, &recov->er_list_size,
+					  &recov->er_list_nr, recov->er_lrecxs,
+					  recov->er_leprs, &recov->er_anchor,
+					  true, NULL, sched, &list_task);
+	if (rc != 0)
+		return rc;
+	list_args = dc_task_get_args(list_task);
+	list_args->dkey_anchor = &recov->er_dkey_anchor;
+
+	rc = tse_task_create(obj_ec_recov_step, sched, recov, &step_task);
+	if (rc != 0)
+		D_GOTO(out_list, rc);
+
+	rc = tse_task_register_deps(step_task, 1, &list_task);
+	if (rc != 0)
+		D_GOTO(out_step, rc);
+
+	rc = tse_task_register_deps(task, 1, &step_task);
+	if (rc != 0)
+		D_GOTO(out_step, rc);
+
+	tse_task_schedule(list_task, false);
+	tse_task_schedule(step_task, false);
+	return 1;
+
+out_step:
+	tse_task_complete(list_task, rc);
+	tse_task_complete(step_task, rc);
+	return rc;
+out_list:
+	tse_task_complete(list_task, rc);
+	return rc;
+}
+
+/**
+ * Fetch the surviving data cells of the stale stripes again at the epoch of
+ * their parity.
+ *
+ * \return	number of fetch tasks registered as dependencies of \a task,
+ *		negative error otherwise.
+ */
+static int
+obj_ec_recov_refetch(tse_task_t *task, struct obj_ec_recov *recov)
+{
+	struct daos_oclass_attr		*oca = recov->er_oca;
+	struct obj_ec_recov_iod		*riod;
+	struct obj_ec_recov_refetch	*ref;
+	uint32_t			 k = obj_ec_data_tgt_nr(oca);
+	uint64_t			 cell_rec_nr = obj_ec_cell_rec_nr(oca);
+	tse_task_t			**tasks = NULL;
+	daos_iod_t			*iod;
+	uint32_t			 i, j, tgt, task_nr = 0;
+	uint64_t			 s;
+	int				 rc = 0;
+
+	for (i = 0; i < recov->er_iod_nr; i++) {
+		riod = &recov->er_riods[i];
+		if (riod->eri_ciods == NULL)
+			continue;
+		for (s = 0; s < riod->eri_stripe_nr; s++) {
+			if (obj_ec_recov_stale(riod, s))
+				recov->er_refetch_nr++;
+		}
+	}
+	if (recov->er_refetch_nr == 0)
+		return 0;
+
+	D_ALLOC_ARRAY(recov->er_refetches, recov->er_refetch_nr);
+	D_ALLOC_ARRAY(tasks, recov->er_refetch_nr * k);
+	if (recov->er_refetches == NULL || tasks == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	ref = recov->er_refetches;
+	for (i = 0; i < recov->er_iod_nr; i++) {
+		riod = &recov->er_riods[i];
+		if (riod->eri_ciods == NULL)
+			continue;
+		for (s = 0; s < riod->eri_stripe_nr; s++) {
+			if (!obj_ec_recov_stale(riod, s))
+				continue;
+			if (riod->eri_pepochs[s] == 0) {
+				D_ERROR("no parity of stripe "DF_U64" listed, "
+					"cannot recover.\n",
+					riod->eri_stripe_start + s);
+				D_GOTO(out, rc = -DER_IO);
+			}
+
+			if (riod->eri_obuf == NULL) {
+				D_ALLOC(riod->eri_obuf,
+					k * riod->eri_stripe_nr *
+					riod->eri_cell_bytes);
+				if (riod->eri_obuf == NULL)
+					D_GOTO(out, rc = -DER_NOMEM);
+			}
+
+			rc = dc_tx_local_open(dc_obj_hdl2cont_hdl(recov->er_oh),
+					      riod->eri_pepochs[s],
+					      &ref->ref_th);
+			if (rc != 0)
+				goto out;
+
+			for (j = 0; j < k; j++) {
+				tgt = recov->er_src[j];
+				if (tgt >= k)
+					continue;
+
+				iod = &ref->ref_iods[j];
+				*iod = recov->er_uiods[i];
+				iod->iod_eprs = NULL;
+				iod->iod_csums = NULL;
+				iod->iod_nr = 1;
+				iod->iod_recxs = &ref->ref_recxs[j];
+				iod->iod_recxs->rx_idx =
+					(riod->eri_stripe_start + s) *
+					cell_rec_nr;
+				iod->iod_recxs->rx_nr = cell_rec_nr;
+				d_iov_set(&ref->ref_iovs[j],
+					  obj_ec_recov_ocell(riod, tgt, s),
+					  riod->eri_cell_bytes);
+				ref->ref_sgls[j].sg_nr = 1;
+				ref->ref_sgls[j].sg_iovs = &ref->ref_iovs[j];
+
+				rc = dc_obj_fetch_shard_task_create(
+						recov->er_oh, ref->ref_th,
+						DIOF_TO_SPEC_SHARD |
+						DIOF_EC_RECOV,
+						recov->er_start_shard + tgt,
+						recov->er_dkey, 1, iod,
+						&ref->ref_sgls[j], NULL, NULL,
+						tse_task2sched(task),
+						&tasks[task_nr]);
+				if (rc != 0)
+					goto out;
+				task_nr++;
+			}
+			ref++;
+		}
+	}
+
+	/* all the sources are parity cells, they are at the parity epoch */
+	if (task_nr == 0)
+		D_GOTO(out, rc = 0);
+
+	rc = tse_task_register_deps(task, task_nr, tasks);
+	if (rc != 0)
+		goto out;
+
+	D_DEBUG(DB_IO, "fetch %u stripes again at the parity epoch.\n",
+		recov->er_refetch_nr);
+	for (i = 0; i < task_nr; i++)
+		tse_task_schedule(tasks[i], false);
+	rc = task_nr;
+
+out:
+	if (rc < 0) {
+		for (i = 0; i < task_nr; i++)
+			tse_task_complete(tasks[i], rc);
+	}
+	if (tasks != NULL)
+		D_FREE(tasks);
+	return rc;
+}
+
+/**
+ * Body of the tasks to order the parity and the partial updates of the
+ * stripes which have both, runs after the probe and after each page of the
+ * listing.
+ */
+static int
+obj_ec_recov_step(tse_task_t *task)
+{
+	struct obj_ec_recov	*recov = tse_task_get_priv(task);
+	int			 rc = task->dt_result;
+
+	if (rc != 0)
+		goto out;
+
+	if (recov->er_listing) {
+		rc = obj_ec_recov_list_merge(recov);
+		if (rc != 0)
+			goto out;
+	}
+
+	while (recov->er_list_iod < recov->er_iod_nr &&
+	       !obj_ec_recov_iod_mixed(recov, recov->er_list_iod))
+		recov->er_list_iod++;
+
+	if (recov->er_list_iod < recov->er_iod_nr)
+		rc = obj_ec_recov_list(task, recov);
+	else
+		rc = obj_ec_recov_refetch(task, recov);
+	/* completed along with the tasks it depends on */
+	if (rc > 0)
+		return 0;
+
+out:
+	tse_task_complete(task, rc);
+	return rc;
+}
+
+static inline bool
+obj_ec_recov_lost(struct obj_ec_recov *recov, uint32_t tgt)
+{
+	uint32_t	i;
+
+	for (i = 0; i < recov->er_err_nr; i++) {
+		if (recov->er_err_list[i] == tgt)
+			return true;
+	}
+	return false;
+}
+
+/** Copy the partial updates newer than the parity over the lost cells */
+static void
+obj_ec_recov_overlay(struct obj_ec_recov *recov, uint32_t iod_idx,
+		     uint64_t stripe)
+{
+	struct obj_ec_recov_iod	*riod = &recov->er_riods[iod_idx];
+	daos_iod_t		*uiod = &recov->er_uiods[iod_idx];
+	struct daos_oclass_attr	*oca = recov->er_oca;
+	uint64_t		 stripe_rec_nr = obj_ec_stripe_rec_nr(oca);
+	uint64_t		 cell_bytes = riod->eri_cell_bytes;
+	unsigned char		*rep;
+	struct obj_ec_recov_ext	*ext;
+	uint64_t		 off, left, nob;
+	uint32_t		 i, tgt;
+
+	rep = riod->eri_rbuf + stripe * obj_ec_data_tgt_nr(oca) * cell_bytes;
+	for (i = 0; i < riod->eri_ext_nr; i++) {
+		ext = &riod->eri_exts[i];
+		if (ext->ere_stripe != stripe ||
+		    ext->ere_epoch <= riod->eri_pepochs[stripe])
+			continue;
+
+		off = (ext->ere_recx.rx_idx -
+		       (riod->eri_stripe_start + stripe) * stripe_rec_nr) *
+		      uiod->iod_size;
+		left = ext->ere_recx.rx_nr * uiod->iod_size;
+		while (left > 0) {
+			tgt = off / cell_bytes;
+			nob = min(left, cell_bytes - off % cell_bytes);
+			if (obj_ec_recov_lost(recov, tgt))
+				memcpy(obj_ec_recov_cell(riod, tgt, stripe) +
+				       off % cell_bytes, rep + off, nob);
+			off += nob;
+			left -= nob;
+		}
+	}
+}
+
+/**
+ * Recover the lost cells of all the covered stripes of \a iod_idx, either
+ * decoded from the surviving cells, or copied from the replica of partial
+ * updates, or both, depending on what the probe of the stripe found.
+ */
+static void
+obj_ec_recov_decode(struct obj_ec_recov *recov, uint32_t iod_idx)
+{
+	struct daos_oclass_attr	*oca = recov->er_oca;
+	struct obj_ec_recov_iod	*riod = &recov->er_riods[iod_idx];
+	uint32_t		 k = obj_ec_data_tgt_nr(oca);
+	uint64_t		 cell_bytes = riod->eri_cell_bytes;
+	unsigned char		*src[OBJ_EC_MAX_K];
+	unsigned char		*out[OBJ_EC_MAX_P];
+	unsigned char		*rep;
+	daos_iod_t		*ciods;
+	bool			 stale;
+	uint64_t		 s;
+	uint32_t		 i, tgt;
+
+	for (s = 0; s < riod->eri_stripe_nr; s++) {
+		ciods = &riod->eri_ciods[2 * s];
+		if (ciods[0].iod_size != 0) {
+			stale = obj_ec_recov_stale(riod, s);
+			for (i = 0; i < k; i++) {
+				tgt = recov->er_src[i];
+				src[i] = stale && tgt < k ?
+					 obj_ec_recov_ocell(riod, tgt, s) :
+					 obj_ec_recov_cell(riod, tgt, s);
+			}
+			for (i = 0; i < recov->er_err_nr; i++)
+				out[i] = obj_ec_recov_cell(riod,
+						recov->er_err_list[i], s);
+			ec_encode_data(cell_bytes, k, recov->er_err_nr,
+				       recov->er_gftbls, src, out);
+			if (stale)
+				obj_ec_recov_overlay(recov, iod_idx, s);
+			continue;
+		}
+
+		/* Not encoded, the replica has all the partial updates of
+		 * the stripe, and holes are zero as from the data targets.
+		 */
+		rep = riod->eri_rbuf + s * k * cell_bytes;
+		for (i = 0; i < recov->er_err_nr; i++)
+			memcpy(obj_ec_recov_cell(riod, recov->er_err_list[i],
+						 s),
+			       rep + recov->er_err_list[i] * cell_bytes,
+			       cell_bytes);
+	}
+}
+
+static int
+obj_ec_recov_comp_cb(tse_task_t *task, void *data)
+{
+	struct obj_ec_recov	*recov = *((struct obj_ec_recov **)data);
+	daos_iod_t		*fiod;
+	uint32_t		 i, j;
+
+	if (task->dt_result != 0)
+		goto out;
+
+	for (i = 0; i < recov->er_iod_nr; i++) {
+		if (recov->er_uiods[i].iod_type != DAOS_IOD_ARRAY ||
+		    recov->er_riods[i].eri_buf == NULL)
+			continue;
+		obj_ec_recov_decode(recov, i);
+		obj_ec_recov_sgl_fill(recov, i);
+	}
+
+	/* return the size of single values fetched on behalf of user, the
+	 * fetched iods are in the same order as user's.
+	 */
+	for (i = 0; i < obj_ec_data_tgt_nr(recov->er_oca); i++) {
+		if (recov->er_src[i] != recov->er_single_tgt)
+			continue;
+		fiod = &recov->er_fiods[i * recov->er_iod_nr];
+		for (j = 0; j < recov->er_iod_nr; j++) {
+			if (recov->er_uiods[j].iod_type != DAOS_IOD_ARRAY) {
+				recov->er_uiods[j].iod_size = fiod->iod_size;
+				fiod++;
+			} else if (recov->er_riods[j].eri_buf != NULL) {
+				fiod++;
+			}
+		}
+	}
+
+out:
+	obj_ec_recov_free(recov);
+	return 0;
+}
+
+/**
+ * Fetch with lost data targets, recover the lost cells from surviving data
+ * and parity cells.
+ *
+ * \param[in]	task		the object fetch task
+ * \param[in]	args		fetch arguments
+ * \param[in]	oid		object ID
+ * \param[in]	oca		object class attribute
+ * \param[in]	uiods		user's iods
+ * \param[in]	usgls		user's sgls
+ * \param[in]	start_shard	the first shard of the EC stripe
+ * \param[in]	lost_bitmap	the lost targets (one bit for each target of
+ *				the stripe)
+ */
+int
+obj_ec_recov_fetch(tse_task_t *task, daos_obj_fetch_t *args,
+		   daos_obj_id_t oid, struct daos_oclass_attr *oca,
+		   daos_iod_t *uiods, d_sg_list_t *usgls, uint32_t start_shard,
+		   uint8_t *lost_bitmap)
+{
+	struct obj_ec_recov	*recov;
+	tse_task_t		*fetch_tasks[OBJ_EC_MAX_K + 2];
+	uint32_t		 k = obj_ec_data_tgt_nr(oca);
+	uint32_t		 i, task_nr = 0;
+	int			 rc;
+
+	D_ALLOC_PTR(recov);
+	if (recov == NULL)
+		return -DER_NOMEM;
+
+	recov->er_oca = oca;
+	recov->er_codec = obj_ec_codec_get(daos_obj_id2class(oid));
+	if (recov->er_codec == NULL) {
+		D_ERROR(DF_OID" no EC codec found.\n", DP_OID(oid));
+		D_GOTO(out, rc = -DER_INVAL);
+	}
+	recov->er_uiods = uiods;
+	recov->er_usgls = usgls;
+	recov->er_iod_nr = args->nr;
+	recov->er_oh = args->oh;
+	recov->er_th = args->th;
+	recov->er_dkey = args->dkey;
+	recov->er_start_shard = start_shard;
+
+	for (i = 0; i < k; i++) {
+		if (isclr(lost_bitmap, i))
+			continue;
+		if (recov->er_err_nr == obj_ec_parity_tgt_nr(oca)) {
+			D_ERROR(DF_OID" too many lost targets.\n", DP_OID(oid));
+			D_GOTO(out, rc = -DER_IO);
+		}
+		recov->er_err_list[recov->er_err_nr++] = i;
+	}
+	D_ASSERT(recov->er_err_nr > 0);
+
+	recov->er_single_tgt = 0;
+	while (isset(lost_bitmap, recov->er_single_tgt)) {
+		recov->er_single_tgt = recov->er_single_tgt == 0 ?
+				       k : recov->er_single_tgt + 1;
+		if (recov->er_single_tgt == obj_ec_tgt_nr(oca))
+			D_GOTO(out, rc = -DER_IO);
+	}
+
+	/* at least one parity target survives, or nothing can be decoded */
+	recov->er_rep_tgt = k;
+	while (isset(lost_bitmap, recov->er_rep_tgt)) {
+		if (++recov->er_rep_tgt == obj_ec_tgt_nr(oca))
+			D_GOTO(out, rc = -DER_IO);
+	}
+
+	rc = obj_ec_recov_tables_init(recov, lost_bitmap);
+	if (rc != 0)
+		goto out;
+
+	D_ALLOC_ARRAY(recov->er_riods, args->nr);
+	if (recov->er_riods == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+	for (i = 0; i < args->nr; i++) {
+		rc = obj_ec_recov_iod_init(recov, i);
+		if (rc != 0)
+			goto out;
+	}
+
+	rc = obj_ec_recov_fetch_init(recov);
+	if (rc != 0)
+		goto out;
+
+	rc = obj_ec_recov_check_init(recov);
+	if (rc != 0)
+		goto out;
+
+	for (i = 0, task_nr = 0; i < k; i++) {
+		if (recov->er_fiod_nrs[i] == 0)
+			continue;
+		rc = dc_obj_fetch_shard_task_create(args->oh, args->th,
+				DIOF_TO_SPEC_SHARD | DIOF_EC_RECOV,
+				start_shard + recov->er_src[i], args->dkey,
+				recov->er_fiod_nrs[i],
+				&recov->er_fiods[i * args->nr],
+				&recov->er_fsgls[i * args->nr], NULL, NULL,
+				tse_task2sched(task), &fetch_tasks[task_nr]);
+		if (rc != 0)
+			D_GOTO(out_tasks, rc);
+		task_nr++;
+	}
+
+	if (recov->er_ciod_nr > 0) {
+		rc = dc_obj_fetch_shard_task_create(args->oh, args->th,
+				DIOF_TO_SPEC_SHARD | DIOF_EC_RECOV,
+				start_shard + recov->er_rep_tgt, args->dkey,
+				recov->er_ciod_nr, recov->er_ciods,
+				recov->er_csgls, NULL, NULL,
+				tse_task2sched(task), &fetch_tasks[task_nr]);
+		if (rc != 0)
+			D_GOTO(out_tasks, rc);
+		task_nr++;
+
+		/* order the parity and the partial updates once probed */
+		rc = tse_task_create(obj_ec_recov_step, tse_task2sched(task),
+				     recov, &fetch_tasks[task_nr]);
+		if (rc != 0)
+			D_GOTO(out_tasks, rc);
+		task_nr++;
+
+		rc = tse_task_register_deps(fetch_tasks[task_nr - 1], 1,
+					    &fetch_tasks[task_nr - 2]);
+		if (rc != 0)
+			D_GOTO(out_tasks, rc);
+	}
+	D_ASSERT(task_nr > 0);
+
+	rc = tse_task_register_comp_cb(task, obj_ec_recov_comp_cb, &recov,
+				       sizeof(recov));
+	if (rc != 0)
+		D_GOTO(out_tasks, rc);
+	/* recov is released by obj_ec_recov_comp_cb from now on */
+	recov = NULL;
+
+	rc = tse_task_register_deps(task, task_nr, fetch_tasks);
+	if (rc != 0)
+		D_GOTO(out_tasks, rc);
+
+	D_DEBUG(DB_IO, DF_OID" degraded fetch from %d targets.\n",
+		DP_OID(oid), task_nr);
+	for (i = 0; i < task_nr; i++)
+		tse_task_schedule(fetch_tasks[i], false);
+
+	return 0;
+
+out_tasks:
+	for (i = 0; i < task_nr; i++)
+		tse_task_complete(fetch_tasks[i], rc);
+out:
+	obj_ec_recov_free(recov);
+	return rc;
+}
@@ -80,7 +80,8 @@ struct obj_auxi_args {
 					 args_initialized:1,
 					 to_leader:1,
 					 spec_shard:1,
-					 req_reasbed:1;
+					 req_reasbed:1,
+					 ec_recov:1;
 	/* request flags, now only with ORF_RESEND */
 	uint32_t			 flags;
 	struct obj_req_tgts		 req_tgts;
@@ -666,6 +667,10 @@ obj_rw_req_reassemb(struct dc_object *obj, daos_obj_rw_t *args,
 	if (!daos_oclass_is_ec(oid, &oca))
 		return 0;
 
+	/* EC recovery fetch is already addressed to per-target extents */
+	if (obj_auxi->ec_recov)
+		return 0;
+
 	rc = obj_reasb_req_init(obj_auxi, args->iods, args->nr, oca);
 	if (rc) {
 		D_ERROR(DF_OID" obj_reasb_req_init failed %d.\n",
@@ -673,6 +678,8 @@ obj_rw_req_reassemb(struct dc_object *obj, daos_obj_rw_t *args,
 		return rc;
 	}
 
+	reasb_req->orr_uiods = args->iods;
+	reasb_req->orr_usgls = args->sgls;
 	rc = obj_ec_req_reasb(args, oid, oca, reasb_req,
 			      obj_auxi->opc == DAOS_OBJ_RPC_UPDATE);
 	if (rc == 0) {
@@ -2393,6 +2400,39 @@ obj_update_csums(const struct dc_object *obj, const daos_obj_update_t *args) {
 	}
 }
 
+/**
+ * Check if any data target addressed by the EC fetch is lost, the shard being
+ * rebuilt is regarded as lost as its data is incomplete. Set all the lost
+ * targets of the stripe in \a lost_bitmap so the lost cells can be recovered
+ * from the surviving ones.
+ *
+ * \return	true if the fetch need to go through degraded mode.
+ */
+static bool
+obj_ec_fetch_degraded(struct dc_object *obj, struct daos_oclass_attr *oca,
+		      uint32_t start_shard, uint8_t *tgt_bitmap,
+		      uint8_t *lost_bitmap)
+{
+	struct dc_obj_shard	*obj_shard;
+	bool			 degraded = false;
+	uint32_t		 i;
+
+	D_RWLOCK_RDLOCK(&obj->cob_lock);
+	for (i = 0; i < obj_ec_tgt_nr(oca); i++) {
+		obj_shard = &obj->cob_shards->do_shards[start_shard + i];
+		if (obj_shard->do_shard != -1 &&
+		    obj_shard->do_target_id != -1 &&
+		    !obj_shard->do_rebuilding)
+			continue;
+		setbit(lost_bitmap, i);
+		if (i < obj_ec_data_tgt_nr(oca) && isset(tgt_bitmap, i))
+			degraded = true;
+	}
+	D_RWLOCK_UNLOCK(&obj->cob_lock);
+
+	return degraded;
+}
+
 static int
 do_dc_obj_fetch(tse_task_t *task, daos_obj_fetch_t *args,
 		uint32_t flags, uint32_t shard)
@@ -2425,6 +2465,7 @@ do_dc_obj_fetch(tse_task_t *task, daos_obj_fetch_t *args,
 		D_GOTO(out_task, rc);
 	}
 
+	obj_auxi->ec_recov = (flags & DIOF_EC_RECOV) != 0;
 	rc = obj_rw_req_reassemb(obj, args, obj_auxi);
 	if (rc) {
 		D_ERROR(DF_OID" obj_req_reassemb failed %d.\n",
@@ -2445,6 +2486,36 @@ do_dc_obj_fetch(tse_task_t *task, daos_obj_fetch_t *args,
 	if (rc != 0)
 		D_GOTO(out_task, rc);
 
+	if (obj_auxi->req_reasbed && !obj_auxi->spec_shard) {
+		struct obj_reasb_req	*reasb_req = &obj_auxi->reasb_req;
+		struct daos_oclass_attr	*oca;
+		uint8_t			 lost_bitmap[OBJ_TGT_BITMAP_LEN] = {0};
+		uint32_t		 start_shard;
+		uint32_t		 grp_size;
+
+		oca = daos_oclass_attr_find(obj->cob_md.omd_id);
+		rc = obj_dkey2grpmemb(obj, dkey_hash, map_ver, &start_shard,
+				      &grp_size);
+		if (rc != 0)
+			D_GOTO(out_task, rc);
+
+		if (obj_ec_fetch_degraded(obj, oca, start_shard,
+					  reasb_req->tgt_bitmap,
+					  lost_bitmap)) {
+			rc = obj_ec_recov_fetch(task, args, obj->cob_md.omd_id,
+						oca, reasb_req->orr_uiods,
+						reasb_req->orr_usgls,
+						start_shard, lost_bitmap);
+			if (rc != 0) {
+				D_ERROR(DF_OID" degraded fetch failed "DF_RC
+					".\n", DP_OID(obj->cob_md.omd_id),
+					DP_RC(rc));
+				goto out_task;
+			}
+			return 0;
+		}
+	}
+
 	rc = obj_rw_bulk_prep(obj, args->iods, args->sgls, args->nr,
 			      false, false, task, obj_auxi);
 	if (rc != 0) {
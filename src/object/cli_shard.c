@@ -614,6 +614,7 @@ struct obj_enum_args {
 	struct dc_obj_shard	*eaa_obj;
 	d_sg_list_t		*eaa_sgl;
 	daos_recx_t		*eaa_recxs;
+	daos_epoch_range_t	*eaa_eprs;
 	daos_size_t		*eaa_size;
 	unsigned int		*eaa_map_ver;
 };
@@ -680,6 +681,13 @@ dc_enumerate_cb(tse_task_t *task, void *arg)
 		       oeo->oeo_recxs.ca_count);
 	}
 
+	if (enum_args->eaa_eprs && oeo->oeo_eprs.ca_count > 0) {
+		D_ASSERT(*enum_args->eaa_nr >= oeo->oeo_eprs.ca_count);
+		memcpy(enum_args->eaa_eprs, oeo->oeo_eprs.ca_arrays,
+		       sizeof(*enum_args->eaa_eprs) *
+		       oeo->oeo_eprs.ca_count);
+	}
+
 	if (enum_args->eaa_sgl && oeo->oeo_sgl.sg_nr > 0) {
 		rc = daos_sgl_copy_data_out(enum_args->eaa_sgl, &oeo->oeo_sgl);
 		if (rc)
@@ -832,6 +840,9 @@ dc_obj_shard_list(struct dc_obj_shard *obj_shard, enum obj_rpc_opc opc,
 	enum_args.eaa_sgl = sgl;
 	enum_args.eaa_map_ver = &args->la_auxi.map_ver;
 	enum_args.eaa_recxs = obj_args->recxs;
+	/* eprs is the input epoch range of object enumeration */
+	enum_args.eaa_eprs = opc == DAOS_OBJ_RECX_RPC_ENUMERATE ?
+			     obj_args->eprs : NULL;
 	rc = tse_task_register_comp_cb(task, dc_enumerate_cb, &enum_args,
 				       sizeof(enum_args));
 	if (rc != 0)
@@ -64,6 +64,8 @@
 extern bool	cli_bypass_rpc;
 /** Switch of server-side IO dispatch */
 extern unsigned int	srv_io_mode;
+/** Fetch SCM-resident data by the bulk handle registering pool SCM */
+extern bool		srv_scm_bulk;
 
 /** client object shard */
 struct dc_obj_shard {
@@ -135,6 +137,9 @@ struct dc_object {
  *    it, create oiod/siod to specify each shard/tgt's IO req.
  */
 struct obj_reasb_req {
+	/* user's iods and sgls, used by EC degraded fetch */
+	daos_iod_t			*orr_uiods;
+	d_sg_list_t			*orr_usgls;
 	daos_iod_t			*orr_iods;
 	d_sg_list_t			*orr_sgls;
 	struct obj_io_desc		*orr_oiods;
@@ -410,6 +415,12 @@ ec_get_tgt_set(daos_iod_t *iods, unsigned int nr, struct daos_oclass_attr *oca,
 int
 ec_split_recxs(tse_task_t *task, struct daos_oclass_attr *oca);
 
+int
+obj_ec_recov_fetch(tse_task_t *task, daos_obj_fetch_t *args,
+		   daos_obj_id_t oid, struct daos_oclass_attr *oca,
+		   daos_iod_t *uiods, d_sg_list_t *usgls, uint32_t start_shard,
+		   uint8_t *lost_bitmap);
+
 void
 ec_free_iods(daos_iod_t *iods, int nr);
 
@@ -32,6 +32,12 @@
 #include "obj_rpc.h"
 #include "obj_internal.h"
 
+/**
+ * Switch of fetching SCM-resident data by the bulk handle registering the
+ * whole pool SCM, enabled by default.
+ */
+bool	srv_scm_bulk = true;
+
 /**
  * Swtich of enable DTX or not, enabled by default.
  */
@@ -40,6 +46,8 @@ obj_mod_init(void)
 {
 	int	rc;
 
+	d_getenv_bool("DAOS_IO_SCM_BULK", &srv_scm_bulk);
+
 	rc = obj_utils_init();
 	if (rc)
 		goto out;
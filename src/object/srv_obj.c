@@ -144,6 +144,8 @@ struct obj_bulk_args {
 	int		bulks_inflight;
 	int		result;
 	ABT_eventual	eventual;
+	/* Bulk handle of pool SCM, it's shared and must not be freed */
+	crt_bulk_t	scm_bulk;
 };
 
 static int
@@ -174,7 +176,8 @@ obj_bulk_comp_cb(const struct crt_bulk_cb_info *cb_info)
 		ABT_eventual_set(arg->eventual, &arg->result,
 				 sizeof(arg->result));
 
-	crt_bulk_free(local_bulk_hdl);
+	if (local_bulk_hdl != arg->scm_bulk)
+		crt_bulk_free(local_bulk_hdl);
 	crt_req_decref(rpc);
 	return cb_info->bci_rc;
 }
@@ -218,14 +221,32 @@ obj_bulk_bypass(d_sg_list_t *sgl, crt_bulk_op_t bulk_op)
 	}
 }
 
+static inline bool
+obj_iov_in_scm(d_iov_t *iov, char *scm_base, daos_size_t scm_size)
+{
+	char	*buf = iov->iov_buf;
+
+	return scm_base != NULL && buf >= scm_base &&
+	       buf + iov->iov_len <= scm_base + scm_size;
+}
+
+/**
+ * Transfer data between the local sgls (or the sgls of the VOS I/O handle)
+ * and the remote bulks. When @pool is provided for fetch, records resident in
+ * the SCM of the pool are transferred by the bulk handle registering the whole
+ * SCM (see ds_pool_child_scm_bulk()), instead of creating bulk handle for them.
+ */
 static int
 obj_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op, bool bulk_bind,
 		  crt_bulk_t *remote_bulks, uint64_t *remote_offs,
-		  daos_handle_t ioh, d_sg_list_t **sgls, int sgl_nr)
+		  daos_handle_t ioh, d_sg_list_t **sgls, int sgl_nr,
+		  struct ds_pool_child *pool)
 {
 	struct obj_bulk_args	arg = { 0 };
 	crt_bulk_opid_t		bulk_opid;
 	crt_bulk_perm_t		bulk_perm;
+	char			*scm_base = NULL;
+	daos_size_t		scm_size = 0;
 	int			i, rc, *status, ret;
 
 	bulk_perm = bulk_op == CRT_BULK_PUT ? CRT_BULK_RO : CRT_BULK_RW;
@@ -233,6 +254,15 @@ obj_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op, bool bulk_bind,
 	if (rc != 0)
 		return dss_abterr2der(rc);
 
+	if (pool != NULL && srv_scm_bulk && bulk_op == CRT_BULK_PUT &&
+	    !(daos_io_bypass & IOBP_SRV_BULK)) {
+		void	*base;
+
+		if (ds_pool_child_scm_bulk(pool, rpc->cr_ctx, &arg.scm_bulk,
+					   &base, &scm_size) == 0)
+			scm_base = base;
+	}
+
 	D_DEBUG(DB_IO, "bulk_op %d sgl_nr %d\n", bulk_op, sgl_nr);
 
 	arg.bulks_inflight++;
@@ -280,6 +310,7 @@ obj_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op, bool bulk_bind,
 		while (idx < sgl->sg_nr_out) {
 			d_sg_list_t	sgl_sent;
 			daos_size_t	length = 0;
+			daos_size_t	local_off;
 			unsigned int	start;
 
 			/**
@@ -296,10 +327,34 @@ obj_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op, bool bulk_bind,
 				break;
 
 			start = idx;
+			/**
+			 * SCM-resident records, transfer them from PMEM. The
+			 * records adjacent in PMEM are coalesced into one
+			 * transfer.
+			 */
+			if (obj_iov_in_scm(&sgl->sg_iovs[start], scm_base,
+					   scm_size)) {
+				char	*buf = sgl->sg_iovs[start].iov_buf;
+
+				local_bulk_hdl = arg.scm_bulk;
+				local_off = buf - scm_base;
+				while (idx < sgl->sg_nr_out &&
+				       sgl->sg_iovs[idx].iov_buf ==
+				       buf + length &&
+				       obj_iov_in_scm(&sgl->sg_iovs[idx],
+						      scm_base, scm_size)) {
+					length += sgl->sg_iovs[idx].iov_len;
+					idx++;
+				}
+				goto transfer;
+			}
+
 			sgl_sent.sg_iovs = &sgl->sg_iovs[start];
 			/* Find the end of the non-empty record */
 			while (sgl->sg_iovs[idx].iov_buf != NULL &&
-			       idx < sgl->sg_nr_out) {
+			       idx < sgl->sg_nr_out &&
+			       !obj_iov_in_scm(&sgl->sg_iovs[idx], scm_base,
+					       scm_size)) {
 				length += sgl->sg_iovs[idx].iov_len;
 				idx++;
 			}
@@ -314,7 +369,8 @@ obj_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op, bool bulk_bind,
 					i, rc);
 				break;
 			}
-
+			local_off = 0;
+		transfer:
 			crt_req_addref(rpc);
 
 			bulk_desc.bd_rpc	= rpc;
@@ -323,7 +379,7 @@ obj_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op, bool bulk_bind,
 			bulk_desc.bd_local_hdl	= local_bulk_hdl;
 			bulk_desc.bd_len	= length;
 			bulk_desc.bd_remote_off	= offset;
-			bulk_desc.bd_local_off	= 0;
+			bulk_desc.bd_local_off	= local_off;
 
 			arg.bulks_inflight++;
 			if (bulk_bind)
@@ -336,7 +392,8 @@ obj_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op, bool bulk_bind,
 				D_ERROR("crt_bulk_transfer %d error (%d).\n",
 					i, rc);
 				arg.bulks_inflight--;
-				crt_bulk_free(local_bulk_hdl);
+				if (local_bulk_hdl != arg.scm_bulk)
+					crt_bulk_free(local_bulk_hdl);
 				crt_req_decref(rpc);
 				break;
 			}
@@ -553,7 +610,7 @@ obj_echo_rw(crt_rpc_t *rpc, daos_iod_t *split_iods, uint64_t *split_offs)
 	bulk_bind = orw->orw_flags & ORF_BULK_BIND;
 	rc = obj_bulk_transfer(rpc, bulk_op, bulk_bind,
 			       orw->orw_bulks.ca_arrays, off,
-			       DAOS_HDL_INVAL, &p_sgl, orw->orw_nr);
+			       DAOS_HDL_INVAL, &p_sgl, orw->orw_nr, NULL);
 out:
 	orwo->orw_ret = rc;
 	orwo->orw_map_version = orw->orw_map_ver;
@@ -883,7 +940,7 @@ obj_local_rw(crt_rpc_t *rpc, struct ds_cont_hdl *cont_hdl,
 		bulk_bind = orw->orw_flags & ORF_BULK_BIND;
 		rc = obj_bulk_transfer(rpc, bulk_op, bulk_bind,
 				       orw->orw_bulks.ca_arrays, offs,
-				       ioh, NULL, orw->orw_nr);
+				       ioh, NULL, orw->orw_nr, cont->sc_pool);
 	} else if (orw->orw_sgls.ca_arrays != NULL) {
 		rc = bio_iod_copy(biod, orw->orw_sgls.ca_arrays, orw->orw_nr);
 	}
@@ -899,6 +956,17 @@ obj_local_rw(crt_rpc_t *rpc, struct ds_cont_hdl *cont_hdl,
 post:
 	err = bio_iod_post(biod);
 	rc = rc ? : err;
+	if (rc == 0 && !size_fetch) {
+		daos_size_t	len = daos_iods_len(iods, orw->orw_nr);
+
+		/* charge the rebuild pulling to rebuild instead of I/O, the
+		 * rebuild handle isn't attached to a container.
+		 */
+		if (len != (daos_size_t)-1)
+			dss_sched_charge(cont_hdl->sch_cont == NULL ?
+					 DSS_POOL_REBUILD : DSS_POOL_SHARE,
+					 len);
+	}
 out:
 	rc = obj_rw_complete(rpc, cont, ioh, rc, dth);
 	D_TIME_END(tls->ot_sp, time_start, OBJ_PF_UPDATE_LOCAL);
@@ -1127,6 +1195,12 @@ ds_obj_tgt_update_handler(crt_rpc_t *rpc)
 			D_GOTO(out, rc);
 	}
 
+	/* Inject failure for test to fail the modification on non-leader
+	 * before anything, including the piggy-backed DTXs, is committed.
+	 */
+	if (DAOS_FAIL_CHECK(DAOS_DTX_NONLEADER_REJECT))
+		D_GOTO(out, rc = -DER_IO);
+
 	/* Inject failure for test to simulate the case of lost some
 	 * record/akey/dkey on some non-leader.
 	 */
@@ -1508,7 +1582,7 @@ obj_enum_reply_bulk(crt_rpc_t *rpc)
 		return 0;
 
 	rc = obj_bulk_transfer(rpc, CRT_BULK_PUT, false, bulks, NULL,
-			       DAOS_HDL_INVAL, sgls, idx);
+			       DAOS_HDL_INVAL, sgls, idx, NULL);
 	if (oei->oei_kds_bulk) {
 		D_FREE(oeo->oeo_kds.ca_arrays);
 		oeo->oeo_kds.ca_arrays = NULL;
@@ -98,7 +98,6 @@ ds_obj_remote_update(struct dtx_leader_handle *dlh, void *data, int idx,
 	crt_rpc_t			*parent_req = obj_exec_arg->rpc;
 	crt_rpc_t			*req;
 	struct dtx_sub_status		*sub;
-	struct dtx_handle		*dth = &dlh->dlh_handle;
 	struct obj_remote_cb_arg	*remote_arg = NULL;
 	struct obj_rw_in		*orw;
 	struct obj_rw_in		*orw_parent;
@@ -157,8 +156,8 @@ ds_obj_remote_update(struct dtx_leader_handle *dlh, void *data, int idx,
 	orw->orw_shard_tgts.ca_count	= 0;
 	orw->orw_shard_tgts.ca_arrays	= NULL;
 	orw->orw_flags |= ORF_BULK_BIND | obj_exec_arg->flags;
-	orw->orw_dti_cos.ca_count	= dth->dth_dti_cos_count;
-	orw->orw_dti_cos.ca_arrays	= dth->dth_dti_cos;
+	orw->orw_dti_cos.ca_count	= dlh->dlh_dti_cos_count;
+	orw->orw_dti_cos.ca_arrays	= dlh->dlh_dti_cos;
 
 	D_DEBUG(DB_TRACE, DF_UOID" forwarding to rank:%d tag:%d.\n",
 		DP_UOID(orw->orw_oid), tgt_ep.ep_rank, tgt_ep.ep_tag);
@@ -228,7 +227,6 @@ ds_obj_remote_punch(struct dtx_leader_handle *dlh, void *data, int idx,
 	struct ds_obj_exec_arg		*obj_exec_arg = data;
 	struct daos_shard_tgt		*shard_tgt;
 	struct obj_remote_cb_arg	*remote_arg;
-	struct dtx_handle		*dth = &dlh->dlh_handle;
 	struct dtx_sub_status		*sub;
 	crt_endpoint_t			 tgt_ep;
 	crt_rpc_t			*parent_req = obj_exec_arg->rpc;
@@ -277,8 +275,8 @@ ds_obj_remote_punch(struct dtx_leader_handle *dlh, void *data, int idx,
 	opi->opi_shard_tgts.ca_count = 0;
 	opi->opi_shard_tgts.ca_arrays = NULL;
 	opi->opi_flags |= obj_exec_arg->flags;
-	opi->opi_dti_cos.ca_count = dth->dth_dti_cos_count;
-	opi->opi_dti_cos.ca_arrays = dth->dth_dti_cos;
+	opi->opi_dti_cos.ca_count = dlh->dlh_dti_cos_count;
+	opi->opi_dti_cos.ca_arrays = dlh->dlh_dti_cos;
 
 	D_DEBUG(DB_TRACE, DF_UOID" forwarding to rank:%d tag:%d.\n",
 		DP_UOID(opi->opi_oid), tgt_ep.ep_rank, tgt_ep.ep_tag);
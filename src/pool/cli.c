@@ -240,6 +240,7 @@ static int
 process_query_reply(struct dc_pool *pool, struct pool_buf *map_buf,
 		    uint32_t map_version, uint32_t leader_rank,
 		    struct daos_pool_space *ps, struct daos_rebuild_status *rs,
+		    struct daos_pool_obj_cache *poc,
 		    d_rank_list_t *tgts, daos_pool_info_t *info,
 		    daos_prop_t *prop_req, daos_prop_t *prop_reply,
 		    bool connect)
@@ -279,7 +280,7 @@ out_unlock:
 
 	if (info != NULL && rc == 0)
 		pool_query_reply_to_info(pool->dp_pool, map_buf, map_version,
-					 leader_rank, ps, rs, info);
+					 leader_rank, ps, rs, poc, info);
 
 	return rc;
 }
@@ -367,7 +368,8 @@ pool_connect_cp(tse_task_t *task, void *data)
 	rc = process_query_reply(pool, map_buf, pco->pco_op.po_map_version,
 				 pco->pco_op.po_hint.sh_rank,
 				 &pco->pco_space, &pco->pco_rebuild_st,
-				 NULL /* tgts */, info, NULL, NULL, true);
+				 NULL /* poc */, NULL /* tgts */, info, NULL,
+				 NULL, true);
 	if (rc != 0) {
 		/* TODO: What do we do about the remote connection state? */
 		D_ERROR("failed to create local pool map: "DF_RC"\n",
@@ -1252,8 +1254,9 @@ pool_query_cb(tse_task_t *task, void *data)
 				 out->pqo_op.po_map_version,
 				 out->pqo_op.po_hint.sh_rank,
 				 &out->pqo_space, &out->pqo_rebuild_st,
-				 arg->dqa_tgts, arg->dqa_info,
-				 arg->dqa_prop, out->pqo_prop, false);
+				 &out->pqo_obj_cache, arg->dqa_tgts,
+				 arg->dqa_info, arg->dqa_prop, out->pqo_prop,
+				 false);
 out:
 	crt_req_decref(arg->rpc);
 	dc_pool_put(arg->dqa_pool);
@@ -103,6 +103,43 @@ crt_proc_struct_daos_pool_space(crt_proc_t proc, struct daos_pool_space *ps)
 	return 0;
 }
 
+static int
+crt_proc_struct_daos_pool_obj_cache(crt_proc_t proc,
+				    struct daos_pool_obj_cache *poc)
+{
+	int rc;
+
+	rc = crt_proc_uint64_t(proc, &poc->poc_hits);
+	if (rc)
+		return -DER_HG;
+
+	rc = crt_proc_uint64_t(proc, &poc->poc_misses);
+	if (rc)
+		return -DER_HG;
+
+	rc = crt_proc_uint64_t(proc, &poc->poc_evictions);
+	if (rc)
+		return -DER_HG;
+
+	rc = crt_proc_uint64_t(proc, &poc->poc_size);
+	if (rc)
+		return -DER_HG;
+
+	rc = crt_proc_uint64_t(proc, &poc->poc_cached);
+	if (rc)
+		return -DER_HG;
+
+	rc = crt_proc_uint32_t(proc, &poc->poc_resizes);
+	if (rc)
+		return -DER_HG;
+
+	rc = crt_proc_uint32_t(proc, &poc->poc_ntargets);
+	if (rc)
+		return -DER_HG;
+
+	return 0;
+}
+
 static int
 crt_proc_struct_daos_rebuild_status(crt_proc_t proc,
 				    struct daos_rebuild_status *drs)
@@ -171,6 +208,8 @@ CRT_RPC_DEFINE(pool_exclude, DAOS_ISEQ_POOL_TGT_UPDATE,
 		DAOS_OSEQ_POOL_TGT_UPDATE)
 CRT_RPC_DEFINE(pool_exclude_out, DAOS_ISEQ_POOL_TGT_UPDATE,
 		DAOS_OSEQ_POOL_TGT_UPDATE)
+CRT_RPC_DEFINE(pool_add_in, DAOS_ISEQ_POOL_TGT_UPDATE,
+		DAOS_OSEQ_POOL_TGT_UPDATE)
 CRT_RPC_DEFINE(pool_evict, DAOS_ISEQ_POOL_EVICT, DAOS_OSEQ_POOL_EVICT)
 CRT_RPC_DEFINE(pool_svc_stop, DAOS_ISEQ_POOL_SVC_STOP, DAOS_OSEQ_POOL_SVC_STOP)
 CRT_RPC_DEFINE(pool_tgt_connect, DAOS_ISEQ_POOL_TGT_CONNECT,
@@ -290,6 +329,8 @@ pool_query_bits(daos_pool_info_t *po_info, daos_prop_t *prop)
 			bits |= DAOS_PO_QUERY_SPACE;
 		if (po_info->pi_bits & DPI_REBUILD_STATUS)
 			bits |= DAOS_PO_QUERY_REBUILD_STATUS;
+		if (po_info->pi_bits & DPI_OBJ_CACHE)
+			bits |= DAOS_PO_QUERY_OBJ_CACHE;
 	}
 
 	if (prop == NULL)
@@ -342,6 +383,8 @@ out:
  * \param[in]		leader_rank	Pool leader rank
  * \param[in]		ps		Pool space
  * \param[in]		rs		Rebuild status
+ * \param[in]		poc		Object cache statistics, NULL if
+ *					the reply carries none
  * @param[in][out]	info		Pool info - pass in with pi_bits set
  *					Returned populated with inputs
  */
@@ -350,6 +393,7 @@ pool_query_reply_to_info(uuid_t pool_uuid, struct pool_buf *map_buf,
 			 uint32_t map_version, uint32_t leader_rank,
 			 struct daos_pool_space *ps,
 			 struct daos_rebuild_status *rs,
+			 struct daos_pool_obj_cache *poc,
 			 daos_pool_info_t *info)
 {
 	D_ASSERT(ps != NULL);
@@ -364,6 +408,13 @@ pool_query_reply_to_info(uuid_t pool_uuid, struct pool_buf *map_buf,
 		info->pi_space		= *ps;
 	if (info->pi_bits & DPI_REBUILD_STATUS)
 		info->pi_rebuild_st	= *rs;
+	if (info->pi_bits & DPI_OBJ_CACHE) {
+		if (poc != NULL)
+			info->pi_obj_cache = *poc;
+		else
+			memset(&info->pi_obj_cache, 0,
+			       sizeof(info->pi_obj_cache));
+	}
 }
 
 int
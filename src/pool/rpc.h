@@ -93,7 +93,10 @@
 		ds_pool_replicas_update_handler, NULL),			\
 	X(POOL_LIST_CONT,						\
 		0, &CQF_pool_list_cont,					\
-		ds_pool_list_cont_handler, NULL)
+		ds_pool_list_cont_handler, NULL),			\
+	X(POOL_ADD_IN,							\
+		0, &CQF_pool_add_in,					\
+		ds_pool_update_handler, NULL)
 
 #define POOL_PROTO_SRV_RPC_LIST						\
 	X(POOL_TGT_CONNECT,						\
@@ -192,6 +195,7 @@ CRT_RPC_DECLARE(pool_disconnect, DAOS_ISEQ_POOL_DISCONNECT,
 /** pool query request bits */
 #define DAOS_PO_QUERY_SPACE		(1ULL << 0)
 #define DAOS_PO_QUERY_REBUILD_STATUS	(1ULL << 1)
+#define DAOS_PO_QUERY_OBJ_CACHE		(1ULL << 2)
 
 #define DAOS_PO_QUERY_PROP_LABEL	(1ULL << 16)
 #define DAOS_PO_QUERY_PROP_SPACE_RB	(1ULL << 17)
@@ -217,6 +221,7 @@ CRT_RPC_DECLARE(pool_disconnect, DAOS_ISEQ_POOL_DISCONNECT,
 	((daos_prop_t)		(pqo_prop)		CRT_PTR) \
 	((struct daos_pool_space) (pqo_space)		CRT_VAR) \
 	((struct daos_rebuild_status) (pqo_rebuild_st)	CRT_VAR) \
+	((struct daos_pool_obj_cache) (pqo_obj_cache)	CRT_VAR) \
 	/* only set on -DER_TRUNC */				 \
 	((uint32_t)		(pqo_map_buf_size)	CRT_VAR)
 
@@ -293,6 +298,8 @@ CRT_RPC_DECLARE(pool_exclude, DAOS_ISEQ_POOL_TGT_UPDATE,
 		DAOS_OSEQ_POOL_TGT_UPDATE)
 CRT_RPC_DECLARE(pool_exclude_out, DAOS_ISEQ_POOL_TGT_UPDATE,
 		DAOS_OSEQ_POOL_TGT_UPDATE)
+CRT_RPC_DECLARE(pool_add_in, DAOS_ISEQ_POOL_TGT_UPDATE,
+		DAOS_OSEQ_POOL_TGT_UPDATE)
 
 #define DAOS_ISEQ_POOL_EVICT	/* input fields */		 \
 	((struct pool_op_in)	(pvi_op)		CRT_VAR)
@@ -342,6 +349,7 @@ CRT_RPC_DECLARE(pool_tgt_disconnect, DAOS_ISEQ_POOL_TGT_DISCONNECT,
 
 #define DAOS_OSEQ_POOL_TGT_QUERY	/* output fields */	 \
 	((struct daos_pool_space) (tqo_space)		CRT_VAR) \
+	((struct daos_pool_obj_cache) (tqo_obj_cache)	CRT_VAR) \
 	((uint32_t)		(tqo_rc)		CRT_VAR)
 
 CRT_RPC_DECLARE(pool_tgt_query, DAOS_ISEQ_POOL_TGT_QUERY,
@@ -429,6 +437,7 @@ pool_query_reply_to_info(uuid_t pool_uuid, struct pool_buf *map_buf,
 			 uint32_t map_version, uint32_t leader_rank,
 			 struct daos_pool_space *ps,
 			 struct daos_rebuild_status *rs,
+			 struct daos_pool_obj_cache *poc,
 			 daos_pool_info_t *info);
 
 int list_cont_bulk_create(crt_context_t ctx, crt_bulk_t *bulk,
@@ -46,6 +46,7 @@ RDB_STRING_KEY(ds_pool_prop_, reclaim);
 RDB_STRING_KEY(ds_pool_prop_, owner);
 RDB_STRING_KEY(ds_pool_prop_, owner_group);
 RDB_STRING_KEY(ds_pool_prop_, nhandles);
+RDB_STRING_KEY(ds_pool_prop_, tgt_down);
 
 /** pool handle KVS */
 RDB_STRING_KEY(ds_pool_prop_, handles);
@@ -67,6 +67,7 @@ extern d_iov_t ds_pool_prop_reclaim;		/*  uint64_t */
 extern d_iov_t ds_pool_prop_owner;		/* string */
 extern d_iov_t ds_pool_prop_owner_group;	/* string */
 extern d_iov_t ds_pool_prop_nhandles;	/* uint32_t */
+extern d_iov_t ds_pool_prop_tgt_down;	/* pool_tgt_down[] (optional) */
 
 /** pool handle KVS */
 extern d_iov_t ds_pool_prop_handles;		/* pool handle KVS */
@@ -74,6 +75,17 @@ extern d_iov_t ds_pool_prop_handles;		/* pool handle KVS */
 /** user-defined attributes KVS */
 extern d_iov_t ds_pool_attr_user;		/* pool user attributes KVS */
 
+/**
+ * ds_pool_prop_tgt_down: the map version and the epoch at which a target went
+ * DOWN, kept until the target is UPIN again. Reintegration only has to pull
+ * the data newer than ptd_epoch.
+ */
+struct pool_tgt_down {
+	uint32_t	ptd_id;
+	uint32_t	ptd_ver;
+	uint64_t	ptd_epoch;
+};
+
 /** value of key (handle uuid) in pool handle KVS (RDB_KVS_GENERIC) */
 struct pool_hdl {
 	uint64_t	ph_capas;
@@ -158,6 +158,145 @@ read_map(struct rdb_tx *tx, const rdb_path_t *kvs, struct pool_map **map)
 	return pool_map_create(buf, version, map);
 }
 
+/*
+ * Look up the target DOWN records, see struct pool_tgt_down. "recs" points to
+ * the value in persistent memory, it is valid only within "tx".
+ */
+static int
+locate_tgt_down(struct rdb_tx *tx, const rdb_path_t *kvs,
+		struct pool_tgt_down **recs, unsigned int *nr)
+{
+	d_iov_t	value;
+	int	rc;
+
+	*recs = NULL;
+	*nr = 0;
+	d_iov_set(&value, NULL /* buf */, 0 /* size */);
+	rc = rdb_tx_lookup(tx, kvs, &ds_pool_prop_tgt_down, &value);
+	if (rc == -DER_NONEXIST)
+		return 0;
+	if (rc != 0)
+		return rc;
+
+	*recs = value.iov_buf;
+	*nr = value.iov_len / sizeof(**recs);
+	return 0;
+}
+
+static struct pool_tgt_down *
+tgt_down_find(struct pool_tgt_down *recs, unsigned int nr, uint32_t id)
+{
+	unsigned int	i;
+
+	for (i = 0; i < nr; i++) {
+		if (recs[i].ptd_id == id)
+			return &recs[i];
+	}
+	return NULL;
+}
+
+/*
+ * Return the epoch since which the targets of "tgts" being added to "map"
+ * miss data, or 0 if it isn't known for any of them.
+ */
+static daos_epoch_t
+tgt_down_epoch(struct pool_tgt_down *recs, unsigned int nr,
+	       struct pool_map *map, struct pool_target_id_list *tgts)
+{
+	daos_epoch_t	epoch = DAOS_EPOCH_MAX;
+	int		i;
+
+	for (i = 0; i < tgts->pti_number; i++) {
+		struct pool_tgt_down	*rec;
+		struct pool_target	*tgt;
+
+		if (pool_map_find_target(map, tgts->pti_ids[i].pti_id,
+					 &tgt) <= 0 ||
+		    tgt->ta_comp.co_status == PO_COMP_ST_UPIN)
+			continue;
+
+		rec = tgt_down_find(recs, nr, tgts->pti_ids[i].pti_id);
+		if (rec == NULL)
+			return 0;
+		if (rec->ptd_epoch < epoch)
+			epoch = rec->ptd_epoch;
+	}
+
+	return epoch == DAOS_EPOCH_MAX ? 0 : epoch;
+}
+
+/*
+ * Update the target DOWN records after ds_pool_map_tgts_update() changed
+ * "map" from "version_before": record the version and "epoch" of the targets
+ * which have just gone DOWN, and drop the records of the targets which are
+ * UPIN again. A target going DOWN again before its reintegration is done
+ * keeps its first record, because it still misses the data since then.
+ */
+static int
+update_tgt_down(struct rdb_tx *tx, const rdb_path_t *kvs,
+		struct pool_map *map, uint32_t version_before,
+		daos_epoch_t epoch)
+{
+	struct pool_target	*tgts = pool_map_targets(map);
+	unsigned int		 tgt_nr = pool_map_target_nr(map);
+	struct pool_tgt_down	*old;
+	struct pool_tgt_down	*recs;
+	unsigned int		 old_nr;
+	unsigned int		 nr = 0;
+	bool			 changed = false;
+	d_iov_t			 value;
+	unsigned int		 i;
+	int			 rc;
+
+	rc = locate_tgt_down(tx, kvs, &old, &old_nr);
+	if (rc != 0)
+		return rc;
+
+	D_ALLOC_ARRAY(recs, old_nr + tgt_nr);
+	if (recs == NULL)
+		return -DER_NOMEM;
+
+	for (i = 0; i < old_nr; i++) {
+		struct pool_target *tgt;
+
+		if (pool_map_find_target(map, old[i].ptd_id, &tgt) > 0 &&
+		    tgt->ta_comp.co_status != PO_COMP_ST_UPIN)
+			recs[nr++] = old[i];
+		else
+			changed = true;
+	}
+
+	for (i = 0; i < tgt_nr; i++) {
+		struct pool_component *comp = &tgts[i].ta_comp;
+
+		if (comp->co_status != PO_COMP_ST_DOWN ||
+		    comp->co_fseq <= version_before ||
+		    tgt_down_find(recs, nr, comp->co_id) != NULL)
+			continue;
+
+		D_DEBUG(DF_DSMS, "target %u DOWN at version %u epoch "DF_U64
+			"\n", comp->co_id, comp->co_fseq, epoch);
+		recs[nr].ptd_id = comp->co_id;
+		recs[nr].ptd_ver = comp->co_fseq;
+		recs[nr].ptd_epoch = epoch;
+		nr++;
+		changed = true;
+	}
+
+	if (!changed)
+		D_GOTO(out, rc = 0);
+
+	if (nr == 0) {
+		rc = rdb_tx_delete(tx, kvs, &ds_pool_prop_tgt_down);
+	} else {
+		d_iov_set(&value, recs, nr * sizeof(*recs));
+		rc = rdb_tx_update(tx, kvs, &ds_pool_prop_tgt_down, &value);
+	}
+out:
+	D_FREE(recs);
+	return rc;
+}
+
 /* Store uuid in file path. */
 static int
 uuid_store(const char *path, const uuid_t uuid)
@@ -1060,6 +1199,59 @@ fini_svc_pool(struct pool_svc *svc)
 	svc->ps_pool = NULL;
 }
 
+/*
+ * Reschedule the reintegration of the UP targets, which might not have been
+ * completed by the previous leader.
+ */
+static int
+pool_svc_regenerate_reint(struct pool_svc *svc, d_rank_list_t *replicas)
+{
+	struct pool_map		*map = svc->ps_pool->sp_map;
+	struct pool_target	*tgts = pool_map_targets(map);
+	struct pool_tgt_down	*recs;
+	unsigned int		 nr;
+	struct rdb_tx		 tx;
+	unsigned int		 i;
+	int			 rc;
+
+	rc = rdb_tx_begin(svc->ps_rsvc.s_db, svc->ps_rsvc.s_term, &tx);
+	if (rc != 0)
+		return rc;
+	ABT_rwlock_rdlock(svc->ps_lock);
+	rc = locate_tgt_down(&tx, &svc->ps_root, &recs, &nr);
+	if (rc != 0)
+		goto out;
+
+	for (i = 0; i < pool_map_target_nr(map); i++) {
+		struct pool_target_id		tgt_id;
+		struct pool_target_id_list	id_list;
+		struct pool_tgt_down		*rec;
+
+		if (tgts[i].ta_comp.co_status != PO_COMP_ST_UP)
+			continue;
+
+		tgt_id.pti_id = tgts[i].ta_comp.co_id;
+		id_list.pti_ids = &tgt_id;
+		id_list.pti_number = 1;
+		rec = tgt_down_find(recs, nr, tgt_id.pti_id);
+
+		rc = ds_rebuild_schedule(svc->ps_uuid,
+					 tgts[i].ta_comp.co_fseq, &id_list,
+					 replicas, RB_OP_REINT,
+					 rec == NULL ? 0 : rec->ptd_epoch);
+		if (rc != 0) {
+			D_ERROR(DF_UUID": schedule reint ver %u failed: "
+				DF_RC"\n", DP_UUID(svc->ps_uuid),
+				tgts[i].ta_comp.co_fseq, DP_RC(rc));
+			break;
+		}
+	}
+out:
+	ABT_rwlock_unlock(svc->ps_lock);
+	rdb_tx_end(&tx);
+	return rc;
+}
+
 static int
 pool_svc_step_up_cb(struct ds_rsvc *rsvc)
 {
@@ -1123,6 +1315,10 @@ out_lock:
 	if (rc != 0)
 		goto out;
 
+	rc = pool_svc_regenerate_reint(svc, replicas);
+	if (rc != 0)
+		goto out;
+
 	rc = crt_group_rank(NULL, &rank);
 	D_ASSERTF(rc == 0, ""DF_RC"\n", DP_RC(rc));
 	D_PRINT(DF_UUID": rank %u became pool service leader "DF_U64"\n",
@@ -2216,7 +2412,8 @@ out:
 
 static int
 pool_space_query_bcast(crt_context_t ctx, struct pool_svc *svc, uuid_t pool_hdl,
-		       struct daos_pool_space *ps)
+		       struct daos_pool_space *ps,
+		       struct daos_pool_obj_cache *poc)
 {
 	struct pool_tgt_query_in	*in;
 	struct pool_tgt_query_out	*out;
@@ -2245,8 +2442,9 @@ pool_space_query_bcast(crt_context_t ctx, struct pool_svc *svc, uuid_t pool_hdl,
 			DP_UUID(svc->ps_uuid), DP_RC(rc));
 		rc = -DER_IO;
 	} else {
-		D_ASSERT(ps != NULL);
+		D_ASSERT(ps != NULL && poc != NULL);
 		*ps = out->tqo_space;
+		*poc = out->tqo_obj_cache;
 	}
 
 out_rpc:
@@ -2682,10 +2880,12 @@ out_lock:
 out_svc:
 	ds_rsvc_set_hint(&svc->ps_rsvc, &out->pqo_op.po_hint);
 	/* See comment above, rebuild doesn't connect the pool */
-	if (rc == 0 && (in->pqi_query_bits & DAOS_PO_QUERY_SPACE) &&
+	if (rc == 0 && (in->pqi_query_bits &
+			(DAOS_PO_QUERY_SPACE | DAOS_PO_QUERY_OBJ_CACHE)) &&
 	    !is_rebuild_pool(in->pqi_op.pi_uuid, in->pqi_op.pi_hdl))
 		rc = pool_space_query_bcast(rpc->cr_ctx, svc, in->pqi_op.pi_hdl,
-					    &out->pqo_space);
+					    &out->pqo_space,
+					    &out->pqo_obj_cache);
 	pool_svc_put_leader(svc);
 out:
 	out->pqo_op.po_rc = rc;
@@ -2700,6 +2900,7 @@ process_query_result(daos_pool_info_t *info, uuid_t pool_uuid,
 		     uint32_t map_version, uint32_t leader_rank,
 		     struct daos_pool_space *ps,
 		     struct daos_rebuild_status *rs,
+		     struct daos_pool_obj_cache *poc,
 		     struct pool_buf *map_buf)
 {
 	struct pool_map	       *map;
@@ -2721,7 +2922,7 @@ process_query_result(daos_pool_info_t *info, uuid_t pool_uuid,
 	info->pi_ndisabled = num_disabled;
 
 	pool_query_reply_to_info(pool_uuid, map_buf, map_version, leader_rank,
-				 ps, rs, info);
+				 ps, rs, poc, info);
 
 out:
 	pool_map_decref(map);
@@ -2818,6 +3019,7 @@ realloc:
 					 out->pqo_op.po_hint.sh_rank,
 					 &out->pqo_space,
 					 &out->pqo_rebuild_st,
+					 &out->pqo_obj_cache,
 					 map_buf);
 	if (rc != 0)
 		D_ERROR("Failed to process pool query results, rc=%d\n", rc);
@@ -3466,7 +3668,7 @@ static int
 ds_pool_update_internal(uuid_t pool_uuid, struct pool_target_id_list *tgts,
 			unsigned int opc, uint32_t *map_version_p,
 			struct rsvc_hint *hint, bool *p_updated,
-			d_rank_list_t **replicasp)
+			d_rank_list_t **replicasp, daos_epoch_t *delta_epoch_p)
 {
 	struct pool_svc	       *svc;
 	struct rdb_tx		tx;
@@ -3474,9 +3676,18 @@ ds_pool_update_internal(uuid_t pool_uuid, struct pool_target_id_list *tgts,
 	uint32_t		map_version_before;
 	uint32_t		map_version = 0;
 	struct pool_buf	       *map_buf = NULL;
+	struct pool_tgt_down   *down_recs;
+	unsigned int		down_nr;
+	daos_epoch_t		epoch;
 	bool			updated = false;
 	int			rc;
 
+	/*
+	 * Taken before the map update, so that the DOWN targets miss none of
+	 * the data newer than it.
+	 */
+	epoch = crt_hlc_get();
+
 	rc = pool_svc_lookup_leader(pool_uuid, &svc, hint);
 	if (rc != 0)
 		D_GOTO(out, rc);
@@ -3496,6 +3707,13 @@ ds_pool_update_internal(uuid_t pool_uuid, struct pool_target_id_list *tgts,
 	 * before and after. If the version hasn't changed, we are done.
 	 */
 	map_version_before = pool_map_get_version(map);
+	if (opc == POOL_ADD && delta_epoch_p != NULL) {
+		rc = locate_tgt_down(&tx, &svc->ps_root, &down_recs, &down_nr);
+		if (rc != 0)
+			D_GOTO(out_replicas, rc);
+		*delta_epoch_p = tgt_down_epoch(down_recs, down_nr, map, tgts);
+	}
+
 	rc = ds_pool_map_tgts_update(map, tgts, opc);
 	if (rc != 0)
 		D_GOTO(out_replicas, rc);
@@ -3506,6 +3724,11 @@ ds_pool_update_internal(uuid_t pool_uuid, struct pool_target_id_list *tgts,
 	if (map_version == map_version_before)
 		D_GOTO(out_replicas, rc = 0);
 
+	rc = update_tgt_down(&tx, &svc->ps_root, map, map_version_before,
+			     epoch);
+	if (rc != 0)
+		D_GOTO(out_replicas, rc);
+
 	/* Write the new pool map. */
 	rc = pool_buf_extract(map, &map_buf);
 	if (rc != 0)
@@ -3647,14 +3870,22 @@ int
 ds_pool_tgt_exclude_out(uuid_t pool_uuid, struct pool_target_id_list *list)
 {
 	return ds_pool_update_internal(pool_uuid, list, POOL_EXCLUDE_OUT,
-				       NULL, NULL, NULL, NULL);
+				       NULL, NULL, NULL, NULL, NULL);
 }
 
 int
 ds_pool_tgt_exclude(uuid_t pool_uuid, struct pool_target_id_list *list)
 {
 	return ds_pool_update_internal(pool_uuid, list, POOL_EXCLUDE,
-				       NULL, NULL, NULL, NULL);
+				       NULL, NULL, NULL, NULL, NULL);
+}
+
+/* Mark the UP targets which have got their data back as UPIN. */
+int
+ds_pool_tgt_add_in(uuid_t pool_uuid, struct pool_target_id_list *list)
+{
+	return ds_pool_update_internal(pool_uuid, list, POOL_ADD_IN,
+				       NULL, NULL, NULL, NULL, NULL);
 }
 
 /*
@@ -3670,6 +3901,8 @@ ds_pool_update(uuid_t pool_uuid, crt_opcode_t opc,
 {
 	struct pool_target_id_list	target_list = { 0 };
 	d_rank_list_t			*replicas = NULL;
+	daos_epoch_t			delta_epoch = 0;
+	bool				rebuild = false;
 	bool				updated;
 	int				rc;
 
@@ -3679,29 +3912,44 @@ ds_pool_update(uuid_t pool_uuid, crt_opcode_t opc,
 	if (rc)
 		D_GOTO(out, rc);
 
-	/* Update target by target id */
-	rc = ds_pool_update_internal(pool_uuid, &target_list, opc, map_version,
-				     hint, &updated, &replicas);
-	if (rc)
-		D_GOTO(out, rc);
-
-	if (updated && opc == POOL_EXCLUDE) {
+	if (opc == POOL_EXCLUDE || opc == POOL_ADD) {
 		char	*env;
-		int	 ret;
 
 		env = getenv(REBUILD_ENV);
 		if ((env && !strcasecmp(env, REBUILD_ENV_DISABLED)) ||
 		    daos_fail_check(DAOS_REBUILD_DISABLE)) {
 			D_DEBUG(DB_TRACE, "Rebuild is disabled\n");
+			/* No data to move back, add the targets in directly */
+			if (opc == POOL_ADD)
+				opc = POOL_ADD_IN;
 		} else { /* enabled by default */
-			D_ASSERT(replicas != NULL);
-			ret = ds_rebuild_schedule(pool_uuid, *map_version,
-						  &target_list, replicas);
-			if (ret != 0) {
-				D_ERROR("rebuild fails rc %d\n", ret);
-				if (rc == 0)
-					rc = ret;
-			}
+			rebuild = true;
+		}
+	}
+
+	/* Update target by target id */
+	rc = ds_pool_update_internal(pool_uuid, &target_list, opc, map_version,
+				     hint, &updated, &replicas, &delta_epoch);
+	if (rc)
+		D_GOTO(out, rc);
+
+	if (updated && rebuild) {
+		int	ret;
+
+		D_ASSERT(replicas != NULL);
+		/*
+		 * The reintegrating targets still have all the data up to the
+		 * epoch they went DOWN, only the newer data is pulled.
+		 */
+		ret = ds_rebuild_schedule(pool_uuid, *map_version,
+					  &target_list, replicas,
+					  opc == POOL_ADD ? RB_OP_REINT :
+							    RB_OP_FAIL,
+					  opc == POOL_ADD ? delta_epoch : 0);
+		if (ret != 0) {
+			D_ERROR("rebuild fails rc %d\n", ret);
+			if (rc == 0)
+				rc = ret;
 		}
 	}
 
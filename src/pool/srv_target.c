@@ -86,11 +86,65 @@ ds_pool_child_put(struct ds_pool_child *child)
 			DP_UUID(child->spc_uuid));
 		D_ASSERT(d_list_empty(&child->spc_list));
 		D_ASSERT(d_list_empty(&child->spc_cont_list));
+		if (child->spc_scm_bulk != NULL)
+			crt_bulk_free(child->spc_scm_bulk);
 		vos_pool_close(child->spc_hdl);
 		D_FREE(child);
 	}
 }
 
+/**
+ * Get the bulk handle registering the whole SCM of the vos_pool, so the fetch
+ * of SCM-resident data can be transferred from PMEM directly without creating
+ * bulk handle (registering memory) for each RPC. The handle is created on first
+ * call with the per-xstream CART context and freed along with the child.
+ */
+int
+ds_pool_child_scm_bulk(struct ds_pool_child *child, crt_context_t ctx,
+		       crt_bulk_t *bulk, void **base, daos_size_t *size)
+{
+	d_sg_list_t	sgl;
+	d_iov_t		iov;
+	int		rc;
+
+	if (child->spc_scm_bulk != NULL)
+		goto out;
+
+	if (child->spc_scm_bulk_failed)
+		return -DER_NOSYS;
+
+	rc = vos_pool_scm_map(child->spc_hdl, &child->spc_scm_base,
+			      &child->spc_scm_size);
+	if (rc)
+		goto failed;
+
+	d_iov_set(&iov, child->spc_scm_base, child->spc_scm_size);
+	sgl.sg_nr = 1;
+	sgl.sg_nr_out = 1;
+	sgl.sg_iovs = &iov;
+
+	rc = crt_bulk_create(ctx, &sgl, CRT_BULK_RO, &child->spc_scm_bulk);
+	if (rc) {
+		D_ERROR(DF_UUID": failed to register SCM %p/"DF_U64": "DF_RC
+			"\n", DP_UUID(child->spc_uuid), child->spc_scm_base,
+			child->spc_scm_size, DP_RC(rc));
+		child->spc_scm_bulk = NULL;
+		goto failed;
+	}
+
+	D_DEBUG(DF_DSMS, DF_UUID": registered SCM %p/"DF_U64"\n",
+		DP_UUID(child->spc_uuid), child->spc_scm_base,
+		child->spc_scm_size);
+out:
+	*bulk = child->spc_scm_bulk;
+	*base = child->spc_scm_base;
+	*size = child->spc_scm_size;
+	return 0;
+failed:
+	child->spc_scm_bulk_failed = true;
+	return rc;
+}
+
 void
 ds_pool_child_purge(struct pool_tls *tls)
 {
@@ -590,9 +644,23 @@ aggregate_pool_space(struct daos_pool_space *agg_ps,
 	}
 }
 
+static void
+aggregate_obj_cache(struct daos_pool_obj_cache *agg_poc,
+		    struct daos_pool_obj_cache *poc)
+{
+	agg_poc->poc_hits += poc->poc_hits;
+	agg_poc->poc_misses += poc->poc_misses;
+	agg_poc->poc_evictions += poc->poc_evictions;
+	agg_poc->poc_size += poc->poc_size;
+	agg_poc->poc_cached += poc->poc_cached;
+	agg_poc->poc_resizes += poc->poc_resizes;
+	agg_poc->poc_ntargets += poc->poc_ntargets;
+}
+
 struct pool_query_xs_arg {
-	struct ds_pool		*qxa_pool;
-	struct daos_pool_space	 qxa_space;
+	struct ds_pool			*qxa_pool;
+	struct daos_pool_space		 qxa_space;
+	struct daos_pool_obj_cache	 qxa_obj_cache;
 };
 
 static void
@@ -606,6 +674,7 @@ pool_query_xs_reduce(void *agg_arg, void *xs_arg)
 
 	D_ASSERT(x_arg->qxa_space.ps_ntargets == 1);
 	aggregate_pool_space(&a_arg->qxa_space, &x_arg->qxa_space);
+	aggregate_obj_cache(&a_arg->qxa_obj_cache, &x_arg->qxa_obj_cache);
 }
 
 static int
@@ -640,6 +709,8 @@ pool_query_one(void *vin)
 	struct ds_pool			*pool = x_arg->qxa_pool;
 	struct ds_pool_child		*pool_child;
 	struct daos_pool_space		*x_ps = &x_arg->qxa_space;
+	struct daos_pool_obj_cache	*x_poc = &x_arg->qxa_obj_cache;
+	struct vos_obj_cache_stats	 ocs;
 	vos_pool_info_t			 vos_pool_info = { 0 };
 	int				 rc, i;
 
@@ -665,13 +736,24 @@ pool_query_one(void *vin)
 		x_ps->ps_free_max[i] = x_ps->ps_space.s_free[i];
 		x_ps->ps_free_min[i] = x_ps->ps_space.s_free[i];
 	}
+
+	/* the object cache is per xstream, read it from its own xstream */
+	vos_obj_cache_stats_get(&ocs);
+	x_poc->poc_hits = ocs.ocs_hits;
+	x_poc->poc_misses = ocs.ocs_misses;
+	x_poc->poc_evictions = ocs.ocs_evictions;
+	x_poc->poc_size = ocs.ocs_size;
+	x_poc->poc_cached = ocs.ocs_cached;
+	x_poc->poc_resizes = ocs.ocs_resizes;
+	x_poc->poc_ntargets = 1;
 out:
 	ds_pool_child_put(pool_child);
 	return rc;
 }
 
 static int
-pool_tgt_query(struct ds_pool *pool, struct daos_pool_space *ps)
+pool_tgt_query(struct ds_pool *pool, struct daos_pool_space *ps,
+	       struct daos_pool_obj_cache *poc)
 {
 	struct dss_coll_ops		coll_ops;
 	struct dss_coll_args		coll_args = { 0 };
@@ -680,6 +762,8 @@ pool_tgt_query(struct ds_pool *pool, struct daos_pool_space *ps)
 
 	D_ASSERT(ps != NULL);
 	memset(ps, 0, sizeof(*ps));
+	if (poc != NULL)
+		memset(poc, 0, sizeof(*poc));
 
 	/* collective operations */
 	coll_ops.co_func		= pool_query_one;
@@ -713,6 +797,8 @@ pool_tgt_query(struct ds_pool *pool, struct daos_pool_space *ps)
 	}
 
 	*ps = agg_arg.qxa_space;
+	if (poc != NULL)
+		*poc = agg_arg.qxa_obj_cache;
 	return rc;
 }
 
@@ -778,7 +864,7 @@ ds_pool_tgt_connect_handler(crt_rpc_t *rpc)
 	ds_pool_iv_ns_update(pool, in->tci_master_rank);
 
 	if (in->tci_query_bits & DAOS_PO_QUERY_SPACE)
-		rc = pool_tgt_query(pool, &out->tco_space);
+		rc = pool_tgt_query(pool, &out->tco_space, NULL);
 out:
 	out->tco_rc = (rc == 0 ? 0 : 1);
 	D_DEBUG(DF_DSMS, DF_UUID": replying rpc %p: %d "DF_RC"\n",
@@ -1002,7 +1088,7 @@ ds_pool_tgt_query_handler(crt_rpc_t *rpc)
 		D_GOTO(out, rc = -DER_NONEXIST);
 	}
 
-	rc = pool_tgt_query(pool, &out->tqo_space);
+	rc = pool_tgt_query(pool, &out->tqo_space, &out->tqo_obj_cache);
 
 out:
 	out->tqo_rc = (rc == 0 ? 0 : 1);
@@ -1020,6 +1106,8 @@ ds_pool_tgt_query_aggregator(crt_rpc_t *source, crt_rpc_t *result, void *priv)
 		return 0;
 
 	aggregate_pool_space(&out_result->tqo_space, &out_source->tqo_space);
+	aggregate_obj_cache(&out_result->tqo_obj_cache,
+			    &out_source->tqo_obj_cache);
 	return 0;
 }
 
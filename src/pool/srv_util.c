@@ -264,16 +264,18 @@ ds_pool_map_tgts_update(struct pool_map *map, struct pool_target_id_list *tgts,
 				dom->do_comp.co_fseq = target->ta_comp.co_fseq;
 			}
 		} else if (opc == POOL_ADD &&
-			 target->ta_comp.co_status != PO_COMP_ST_UP &&
 			 target->ta_comp.co_status != PO_COMP_ST_UPIN) {
 			/**
-			 * XXX this is only temporarily used for recovering
-			 * the DOWNOUT target back to UP after rebuild test,
-			 * so we do not update co_ver for now, otherwise the
+			 * XXX we do not update co_ver for now, otherwise the
 			 * object layout might be changed, so the ring shuffle
 			 * is based on target version. Once this is used
 			 * for reintegrate new target, co_ver should be
 			 * updated.
+			 *
+			 * The target stays UP, i.e. not serving I/O, until
+			 * the reintegration moved its data back, co_fseq is
+			 * the version of the reintegration. Adding an UP
+			 * target again retries its reintegration.
 			 */
 			D_DEBUG(DF_DSMS, "change target %u/%u to UP %p\n",
 				target->ta_comp.co_rank,
@@ -281,6 +283,17 @@ ds_pool_map_tgts_update(struct pool_map *map, struct pool_target_id_list *tgts,
 			D_PRINT("Target (rank %u idx %u) is added.\n",
 				target->ta_comp.co_rank,
 				target->ta_comp.co_index);
+			target->ta_comp.co_status = PO_COMP_ST_UP;
+			target->ta_comp.co_fseq = ++version;
+			dom->do_comp.co_status = PO_COMP_ST_UPIN;
+		} else if (opc == POOL_ADD_IN &&
+			 target->ta_comp.co_status != PO_COMP_ST_UPIN) {
+			D_DEBUG(DF_DSMS, "change target %u/%u to UPIN %p\n",
+				target->ta_comp.co_rank,
+				target->ta_comp.co_index, map);
+			D_PRINT("Target (rank %u idx %u) is reintegrated.\n",
+				target->ta_comp.co_rank,
+				target->ta_comp.co_index);
 			target->ta_comp.co_status = PO_COMP_ST_UPIN;
 			target->ta_comp.co_fseq = 1;
 			version++;
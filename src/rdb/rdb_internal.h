@@ -71,15 +71,26 @@ struct rdb {
 	d_rank_list_t	       *d_replicas;
 	uint64_t		d_applied;	/* last applied index */
 	uint64_t		d_debut;	/* first entry in a term */
+	uint64_t		d_lease_term;	/* of d_lease_expiry */
+	double			d_lease_expiry;	/* leader lease end (s) */
+	double			d_lease_dur;	/* leader lease duration (s) */
 	ABT_cond		d_applied_cv;	/* for d_applied updates */
 	struct d_hash_table	d_results;	/* rdb_raft_result hash */
 	d_list_t		d_requests;	/* RPCs waiting for replies */
+	int			d_ae_window;	/* max AEs in flight per node */
 	d_list_t		d_replies;	/* RPCs received replies */
 	ABT_cond		d_replies_cv;	/* for d_replies enqueues */
 	struct rdb_raft_event	d_events[2];	/* rdb_raft_events queue */
 	int			d_nevents;	/* d_events queue len from 0 */
 	ABT_cond		d_events_cv;	/* for d_events enqueues */
 	uint64_t		d_compact_thres;/* of compactable entries */
+	uint64_t		d_lc_batch_max;	/* of entries per LC flush */
+	double			d_lc_batch_lat;	/* max proposal wait (s) */
+	d_list_t		d_proposals;	/* rdb_raft_proposal queue */
+	uint64_t		d_nproposals;	/* d_proposals queue len */
+	bool			d_proposing;	/* collecting d_proposals */
+	struct rdb_raft_proposal *d_proposal;	/* being appended in a batch */
+	ABT_cond		d_proposals_cv;	/* for batch completions */
 	ABT_cond		d_compact_cv;	/* for base updates */
 	bool			d_stop;		/* for rdb_stop() */
 	ABT_thread		d_timerd;
@@ -134,6 +145,9 @@ struct rdb_raft_node {
 	/* Leader fields */
 	uint64_t		dn_term;	/* of leader */
 	struct rdb_raft_is	dn_is;
+	uint64_t		dn_ae_term;	/* of dn_ae_sent */
+	uint64_t		dn_ae_sent;	/* last index in flight */
+	int			dn_ae_inflight;	/* number of AEs in flight */
 };
 
 int rdb_raft_init(daos_handle_t pool, daos_handle_t mc,
@@ -161,6 +161,44 @@ rdb_raft_clone_ae(const msg_appendentries_t *ae, msg_appendentries_t *ae_new)
 	return 0;
 }
 
+/*
+ * Raft always builds an AE from the next index of the node, which it only
+ * advances upon successful AE responses. When pipelining, i.e.,
+ * db->d_ae_window > 1, skip the entries that are already in flight to the node
+ * by trimming msg into ae. Return false if msg shall not be sent at all,
+ * because all its entries are already in flight or because the window of the
+ * node is full; a reply to the in-flight AEs will make raft send the rest.
+ */
+static bool
+rdb_raft_trim_ae(struct rdb *db, struct rdb_raft_node *rdb_node,
+		 msg_appendentries_t *msg, msg_appendentries_t *ae)
+{
+	uint64_t	last = msg->prev_log_idx + msg->n_entries;
+	int		skip;
+
+	*ae = *msg;
+	if (db->d_ae_window <= 1 || msg->n_entries == 0)
+		return true;
+
+	if (rdb_node->dn_ae_term != msg->term) {
+		rdb_node->dn_ae_term = msg->term;
+		rdb_node->dn_ae_sent = 0;
+	}
+	if (rdb_node->dn_ae_inflight == 0 ||
+	    rdb_node->dn_ae_sent <= msg->prev_log_idx)
+		return true;
+	if (rdb_node->dn_ae_sent >= last ||
+	    rdb_node->dn_ae_inflight >= db->d_ae_window)
+		return false;
+
+	skip = rdb_node->dn_ae_sent - msg->prev_log_idx;
+	ae->prev_log_idx = rdb_node->dn_ae_sent;
+	ae->prev_log_term = msg->entries[skip - 1].term;
+	ae->entries = &msg->entries[skip];
+	ae->n_entries = msg->n_entries - skip;
+	return true;
+}
+
 static int
 rdb_raft_cb_send_appendentries(raft_server_t *raft, void *arg,
 			       raft_node_t *node, msg_appendentries_t *msg)
@@ -169,6 +207,7 @@ rdb_raft_cb_send_appendentries(raft_server_t *raft, void *arg,
 	struct rdb_raft_node	       *rdb_node = raft_node_get_udata(node);
 	crt_rpc_t		       *rpc;
 	struct rdb_appendentries_in    *in;
+	msg_appendentries_t		ae;
 	int				rc;
 
 	D_ASSERT(db->d_raft == raft);
@@ -179,6 +218,21 @@ rdb_raft_cb_send_appendentries(raft_server_t *raft, void *arg,
 	if (DAOS_FAIL_CHECK(DAOS_RDB_SKIP_APPENDENTRIES_FAIL))
 		D_GOTO(err, rc = 0);
 
+	/*
+	 * Hold the AE until the batch being appended is durable, so that no
+	 * follower acknowledges an entry that the leader may still lose. See
+	 * rdb_raft_release_ae().
+	 */
+	if (db->d_proposal != NULL)
+		return 0;
+
+	if (!rdb_raft_trim_ae(db, rdb_node, msg, &ae)) {
+		D_DEBUG(DB_TRACE, DF_DB": ae to rank %u in flight: sent="DF_U64
+			" inflight=%d\n", DP_DB(db), rdb_node->dn_rank,
+			rdb_node->dn_ae_sent, rdb_node->dn_ae_inflight);
+		return 0;
+	}
+
 	rc = rdb_create_raft_rpc(RDB_APPENDENTRIES, node, &rpc);
 	if (rc != 0) {
 		D_ERROR(DF_DB": failed to create AE RPC to node %d: %d\n",
@@ -187,7 +241,7 @@ rdb_raft_cb_send_appendentries(raft_server_t *raft, void *arg,
 	}
 	in = crt_req_get(rpc);
 	uuid_copy(in->aei_op.ri_uuid, db->d_uuid);
-	rc = rdb_raft_clone_ae(msg, &in->aei_msg);
+	rc = rdb_raft_clone_ae(&ae, &in->aei_msg);
 	if (rc != 0) {
 		D_ERROR(DF_DB": failed to allocate entry array\n", DP_DB(db));
 		D_GOTO(err_rpc, rc);
@@ -199,6 +253,11 @@ rdb_raft_cb_send_appendentries(raft_server_t *raft, void *arg,
 			DP_DB(db), raft_node_get_id(node), rc);
 		D_GOTO(err_in, rc);
 	}
+	/* Released by rdb_raft_free_request(). */
+	rdb_node->dn_ae_inflight++;
+	if (ae.n_entries > 0 &&
+	    ae.prev_log_idx + ae.n_entries > rdb_node->dn_ae_sent)
+		rdb_node->dn_ae_sent = ae.prev_log_idx + ae.n_entries;
 	return 0;
 
 err_in:
@@ -1107,11 +1166,17 @@ rdb_raft_update_node(struct rdb *db, uint64_t index, raft_entry_t *entry)
 	return rc;
 }
 
+/*
+ * Apply and persist entry at index, and advance the volatile log tail. The
+ * persistent log tail is left untouched; the caller must group-commit it with
+ * rdb_raft_log_flush(). Return in *buf the persistent memory address of the
+ * entry data, which shall replace entry->data.buf once the entry is durable.
+ * This function tries to discard index if an error occurs.
+ */
 static int
-rdb_raft_log_offer_single(raft_server_t *raft, void *arg,
-			  raft_entry_t *entry, uint64_t index)
+rdb_raft_log_append(struct rdb *db, raft_entry_t *entry, uint64_t index,
+		    void **buf)
 {
-	struct rdb	       *db = arg;
 	d_iov_t		keys[2];
 	d_iov_t		values[2];
 	struct rdb_entry	header;
@@ -1164,7 +1229,7 @@ rdb_raft_log_offer_single(raft_server_t *raft, void *arg,
 		goto err_discard;
 	}
 
-	/* Replace entry->data.buf with the data's persistent memory address. */
+	/* Look up the data's persistent memory address. */
 	if (entry->data.len > 0) {
 		d_iov_set(&values[0], NULL, entry->data.len);
 		rc = rdb_lc_lookup(db->d_lc, index, RDB_LC_ATTRS,
@@ -1174,26 +1239,21 @@ rdb_raft_log_offer_single(raft_server_t *raft, void *arg,
 				" data: %d\n", DP_DB(db), index, rc);
 			goto err_discard;
 		}
-		entry->data.buf = values[0].iov_buf;
+		*buf = values[0].iov_buf;
 	} else {
-		entry->data.buf = NULL;
+		*buf = NULL;
 	}
 
-	/* Update the log tail. See the log tail assertion above. */
+	/*
+	 * Update the volatile log tail. See the log tail assertion above. The
+	 * entry becomes durable only after rdb_raft_log_flush() persists the
+	 * log tail; until then, rdb_raft_load_lc() discards it on restart.
+	 */
 	db->d_lc_record.dlr_tail++;
-	d_iov_set(&values[0], &db->d_lc_record, sizeof(db->d_lc_record));
-	rc = rdb_mc_update(db->d_mc, RDB_MC_ATTRS, 1 /* n */, &rdb_mc_lc,
-			   &values[0]);
-	if (rc != 0) {
-		D_ERROR(DF_DB": failed to update log tail "DF_U64": %d\n",
-			DP_DB(db), db->d_lc_record.dlr_tail, rc);
-		db->d_lc_record.dlr_tail--;
-		goto err_discard;
-	}
 
 	D_DEBUG(DB_TRACE, DF_DB": appended entry "DF_U64": term=%d type=%d "
 		"buf=%p len=%u\n", DP_DB(db), index, entry->term, entry->type,
-		entry->data.buf, entry->data.len);
+		*buf, entry->data.len);
 	return 0;
 
 err_discard:
@@ -1204,23 +1264,184 @@ err_discard:
 	return rc;
 }
 
+/*
+ * Persist the volatile log tail, making all entries appended by
+ * rdb_raft_log_append() since the previous persistent log tail, tail, durable
+ * with a single metadata container update. If an error occurs, revert the
+ * volatile log tail to tail and try to discard the entries beyond it.
+ */
 static int
-rdb_raft_cb_log_offer(raft_server_t *raft, void *arg, raft_entry_t *entries,
-		      int index, int *n_entries)
+rdb_raft_log_flush(struct rdb *db, uint64_t tail)
 {
-	int i;
-	int rc = 0;
+	d_iov_t	value;
+	int	rc;
+	int	rc_tmp;
+
+	D_ASSERTF(tail <= db->d_lc_record.dlr_tail, DF_U64" <= "DF_U64"\n",
+		  tail, db->d_lc_record.dlr_tail);
+	if (tail == db->d_lc_record.dlr_tail)
+		return 0;
+
+	d_iov_set(&value, &db->d_lc_record, sizeof(db->d_lc_record));
+	rc = rdb_mc_update(db->d_mc, RDB_MC_ATTRS, 1 /* n */, &rdb_mc_lc,
+			   &value);
+	if (rc != 0) {
+		D_ERROR(DF_DB": failed to update log tail "DF_U64": %d\n",
+			DP_DB(db), db->d_lc_record.dlr_tail, rc);
+		rc_tmp = rdb_lc_discard(db->d_lc, tail,
+					db->d_lc_record.dlr_tail - 1);
+		if (rc_tmp != 0)
+			D_ERROR(DF_DB": failed to discard entries "DF_U64"-"
+				DF_U64": %d\n", DP_DB(db), tail,
+				db->d_lc_record.dlr_tail - 1, rc_tmp);
+		db->d_lc_record.dlr_tail = tail;
+		return rc;
+	}
 
-	for (i = 0; i < *n_entries; ++i) {
-		rc = rdb_raft_log_offer_single(raft, arg, &entries[i],
-					       index + i);
+	D_DEBUG(DB_TRACE, DF_DB": flushed entries "DF_U64"-"DF_U64"\n",
+		DP_DB(db), tail, db->d_lc_record.dlr_tail - 1);
+	return 0;
+}
+
+/* An entry proposed to the leader */
+struct rdb_raft_proposal {
+	d_list_t		drp_entry;	/* in d_proposals */
+	msg_entry_t	       *drp_mentry;
+	void		       *drp_result;	/* of the entry */
+	msg_entry_response_t	drp_response;
+	void		       *drp_buf;	/* persistent entry data */
+	bool			drp_appended;	/* to the LC */
+	int			drp_rc;
+	bool			drp_done;	/* batch finished */
+};
+
+/*
+ * Revert the volatile log tail to tail after the transaction appending the
+ * entries beyond it has aborted. Also empty the rdb_kvs cache, which may hold
+ * rdb_kvs objects corresponding to KVSs created by those entries.
+ */
+static void
+rdb_raft_log_revert(struct rdb *db, uint64_t tail)
+{
+	db->d_lc_record.dlr_tail = tail;
+	rdb_kvs_cache_evict(db->d_kvss);
+}
+
+/* Append entry at index, and persist it with its own log tail update. */
+static int
+rdb_raft_log_append_one(struct rdb *db, raft_entry_t *entry, uint64_t index)
+{
+	uint64_t	tail = db->d_lc_record.dlr_tail;
+	void	       *buf;
+	int		rc;
+
+	rc = rdb_raft_log_append(db, entry, index, &buf);
+	if (rc != 0)
+		return rc;
+	rc = rdb_raft_log_flush(db, tail);
+	if (rc != 0)
+		return rc;
+	entry->data.buf = buf;
+	return 0;
+}
+
+/*
+ * Append entries[0, n) at index, persisting them and the new log tail in one
+ * PMDK transaction. Either all or none of the entries are appended.
+ */
+static int
+rdb_raft_log_append_batch(struct rdb *db, raft_entry_t *entries,
+			  uint64_t index, int n)
+{
+	uint64_t	tail = db->d_lc_record.dlr_tail;
+	void	      **bufs;
+	int		i;
+	int		rc;
+
+	D_ALLOC_ARRAY(bufs, n);
+	if (bufs == NULL)
+		return -DER_NOMEM;
+
+	rc = vos_pool_tx_begin(db->d_pool);
+	if (rc != 0) {
+		D_ERROR(DF_DB": failed to begin tx: %d\n", DP_DB(db), rc);
+		goto out;
+	}
+	for (i = 0; i < n; i++) {
+		rc = rdb_raft_log_append(db, &entries[i], index + i, &bufs[i]);
 		if (rc != 0)
 			break;
 	}
-	*n_entries = i;
+	if (rc == 0)
+		rc = rdb_raft_log_flush(db, tail);
+	rc = vos_pool_tx_end(db->d_pool, rc);
+	if (rc != 0) {
+		D_ERROR(DF_DB": failed to append entries "DF_U64"-"DF_U64
+			": %d\n", DP_DB(db), index, index + n - 1, rc);
+		rdb_raft_log_revert(db, tail);
+		goto out;
+	}
+
+	for (i = 0; i < n; i++)
+		entries[i].data.buf = bufs[i];
+out:
+	D_FREE(bufs);
 	return rc;
 }
 
+/*
+ * Append the offered entries, group-committing up to db->d_lc_batch_max of
+ * them in one PMDK transaction with one log tail update. A configuration
+ * change entry, whose effects on the volatile replica list are not revertible
+ * by a transaction abort, is appended on its own. If a batch fails, retry its
+ * entries one by one, so that an entry failing deterministically does not
+ * take the others with it.
+ */
+static int
+rdb_raft_cb_log_offer(raft_server_t *raft, void *arg, raft_entry_t *entries,
+		      int index, int *n_entries)
+{
+	struct rdb     *db = arg;
+	int		b;	/* first entry of the batch */
+	int		n;	/* number of entries in the batch */
+	int		i;
+	int		rc;
+
+	/* The batch is persisted by rdb_raft_propose_batch(). */
+	if (db->d_proposal != NULL) {
+		D_ASSERTF(*n_entries == 1, "%d\n", *n_entries);
+		rc = rdb_raft_log_append(db, &entries[0], index,
+					 &db->d_proposal->drp_buf);
+		if (rc != 0)
+			*n_entries = 0;
+		else
+			db->d_proposal->drp_appended = true;
+		return rc;
+	}
+
+	for (b = 0; b < *n_entries; b += n) {
+		n = 1;
+		if (!raft_entry_is_cfg_change(&entries[b])) {
+			while (b + n < *n_entries && n < db->d_lc_batch_max &&
+			       !raft_entry_is_cfg_change(&entries[b + n]))
+				n++;
+			rc = rdb_raft_log_append_batch(db, &entries[b],
+						       index + b, n);
+			if (rc == 0)
+				continue;
+		}
+		for (i = b; i < b + n; i++) {
+			rc = rdb_raft_log_append_one(db, &entries[i],
+						     index + i);
+			if (rc != 0) {
+				*n_entries = i;
+				return rc;
+			}
+		}
+	}
+	return 0;
+}
+
 static int
 rdb_raft_cb_log_poll(raft_server_t *raft, void *arg, raft_entry_t *entries,
 		     int index, int *n_entries)
@@ -1647,6 +1868,7 @@ rdb_raft_step_down(struct rdb *db, uint64_t term)
 	D_WARN(DF_DB": no longer leader of term "DF_U64"\n", DP_DB(db),
 	       term);
 	db->d_debut = 0;
+	db->d_lease_expiry = 0;
 	rdb_raft_queue_event(db, RDB_RAFT_STEP_DOWN, term);
 }
 
@@ -1814,46 +2036,329 @@ rdb_raft_unregister_result(struct rdb *db, uint64_t index)
 	D_FREE(result);
 }
 
-/* Append and wait for \a entry to be applied. */
+/*
+ * Is the leader lease still valid? A lease is taken whenever an entry of the
+ * current term is committed, starting from before the entry was appended, so
+ * a majority has heard from this leader after the start of the lease. raft
+ * followers refuse to vote for other candidates until an election timeout
+ * has elapsed since they last heard from the leader. Since db->d_lease_dur is
+ * bounded by half the election timeout, no other leader can have been elected
+ * while the lease is valid.
+ */
+static bool
+rdb_raft_lease_valid(struct rdb *db)
+{
+	return db->d_lease_dur > 0 && raft_is_leader(db->d_raft) &&
+	       db->d_lease_term == raft_get_current_term(db->d_raft) &&
+	       ABT_get_wtime() < db->d_lease_expiry;
+}
+
+/*
+ * Renew the leader lease after an entry appended at \a start in \a term has
+ * been committed, unless the term has changed in the meantime.
+ */
+static void
+rdb_raft_lease_renew(struct rdb *db, uint64_t term, double start)
+{
+	if (db->d_lease_dur <= 0 || raft_get_current_term(db->d_raft) != term)
+		return;
+	if (db->d_lease_term != term || start + db->d_lease_dur >
+					db->d_lease_expiry) {
+		db->d_lease_term = term;
+		db->d_lease_expiry = start + db->d_lease_dur;
+	}
+}
+
+/*
+ * Raft sends a new entry only to the nodes that have no entries outstanding.
+ * When pipelining, also send it to the nodes that have fewer than
+ * db->d_ae_window AEs in flight, instead of waiting for their replies.
+ */
+static void
+rdb_raft_pipeline_ae(struct rdb *db)
+{
+	d_rank_t	self;
+	int		i;
+	int		rc;
+
+	if (db->d_ae_window <= 1)
+		return;
+
+	rc = crt_group_rank(NULL, &self);
+	D_ASSERTF(rc == 0, ""DF_RC"\n", DP_RC(rc));
+	for (i = 0; i < db->d_replicas->rl_nr; i++) {
+		d_rank_t		rank = db->d_replicas->rl_ranks[i];
+		raft_node_t	       *node;
+		struct rdb_raft_node   *rdb_node;
+
+		if (rank == self)
+			continue;
+		node = raft_get_node(db->d_raft, rank);
+		if (node == NULL)
+			continue;
+		rdb_node = raft_node_get_udata(node);
+		if (rdb_node->dn_ae_inflight == 0 ||
+		    rdb_node->dn_ae_inflight >= db->d_ae_window)
+			continue;
+		/* Leave nodes that need a snapshot to raft. */
+		if (raft_node_get_next_idx(node) <= db->d_lc_record.dlr_base)
+			continue;
+		rc = raft_send_appendentries(db->d_raft, node);
+		if (rc != 0)
+			D_DEBUG(DB_TRACE, DF_DB": failed to pipeline ae to rank "
+				"%u: %d\n", DP_DB(db), rank, rc);
+	}
+}
+
+/*
+ * Append the entry of p to the raft log. Do not yield before calling
+ * raft_recv_entry(), so that the index assertion below will hold.
+ */
 static int
-rdb_raft_append_apply_internal(struct rdb *db, msg_entry_t *mentry,
-			       void *result)
+rdb_raft_propose(struct rdb *db, struct rdb_raft_proposal *p)
 {
-	msg_entry_response_t	mresponse;
 	struct rdb_raft_state	state;
 	uint64_t		index;
 	int			rc;
 
-	/*
-	 * Do not yield before calling rdb_recv_entry(), so that the index
-	 * assertion below will hold.
-	 */
 	index = raft_get_current_idx(db->d_raft) + 1;
-	if (result != NULL) {
-		rc = rdb_raft_register_result(db, index, result);
+	if (p->drp_result != NULL) {
+		rc = rdb_raft_register_result(db, index, p->drp_result);
 		if (rc != 0)
 			goto out;
 	}
 
 	rdb_raft_save_state(db, &state);
-	rc = raft_recv_entry(db->d_raft, mentry, &mresponse);
+	rc = raft_recv_entry(db->d_raft, p->drp_mentry, &p->drp_response);
 	rc = rdb_raft_check_state(db, &state, rc);
 	if (rc != 0) {
 		if (rc != -DER_NOTLEADER)
 			D_ERROR(DF_DB": failed to append entry: %d\n",
 				DP_DB(db), rc);
-		goto out_result;
+		if (p->drp_result != NULL)
+			rdb_raft_unregister_result(db, index);
+		goto out;
 	}
 
 	/* The actual index must match the expected index. */
-	D_ASSERTF(mresponse.idx == index, "%d == "DF_U64"\n", mresponse.idx,
-		  index);
-	rc = rdb_raft_wait_applied(db, mresponse.idx, mresponse.term);
+	D_ASSERTF(p->drp_response.idx == index, "%d == "DF_U64"\n",
+		  p->drp_response.idx, index);
+out:
+	p->drp_rc = rc;
+	return rc;
+}
+
+/*
+ * Send the AEs held back while the batch starting at index first was being
+ * appended, to the nodes that raft_recv_entry() would have sent them to, i.e.,
+ * those that were up to date.
+ */
+static void
+rdb_raft_release_ae(struct rdb *db, uint64_t first)
+{
+	d_rank_t	self;
+	int		i;
+	int		rc;
+
+	rc = crt_group_rank(NULL, &self);
+	D_ASSERTF(rc == 0, ""DF_RC"\n", DP_RC(rc));
+	for (i = 0; i < db->d_replicas->rl_nr; i++) {
+		d_rank_t	rank = db->d_replicas->rl_ranks[i];
+		raft_node_t    *node;
+
+		if (rank == self)
+			continue;
+		node = raft_get_node(db->d_raft, rank);
+		if (node == NULL || raft_node_get_next_idx(node) < first)
+			continue;
+		rc = raft_send_appendentries(db->d_raft, node);
+		if (rc != 0)
+			D_DEBUG(DB_TRACE, DF_DB": failed to send ae to rank "
+				"%u: %d\n", DP_DB(db), rank, rc);
+	}
+}
+
+/*
+ * The transaction appending the batch starting at index first has aborted,
+ * but raft has accepted the entries up to its current index. Append them
+ * again, one by one, from the proposers' buffers, which raft still refers to.
+ * If that fails too, the raft log has diverged from the LC; step down and stop
+ * the replica.
+ */
+static void
+rdb_raft_replay_batch(struct rdb *db, d_list_t *batch, uint64_t first)
+{
+	struct rdb_raft_proposal       *p;
+	struct rdb_raft_state		state;
+	raft_entry_t		       *entry;
+	uint64_t			index;
+	int				rc = 0;
+
+	for (index = first; index <= raft_get_current_idx(db->d_raft);
+	     index++) {
+		entry = raft_get_entry_from_idx(db->d_raft, index);
+		D_ASSERT(entry != NULL);
+		rc = rdb_raft_log_append_one(db, entry, index);
+		if (rc != 0)
+			break;
+	}
+	if (rc == 0)
+		return;
+
+	D_ERROR(DF_DB": failed to replay entry "DF_U64": %d\n", DP_DB(db),
+		index, rc);
+	d_list_for_each_entry(p, batch, drp_entry) {
+		if (p->drp_rc != 0 || p->drp_response.idx < index)
+			continue;
+		p->drp_rc = rc;
+		if (p->drp_result != NULL)
+			rdb_raft_unregister_result(db, p->drp_response.idx);
+	}
+	rdb_raft_save_state(db, &state);
+	raft_become_follower(db->d_raft);
+	rdb_raft_check_state(db, &state, 0 /* raft_rc */);
+	db->d_cbs->dc_stop(db, rc, db->d_arg);
+}
+
+/*
+ * Append the proposals in batch, persisting their entries and the new log
+ * tail in one PMDK transaction. Must not yield.
+ */
+static void
+rdb_raft_propose_batch(struct rdb *db, d_list_t *batch)
+{
+	struct rdb_raft_proposal       *p;
+	uint64_t			tail = db->d_lc_record.dlr_tail;
+	uint64_t			first;
+	raft_entry_t		       *entry;
+	int				rc;
+
+	rc = vos_pool_tx_begin(db->d_pool);
+	if (rc != 0) {
+		D_ERROR(DF_DB": failed to begin tx: %d\n", DP_DB(db), rc);
+		d_list_for_each_entry(p, batch, drp_entry)
+			p->drp_rc = rc;
+		return;
+	}
+
+	first = raft_get_current_idx(db->d_raft) + 1;
+	rc = 0;
+	d_list_for_each_entry(p, batch, drp_entry) {
+		/* Once an entry fails, fail the rest. */
+		if (rc != 0) {
+			p->drp_rc = rc;
+			continue;
+		}
+		db->d_proposal = p;
+		rc = rdb_raft_propose(db, p);
+		db->d_proposal = NULL;
+	}
+
+	/*
+	 * A failure other than -DER_NOTLEADER, which raft_recv_entry() returns
+	 * before touching the log, may have aborted the transaction already.
+	 */
+	if (rc == 0 || rc == -DER_NOTLEADER)
+		rc = rdb_raft_log_flush(db, tail);
+	rc = vos_pool_tx_end(db->d_pool, rc);
+	if (rc != 0) {
+		D_ERROR(DF_DB": failed to append entries "DF_U64"-"DF_U64
+			": %d\n", DP_DB(db), tail, db->d_lc_record.dlr_tail - 1,
+			rc);
+		rdb_raft_log_revert(db, tail);
+		rdb_raft_replay_batch(db, batch, first);
+	} else {
+		d_list_for_each_entry(p, batch, drp_entry) {
+			if (!p->drp_appended)
+				continue;
+			entry = raft_get_entry_from_idx(db->d_raft,
+							p->drp_response.idx);
+			D_ASSERT(entry != NULL);
+			entry->data.buf = p->drp_buf;
+		}
+	}
+
+	if (raft_is_leader(db->d_raft))
+		rdb_raft_release_ae(db, first);
+}
+
+/*
+ * Group-commit the entry of p with the entries proposed concurrently. The
+ * first proposer of a batch collects the batch by yielding for up to
+ * db->d_lc_batch_lat seconds, or until db->d_lc_batch_max proposals have been
+ * queued, and then appends it. The other proposers of the batch wait for it.
+ */
+static void
+rdb_raft_propose_group(struct rdb *db, struct rdb_raft_proposal *p)
+{
+	struct rdb_raft_proposal       *q;
+	d_list_t			batch;
+	double				deadline;
+
+	/* If the batch being collected is full, wait for the next one. */
+	while (db->d_proposing && db->d_nproposals >= db->d_lc_batch_max)
+		ABT_thread_yield();
+
+	d_list_add_tail(&p->drp_entry, &db->d_proposals);
+	db->d_nproposals++;
+	if (db->d_proposing) {
+		ABT_mutex_lock(db->d_mutex);
+		while (!p->drp_done)
+			ABT_cond_wait(db->d_proposals_cv, db->d_mutex);
+		ABT_mutex_unlock(db->d_mutex);
+		return;
+	}
+
+	db->d_proposing = true;
+	deadline = ABT_get_wtime() + db->d_lc_batch_lat;
+	do {
+		/* Let the runnable proposers queue their entries. */
+		ABT_thread_yield();
+	} while (db->d_nproposals < db->d_lc_batch_max && !db->d_stop &&
+		 ABT_get_wtime() < deadline);
+	D_INIT_LIST_HEAD(&batch);
+	d_list_splice_init(&db->d_proposals, &batch);
+	db->d_nproposals = 0;
+	db->d_proposing = false;
+
+	rdb_raft_propose_batch(db, &batch);
+
+	ABT_mutex_lock(db->d_mutex);
+	d_list_for_each_entry(q, &batch, drp_entry)
+		q->drp_done = true;
+	ABT_cond_broadcast(db->d_proposals_cv);
+	ABT_mutex_unlock(db->d_mutex);
+}
+
+/* Append and wait for \a entry to be applied. */
+static int
+rdb_raft_append_apply_internal(struct rdb *db, msg_entry_t *mentry,
+			       void *result)
+{
+	struct rdb_raft_proposal	p = {};
+	double				start = ABT_get_wtime();
+	int				rc;
+
+	p.drp_mentry = mentry;
+	p.drp_result = result;
+	/* Configuration changes are not revertible; append them alone. */
+	if (mentry->type == RAFT_LOGTYPE_NORMAL && db->d_lc_batch_max > 1)
+		rdb_raft_propose_group(db, &p);
+	else
+		rdb_raft_propose(db, &p);
+	rc = p.drp_rc;
+	if (rc != 0)
+		goto out;
+
+	rdb_raft_pipeline_ae(db);
+	rc = rdb_raft_wait_applied(db, p.drp_response.idx,
+				   p.drp_response.term);
+	if (rc == 0)
+		rdb_raft_lease_renew(db, p.drp_response.term, start);
 	raft_apply_all(db->d_raft);
 
-out_result:
 	if (result != NULL)
-		rdb_raft_unregister_result(db, index);
+		rdb_raft_unregister_result(db, p.drp_response.idx);
 out:
 	return rc;
 }
@@ -1903,9 +2408,12 @@ rdb_raft_append_apply(struct rdb *db, void *entry, size_t size, void *result)
 int
 rdb_raft_verify_leadership(struct rdb *db)
 {
+	/* Answer locally while the leader lease is valid. */
+	if (rdb_raft_lease_valid(db))
+		return 0;
 	/*
 	 * raft does not provide this functionality yet; append an empty entry
-	 * as a (slower) workaround.
+	 * as a (slower) workaround, which also renews the lease.
 	 */
 	return rdb_raft_append_apply(db, NULL /* entry */, 0 /* size */,
 				     NULL /* result */);
@@ -2281,6 +2789,51 @@ rdb_raft_get_compact_thres(void)
 	return i;
 }
 
+static uint64_t
+rdb_raft_get_lc_batch_max(void)
+{
+	unsigned int i = 64;
+
+	d_getenv_int("RDB_LOG_BATCH_MAX", &i);
+	if (i == 0)
+		i = 1;
+	return i;
+}
+
+/* Return the max time a leader waits for a batch of proposals in seconds. */
+static double
+rdb_raft_get_lc_batch_lat(void)
+{
+	unsigned int i = 0;	/* us */
+
+	d_getenv_int("RDB_LOG_BATCH_LATENCY", &i);
+	return (double)i / 1000000;
+}
+
+/* Return the leader lease duration in seconds, given election_timeout in ms. */
+static double
+rdb_raft_get_lease_dur(int election_timeout)
+{
+	unsigned int	max = election_timeout > 0 ? election_timeout / 2 : 0;
+	unsigned int	i = max;
+
+	d_getenv_int("RDB_LEASE_TIMEOUT", &i);
+	if (i > max)
+		i = max;
+	return (double)i / 1000;
+}
+
+static int
+rdb_raft_get_ae_window(void)
+{
+	unsigned int i = 4;
+
+	d_getenv_int("RDB_AE_WINDOW", &i);
+	if (i == 0)
+		i = 1;
+	return i;
+}
+
 int
 rdb_raft_start(struct rdb *db)
 {
@@ -2293,7 +2846,11 @@ rdb_raft_start(struct rdb *db)
 
 	D_INIT_LIST_HEAD(&db->d_requests);
 	D_INIT_LIST_HEAD(&db->d_replies);
+	D_INIT_LIST_HEAD(&db->d_proposals);
 	db->d_compact_thres = rdb_raft_get_compact_thres();
+	db->d_lc_batch_max = rdb_raft_get_lc_batch_max();
+	db->d_lc_batch_lat = rdb_raft_get_lc_batch_lat();
+	db->d_ae_window = rdb_raft_get_ae_window();
 
 	rc = d_hash_table_create_inplace(D_HASH_FT_NOLOCK, 4 /* bits */,
 					 NULL /* priv */,
@@ -2334,11 +2891,19 @@ rdb_raft_start(struct rdb *db)
 		goto err_replies_cv;
 	}
 
+	rc = ABT_cond_create(&db->d_proposals_cv);
+	if (rc != ABT_SUCCESS) {
+		D_ERROR(DF_DB": failed to create proposals CV: %d\n",
+			DP_DB(db), rc);
+		rc = dss_abterr2der(rc);
+		goto err_compact_cv;
+	}
+
 	db->d_raft = raft_new();
 	if (db->d_raft == NULL) {
 		D_ERROR(DF_DB": failed to create raft object\n", DP_DB(db));
 		rc = -DER_NOMEM;
-		goto err_compact_cv;
+		goto err_proposals_cv;
 	}
 
 	/*
@@ -2377,6 +2942,7 @@ rdb_raft_start(struct rdb *db)
 	request_timeout = rdb_raft_get_request_timeout();
 	raft_set_election_timeout(db->d_raft, election_timeout);
 	raft_set_request_timeout(db->d_raft, request_timeout);
+	db->d_lease_dur = rdb_raft_get_lease_dur(election_timeout);
 
 	rc = dss_ult_create(rdb_recvd, db, DSS_ULT_RDB, DSS_TGT_SELF, 0,
 			    &db->d_recvd);
@@ -2396,8 +2962,11 @@ rdb_raft_start(struct rdb *db)
 		goto err_callbackd;
 
 	D_DEBUG(DB_MD, DF_DB": raft started: election_timeout=%dms "
-		"request_timeout=%dms compact_thres="DF_U64"\n", DP_DB(db),
-		election_timeout, request_timeout, db->d_compact_thres);
+		"request_timeout=%dms compact_thres="DF_U64" lc_batch_max="
+		DF_U64" lc_batch_lat=%fs ae_window=%d lease=%fs\n",
+		DP_DB(db), election_timeout, request_timeout,
+		db->d_compact_thres, db->d_lc_batch_max, db->d_lc_batch_lat,
+		db->d_ae_window, db->d_lease_dur);
 	return 0;
 
 err_callbackd:
@@ -2420,6 +2989,8 @@ err_lc:
 	rdb_raft_unload_lc(db);
 err_raft:
 	raft_free(db->d_raft);
+err_proposals_cv:
+	ABT_cond_free(&db->d_proposals_cv);
 err_compact_cv:
 	ABT_cond_free(&db->d_compact_cv);
 err_replies_cv:
@@ -2482,6 +3053,7 @@ rdb_raft_stop(struct rdb *db)
 
 	rdb_raft_unload_lc(db);
 	raft_free(db->d_raft);
+	ABT_cond_free(&db->d_proposals_cv);
 	ABT_cond_free(&db->d_compact_cv);
 	ABT_cond_free(&db->d_replies_cv);
 	ABT_cond_free(&db->d_events_cv);
@@ -2727,6 +3299,17 @@ rdb_raft_process_reply(struct rdb *db, crt_rpc_t *rpc)
 		break;
 	case RDB_APPENDENTRIES:
 		out_ae = out;
+		/*
+		 * A rejected AE may be due to a reordered or lost predecessor.
+		 * Forget what is in flight, so that the retry raft is about to
+		 * send from the corrected next index is not trimmed.
+		 */
+		if (!out_ae->aeo_msg.success) {
+			struct rdb_raft_node *rdb_node;
+
+			rdb_node = raft_node_get_udata(node);
+			rdb_node->dn_ae_sent = 0;
+		}
 		rc = raft_recv_appendentries_response(db->d_raft, node,
 						      &out_ae->aeo_msg);
 		break;
@@ -2769,6 +3352,27 @@ rdb_raft_free_bulk_and_buffer(crt_bulk_t bulk)
 	D_FREE(iov.iov_buf);
 }
 
+/* Account for the end of an AE, whether it has been replied or dropped. */
+static void
+rdb_raft_ae_done(struct rdb *db, crt_rpc_t *rpc)
+{
+	struct rdb_raft_node   *rdb_node;
+	raft_node_t	       *node;
+	d_rank_t		rank;
+	int			rc;
+
+	rc = crt_req_dst_rank_get(rpc, &rank);
+	D_ASSERTF(rc == 0, ""DF_RC"\n", DP_RC(rc));
+	node = raft_get_node(db->d_raft, rank);
+	if (node == NULL)
+		return;
+	rdb_node = raft_node_get_udata(node);
+	if (rdb_node->dn_ae_inflight > 0)
+		rdb_node->dn_ae_inflight--;
+	if (rdb_node->dn_ae_inflight == 0)
+		rdb_node->dn_ae_sent = 0;
+}
+
 /* Free any additional memory we allocated for the request. */
 void
 rdb_raft_free_request(struct rdb *db, crt_rpc_t *rpc)
@@ -2784,6 +3388,7 @@ rdb_raft_free_request(struct rdb *db, crt_rpc_t *rpc)
 	case RDB_APPENDENTRIES:
 		in_ae = crt_req_get(rpc);
 		rdb_raft_fini_ae(&in_ae->aei_msg);
+		rdb_raft_ae_done(db, rpc);
 		break;
 	case RDB_INSTALLSNAPSHOT:
 		in_is = crt_req_get(rpc);
@@ -75,6 +75,8 @@ struct rebuild_iter_obj_arg {
 
 #define PULLER_STACK_SIZE	131072
 #define MAX_BUF_SIZE		2048
+/* Max small dkeys of the same object being pulled in one batch */
+#define PULL_BATCH_MAX		16
 
 static int
 rebuild_fetch_update_inline(struct rebuild_one *rdone, daos_handle_t oh,
@@ -310,39 +312,20 @@ rebuild_one_punch(struct rebuild_tgt_pool_tracker *rpt,
 }
 
 static int
-rebuild_dkey(struct rebuild_tgt_pool_tracker *rpt,
-	     struct rebuild_one *rdone)
+rebuild_obj_open(struct rebuild_tgt_pool_tracker *rpt,
+		 struct rebuild_pool_tls *tls, struct rebuild_one *rdone,
+		 daos_handle_t *coh, daos_handle_t *oh,
+		 struct ds_cont_child **cont)
 {
-	struct rebuild_pool_tls	*tls;
-	struct ds_cont_child *rebuild_cont;
-	daos_handle_t		coh = DAOS_HDL_INVAL;
-	daos_handle_t		oh;
-	daos_size_t		data_size;
-	int			rc;
-
-	tls = rebuild_pool_tls_lookup(rpt->rt_pool_uuid,
-				      rpt->rt_rebuild_ver);
-	D_ASSERT(tls != NULL);
-	if (daos_handle_is_inval(tls->rebuild_pool_hdl)) {
-		daos_handle_t ph = DAOS_HDL_INVAL;
-		struct pool_map *map = rebuild_pool_map_get(rpt->rt_pool);
-
-		rc = dc_pool_local_open(rpt->rt_pool_uuid, rpt->rt_poh_uuid,
-					0, NULL, map, rpt->rt_svc_list, &ph);
-		rebuild_pool_map_put(map);
-		if (rc)
-			D_GOTO(free, rc);
-
-		tls->rebuild_pool_hdl = ph;
-	}
+	int	rc;
 
 	/* Open client dc handle */
 	rc = dc_cont_local_open(rdone->ro_cont_uuid, rpt->rt_coh_uuid,
-				0, tls->rebuild_pool_hdl, &coh);
+				0, tls->rebuild_pool_hdl, coh);
 	if (rc)
-		D_GOTO(free, rc);
+		return rc;
 
-	rc = dsc_obj_open(coh, rdone->ro_oid.id_pub, DAOS_OO_RW, &oh);
+	rc = dsc_obj_open(*coh, rdone->ro_oid.id_pub, DAOS_OO_RW, oh);
 	if (rc)
 		D_GOTO(cont_close, rc);
 
@@ -350,13 +333,44 @@ rebuild_dkey(struct rebuild_tgt_pool_tracker *rpt,
 		D_GOTO(obj_close, rc = -DER_NOSPACE);
 
 	rc = ds_cont_child_lookup(rpt->rt_pool_uuid, rdone->ro_cont_uuid,
-				  &rebuild_cont);
+				  cont);
 	if (rc)
 		D_GOTO(obj_close, rc);
 
+	return 0;
+
+obj_close:
+	dsc_obj_close(*oh);
+	*oh = DAOS_HDL_INVAL;
+cont_close:
+	dc_cont_local_close(tls->rebuild_pool_hdl, *coh);
+	*coh = DAOS_HDL_INVAL;
+	return rc;
+}
+
+static void
+rebuild_obj_close(struct rebuild_pool_tls *tls, daos_handle_t coh,
+		  daos_handle_t oh, struct ds_cont_child *cont)
+{
+	if (cont != NULL)
+		ds_cont_child_put(cont);
+	if (!daos_handle_is_inval(oh))
+		dsc_obj_close(oh);
+	if (!daos_handle_is_inval(coh))
+		dc_cont_local_close(tls->rebuild_pool_hdl, coh);
+}
+
+static int
+rebuild_dkey(struct rebuild_tgt_pool_tracker *rpt,
+	     struct rebuild_pool_tls *tls, daos_handle_t oh,
+	     struct ds_cont_child *rebuild_cont, struct rebuild_one *rdone)
+{
+	daos_size_t		data_size;
+	int			rc;
+
 	rc = rebuild_one_punch(rpt, rdone, rebuild_cont);
 	if (rc)
-		D_GOTO(cont_put, rc);
+		return rc;
 
 	data_size = daos_iods_len(rdone->ro_iods, rdone->ro_iod_num);
 
@@ -373,13 +387,9 @@ rebuild_dkey(struct rebuild_tgt_pool_tracker *rpt,
 
 	tls->rebuild_pool_rec_count += rdone->ro_rec_num;
 	tls->rebuild_pool_size += rdone->ro_size;
-cont_put:
-	ds_cont_child_put(rebuild_cont);
-obj_close:
-	dsc_obj_close(oh);
-cont_close:
-	dc_cont_local_close(tls->rebuild_pool_hdl, coh);
-free:
+	tls->rebuild_pool_dkey_count++;
+	dss_sched_charge(DSS_POOL_REBUILD, rdone->ro_size);
+
 	return rc;
 }
 
@@ -410,6 +420,171 @@ rebuild_one_destroy(struct rebuild_one *rdone)
 	D_FREE(rdone);
 }
 
+static void
+rebuild_one_done(struct rebuild_tgt_pool_tracker *rpt,
+		 struct rebuild_puller *puller, struct rebuild_pool_tls *tls,
+		 struct rebuild_one *rdone, int rc)
+{
+	ABT_mutex_lock(puller->rp_lock);
+	D_ASSERT(puller->rp_inflight > 0);
+	puller->rp_inflight--;
+	ABT_mutex_unlock(puller->rp_lock);
+
+	if (rc == -DER_NOSPACE) {
+		/* If there are no space on current VOS, let's
+		 * hang the rebuild ULT on the current xstream,
+		 * and waitting for the space is reclaimed or
+		 * the drive is replaced.
+		 *
+		 * If the space is reclaimed, then it will
+		 * resume the rebuild ULT.
+		 * If the drive is replaced, then it will
+		 * abort the current rebuild by other process.
+		 */
+		rebuild_hang();
+		ABT_thread_yield();
+		D_DEBUG(DB_REBUILD, "%p rebuild got back.\n", rpt);
+		/* Added it back to rdone */
+		ABT_mutex_lock(puller->rp_lock);
+		d_list_add_tail(&rdone->ro_list, &puller->rp_one_list);
+		ABT_mutex_unlock(puller->rp_lock);
+		return;
+	}
+
+	/* Ignore nonexistent error because puller could race
+	 * with user's container destroy:
+	 * - puller got the container+oid from a remote scanner
+	 * - user destroyed the container
+	 * - puller try to open container or pulling data
+	 *   (nonexistent)
+	 * This is just a workaround...
+	 */
+	if (tls->rebuild_pool_status == 0 && rc != 0 &&
+	    rc != -DER_NONEXIST) {
+		tls->rebuild_pool_status = rc;
+		rpt->rt_abort = 1;
+	}
+	/* XXX If rebuild fails, Should we add this back to
+	 * dkey list
+	 */
+	rebuild_one_destroy(rdone);
+}
+
+/* Argument of the ULT pulling a batch of dkeys */
+struct rebuild_pull_arg {
+	struct rebuild_tgt_pool_tracker	*rpa_rpt;
+	struct rebuild_puller		*rpa_puller;
+	/* dkeys of the same object */
+	d_list_t			 rpa_list;
+};
+
+static void
+rebuild_pull_ult(void *data)
+{
+	struct rebuild_pull_arg		*arg = data;
+	struct rebuild_tgt_pool_tracker *rpt = arg->rpa_rpt;
+	struct rebuild_puller		*puller = arg->rpa_puller;
+	struct rebuild_pool_tls		*tls;
+	struct rebuild_one		*rdone;
+	struct rebuild_one		*tmp;
+	struct ds_cont_child		*cont = NULL;
+	daos_handle_t			 coh = DAOS_HDL_INVAL;
+	daos_handle_t			 oh = DAOS_HDL_INVAL;
+	int				 rc = 0;
+
+	tls = rebuild_pool_tls_lookup(rpt->rt_pool_uuid,
+				      rpt->rt_rebuild_ver);
+	D_ASSERT(tls != NULL);
+
+	/* All the dkeys in the batch share the container & object handles */
+	rdone = d_list_entry(arg->rpa_list.next, struct rebuild_one, ro_list);
+	if (!rpt->rt_abort)
+		rc = rebuild_obj_open(rpt, tls, rdone, &coh, &oh, &cont);
+
+	d_list_for_each_entry_safe(rdone, tmp, &arg->rpa_list, ro_list) {
+		int	ret = rc;
+
+		d_list_del_init(&rdone->ro_list);
+		if (ret == 0 && !rpt->rt_abort) {
+			ret = rebuild_dkey(rpt, tls, oh, cont, rdone);
+			D_DEBUG(DB_REBUILD, DF_UOID" rebuild dkey "
+				DF_KEY" rc %d tag %d rpt %p\n",
+				DP_UOID(rdone->ro_oid),
+				DP_KEY(&rdone->ro_dkey), ret,
+				dss_get_module_info()->dmi_tgt_id, rpt);
+		}
+		rebuild_one_done(rpt, puller, tls, rdone, ret);
+	}
+
+	rebuild_obj_close(tls, coh, oh, cont);
+	D_FREE(arg);
+
+	ABT_mutex_lock(puller->rp_lock);
+	D_ASSERT(puller->rp_pulling > 0);
+	puller->rp_pulling--;
+	if (puller->rp_pulling == 0)
+		tls->rebuild_pool_pull_ns += daos_get_ntime() -
+					     tls->rebuild_pool_pull_start;
+	ABT_cond_broadcast(puller->rp_pull_cond);
+	ABT_mutex_unlock(puller->rp_lock);
+}
+
+static bool
+rebuild_one_is_small(struct rebuild_one *rdone)
+{
+	return daos_iods_len(rdone->ro_iods, rdone->ro_iod_num) <
+		MAX_BUF_SIZE;
+}
+
+/*
+ * Move a batch of dkeys from the head of @list to @batch, consecutive small
+ * dkeys of the same object are pulled in one batch.
+ */
+static void
+rebuild_batch_prep(d_list_t *list, d_list_t *batch)
+{
+	struct rebuild_one	*first;
+	struct rebuild_one	*rdone;
+	struct rebuild_one	*tmp;
+	int			 cnt = 0;
+
+	first = d_list_entry(list->next, struct rebuild_one, ro_list);
+	d_list_for_each_entry_safe(rdone, tmp, list, ro_list) {
+		if (rdone != first &&
+		    (cnt >= PULL_BATCH_MAX || !rebuild_one_is_small(first) ||
+		     !rebuild_one_is_small(rdone) ||
+		     uuid_compare(rdone->ro_cont_uuid,
+				  first->ro_cont_uuid) != 0 ||
+		     daos_unit_oid_compare(rdone->ro_oid, first->ro_oid) != 0))
+			break;
+
+		d_list_move_tail(&rdone->ro_list, batch);
+		cnt++;
+	}
+}
+
+static int
+rebuild_pool_hdl_open(struct rebuild_tgt_pool_tracker *rpt,
+		      struct rebuild_pool_tls *tls)
+{
+	daos_handle_t	 ph = DAOS_HDL_INVAL;
+	struct pool_map	*map;
+	int		 rc;
+
+	if (!daos_handle_is_inval(tls->rebuild_pool_hdl))
+		return 0;
+
+	map = rebuild_pool_map_get(rpt->rt_pool);
+	rc = dc_pool_local_open(rpt->rt_pool_uuid, rpt->rt_poh_uuid,
+				0, NULL, map, rpt->rt_svc_list, &ph);
+	rebuild_pool_map_put(map);
+	if (rc)
+		return rc;
+
+	tls->rebuild_pool_hdl = ph;
+	return 0;
+}
+
 static void
 rebuild_one_ult(void *arg)
 {
@@ -431,6 +606,7 @@ rebuild_one_ult(void *arg)
 	while (1) {
 		struct rebuild_one	*rdone;
 		struct rebuild_one	*tmp;
+		struct rebuild_pull_arg	*pull_arg;
 		d_list_t		rebuild_list;
 		int			rc = 0;
 
@@ -443,68 +619,64 @@ rebuild_one_ult(void *arg)
 		}
 		ABT_mutex_unlock(puller->rp_lock);
 
-		d_list_for_each_entry_safe(rdone, tmp, &rebuild_list, ro_list) {
-			d_list_del_init(&rdone->ro_list);
-			if (!rpt->rt_abort) {
-				rc = rebuild_dkey(rpt, rdone);
-				D_DEBUG(DB_REBUILD, DF_UOID" rebuild dkey "
-					DF_KEY" rc %d tag %d rpt %p\n",
-					DP_UOID(rdone->ro_oid),
-					DP_KEY(&rdone->ro_dkey),
-					rc, idx, rpt);
+		while (!d_list_empty(&rebuild_list)) {
+			D_ALLOC_PTR(pull_arg);
+			if (pull_arg == NULL)
+				rc = -DER_NOMEM;
+			else if (!rpt->rt_abort)
+				rc = rebuild_pool_hdl_open(rpt, tls);
+
+			if (rc != 0 || rpt->rt_abort) {
+				D_FREE(pull_arg);
+				d_list_for_each_entry_safe(rdone, tmp,
+							   &rebuild_list,
+							   ro_list) {
+					d_list_del_init(&rdone->ro_list);
+					rebuild_one_done(rpt, puller, tls,
+							 rdone, rc);
+				}
+				break;
 			}
 
-			D_ASSERT(puller->rp_inflight > 0);
-			puller->rp_inflight--;
-
-			if (rc == -DER_NOSPACE) {
-				/* If there are no space on current VOS, let's
-				 * hang the rebuild ULT on the current xstream,
-				 * and waitting for the space is reclaimed or
-				 * the drive is replaced.
-				 *
-				 * If the space is reclaimed, then it will
-				 * resume the rebuild ULT.
-				 * If the drive is replaced, then it will
-				 * abort the current rebuild by other process.
-				 */
-				rebuild_hang();
-				ABT_thread_yield();
-				D_DEBUG(DB_REBUILD, "%p rebuild got back.\n",
-					rpt);
-				rc = 0;
-				/* Added it back to rdone */
-				ABT_mutex_lock(puller->rp_lock);
-				d_list_add_tail(&rdone->ro_list,
-						&puller->rp_one_list);
-				ABT_mutex_unlock(puller->rp_lock);
-				continue;
-			}
+			pull_arg->rpa_rpt = rpt;
+			pull_arg->rpa_puller = puller;
+			D_INIT_LIST_HEAD(&pull_arg->rpa_list);
+			rebuild_batch_prep(&rebuild_list, &pull_arg->rpa_list);
+
+			/* Wait for a slot in the pulling window */
+			ABT_mutex_lock(puller->rp_lock);
+			while (puller->rp_pulling >=
+			       rebuild_gst.rg_pull_inflight)
+				ABT_cond_wait(puller->rp_pull_cond,
+					      puller->rp_lock);
+			if (puller->rp_pulling == 0)
+				tls->rebuild_pool_pull_start = daos_get_ntime();
+			puller->rp_pulling++;
+			ABT_mutex_unlock(puller->rp_lock);
 
-			/* Ignore nonexistent error because puller could race
-			 * with user's container destroy:
-			 * - puller got the container+oid from a remote scanner
-			 * - user destroyed the container
-			 * - puller try to open container or pulling data
-			 *   (nonexistent)
-			 * This is just a workaround...
-			 */
-			if (tls->rebuild_pool_status == 0 && rc != 0 &&
-			    rc != -DER_NONEXIST) {
-				tls->rebuild_pool_status = rc;
-				rpt->rt_abort = 1;
+			rc = dss_ult_create(rebuild_pull_ult, pull_arg,
+					    DSS_ULT_REBUILD, idx,
+					    PULLER_STACK_SIZE, NULL);
+			if (rc) {
+				D_ERROR("create pulling ULT failed: "DF_RC"\n",
+					DP_RC(rc));
+				/* Pull the batch in current ULT instead */
+				rebuild_pull_ult(pull_arg);
+				rc = 0;
 			}
-			/* XXX If rebuild fails, Should we add this back to
-			 * dkey list
-			 */
-			rebuild_one_destroy(rdone);
 		}
 
 		/* check if it should exist */
 		ABT_mutex_lock(puller->rp_lock);
 		if (d_list_empty(&puller->rp_one_list) && rpt->rt_finishing) {
-			ABT_mutex_unlock(puller->rp_lock);
-			break;
+			/* In-flight pulling could re-queue dkeys on NOSPACE */
+			while (puller->rp_pulling > 0)
+				ABT_cond_wait(puller->rp_pull_cond,
+					      puller->rp_lock);
+			if (d_list_empty(&puller->rp_one_list)) {
+				ABT_mutex_unlock(puller->rp_lock);
+				break;
+			}
 		}
 		/* XXX exist if rebuild is aborted */
 		ABT_mutex_unlock(puller->rp_lock);
@@ -881,6 +1053,26 @@ rebuild_obj_punch(struct rebuild_iter_obj_arg *arg)
 /**
  * Iterate akeys/dkeys of the object
  */
+/*
+ * Fence the epoch range for delta rebuild, the data not newer than the delta
+ * epoch is already on the target. Return false if nothing to pull.
+ */
+static bool
+rebuild_epr_fence(struct rebuild_tgt_pool_tracker *rpt,
+		  daos_epoch_range_t *epr)
+{
+	if (rpt->rt_delta_epoch == 0)
+		return true;
+
+	if (epr->epr_hi <= rpt->rt_delta_epoch)
+		return false;
+
+	if (epr->epr_lo <= rpt->rt_delta_epoch)
+		epr->epr_lo = rpt->rt_delta_epoch + 1;
+
+	return true;
+}
+
 static void
 rebuild_obj_ult(void *data)
 {
@@ -894,7 +1086,8 @@ rebuild_obj_ult(void *data)
 				      arg->rpt->rt_rebuild_ver);
 	D_ASSERT(tls != NULL);
 
-	if (arg->epoch != DAOS_EPOCH_MAX) {
+	if (arg->epoch != DAOS_EPOCH_MAX &&
+	    arg->epoch > arg->rpt->rt_delta_epoch) {
 		rc = rebuild_obj_punch(arg);
 		if (rc)
 			D_GOTO(free, rc);
@@ -910,6 +1103,8 @@ rebuild_obj_ult(void *data)
 		for (i = 0; i < arg->snap_cnt; i++) {
 			epr.epr_lo = i > 0 ? arg->snaps[i-1] + 1 : 0;
 			epr.epr_hi = arg->snaps[i];
+			if (!rebuild_epr_fence(arg->rpt, &epr))
+				continue;
 			rc = rebuild_one_epoch_object(oh, &epr, arg);
 			if (rc)
 				D_GOTO(close, rc);
@@ -919,7 +1114,8 @@ rebuild_obj_ult(void *data)
 	D_ASSERT(arg->rpt->rt_stable_epoch != 0);
 	epr.epr_lo = arg->snaps ? arg->snaps[arg->snap_cnt - 1] + 1 : 0;
 	epr.epr_hi = arg->rpt->rt_stable_epoch;
-	rc = rebuild_one_epoch_object(oh, &epr, arg);
+	if (rebuild_epr_fence(arg->rpt, &epr))
+		rc = rebuild_one_epoch_object(oh, &epr, arg);
 
 close:
 	dsc_obj_close(oh);
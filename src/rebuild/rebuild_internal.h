@@ -54,10 +54,14 @@ struct rebuild_one {
 
 struct rebuild_puller {
 	unsigned int	rp_inflight;
+	/** # of in-flight pulling ULTs */
+	unsigned int	rp_pulling;
 	ABT_thread	rp_ult;
 	ABT_mutex	rp_lock;
 	/** serialize initialization of ULTs */
 	ABT_cond	rp_fini_cond;
+	/** wait for the completion of pulling ULTs */
+	ABT_cond	rp_pull_cond;
 	d_list_t	rp_one_list;
 	unsigned int	rp_ult_running:1;
 };
@@ -116,6 +120,10 @@ struct rebuild_tgt_pool_tracker {
 	uint64_t		rt_reported_size;
 	/* global stable epoch to use for rebuilding the data */
 	uint64_t		rt_stable_epoch;
+	/* only the data newer than this epoch is pulled, 0 for all data */
+	uint64_t		rt_delta_epoch;
+	/* rebuild operation, daos_rebuild_opc_t */
+	uint32_t		rt_rebuild_op;
 	/* local rebuild epoch mainly to constrain the VOS aggregation
 	 * to make sure aggreation will not cross the epoch
 	 */
@@ -168,6 +176,12 @@ struct rebuild_global_pool_tracker {
 	/* stable epoch of the rebuild */
 	uint64_t	rgt_stable_epoch;
 
+	/* delta epoch of the rebuild, see rebuild_task::dst_delta_epoch */
+	uint64_t	rgt_delta_epoch;
+
+	/* rebuild operation, daos_rebuild_opc_t */
+	uint32_t	rgt_rebuild_op;
+
 	unsigned int	rgt_abort:1,
 			rgt_notify_stable_epoch:1;
 };
@@ -216,10 +230,15 @@ struct rebuild_global {
 	ABT_cond	rg_stop_cond;
 	/* how many pools is being rebuilt */
 	unsigned int	rg_inflight;
+	/* max in-flight dkey pulling ULTs per target */
+	unsigned int	rg_pull_inflight;
 	unsigned int	rg_rebuild_running:1,
 			rg_abort:1;
 };
 
+/* Default max in-flight dkey pulling ULTs per target */
+#define REBUILD_PULL_INFLIGHT	8
+
 /* Per target structure to track the rebuild status */
 extern struct rebuild_global rebuild_gst;
 
@@ -229,6 +248,13 @@ struct rebuild_task {
 	struct pool_target_id_list	dst_tgts;
 	d_rank_list_t	*dst_svc_list;
 	uint32_t	dst_map_ver;
+	/* RB_OP_FAIL for the DOWN targets, RB_OP_REINT for the UP ones */
+	uint32_t	dst_rebuild_op;
+	/*
+	 * Delta rebuild (e.g. reintegrating a target being DOWN for a while)
+	 * only pulls the data newer than this epoch, 0 for full rebuild.
+	 */
+	daos_epoch_t	dst_delta_epoch;
 };
 
 /* Per pool structure in TLS to check pool rebuild status
@@ -243,6 +269,10 @@ struct rebuild_pool_tls {
 	uint64_t	rebuild_pool_obj_count;
 	uint64_t	rebuild_pool_rec_count;
 	uint64_t	rebuild_pool_size;
+	uint64_t	rebuild_pool_dkey_count;
+	/* Time (ns) spent with dkey pulling in flight */
+	uint64_t	rebuild_pool_pull_ns;
+	uint64_t	rebuild_pool_pull_start;
 	unsigned int	rebuild_pool_ver;
 	int		rebuild_pool_status;
 	unsigned int	rebuild_pool_scanning:1;
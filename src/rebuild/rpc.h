@@ -69,12 +69,13 @@ extern struct crt_proto_format rebuild_proto_fmt;
 	((uuid_t)		(rsi_cont_hdl_uuid)	CRT_VAR) \
 	((d_rank_list_t)	(rsi_svc_list)		CRT_PTR) \
 	((uint64_t)		(rsi_leader_term)	CRT_VAR) \
+	((uint64_t)		(rsi_delta_epoch)	CRT_VAR) \
 	((uint32_t)		(rsi_tgts_num)		CRT_VAR) \
 	((uint32_t)		(rsi_ns_id)		CRT_VAR) \
 	((uint32_t)		(rsi_pool_map_ver)	CRT_VAR) \
 	((uint32_t)		(rsi_rebuild_ver)	CRT_VAR) \
 	((uint32_t)		(rsi_master_rank)	CRT_VAR) \
-	((uint32_t)		(rsi_padding)		CRT_VAR)
+	((uint32_t)		(rsi_rebuild_op)	CRT_VAR)
 
 #define DAOS_OSEQ_REBUILD_SCAN	/* output fields */		 \
 	((d_rank_list_t)	(rso_ranks_list)	CRT_PTR) \
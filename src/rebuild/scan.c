@@ -608,9 +608,16 @@ rebuild_obj_scan_cb(daos_handle_t ch, vos_iter_entry_t *ent,
 		shards = shard_array;
 	}
 
-	rebuild_nr = pl_obj_find_rebuild(map, &md, NULL, rpt->rt_rebuild_ver,
-					 tgts, shards, arg->rebuild_tgt_nr,
-					 myrank);
+	if (rpt->rt_rebuild_op == RB_OP_REINT)
+		rebuild_nr = pl_obj_find_reint(map, &md, NULL,
+					       rpt->rt_rebuild_ver, tgts,
+					       shards, arg->rebuild_tgt_nr,
+					       myrank);
+	else
+		rebuild_nr = pl_obj_find_rebuild(map, &md, NULL,
+						 rpt->rt_rebuild_ver, tgts,
+						 shards, arg->rebuild_tgt_nr,
+						 myrank);
 	if (rebuild_nr <= 0) /* No need rebuild */
 		D_GOTO(out, rc = rebuild_nr);
 
@@ -698,6 +705,11 @@ rebuild_container_scan_cb(daos_handle_t ih, vos_iter_entry_t *entry,
 	param.ip_hdl = coh;
 	param.ip_epr.epr_lo = 0;
 	param.ip_epr.epr_hi = DAOS_EPOCH_MAX;
+	/* The objects punched before the delta epoch are gone on the
+	 * reintegrating target as well.
+	 */
+	if (rpt->rt_delta_epoch != 0)
+		param.ip_epr.epr_lo = rpt->rt_delta_epoch + 1;
 	param.ip_flags = VOS_IT_FOR_REBUILD;
 	uuid_copy(xarg->co_uuid, entry->ie_couuid);
 	rc = vos_iterate(&param, VOS_ITER_OBJ, false, &anchor,
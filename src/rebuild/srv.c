@@ -105,6 +105,8 @@ rebuild_pool_tls_create(uuid_t pool_uuid, uuid_t poh_uuid, uuid_t coh_uuid,
 	rebuild_pool_tls->rebuild_pool_rec_count = 0;
 	rebuild_pool_tls->rebuild_pool_obj_count = 0;
 	rebuild_pool_tls->rebuild_pool_size = 0;
+	rebuild_pool_tls->rebuild_pool_dkey_count = 0;
+	rebuild_pool_tls->rebuild_pool_pull_ns = 0;
 
 	/* Only 1 thread will access the list, no need lock */
 	d_list_add(&rebuild_pool_tls->rebuild_pool_list,
@@ -351,6 +353,11 @@ is_current_tgt_up(struct rebuild_tgt_pool_tracker *rpt)
 	rc = pool_map_find_target_by_rank_idx(rpt->rt_pool->sp_map, rank,
 					      idx, &tgt);
 	D_ASSERT(rc == 1);
+	/* The reintegrating (UP) target pulls its data back */
+	if (tgt->ta_comp.co_status == PO_COMP_ST_UP &&
+	    rpt->rt_rebuild_op == RB_OP_REINT)
+		return true;
+
 	if (tgt->ta_comp.co_status != PO_COMP_ST_UPIN) {
 		D_DEBUG(DB_REBUILD, "%d/%d target status %d\n",
 			rank, idx, tgt->ta_comp.co_status);
@@ -368,6 +375,7 @@ dss_rebuild_check_one(void *data)
 	struct rebuild_tgt_query_info	*status = arg->status;
 	struct rebuild_tgt_pool_tracker	*rpt = arg->rpt;
 	unsigned int			idx = dss_get_module_info()->dmi_tgt_id;
+	uint64_t			pull_ns;
 
 	if (!is_current_tgt_up(rpt))
 		return 0;
@@ -377,14 +385,20 @@ dss_rebuild_check_one(void *data)
 	D_ASSERTF(pool_tls != NULL, DF_UUID" ver %d\n",
 		   DP_UUID(rpt->rt_pool_uuid), rpt->rt_rebuild_ver);
 
+	pull_ns = pool_tls->rebuild_pool_pull_ns;
 	D_DEBUG(DB_REBUILD, "%d rec_count "DF_U64" obj_count "DF_U64
-		" size "DF_U64" scanning %d status %d inflight %d\n",
+		" size "DF_U64" scanning %d status %d inflight %d pulling %d"
+		" dkey_count "DF_U64" pull_ms "DF_U64" bw "DF_U64" MB/s\n",
 		idx, pool_tls->rebuild_pool_rec_count,
 		pool_tls->rebuild_pool_obj_count,
 		pool_tls->rebuild_pool_size,
 		pool_tls->rebuild_pool_scanning,
 		pool_tls->rebuild_pool_status,
-		rpt->rt_pullers[idx].rp_inflight);
+		rpt->rt_pullers[idx].rp_inflight,
+		rpt->rt_pullers[idx].rp_pulling,
+		pool_tls->rebuild_pool_dkey_count, pull_ns / NSEC_PER_MSEC,
+		pull_ns == 0 ? 0 : (pool_tls->rebuild_pool_size >> 20) *
+				   NSEC_PER_SEC / pull_ns);
 	ABT_mutex_lock(status->lock);
 	if (pool_tls->rebuild_pool_scanning)
 		status->scanning = 1;
@@ -701,10 +715,11 @@ out:
 /* To notify all targets to prepare the rebuild */
 static int
 rebuild_prepare(struct ds_pool *pool, uint32_t rebuild_ver,
-		uint64_t leader_term,
+		uint64_t leader_term, daos_rebuild_opc_t rebuild_op,
 		struct pool_target_id_list *exclude_tgts,
 		struct rebuild_global_pool_tracker **rgt)
 {
+	unsigned int	tgt_status;
 	unsigned int	master_rank;
 	int		rc;
 
@@ -720,9 +735,12 @@ rebuild_prepare(struct ds_pool *pool, uint32_t rebuild_ver,
 		return rc;
 
 	(*rgt)->rgt_leader_term = leader_term;
+	(*rgt)->rgt_rebuild_op = rebuild_op;
 	uuid_generate((*rgt)->rgt_coh_uuid);
 	uuid_generate((*rgt)->rgt_poh_uuid);
 	(*rgt)->rgt_time_start = d_timeus_secdiff(0);
+	tgt_status = rebuild_op == RB_OP_REINT ? PO_COMP_ST_UP :
+						 PO_COMP_ST_DOWN;
 	if (exclude_tgts != NULL) {
 		bool excluded = false;
 		int i;
@@ -739,8 +757,7 @@ rebuild_prepare(struct ds_pool *pool, uint32_t rebuild_ver,
 			if (ret <= 0)
 				continue;
 
-			if (target &&
-			    target->ta_comp.co_status == PO_COMP_ST_DOWN)
+			if (target && target->ta_comp.co_status == tgt_status)
 				excluded = true;
 
 			dom = pool_map_find_node_by_rank(pool->sp_map,
@@ -819,6 +836,8 @@ retry:
 	rsi->rsi_ns_id = pool->sp_iv_ns->iv_ns_id;
 	rsi->rsi_pool_map_ver = map_ver;
 	rsi->rsi_leader_term = rgt->rgt_leader_term;
+	rsi->rsi_delta_epoch = rgt->rgt_delta_epoch;
+	rsi->rsi_rebuild_op = rgt->rgt_rebuild_op;
 	rsi->rsi_rebuild_ver = rgt->rgt_rebuild_ver;
 	rsi->rsi_tgts_num = tgts_failed->pti_number;
 	rsi->rsi_svc_list = svc_list;
@@ -876,7 +895,7 @@ retry:
 
 			rc = ds_rebuild_schedule(pool->sp_uuid,
 					pool_map_get_version(pool->sp_map),
-					&list, svc_list);
+					&list, svc_list, RB_OP_FAIL, 0);
 			if (rc != 0) {
 				D_ERROR("rebuild fails rc "DF_RC"\n",
 					DP_RC(rc));
@@ -931,6 +950,8 @@ rpt_destroy(struct rebuild_tgt_pool_tracker *rpt)
 			D_ASSERT(puller->rp_ult == NULL);
 			if (puller->rp_fini_cond)
 				ABT_cond_free(&puller->rp_fini_cond);
+			if (puller->rp_pull_cond)
+				ABT_cond_free(&puller->rp_pull_cond);
 			if (puller->rp_lock)
 				ABT_mutex_free(&puller->rp_lock);
 		}
@@ -989,7 +1010,8 @@ rebuild_task_destroy(struct rebuild_task *task)
  **/
 static int
 rebuild_try_merge_tgts(const uuid_t pool_uuid, uint32_t map_ver,
-		       struct pool_target_id_list *tgts_failed)
+		       struct pool_target_id_list *tgts_failed,
+		       daos_rebuild_opc_t rebuild_op, daos_epoch_t delta_epoch)
 {
 	struct rebuild_task *task;
 	struct rebuild_task *found = NULL;
@@ -997,7 +1019,9 @@ rebuild_try_merge_tgts(const uuid_t pool_uuid, uint32_t map_ver,
 
 	d_list_for_each_entry(task, &rebuild_gst.rg_queue_list,
 			      dst_list) {
-		if (uuid_compare(task->dst_pool_uuid, pool_uuid) == 0) {
+		/* The reintegration can't share the rebuild of the failures */
+		if (uuid_compare(task->dst_pool_uuid, pool_uuid) == 0 &&
+		    task->dst_rebuild_op == rebuild_op) {
 			found = task;
 			break;
 		}
@@ -1021,6 +1045,10 @@ rebuild_try_merge_tgts(const uuid_t pool_uuid, uint32_t map_ver,
 		found->dst_map_ver = map_ver;
 	}
 
+	/* The merged task has to pull all the data needed by either task */
+	if (found->dst_delta_epoch > delta_epoch)
+		found->dst_delta_epoch = delta_epoch;
+
 	D_PRINT("Rebuild [queued] ("DF_UUID" ver=%u) id %u\n",
 		DP_UUID(pool_uuid), map_ver, tgts_failed->pti_ids[0].pti_id);
 
@@ -1035,7 +1063,8 @@ rebuild_try_merge_tgts(const uuid_t pool_uuid, uint32_t map_ver,
 static int
 rebuild_leader_start(struct ds_pool *pool, uint32_t rebuild_ver,
 		     struct pool_target_id_list *tgts_failed,
-		     d_rank_list_t *svc_list,
+		     d_rank_list_t *svc_list, daos_rebuild_opc_t rebuild_op,
+		     daos_epoch_t delta_epoch,
 		     struct rebuild_global_pool_tracker **p_rgt)
 {
 	uint32_t	map_ver;
@@ -1053,12 +1082,13 @@ rebuild_leader_start(struct ds_pool *pool, uint32_t rebuild_ver,
 		D_GOTO(out, rc);
 	}
 
-	rc = rebuild_prepare(pool, rebuild_ver, leader_term, tgts_failed,
-			     p_rgt);
+	rc = rebuild_prepare(pool, rebuild_ver, leader_term, rebuild_op,
+			     tgts_failed, p_rgt);
 	if (rc) {
 		D_ERROR("rebuild prepare failed: rc "DF_RC"\n", DP_RC(rc));
 		D_GOTO(out, rc);
 	}
+	(*p_rgt)->rgt_delta_epoch = delta_epoch;
 
 	rc = ds_pool_map_buf_get(pool->sp_uuid, &map_buf_iov, &map_ver);
 	if (rc) {
@@ -1099,7 +1129,8 @@ rebuild_task_ult(void *arg)
 		 DP_UUID(task->dst_pool_uuid), task->dst_map_ver);
 
 	rc = rebuild_leader_start(pool, task->dst_map_ver, &task->dst_tgts,
-				  task->dst_svc_list, &rgt);
+				  task->dst_svc_list, task->dst_rebuild_op,
+				  task->dst_delta_epoch, &rgt);
 	if (rc != 0) {
 		if (rc == -DER_CANCELED) {
 			D_DEBUG(DB_REBUILD, "pool "DF_UUID" ver %u rebuild is"
@@ -1147,7 +1178,9 @@ done:
 		/* Merge the targets to following rebuild task, try again */
 		ret = rebuild_try_merge_tgts(task->dst_pool_uuid,
 					     task->dst_map_ver,
-					     &task->dst_tgts);
+					     &task->dst_tgts,
+					     task->dst_rebuild_op,
+					     task->dst_delta_epoch);
 		if (ret == 1)
 			D_GOTO(iv_stop, rc);
 
@@ -1159,6 +1192,26 @@ done:
 		       rgt->rgt_status.rs_errno);
 	}
 
+	if (task->dst_rebuild_op == RB_OP_REINT) {
+		/* Only the target which has got all of its data back can
+		 * serve I/O, otherwise it stays UP and it is up to the
+		 * administrator to reintegrate it again.
+		 */
+		if (rgt == NULL || !is_rebuild_global_done(rgt) ||
+		    rgt->rgt_status.rs_errno != 0) {
+			D_ERROR("reintegrate target %d of "DF_UUID" failed\n",
+				task->dst_tgts.pti_ids[0].pti_id,
+				DP_UUID(task->dst_pool_uuid));
+			D_GOTO(iv_stop, rc);
+		}
+
+		rc = ds_pool_tgt_add_in(pool->sp_uuid, &task->dst_tgts);
+		D_DEBUG(DB_REBUILD, "mark reintegrated target %d of "DF_UUID
+			" as UPIN: %d\n", task->dst_tgts.pti_ids[0].pti_id,
+			DP_UUID(task->dst_pool_uuid), rc);
+		D_GOTO(iv_stop, rc);
+	}
+
 	rc = ds_pool_tgt_exclude_out(pool->sp_uuid, &task->dst_tgts);
 	D_DEBUG(DB_REBUILD, "mark failed target %d of "DF_UUID
 		" as DOWNOUT: %d\n", task->dst_tgts.pti_ids[0].pti_id,
@@ -1349,18 +1402,24 @@ ds_rebuild_leader_stop_all()
 
 /**
  * Add rebuild task to the rebuild list and another ULT will rebuild the
- * pool.
+ * pool. \a rebuild_op is RB_OP_FAIL to rebuild the DOWN targets in
+ * \a tgts_failed, or RB_OP_REINT to move the data back to the UP targets
+ * being reintegrated. If \a delta_epoch isn't 0, only the data newer than
+ * \a delta_epoch will be pulled, e.g. for reintegrating a target which has
+ * all the data up to the epoch when it went DOWN.
  */
 int
 ds_rebuild_schedule(const uuid_t uuid, uint32_t map_ver,
 		    struct pool_target_id_list *tgts_failed,
-		    d_rank_list_t *svc_list)
+		    d_rank_list_t *svc_list, daos_rebuild_opc_t rebuild_op,
+		    daos_epoch_t delta_epoch)
 {
 	struct rebuild_task	*task;
 	int			rc;
 
 	/* Check if the pool already in the queue list */
-	rc = rebuild_try_merge_tgts(uuid, map_ver, tgts_failed);
+	rc = rebuild_try_merge_tgts(uuid, map_ver, tgts_failed, rebuild_op,
+				    delta_epoch);
 	if (rc)
 		return rc == 1 ? 0 : rc;
 
@@ -1369,6 +1428,8 @@ ds_rebuild_schedule(const uuid_t uuid, uint32_t map_ver,
 		return -DER_NOMEM;
 
 	task->dst_map_ver = map_ver;
+	task->dst_rebuild_op = rebuild_op;
+	task->dst_delta_epoch = delta_epoch;
 	uuid_copy(task->dst_pool_uuid, uuid);
 	D_INIT_LIST_HEAD(&task->dst_list);
 
@@ -1437,7 +1498,7 @@ ds_rebuild_regenerate_task(struct ds_pool *pool, d_rank_list_t *svc_list)
 		id_list.pti_number = 1;
 
 		rc = ds_rebuild_schedule(pool->sp_uuid, tgt->ta_comp.co_fseq,
-					 &id_list, svc_list);
+					 &id_list, svc_list, RB_OP_FAIL, 0);
 		if (rc) {
 			D_ERROR(DF_UUID" schedule ver %d failed: rc %d\n",
 				DP_UUID(pool->sp_uuid), tgt->ta_comp.co_fseq,
@@ -1796,6 +1857,10 @@ rpt_create(struct ds_pool *pool, d_rank_list_t *svc_list, uint32_t pm_ver,
 		rc = ABT_cond_create(&puller->rp_fini_cond);
 		if (rc != ABT_SUCCESS)
 			D_GOTO(free, rc = dss_abterr2der(rc));
+
+		rc = ABT_cond_create(&puller->rp_pull_cond);
+		if (rc != ABT_SUCCESS)
+			D_GOTO(free, rc = dss_abterr2der(rc));
 	}
 
 	uuid_copy(rpt->rt_pool_uuid, pool->sp_uuid);
@@ -1898,6 +1963,8 @@ rebuild_tgt_prepare(crt_rpc_t *rpc, struct rebuild_tgt_pool_tracker **p_rpt)
 
 	uuid_copy(rpt->rt_poh_uuid, rsi->rsi_pool_hdl_uuid);
 	uuid_copy(rpt->rt_coh_uuid, rsi->rsi_cont_hdl_uuid);
+	rpt->rt_delta_epoch = rsi->rsi_delta_epoch;
+	rpt->rt_rebuild_op = rsi->rsi_rebuild_op;
 
 	D_DEBUG(DB_REBUILD, "rebuild coh/poh "DF_UUID"/"DF_UUID"\n",
 		DP_UUID(rpt->rt_coh_uuid), DP_UUID(rpt->rt_poh_uuid));
@@ -1979,6 +2046,12 @@ init(void)
 	if (rc != ABT_SUCCESS)
 		return dss_abterr2der(rc);
 
+	rebuild_gst.rg_pull_inflight = REBUILD_PULL_INFLIGHT;
+	d_getenv_int("DAOS_REBUILD_PULL_INFLIGHT",
+		     &rebuild_gst.rg_pull_inflight);
+	if (rebuild_gst.rg_pull_inflight == 0)
+		rebuild_gst.rg_pull_inflight = 1;
+
 	rc = rebuild_iv_init();
 	return rc;
 }
@@ -29,6 +29,7 @@
  * kill servers and update pool map.
 */
 #define D_LOGFAC	DD_FAC(tests)
+#include <daos/object.h>
 #include "daos_iotest.h"
 
 int		g_dkeys	  = 1000;
@@ -253,6 +254,187 @@ io_degraded_enum_demo(void **state)
 	insert_lookup_enum_with_ops(arg, ENUMERATE);
 }
 
+#define EC_DEGRADED_DATA_SIZE	(4 * 1024)
+
+/** Lose the target of the first data cell of \a oid and hold its rebuild */
+static void
+ec_degraded_kill(test_arg_t *arg, daos_obj_id_t oid)
+{
+	struct daos_obj_layout	*layout;
+	d_rank_t		 rank;
+
+	daos_obj_layout_get(arg->coh, oid, &layout);
+	rank = layout->ol_shards[0]->os_ranks[0];
+	daos_obj_layout_free(layout);
+
+	MPI_Barrier(MPI_COMM_WORLD);
+	if (arg->myrank == 0) {
+		/* hold rebuild so the lost shard cannot serve the fetch */
+		daos_mgmt_set_params(arg->group, -1, DMG_KEY_FAIL_LOC,
+				     DAOS_REBUILD_HANG, 0, NULL);
+		daos_kill_server(arg, arg->pool.pool_uuid, arg->group,
+				 &arg->pool.alive_svc, rank);
+		daos_exclude_server(arg->pool.pool_uuid, arg->group,
+				    &arg->pool.svc, rank);
+	}
+	MPI_Barrier(MPI_COMM_WORLD);
+}
+
+static void
+ec_degraded_restore(test_arg_t *arg)
+{
+	MPI_Barrier(MPI_COMM_WORLD);
+	if (arg->myrank == 0) {
+		daos_mgmt_set_params(arg->group, -1, DMG_KEY_FAIL_LOC, 0, 0,
+				     NULL);
+		test_rebuild_wait(&arg, 1);
+	}
+	MPI_Barrier(MPI_COMM_WORLD);
+}
+
+/**
+ * Write full stripes to an EC object, lose the target of the first data cell
+ * and verify the data can still be read back (recovered from parity).
+ */
+static void
+io_degraded_ec_fetch(void **state)
+{
+	test_arg_t		*arg = *state;
+	daos_obj_id_t		 oid;
+	struct ioreq		 req;
+	daos_recx_t		 recx;
+	char			*data;
+	char			*fetch_buf;
+	int			 i;
+
+	if (!test_runable(arg, dts_ec_grp_size + 1))
+		skip();
+
+	oid = dts_oid_gen(dts_ec_obj_class, 0, arg->myrank);
+	ioreq_init(&req, arg->coh, oid, DAOS_IOD_ARRAY, arg);
+
+	D_ALLOC(data, EC_DEGRADED_DATA_SIZE);
+	assert_non_null(data);
+	D_ALLOC(fetch_buf, EC_DEGRADED_DATA_SIZE);
+	assert_non_null(fetch_buf);
+	for (i = 0; i < EC_DEGRADED_DATA_SIZE; i++)
+		data[i] = 'a' + i % 26;
+
+	recx.rx_idx = 0;
+	recx.rx_nr = EC_DEGRADED_DATA_SIZE;
+	insert_recxs("degraded ec dkey", "degraded ec akey", 1, DAOS_TX_NONE,
+		     &recx, 1, data, EC_DEGRADED_DATA_SIZE, &req);
+
+	ec_degraded_kill(arg, oid);
+
+	print_message("fetch with the first data target lost\n");
+	lookup_recxs("degraded ec dkey", "degraded ec akey", 1, DAOS_TX_NONE,
+		     &recx, 1, fetch_buf, EC_DEGRADED_DATA_SIZE, &req);
+	assert_memory_equal(data, fetch_buf, EC_DEGRADED_DATA_SIZE);
+
+	ec_degraded_restore(arg);
+
+	ioreq_fini(&req);
+	D_FREE(data);
+	D_FREE(fetch_buf);
+}
+
+/**
+ * Write a sub-stripe extent to an EC object, which is replicated to the
+ * parity targets instead of being encoded, lose the target of the first data
+ * cell and verify the extent is read back from the replica. A stripe with
+ * both parity and partial updates must read back whichever is newer.
+ */
+static void
+io_degraded_ec_partial_fetch(void **state)
+{
+	test_arg_t		*arg = *state;
+	struct daos_oclass_attr	*oca;
+	daos_obj_id_t		 oid;
+	struct ioreq		 req;
+	daos_recx_t		 recx;
+	char			*data;
+	char			*fetch_buf;
+	char			*expect;
+	int			 stripe;
+	int			 i;
+
+	if (!test_runable(arg, dts_ec_grp_size + 1))
+		skip();
+
+	oid = dts_oid_gen(dts_ec_obj_class, 0, arg->myrank);
+	ioreq_init(&req, arg->coh, oid, DAOS_IOD_ARRAY, arg);
+	oca = daos_oclass_attr_find(oid);
+	assert_non_null(oca);
+	stripe = oca->u.ec.e_k * oca->u.ec.e_len;
+
+	D_ALLOC(data, EC_DEGRADED_DATA_SIZE);
+	assert_non_null(data);
+	D_ALLOC(fetch_buf, EC_DEGRADED_DATA_SIZE);
+	assert_non_null(fetch_buf);
+	D_ALLOC(expect, EC_DEGRADED_DATA_SIZE);
+	assert_non_null(expect);
+	for (i = 0; i < EC_DEGRADED_DATA_SIZE; i++)
+		data[i] = 'a' + i % 26;
+
+	/* starts and ends inside the first stripe, over two data cells */
+	recx.rx_idx = 3;
+	recx.rx_nr = stripe - 6;
+	insert_recxs("partial ec dkey", "degraded ec akey", 1, DAOS_TX_NONE,
+		     &recx, 1, data, recx.rx_nr, &req);
+
+	/* full stripes then a partial overwrite of the first one */
+	recx.rx_idx = 0;
+	recx.rx_nr = EC_DEGRADED_DATA_SIZE;
+	insert_recxs("mixed ec dkey", "degraded ec akey", 1, DAOS_TX_NONE,
+		     &recx, 1, data, EC_DEGRADED_DATA_SIZE, &req);
+	recx.rx_idx = 3;
+	recx.rx_nr = stripe - 6;
+	insert_recxs("mixed ec dkey", "degraded ec akey", 1, DAOS_TX_NONE,
+		     &recx, 1, data + 1, recx.rx_nr, &req);
+
+	/* a partial update then full stripes over it */
+	recx.rx_idx = 3;
+	recx.rx_nr = stripe - 6;
+	insert_recxs("covered ec dkey", "degraded ec akey", 1, DAOS_TX_NONE,
+		     &recx, 1, data + 2, recx.rx_nr, &req);
+	recx.rx_idx = 0;
+	recx.rx_nr = EC_DEGRADED_DATA_SIZE;
+	insert_recxs("covered ec dkey", "degraded ec akey", 1, DAOS_TX_NONE,
+		     &recx, 1, data, EC_DEGRADED_DATA_SIZE, &req);
+
+	ec_degraded_kill(arg, oid);
+
+	print_message("fetch sub-stripe extent with the first data target "
+		      "lost\n");
+	recx.rx_idx = 3;
+	recx.rx_nr = stripe - 6;
+	lookup_recxs("partial ec dkey", "degraded ec akey", 1, DAOS_TX_NONE,
+		     &recx, 1, fetch_buf, recx.rx_nr, &req);
+	assert_memory_equal(data, fetch_buf, recx.rx_nr);
+
+	print_message("fetch stripe with parity and newer partial update\n");
+	memcpy(expect, data, stripe);
+	memcpy(expect + 3, data + 1, stripe - 6);
+	recx.rx_idx = 0;
+	recx.rx_nr = stripe;
+	lookup_recxs("mixed ec dkey", "degraded ec akey", 1, DAOS_TX_NONE,
+		     &recx, 1, fetch_buf, recx.rx_nr, &req);
+	assert_memory_equal(expect, fetch_buf, stripe);
+
+	print_message("fetch stripe with parity and older partial update\n");
+	lookup_recxs("covered ec dkey", "degraded ec akey", 1, DAOS_TX_NONE,
+		     &recx, 1, fetch_buf, recx.rx_nr, &req);
+	assert_memory_equal(data, fetch_buf, stripe);
+
+	ec_degraded_restore(arg);
+
+	ioreq_fini(&req);
+	D_FREE(data);
+	D_FREE(fetch_buf);
+	D_FREE(expect);
+}
+
 /** create a new pool/container for each test */
 static const struct CMUnitTest degraded_tests[] = {
 	{"DEGRADED1: Degraded mode during updates",
@@ -261,6 +443,10 @@ static const struct CMUnitTest degraded_tests[] = {
 	 io_degraded_lookup_demo, NULL, test_case_teardown},
 	{"DEGRADED3: Degraded mode during enumerate",
 	 io_degraded_enum_demo, NULL, test_case_teardown},
+	{"DEGRADED4: EC fetch with lost data target",
+	 io_degraded_ec_fetch, NULL, test_case_teardown},
+	{"DEGRADED5: EC fetch of partial stripe with lost data target",
+	 io_degraded_ec_partial_fetch, NULL, test_case_teardown},
 };
 
 static int
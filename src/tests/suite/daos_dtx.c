@@ -673,6 +673,91 @@ dtx_17(void **state)
 	ioreq_fini(&req);
 }
 
+static void
+dtx_piggyback(void **state, bool fail)
+{
+	test_arg_t	*arg = *state;
+	char		*update_buf;
+	const char	*dkey = dts_dtx_dkey;
+	const char	*akey1 = "akey-1";
+	const char	*akey2 = "akey-2";
+	const char	*akey3 = "akey-3";
+	daos_obj_id_t	 oid;
+	struct ioreq	 req;
+	int		 rc;
+
+	if (!test_runable(arg, dts_dtx_replica_cnt))
+		return;
+
+	D_ALLOC(update_buf, dts_dtx_iosize);
+	assert_non_null(update_buf);
+	dts_buf_render(update_buf, dts_dtx_iosize);
+
+	oid = dts_oid_gen(dts_dtx_class, 0, arg->myrank);
+	arg->async = 0;
+	ioreq_init(&req, arg->coh, oid, DAOS_IOD_SINGLE, arg);
+
+	/* The DTXs can only be committed on the non-leaders by piggy-backing
+	 * them on the next modification of the same object.
+	 */
+	dtx_set_fail_loc(arg, DAOS_DTX_NO_BATCHED_COMMIT | DAOS_FAIL_ALWAYS);
+
+	/* Asynchronously commit the 1st update. */
+	insert_single(dkey, akey1, 0, update_buf, dts_dtx_iosize,
+		      DAOS_TX_NONE, &req);
+
+	if (fail) {
+		/* The non-leaders fail the 2nd update before committing the
+		 * piggy-backed DTX, the leader has to keep it in CoS.
+		 */
+		dtx_set_fail_loc(arg, DAOS_DTX_NONLEADER_REJECT |
+				 DAOS_FAIL_ALWAYS);
+		arg->expect_result = -DER_IO;
+		insert_single(dkey, akey2, 0, update_buf, dts_dtx_iosize,
+			      DAOS_TX_NONE, &req);
+		arg->expect_result = 0;
+		dtx_set_fail_loc(arg, DAOS_DTX_NO_BATCHED_COMMIT |
+				 DAOS_FAIL_ALWAYS);
+
+		daos_fail_loc_set(DAOS_OBJ_SPECIAL_SHARD | DAOS_FAIL_ALWAYS);
+		rc = dtx_check_replicas_v2(dkey, akey1, "piggyback_fail",
+					   update_buf, dts_dtx_iosize, false,
+					   &req);
+		daos_fail_loc_set(0);
+		/* Only the leader has committed the 1st update. */
+		assert_int_equal(rc, 1);
+	}
+
+	/* Piggy-back the DTX of the 1st update on the next one. */
+	insert_single(dkey, akey3, 0, update_buf, dts_dtx_iosize,
+		      DAOS_TX_NONE, &req);
+
+	daos_fail_loc_set(DAOS_OBJ_SPECIAL_SHARD | DAOS_FAIL_ALWAYS);
+	rc = dtx_check_replicas_v2(dkey, akey1, "piggyback", update_buf,
+				   dts_dtx_iosize, false, &req);
+	daos_fail_loc_set(0);
+	assert_int_equal(rc, dts_dtx_replica_cnt);
+
+	dtx_set_fail_loc(arg, 0);
+
+	D_FREE(update_buf);
+	ioreq_fini(&req);
+}
+
+static void
+dtx_18(void **state)
+{
+	print_message("Commit piggy-backed DTX without DTX_COMMIT RPC\n");
+	dtx_piggyback(state, false);
+}
+
+static void
+dtx_19(void **state)
+{
+	print_message("Keep piggy-backed DTX in CoS if non-leader failed\n");
+	dtx_piggyback(state, true);
+}
+
 static const struct CMUnitTest dtx_tests[] = {
 	{"DTX1: update/punch single value with DTX successfully",
 	 dtx_1, NULL, test_case_teardown},
@@ -708,6 +793,10 @@ static const struct CMUnitTest dtx_tests[] = {
 	 dtx_16, NULL, test_case_teardown},
 	{"DTX17: DTX resync during open-close",
 	 dtx_17, NULL, test_case_teardown},
+	{"DTX18: Commit piggy-backed DTX without DTX_COMMIT RPC",
+	 dtx_18, NULL, test_case_teardown},
+	{"DTX19: Keep piggy-backed DTX in CoS if non-leader failed",
+	 dtx_19, NULL, test_case_teardown},
 };
 
 int
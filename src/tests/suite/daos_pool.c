@@ -89,6 +89,10 @@ pool_connect(void **state)
 		assert_int_equal(rc, 0);
 		WAIT_ON_ASYNC(arg, ev);
 		assert_int_equal(info.pi_ndisabled, 0);
+		assert_int_equal(info.pi_obj_cache.poc_ntargets,
+				 info.pi_space.ps_ntargets);
+		assert_true(info.pi_obj_cache.poc_cached <=
+			    info.pi_obj_cache.poc_size);
 		print_message("success\n");
 	}
 
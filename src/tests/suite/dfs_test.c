@@ -463,6 +463,69 @@ dfs_test_short_read(void **state)
 	D_FREE(rsgl.sg_iovs);
 }
 
+static void
+dfs_test_dcache(void **state)
+{
+	test_arg_t		*arg = *state;
+	dfs_obj_t		*dir, *obj;
+	mode_t			mode;
+	char			*dname = "dcache_dir";
+	int			i, rc;
+
+	if (arg->myrank != 0)
+		return;
+
+	rc = dfs_set_dcache(dfs_mt, 60);
+	assert_int_equal(rc, 0);
+
+	rc = dfs_mkdir(dfs_mt, NULL, dname, S_IWUSR | S_IRUSR | S_IXUSR);
+	assert_int_equal(rc, 0);
+	rc = dfs_lookup(dfs_mt, "/dcache_dir", O_RDWR, &dir, &mode, NULL);
+	assert_int_equal(rc, 0);
+	assert_true(S_ISDIR(mode));
+	rc = dfs_open(dfs_mt, dir, "f", S_IFREG | S_IWUSR | S_IRUSR,
+		      O_RDWR | O_CREAT, 0, 0, NULL, &obj);
+	assert_int_equal(rc, 0);
+	rc = dfs_release(obj);
+	assert_int_equal(rc, 0);
+
+	/** the first lookup populates the cache, the others hit it */
+	for (i = 0; i < 3; i++) {
+		rc = dfs_lookup(dfs_mt, "/dcache_dir/f", O_RDONLY, &obj, &mode,
+				NULL);
+		assert_int_equal(rc, 0);
+		assert_true(S_ISREG(mode));
+		rc = dfs_release(obj);
+		assert_int_equal(rc, 0);
+	}
+
+	/** a local move invalidates the cached entry */
+	rc = dfs_move(dfs_mt, dir, "f", dir, "g", NULL);
+	assert_int_equal(rc, 0);
+	rc = dfs_lookup(dfs_mt, "/dcache_dir/f", O_RDONLY, &obj, &mode, NULL);
+	assert_int_equal(rc, ENOENT);
+	rc = dfs_lookup(dfs_mt, "/dcache_dir/g", O_RDONLY, &obj, &mode, NULL);
+	assert_int_equal(rc, 0);
+	rc = dfs_release(obj);
+	assert_int_equal(rc, 0);
+
+	/** so does a local remove */
+	rc = dfs_remove(dfs_mt, dir, "g", false, NULL);
+	assert_int_equal(rc, 0);
+	rc = dfs_lookup(dfs_mt, "/dcache_dir/g", O_RDONLY, &obj, &mode, NULL);
+	assert_int_equal(rc, ENOENT);
+
+	rc = dfs_release(dir);
+	assert_int_equal(rc, 0);
+	rc = dfs_remove(dfs_mt, NULL, dname, false, NULL);
+	assert_int_equal(rc, 0);
+	rc = dfs_lookup(dfs_mt, "/dcache_dir", O_RDONLY, &dir, &mode, NULL);
+	assert_int_equal(rc, ENOENT);
+
+	rc = dfs_set_dcache(dfs_mt, 0);
+	assert_int_equal(rc, 0);
+}
+
 static const struct CMUnitTest dfs_tests[] = {
 	{ "DFS_TEST1: DFS mount / umount",
 	  dfs_test_mount, async_disable, test_case_teardown},
@@ -470,6 +533,8 @@ static const struct CMUnitTest dfs_tests[] = {
 	  dfs_test_short_read, async_disable, test_case_teardown},
 	{ "DFS_TEST3: multi-threads read shared file",
 	  dfs_test_read_shared_file, async_disable, test_case_teardown},
+	{ "DFS_TEST4: DFS dentry cache",
+	  dfs_test_dcache, async_disable, test_case_teardown},
 };
 
 static int
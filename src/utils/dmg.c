@@ -524,6 +524,7 @@ pool_op_hdlr(int argc, char *argv[])
 		daos_pool_info_t		 pinfo = {0};
 		struct daos_pool_space		*ps = &pinfo.pi_space;
 		struct daos_rebuild_status	*rstat = &pinfo.pi_rebuild_st;
+		struct daos_pool_obj_cache	*poc = &pinfo.pi_obj_cache;
 		int				 i;
 
 		pinfo.pi_bits = DPI_ALL;
@@ -565,6 +566,14 @@ pool_op_hdlr(int argc, char *argv[])
 			D_PRINT("Rebuild failed, rc=%d, status=%d\n",
 				rc, rstat->rs_errno);
 		}
+
+		D_PRINT("Object cache info:\n");
+		D_PRINT("- Target(VOS) count:%u\n", poc->poc_ntargets);
+		D_PRINT("- Hits: "DF_U64", misses: "DF_U64", evictions: "
+			DF_U64"\n", poc->poc_hits, poc->poc_misses,
+			poc->poc_evictions);
+		D_PRINT("- Cached: "DF_U64", size: "DF_U64", resizes: %u\n",
+			poc->poc_cached, poc->poc_size, poc->poc_resizes);
 	}
 
 	/* Disconnect from the pool for operations that need a connection. */
@@ -610,6 +610,183 @@ ut_reserve_special(void **state)
 	ut_teardown(&args);
 }
 
+static void
+ut_reserve_cache(void **state)
+{
+	/* Use a temporary device instead of the main one the other tests use */
+	struct vea_ut_args args;
+	struct vea_hint_context *h_ctxt;
+	struct vea_resrvd_ext *ext;
+	struct vea_unmap_context unmap_ctxt;
+	struct vea_stat stat;
+	d_list_t *r_list;
+	uint64_t off;
+	uint32_t hdr_blks = 1;
+	uint64_t capacity = ((VEA_LARGE_EXT_MB * 2) << 20); /* 128MB */
+	uint32_t blk_sz = 0; /* use the default size */
+	uint32_t cache_blks = 64;
+	int rc;
+
+	ut_setup(&args);
+
+	rc = vea_format(&args.vua_umm, &args.vua_txd, args.vua_md, blk_sz,
+			hdr_blks, capacity, NULL, NULL, false);
+	assert_int_equal(rc, 0);
+
+	unmap_ctxt.vnc_unmap = NULL;
+	unmap_ctxt.vnc_data = NULL;
+	rc = vea_load(&args.vua_umm, &args.vua_txd, args.vua_md, &unmap_ctxt,
+		      &args.vua_vsi);
+	assert_int_equal(rc, 0);
+
+	rc = vea_hint_load(args.vua_hint[0], &h_ctxt);
+	assert_int_equal(rc, 0);
+	vea_hint_set_cache(h_ctxt, cache_blks);
+
+	r_list = &args.vua_resrvd_list[0];
+
+	print_message("reserve without reservation in flight\n");
+	rc = vea_reserve(args.vua_vsi, 4, h_ctxt, r_list);
+	assert_int_equal(rc, 0);
+	ext = d_list_entry(r_list->prev, struct vea_resrvd_ext, vre_link);
+	off = ext->vre_blk_off + ext->vre_blk_cnt;
+
+	print_message("reserve with reservation in flight\n");
+	rc = vea_reserve(args.vua_vsi, 4, h_ctxt, r_list);
+	assert_int_equal(rc, 0);
+	ext = d_list_entry(r_list->prev, struct vea_resrvd_ext, vre_link);
+	assert_int_equal(ext->vre_blk_off, off);
+	assert_int_equal(ext->vre_blk_cnt, 4);
+	off += 4;
+
+	/* The pre-reserved blocks are invisible for allocation */
+	rc = vea_verify_alloc(args.vua_vsi, true, off, cache_blks);
+	assert_int_equal(rc, 0);
+
+	print_message("reserve from the cache\n");
+	rc = vea_reserve(args.vua_vsi, 8, h_ctxt, r_list);
+	assert_int_equal(rc, 0);
+	ext = d_list_entry(r_list->prev, struct vea_resrvd_ext, vre_link);
+	assert_int_equal(ext->vre_blk_off, off);
+	assert_int_equal(ext->vre_blk_cnt, 8);
+	off += 8;
+
+	rc = vea_query(args.vua_vsi, NULL, &stat);
+	assert_int_equal(rc, 0);
+	assert_int_equal(stat.vs_resrv_cache, 1);
+
+	print_message("publish and return the unused cache\n");
+	rc = umem_tx_begin(&args.vua_umm, &args.vua_txd);
+	assert_int_equal(rc, 0);
+
+	rc = vea_tx_publish(args.vua_vsi, h_ctxt, r_list);
+	assert_int_equal(rc, 0);
+
+	rc = umem_tx_commit(&args.vua_umm);
+	assert_int_equal(rc, 0);
+
+	/* The unused pre-reserved blocks are free again */
+	rc = vea_verify_alloc(args.vua_vsi, true, off, cache_blks - 8);
+	assert_int_equal(rc, 1);
+	rc = vea_verify_alloc(args.vua_vsi, false, off, cache_blks - 8);
+	assert_int_equal(rc, 1);
+	/* The reserved blocks are allocated */
+	rc = vea_verify_alloc(args.vua_vsi, false, off - 16, 16);
+	assert_int_equal(rc, 0);
+
+	vea_hint_unload(h_ctxt);
+	vea_unload(args.vua_vsi);
+	ut_teardown(&args);
+}
+
+static void
+ut_frag_index(void **state)
+{
+	/* Use a temporary device instead of the main one the other tests use */
+	struct vea_ut_args args;
+	struct vea_resrvd_ext *ext;
+	struct vea_unmap_context unmap_ctxt;
+	struct vea_stat stat;
+	d_list_t *r_list;
+	uint64_t blk_off[3];
+	uint32_t blk_cnt[3];
+	uint32_t hdr_blks = 1;
+	uint64_t capacity = ((VEA_LARGE_EXT_MB * 2) << 20); /* 128MB */
+	uint32_t blk_sz = 0; /* use the default size */
+	uint32_t tot_blks;
+	int rc, i;
+
+	ut_setup(&args);
+
+	rc = vea_format(&args.vua_umm, &args.vua_txd, args.vua_md, blk_sz,
+			hdr_blks, capacity, NULL, NULL, false);
+	assert_int_equal(rc, 0);
+
+	unmap_ctxt.vnc_unmap = NULL;
+	unmap_ctxt.vnc_data = NULL;
+	rc = vea_load(&args.vua_umm, &args.vua_txd, args.vua_md, &unmap_ctxt,
+		      &args.vua_vsi);
+	assert_int_equal(rc, 0);
+
+	print_message("fragmentation index of the empty device\n");
+	assert_int_equal(vea_frag_index(args.vua_vsi), 0);
+
+	rc = vea_query(args.vua_vsi, NULL, &stat);
+	assert_int_equal(rc, 0);
+	tot_blks = stat.vs_free_transient;
+
+	print_message("reserve and publish the whole device\n");
+	r_list = &args.vua_resrvd_list[0];
+	blk_cnt[1] = 8;
+	blk_cnt[2] = 16;
+	blk_cnt[0] = tot_blks - blk_cnt[1] - blk_cnt[2];
+	for (i = 0; i < 3; i++) {
+		rc = vea_reserve(args.vua_vsi, blk_cnt[i], NULL, r_list);
+		assert_int_equal(rc, 0);
+		ext = d_list_entry(r_list->prev, struct vea_resrvd_ext,
+				   vre_link);
+		blk_off[i] = ext->vre_blk_off;
+	}
+
+	rc = umem_tx_begin(&args.vua_umm, &args.vua_txd);
+	assert_int_equal(rc, 0);
+
+	rc = vea_tx_publish(args.vua_vsi, NULL, r_list);
+	assert_int_equal(rc, 0);
+
+	rc = umem_tx_commit(&args.vua_umm);
+	assert_int_equal(rc, 0);
+
+	assert_int_equal(vea_frag_index(args.vua_vsi), 0);
+
+	print_message("free the small extents\n");
+	for (i = 1; i < 3; i++) {
+		rc = vea_free(args.vua_vsi, blk_off[i], blk_cnt[i]);
+		assert_int_equal(rc, 0);
+	}
+	vea_flush(args.vua_vsi);
+
+	/* All the free space is in small extents */
+	rc = vea_query(args.vua_vsi, NULL, &stat);
+	assert_int_equal(rc, 0);
+	assert_int_equal(stat.vs_frag_idx, 100);
+	assert_int_equal(vea_frag_index(args.vua_vsi), 100);
+
+	print_message("free the large extent\n");
+	rc = vea_free(args.vua_vsi, blk_off[0], blk_cnt[0]);
+	assert_int_equal(rc, 0);
+	vea_flush(args.vua_vsi);
+
+	/* All the free extents are coalesced into a large one */
+	rc = vea_query(args.vua_vsi, NULL, &stat);
+	assert_int_equal(rc, 0);
+	assert_int_equal(stat.vs_frag_idx, 0);
+	assert_int_equal(stat.vs_largest_blks, tot_blks);
+
+	vea_unload(args.vua_vsi);
+	ut_teardown(&args);
+}
+
 static void
 ut_inval_params_format(void **state)
 {
@@ -1273,6 +1450,8 @@ static const struct CMUnitTest vea_uts[] = {
 	{ "vea_hint_unload", ut_hint_unload, NULL, NULL},
 	{ "vea_unload", ut_unload, NULL, NULL},
 	{ "vea_reserve_special", ut_reserve_special, NULL, NULL},
+	{ "vea_reserve_cache", ut_reserve_cache, NULL, NULL},
+	{ "vea_frag_index", ut_frag_index, NULL, NULL},
 	{ "vea_inval_params_format", ut_inval_params_format, NULL, NULL},
 	{ "vea_inval_params_load", ut_inval_params_load, NULL, NULL},
 	{ "vea_inval_param_reserve", ut_inval_params_reserve, NULL, NULL},
@@ -36,6 +36,11 @@ free_class_remove(struct vea_free_class *vfc, struct vea_entry *entry)
 			  vfc->vfc_large_thresh);
 		d_binheap_remove(&vfc->vfc_heap, &entry->ve_node);
 		entry->ve_in_heap = 0;
+		D_ASSERT(vfc->vfc_large_blks >= entry->ve_ext.vfe_blk_cnt);
+		vfc->vfc_large_blks -= entry->ve_ext.vfe_blk_cnt;
+	} else if (!d_list_empty(&entry->ve_link)) {
+		D_ASSERT(vfc->vfc_small_blks >= entry->ve_ext.vfe_blk_cnt);
+		vfc->vfc_small_blks -= entry->ve_ext.vfe_blk_cnt;
 	}
 	d_list_del_init(&entry->ve_link);
 }
@@ -78,6 +83,34 @@ compound_alloc(struct vea_space_info *vsi, struct vea_free_extent *vfe,
 	return rc;
 }
 
+int
+reserve_cache(struct vea_space_info *vsi, struct vea_hint_context *hint,
+	      uint32_t blk_cnt, struct vea_resrvd_ext *resrvd)
+{
+	struct vea_free_extent *cache;
+
+	if (hint == NULL || hint->vhc_cache.vfe_blk_cnt == 0)
+		return 0;
+
+	/* Return the leftover and go through the normal reserve */
+	cache = &hint->vhc_cache;
+	if (cache->vfe_blk_cnt < blk_cnt)
+		return hint_cache_return(vsi, hint);
+
+	resrvd->vre_blk_off = cache->vfe_blk_off;
+	resrvd->vre_blk_cnt = blk_cnt;
+
+	cache->vfe_blk_off += blk_cnt;
+	cache->vfe_blk_cnt -= blk_cnt;
+
+	vsi->vsi_stat[STAT_RESRV_CACHE] += 1;
+
+	D_DEBUG(DB_IO, "["DF_U64", %u]\n", resrvd->vre_blk_off,
+		resrvd->vre_blk_cnt);
+
+	return 0;
+}
+
 int
 reserve_hint(struct vea_space_info *vsi, uint32_t blk_cnt,
 	     struct vea_resrvd_ext *resrvd)
@@ -292,6 +292,7 @@ error:
  *
  * Reserve attempting order:
  *
+ * 0. Reserve from the blocks pre-reserved for the I/O stream. (vhc_cache)
  * 1. Reserve from the free extent with 'hinted' start offset. (vsi_free_tree)
  * 2. Reserve from the largest free extent if it isn't non-active (extent age
  *    isn't VEA_EXT_AGE_MAX), otherwise, divide it in half-and-half and resreve
@@ -300,12 +301,17 @@ error:
  *    policy, larger & older free extent has priority. (vfc_lrus)
  * 4. Repeat the search in 3rd step to reserve an extent vector. (vsi_vec_tree)
  * 5. Fail reserve with ENOMEM if all above attempts fail.
+ *
+ * When the reservation cache of the I/O stream is enabled and there is
+ * reservation in flight, extra blocks are reserved in step 1 ~ 4 and kept in
+ * the cache for the following reserves, see vea_hint_set_cache().
  */
 int
 vea_reserve(struct vea_space_info *vsi, uint32_t blk_cnt,
 	    struct vea_hint_context *hint, d_list_t *resrvd_list)
 {
 	struct vea_resrvd_ext *resrvd;
+	uint32_t resrv_cnt;
 	bool retry = true;
 	int rc = 0;
 
@@ -322,35 +328,47 @@ vea_reserve(struct vea_space_info *vsi, uint32_t blk_cnt,
 	/* Get hint offset */
 	hint_get(hint, &resrvd->vre_hint_off);
 
+	/* Reserve from the pre-reserved blocks of the I/O stream */
+	rc = reserve_cache(vsi, hint, blk_cnt, resrvd);
+	if (rc != 0)
+		goto error;
+	else if (resrvd->vre_blk_cnt != 0)
+		goto done;
+
+	/* Pre-reserve blocks for the I/O stream along with this reserve */
+	resrv_cnt = blk_cnt + hint_cache_blks(hint, blk_cnt);
 migrate:
 	/* Trigger free extents migration */
 	migrate_free_exts(vsi);
 
 	/* Reserve from hint offset */
-	rc = reserve_hint(vsi, blk_cnt, resrvd);
+	rc = reserve_hint(vsi, resrv_cnt, resrvd);
 	if (rc != 0)
 		goto error;
 	else if (resrvd->vre_blk_cnt != 0)
 		goto done;
 
 	/* Reserve from the large extents */
-	rc = reserve_large(vsi, blk_cnt, resrvd);
+	rc = reserve_large(vsi, resrv_cnt, resrvd);
 	if (rc != 0)
 		goto error;
 	else if (resrvd->vre_blk_cnt != 0)
 		goto done;
 
 	/* Reserve from the small extents */
-	rc = reserve_small(vsi, blk_cnt, resrvd);
+	rc = reserve_small(vsi, resrv_cnt, resrvd);
 	if (rc != 0)
 		goto error;
 	else if (resrvd->vre_blk_cnt != 0)
 		goto done;
 
 	/* Reserve extent vector as the last resort */
-	rc = reserve_vector(vsi, blk_cnt, resrvd);
+	rc = reserve_vector(vsi, resrv_cnt, resrvd);
 
-	if (rc == -DER_NOSPACE && retry) {
+	if (rc == -DER_NOSPACE && resrv_cnt > blk_cnt) {
+		resrv_cnt = blk_cnt; /* give up pre-reserve */
+		goto migrate;
+	} else if (rc == -DER_NOSPACE && retry) {
 		vsi->vsi_agg_time = 0; /* force free extents migration */
 		retry = false;
 		goto migrate;
@@ -359,10 +377,15 @@ migrate:
 	}
 done:
 	D_ASSERT(resrvd->vre_blk_off != VEA_HINT_OFF_INVAL);
+	/* Keep the pre-reserved blocks in the cache of I/O stream */
+	if (resrvd->vre_blk_cnt > blk_cnt)
+		hint_cache_fill(hint, resrvd, blk_cnt);
 	D_ASSERT(resrvd->vre_blk_cnt == blk_cnt);
 	/* Update hint offset */
 	hint_update(hint, resrvd->vre_blk_off + blk_cnt,
 		    &resrvd->vre_hint_seq);
+	if (hint != NULL)
+		hint->vhc_resrvd_cnt++;
 
 	d_list_add_tail(&resrvd->vre_link, resrvd_list);
 
@@ -381,7 +404,8 @@ process_resrvd_list(struct vea_space_info *vsi, struct vea_hint_context *hint,
 	unsigned int flags = VEA_FL_GEN_AGE;
 	uint64_t seq_max = 0, seq_min = 0;
 	uint64_t off_c = 0, off_p = 0;
-	int rc = 0;
+	unsigned int resrvd_cnt = 0;
+	int rc = 0, ret;
 
 	if (d_list_empty(resrvd_list))
 		return 0;
@@ -435,9 +459,11 @@ error:
 	d_list_for_each_entry_safe(resrvd, tmp, resrvd_list, vre_link) {
 		d_list_del_init(&resrvd->vre_link);
 		D_FREE(resrvd);
+		resrvd_cnt++;
 	}
 
-	return rc;
+	ret = hint_resrvd_put(vsi, hint, resrvd_cnt);
+	return rc ? : ret;
 }
 
 /* Cancel the reserved extent(s) */
@@ -608,9 +634,26 @@ vea_hint_load(struct vea_hint_df *phd, struct vea_hint_context **thc)
 void
 vea_hint_unload(struct vea_hint_context *thc)
 {
+	/*
+	 * The pre-reserved blocks are returned once there isn't reservation
+	 * in flight, they are leaked (till next vea_load) if the I/O stream
+	 * is unloaded with outstanding reservations.
+	 */
+	if (thc->vhc_cache.vfe_blk_cnt != 0)
+		D_ERROR("Unload hint with pre-reserved ["DF_U64", %u]\n",
+			thc->vhc_cache.vfe_blk_off,
+			thc->vhc_cache.vfe_blk_cnt);
 	D_FREE(thc);
 }
 
+/* Enable or disable the reservation cache of an I/O stream */
+void
+vea_hint_set_cache(struct vea_hint_context *thc, uint32_t blk_cnt)
+{
+	D_ASSERT(thc != NULL);
+	thc->vhc_cache_max = blk_cnt;
+}
+
 static int
 count_free_persistent(daos_handle_t ih, d_iov_t *key, d_iov_t *val,
 		      void *arg)
@@ -716,11 +759,20 @@ vea_query(struct vea_space_info *vsi, struct vea_attr *attr,
 		stat->vs_resrv_large = vsi->vsi_stat[STAT_RESRV_LARGE];
 		stat->vs_resrv_small = vsi->vsi_stat[STAT_RESRV_SMALL];
 		stat->vs_resrv_vec = vsi->vsi_stat[STAT_RESRV_VEC];
+		stat->vs_resrv_cache = vsi->vsi_stat[STAT_RESRV_CACHE];
+		stat->vs_frag_idx = frag_index(vfc);
 	}
 
 	return 0;
 }
 
+unsigned int
+vea_frag_index(struct vea_space_info *vsi)
+{
+	D_ASSERT(vsi != NULL);
+	return frag_index(&vsi->vsi_class);
+}
+
 void
 vea_flush(struct vea_space_info *vsi)
 {
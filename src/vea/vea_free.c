@@ -201,6 +201,7 @@ compound_free(struct vea_space_info *vsi, struct vea_free_extent *vfe,
 			return rc;
 
 		entry->ve_in_heap = 1;
+		vfc->vfc_large_blks += entry->ve_ext.vfe_blk_cnt;
 	} else { /* Otherwise add to one of size categarized LRU */
 		struct vea_entry *cur;
 		d_list_t *lru_head, *tmp;
@@ -225,6 +226,7 @@ compound_free(struct vea_space_info *vsi, struct vea_free_extent *vfe,
 			if (d_list_empty(&entry->ve_link))
 				d_list_add(&entry->ve_link, lru_head);
 		}
+		vfc->vfc_small_blks += entry->ve_ext.vfe_blk_cnt;
 	}
 
 	return 0;
@@ -389,6 +391,10 @@ migrate_end_cb(void *data, bool noop)
 	/* Update aggregation time before yield */
 	vsi->vsi_agg_time = cur_time;
 
+	D_DEBUG(DB_IO, "Fragmentation index: %u, large free blks: "DF_U64", "
+		"small free blks: "DF_U64"\n", frag_index(&vsi->vsi_class),
+		vsi->vsi_class.vfc_large_blks, vsi->vsi_class.vfc_small_blks);
+
 	/*
 	 * According to NVMe spec, unmap isn't an expensive non-queue command
 	 * anymore, so we should just unmap as soon as the extent is freed.
@@ -420,6 +426,22 @@ migrate_end_cb(void *data, bool noop)
 	}
 }
 
+/*
+ * Fragmentation index: percentage of the free blocks scattered in the small
+ * free extents (not larger than the large extent threshold), which can't
+ * satisfy large allocation requests.
+ */
+unsigned int
+frag_index(struct vea_free_class *vfc)
+{
+	uint64_t tot_blks = vfc->vfc_large_blks + vfc->vfc_small_blks;
+
+	if (tot_blks == 0)
+		return 0;
+
+	return (vfc->vfc_small_blks * 100) / tot_blks;
+}
+
 void
 migrate_free_exts(struct vea_space_info *vsi)
 {
@@ -114,3 +114,74 @@ hint_tx_publish(struct umem_instance *umm, struct vea_hint_context *hint,
 
 	return -DER_INVAL;
 }
+
+/*
+ * How many blocks to be pre-reserved along with the @blk_cnt reserve. Only
+ * pre-reserve when the I/O stream has reservation in flight, so that single
+ * reserve -> publish won't pay for returning the unused blocks.
+ */
+uint32_t
+hint_cache_blks(struct vea_hint_context *hint, uint32_t blk_cnt)
+{
+	if (hint == NULL || hint->vhc_cache_max == 0 ||
+	    hint->vhc_resrvd_cnt == 0)
+		return 0;
+
+	/* Large reserve doesn't benefit from cache */
+	if (blk_cnt >= hint->vhc_cache_max)
+		return 0;
+
+	D_ASSERT(hint->vhc_cache.vfe_blk_cnt == 0);
+	return hint->vhc_cache_max;
+}
+
+/* Keep the pre-reserved tail of @resrvd in the cache of I/O stream */
+void
+hint_cache_fill(struct vea_hint_context *hint, struct vea_resrvd_ext *resrvd,
+		uint32_t blk_cnt)
+{
+	D_ASSERT(hint != NULL);
+	D_ASSERT(resrvd->vre_blk_cnt > blk_cnt);
+	D_ASSERT(hint->vhc_cache.vfe_blk_cnt == 0);
+
+	hint->vhc_cache.vfe_blk_off = resrvd->vre_blk_off + blk_cnt;
+	hint->vhc_cache.vfe_blk_cnt = resrvd->vre_blk_cnt - blk_cnt;
+	resrvd->vre_blk_cnt = blk_cnt;
+}
+
+/* Return the unused pre-reserved blocks to the compound index */
+int
+hint_cache_return(struct vea_space_info *vsi, struct vea_hint_context *hint)
+{
+	struct vea_free_extent	vfe;
+
+	if (hint == NULL || hint->vhc_cache.vfe_blk_cnt == 0)
+		return 0;
+
+	vfe = hint->vhc_cache;
+	hint->vhc_cache.vfe_blk_off = 0;
+	hint->vhc_cache.vfe_blk_cnt = 0;
+
+	D_DEBUG(DB_IO, "Return cache ["DF_U64", %u]\n", vfe.vfe_blk_off,
+		vfe.vfe_blk_cnt);
+	return compound_free(vsi, &vfe, VEA_FL_GEN_AGE);
+}
+
+/*
+ * @cnt reserved extents of the I/O stream are published or cancelled, the
+ * pre-reserved blocks are returned when no reservation in flight.
+ */
+int
+hint_resrvd_put(struct vea_space_info *vsi, struct vea_hint_context *hint,
+		unsigned int cnt)
+{
+	if (hint == NULL)
+		return 0;
+
+	/* The extents could be reserved without hint */
+	hint->vhc_resrvd_cnt -= min(hint->vhc_resrvd_cnt, cnt);
+	if (hint->vhc_resrvd_cnt != 0)
+		return 0;
+
+	return hint_cache_return(vsi, hint);
+}
@@ -85,6 +85,8 @@ create_free_class(struct vea_free_class *vfc, struct vea_space_df *md)
 	min_blks = (1U << 20) / md->vsd_blk_sz;
 
 	vfc->vfc_large_thresh = max_blks;
+	vfc->vfc_large_blks = 0;
+	vfc->vfc_small_blks = 0;
 	lru_cnt = 1;
 	while (max_blks > min_blks) {
 		max_blks >>= 1;
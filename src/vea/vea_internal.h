@@ -39,6 +39,12 @@ struct vea_hint_context {
 	uint64_t		 vhc_off;
 	/* In-memory hint sequence */
 	uint64_t		 vhc_seq;
+	/* Blocks pre-reserved for the I/O stream, see reserve_cache() */
+	struct vea_free_extent	 vhc_cache;
+	/* How many blocks to be pre-reserved, 0 means cache disabled */
+	uint32_t		 vhc_cache_max;
+	/* Reserved extents of the I/O stream not published/cancelled yet */
+	uint32_t		 vhc_resrvd_cnt;
 };
 
 /* Free extent informat stored in the in-memory compound free extent index */
@@ -88,6 +94,9 @@ struct vea_free_class {
 	 * from small extents.
 	 */
 	struct free_ext_cursor	*vfc_cursor;
+	/* Free blocks tracked by the heap and the size classed LRUs */
+	uint64_t		 vfc_large_blks;
+	uint64_t		 vfc_small_blks;
 };
 
 enum {
@@ -95,6 +104,7 @@ enum {
 	STAT_RESRV_LARGE,
 	STAT_RESRV_SMALL,
 	STAT_RESRV_VEC,
+	STAT_RESRV_CACHE,
 	STAT_MAX,
 };
 
@@ -164,6 +174,8 @@ int vea_verify_alloc(struct vea_space_info *vsi, bool transient,
 /* vea_alloc.c */
 void free_class_remove(struct vea_free_class *vfc, struct vea_entry *entry);
 int compound_vec_alloc(struct vea_space_info *vsi, struct vea_ext_vector *vec);
+int reserve_cache(struct vea_space_info *vsi, struct vea_hint_context *hint,
+		  uint32_t blk_cnt, struct vea_resrvd_ext *resrvd);
 int reserve_hint(struct vea_space_info *vsi, uint32_t blk_cnt,
 		 struct vea_resrvd_ext *resrvd);
 int reserve_large(struct vea_space_info *vsi, uint32_t blk_cnt,
@@ -180,6 +192,7 @@ int compound_free(struct vea_space_info *vsi, struct vea_free_extent *vfe,
 int persistent_free(struct vea_space_info *vsi, struct vea_free_extent *vfe);
 int aggregated_free(struct vea_space_info *vsi, struct vea_free_extent *vfe);
 void migrate_free_exts(struct vea_space_info *vsi);
+unsigned int frag_index(struct vea_free_class *vfc);
 
 /* vea_hint.c */
 void hint_get(struct vea_hint_context *hint, uint64_t *off);
@@ -188,5 +201,12 @@ int hint_cancel(struct vea_hint_context *hint, uint64_t off, uint64_t seq_min,
 		uint64_t seq_max);
 int hint_tx_publish(struct umem_instance *umm, struct vea_hint_context *hint,
 		    uint64_t off, uint64_t seq_min, uint64_t seq_max);
+uint32_t hint_cache_blks(struct vea_hint_context *hint, uint32_t blk_cnt);
+void hint_cache_fill(struct vea_hint_context *hint,
+		     struct vea_resrvd_ext *resrvd, uint32_t blk_cnt);
+int hint_cache_return(struct vea_space_info *vsi,
+		      struct vea_hint_context *hint);
+int hint_resrvd_put(struct vea_space_info *vsi, struct vea_hint_context *hint,
+		    unsigned int cnt);
 
 #endif /* __VEA_INTERNAL_H__ */
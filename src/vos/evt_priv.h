@@ -84,6 +84,8 @@ struct evt_context {
 	int				 tc_creds_on:1;
 	/** cached number of bytes per entry */
 	uint32_t			 tc_inob;
+	/** evt_ent_array_fill skipped unavailable extents */
+	bool				 tc_unavail;
 	/** cached tree feature bits (reduce PMEM access) */
 	uint64_t			 tc_feats;
 	/** memory instance (PMEM or DRAM) */
@@ -101,6 +103,54 @@ struct evt_context {
 	struct evt_desc_cbs		 tc_desc_cbs;
 };
 
+/** Number of sets and ways of the visible extent cache */
+#define EVT_VCACHE_SETS			64
+#define EVT_VCACHE_WAYS			4
+/** Queries returning more visible extents than this are not cached */
+#define EVT_VCACHE_ENT_MAX		128
+
+/** A cached evt_find result */
+struct evt_vcache_slot {
+	/** mapped address of the tree root, NULL for an unused slot */
+	struct evt_root			*vs_root;
+	/** pmemobj pool uuid of the tree */
+	uint64_t			 vs_pool_uuid;
+	/** epr_lo of the query */
+	daos_epoch_t			 vs_epr_lo;
+	/** range of epr_hi for which the query returns the same result */
+	daos_epoch_range_t		 vs_hi;
+	/** extent of the query */
+	struct evt_extent		 vs_ext;
+	/** clock of the last access, for replacement within a set */
+	uint64_t			 vs_stamp;
+	/** number of bytes per entry */
+	uint32_t			 vs_inob;
+	/** number of visible extents */
+	uint32_t			 vs_nr;
+	/** visible extents, in the order returned by evt_find */
+	struct evt_entry		*vs_ents;
+};
+
+/**
+ * Per-xstream cache of visible extents returned by evt_find, so repeated
+ * reads of the same region skip the fill and sort. A result is only cached
+ * if all its extents are committed. It serves any later query of the same
+ * extent and epr_lo whose epr_hi lies between the latest extent the result
+ * covers and the first extent above it, so reads at increasing epochs keep
+ * hitting. An insert or delete of an extent within the extent drops the
+ * result if the query could see it, and otherwise lowers the highest epr_hi
+ * the result serves.
+ */
+struct evt_vcache {
+	/** access clock */
+	uint64_t			 vc_clock;
+	uint64_t			 vc_hits;
+	uint64_t			 vc_misses;
+	/** set associative slots, the set is selected by the tree */
+	struct evt_vcache_slot		 vc_slots[EVT_VCACHE_SETS]
+						 [EVT_VCACHE_WAYS];
+};
+
 #define EVT_NODE_NULL			UMOFF_NULL
 #define EVT_ROOT_NULL			UMOFF_NULL
 
@@ -239,6 +289,15 @@ int evt_tcx_clone(struct evt_context *tcx, struct evt_context **tcx_pp);
  */
 int evt_node_delete(struct evt_context *tcx);
 
+/** Drop the cached visible extents of the tree affected by a modification
+ *
+ * \param[IN]	tcx	The tree context
+ * \param[IN]	rect	The inserted or deleted rectangle, NULL to drop all
+ *			cached results of the tree
+ */
+void evt_vcache_invalidate(struct evt_context *tcx,
+			   const struct evt_rect *rect);
+
 #define EVT_HDL_ALIVE	0xbabecafe
 #define EVT_HDL_DEAD	0xdeadbeef
 
@@ -879,6 +879,7 @@ evt_tcx_create(struct evt_root *root, uint64_t feats, unsigned int order,
 			DP_RC(rc));
 		D_GOTO(failed, rc);
 	}
+	tcx->tc_pmempool_uuid = umem_get_uuid(evt_umm(tcx));
 
 	if (feats != -1) { /* tree creation */
 		tcx->tc_feats	= feats;
@@ -1360,6 +1361,9 @@ evt_root_init(struct evt_context *tcx)
 	if (rc != 0)
 		return rc;
 
+	/* The root may be reused from a destroyed tree */
+	evt_vcache_invalidate(tcx, NULL);
+
 	root = tcx->tc_root;
 
 	root->tr_feats = tcx->tc_feats;
@@ -1463,6 +1467,8 @@ evt_root_destroy(struct evt_context *tcx, bool *destroyed)
 	int		 rc;
 	bool		 empty = true;
 
+	evt_vcache_invalidate(tcx, NULL);
+
 	root = tcx->tc_root;
 	if (root && !UMOFF_IS_NULL(root->tr_node)) {
 		/* destroy the root node and all descendants */
@@ -1813,6 +1819,8 @@ evt_insert(daos_handle_t toh, const struct evt_entry_in *entry)
 	if (rc != 0)
 		return rc;
 
+	evt_vcache_invalidate(tcx, &entry->ei_rect);
+
 	rc = evt_tx_begin(tcx);
 	if (rc != 0)
 		return rc;
@@ -1919,6 +1927,7 @@ evt_ent_array_fill(struct evt_context *tcx, enum evt_find_opc find_opc,
 
 	V_TRACE(DB_TRACE, "Searching rectangle "DF_RECT" opc=%d\n",
 		DP_RECT(rect), find_opc);
+	tcx->tc_unavail = false;
 	if (tcx->tc_root->tr_depth == 0)
 		return 0; /* empty tree */
 
@@ -1998,8 +2007,10 @@ evt_ent_array_fill(struct evt_context *tcx, enum evt_find_opc find_opc,
 			desc = evt_node_desc_at(tcx, node, i);
 			rc = evt_desc_log_status(tcx, desc, intent);
 			/* Skip the unavailable record. */
-			if (rc == ALB_UNAVAILABLE)
+			if (rc == ALB_UNAVAILABLE) {
+				tcx->tc_unavail = true;
 				continue;
+			}
 
 			/* early check */
 			switch (find_opc) {
@@ -2108,6 +2119,251 @@ out:
 	return rc;
 }
 
+int
+evt_vcache_create(struct evt_vcache **vcp)
+{
+	struct evt_vcache	*vc;
+
+	D_ALLOC_PTR(vc);
+	if (vc == NULL)
+		return -DER_NOMEM;
+
+	*vcp = vc;
+	return 0;
+}
+
+void
+evt_vcache_destroy(struct evt_vcache *vc)
+{
+	int	i;
+	int	j;
+
+	D_DEBUG(DB_IO, "evtree visible extent cache hits "DF_U64" misses "
+		DF_U64"\n", vc->vc_hits, vc->vc_misses);
+
+	for (i = 0; i < EVT_VCACHE_SETS; i++) {
+		for (j = 0; j < EVT_VCACHE_WAYS; j++)
+			D_FREE(vc->vc_slots[i][j].vs_ents);
+	}
+	D_FREE(vc);
+}
+
+static inline struct evt_vcache *
+evt_vcache_get(void)
+{
+	struct vos_tls	*tls = vos_tls_get();
+
+	/* NB: no cache for evtree used without VOS, e.g. evt_ctl */
+	return tls == NULL ? NULL : tls->vtl_imems_inst.vis_evt_vcache;
+}
+
+/** Return the set of slots which can cache queries of the tree */
+static struct evt_vcache_slot *
+evt_vcache_set(struct evt_vcache *vc, struct evt_context *tcx)
+{
+	uint64_t	root = (uint64_t)tcx->tc_root;
+	uint64_t	idx;
+
+	idx = d_hash_murmur64((unsigned char *)&root, sizeof(root),
+			      tcx->tc_pmempool_uuid) % EVT_VCACHE_SETS;
+	return vc->vc_slots[idx];
+}
+
+static inline bool
+evt_vcache_slot_owned(struct evt_vcache_slot *slot, struct evt_context *tcx)
+{
+	return slot->vs_root == tcx->tc_root &&
+	       slot->vs_pool_uuid == tcx->tc_pmempool_uuid;
+}
+
+static inline void
+evt_vcache_slot_drop(struct evt_vcache_slot *slot)
+{
+	D_FREE(slot->vs_ents);
+	slot->vs_root = NULL;
+	slot->vs_nr = 0;
+}
+
+/**
+ * See the description in evt_priv.h
+ */
+void
+evt_vcache_invalidate(struct evt_context *tcx, const struct evt_rect *rect)
+{
+	struct evt_vcache	*vc = evt_vcache_get();
+	struct evt_vcache_slot	*set;
+	struct evt_vcache_slot	*slot;
+	int			 i;
+
+	if (vc == NULL || tcx->tc_root == NULL)
+		return;
+
+	set = evt_vcache_set(vc, tcx);
+	for (i = 0; i < EVT_VCACHE_WAYS; i++) {
+		slot = &set[i];
+		if (!evt_vcache_slot_owned(slot, tcx))
+			continue;
+
+		if (rect != NULL &&
+		    (rect->rc_epc < slot->vs_epr_lo ||
+		     rect->rc_epc > slot->vs_hi.epr_hi ||
+		     rect->rc_ex.ex_hi < slot->vs_ext.ex_lo ||
+		     rect->rc_ex.ex_lo > slot->vs_ext.ex_hi))
+			continue;
+
+		/* Queries below the extent's epoch still can't see it */
+		if (rect != NULL && rect->rc_epc > slot->vs_hi.epr_lo) {
+			slot->vs_hi.epr_hi = rect->rc_epc - 1;
+			continue;
+		}
+
+		evt_vcache_slot_drop(slot);
+	}
+}
+
+/** Find the cached result of the query and copy it to \a ent_array */
+static int
+evt_vcache_lookup(struct evt_vcache *vc, struct evt_context *tcx,
+		  const daos_epoch_range_t *epr, const struct evt_extent *ext,
+		  struct evt_entry_array *ent_array)
+{
+	struct evt_vcache_slot	*set;
+	struct evt_vcache_slot	*slot;
+	struct evt_entry	*ent;
+	int			 i;
+	int			 rc;
+
+	set = evt_vcache_set(vc, tcx);
+	for (i = 0; i < EVT_VCACHE_WAYS; i++) {
+		slot = &set[i];
+		if (evt_vcache_slot_owned(slot, tcx) &&
+		    slot->vs_epr_lo == epr->epr_lo &&
+		    slot->vs_hi.epr_lo <= epr->epr_hi &&
+		    slot->vs_hi.epr_hi >= epr->epr_hi &&
+		    slot->vs_ext.ex_lo == ext->ex_lo &&
+		    slot->vs_ext.ex_hi == ext->ex_hi)
+			break;
+	}
+
+	if (i == EVT_VCACHE_WAYS) {
+		vc->vc_misses++;
+		return -DER_NONEXIST;
+	}
+
+	for (i = 0; i < slot->vs_nr; i++) {
+		rc = ent_array_alloc(tcx, ent_array, &ent, false);
+		if (rc != 0) {
+			D_ASSERT(rc != -DER_AGAIN);
+			return rc;
+		}
+		*ent = slot->vs_ents[i];
+	}
+	ent_array->ea_inob = slot->vs_inob;
+	slot->vs_stamp = ++vc->vc_clock;
+	vc->vc_hits++;
+	return 0;
+}
+
+/**
+ * Return the highest epr_hi for which a query of \a ext returns the same as
+ * for \a epr_hi, i.e. the epoch before the first extent above \a epr_hi
+ * overlapping \a ext.
+ */
+static daos_epoch_t
+evt_vcache_hi_max(struct evt_context *tcx, daos_epoch_t epr_hi,
+		  const struct evt_extent *ext)
+{
+	struct evt_entry_array	 ent_array;
+	struct evt_entry	*ent;
+	struct evt_filter	 filter;
+	struct evt_rect		 rect;
+	daos_epoch_t		 hi_max = DAOS_EPOCH_MAX;
+	int			 rc;
+
+	if (epr_hi == DAOS_EPOCH_MAX)
+		return epr_hi;
+
+	evt_ent_array_init(&ent_array);
+	rect.rc_ex = filter.fr_ex = *ext;
+	rect.rc_epc = DAOS_EPOCH_MAX;
+	filter.fr_epr.epr_lo = epr_hi + 1;
+	filter.fr_epr.epr_hi = DAOS_EPOCH_MAX;
+	filter.fr_punch = 0;
+	rc = evt_ent_array_fill(tcx, EVT_FIND_ALL, DAOS_INTENT_DEFAULT,
+				&filter, &rect, &ent_array);
+	/* The epochs of skipped extents are unknown */
+	if (rc != 0 || tcx->tc_unavail) {
+		hi_max = epr_hi;
+	} else {
+		evt_ent_array_for_each(ent, &ent_array) {
+			if (ent->en_epoch <= hi_max)
+				hi_max = ent->en_epoch - 1;
+		}
+	}
+	evt_ent_array_fini(&ent_array);
+	return hi_max;
+}
+
+/** Cache the result of a query, if all visible extents are committed */
+static void
+evt_vcache_insert(struct evt_vcache *vc, struct evt_context *tcx,
+		  const daos_epoch_range_t *epr, const struct evt_extent *ext,
+		  struct evt_entry_array *ent_array)
+{
+	struct evt_vcache_slot	*set;
+	struct evt_vcache_slot	*slot;
+	struct evt_entry	*ents = NULL;
+	struct evt_entry	*ent;
+	daos_epoch_t		 hi_min = epr->epr_lo;
+	int			 i;
+
+	/* Visibility of uncommitted extents changes without modifying the
+	 * tree, so results depending on them can't be cached.
+	 */
+	if (tcx->tc_unavail || ent_array->ea_ent_nr > EVT_VCACHE_ENT_MAX)
+		return;
+
+	for (i = 0; i < ent_array->ea_ent_nr; i++) {
+		ent = evt_ent_array_get(ent_array, i);
+		if (ent->en_avail_rc != ALB_AVAILABLE_CLEAN)
+			return;
+		if (ent->en_epoch > hi_min)
+			hi_min = ent->en_epoch;
+	}
+
+	if (ent_array->ea_ent_nr != 0) {
+		D_ALLOC_ARRAY(ents, ent_array->ea_ent_nr);
+		if (ents == NULL)
+			return;
+		for (i = 0; i < ent_array->ea_ent_nr; i++)
+			ents[i] = *evt_ent_array_get(ent_array, i);
+	}
+
+	/* Take an unused slot, or replace the least recently used one */
+	set = evt_vcache_set(vc, tcx);
+	slot = &set[0];
+	for (i = 0; i < EVT_VCACHE_WAYS; i++) {
+		if (set[i].vs_root == NULL) {
+			slot = &set[i];
+			break;
+		}
+		if (set[i].vs_stamp < slot->vs_stamp)
+			slot = &set[i];
+	}
+	evt_vcache_slot_drop(slot);
+
+	slot->vs_root = tcx->tc_root;
+	slot->vs_pool_uuid = tcx->tc_pmempool_uuid;
+	slot->vs_epr_lo = epr->epr_lo;
+	slot->vs_hi.epr_lo = hi_min;
+	slot->vs_hi.epr_hi = evt_vcache_hi_max(tcx, epr->epr_hi, ext);
+	slot->vs_ext = *ext;
+	slot->vs_inob = ent_array->ea_inob;
+	slot->vs_nr = ent_array->ea_ent_nr;
+	slot->vs_ents = ents;
+	slot->vs_stamp = ++vc->vc_clock;
+}
+
 struct evt_max_rect {
 	struct evt_rect		mr_rect;
 	bool			mr_valid;
@@ -2126,6 +2382,7 @@ evt_find(daos_handle_t toh, const daos_epoch_range_t *epr,
 	 struct evt_entry_array *ent_array)
 {
 	struct evt_context	*tcx;
+	struct evt_vcache	*vc;
 	struct evt_filter	 filter;
 	struct evt_rect		 rect;
 	int			 rc;
@@ -2142,10 +2399,20 @@ evt_find(daos_handle_t toh, const daos_epoch_range_t *epr,
 	filter.fr_punch = 0;
 	rect.rc_epc = epr->epr_hi;
 
+	vc = evt_vcache_get();
+	if (vc != NULL) {
+		rc = evt_vcache_lookup(vc, tcx, epr, extent, ent_array);
+		if (rc != -DER_NONEXIST)
+			goto out;
+	}
+
 	rc = evt_ent_array_fill(tcx, EVT_FIND_ALL, DAOS_INTENT_DEFAULT,
 				&filter, &rect, ent_array);
 	if (rc == 0)
 		rc = evt_ent_array_sort(tcx, ent_array, NULL, EVT_VISIBLE);
+	if (rc == 0 && vc != NULL)
+		evt_vcache_insert(vc, tcx, epr, extent, ent_array);
+out:
 	if (rc != 0)
 		evt_ent_array_fini(ent_array);
 	return rc;
@@ -2661,6 +2928,7 @@ static struct evt_policy_ops evt_ssof_pol_ops = {
 	.po_adjust		= evt_ssof_adjust,
 	.po_split		= evt_even_split,
 	.po_rect_weight		= evt_common_rect_weight,
+	.po_cmp_rect		= evt_ssof_cmp_rect,
 };
 
 /**
@@ -2764,6 +3032,7 @@ static struct evt_policy_ops evt_sdist_pol_ops = {
 	.po_adjust		= evt_sdist_adjust,
 	.po_split		= evt_sdist_split,
 	.po_rect_weight		= evt_common_rect_weight,
+	.po_cmp_rect		= evt_sdist_cmp_rect,
 };
 
 static struct evt_policy_ops evt_sdist_even_pol_ops = {
@@ -2771,6 +3040,7 @@ static struct evt_policy_ops evt_sdist_even_pol_ops = {
 	.po_adjust		= evt_sdist_adjust,
 	.po_split		= evt_even_split,
 	.po_rect_weight		= evt_common_rect_weight,
+	.po_cmp_rect		= evt_sdist_cmp_rect,
 };
 
 /** After the current cursor is deleted, the trace
@@ -2842,6 +3112,10 @@ evt_node_delete(struct evt_context *tcx)
 	 * Then we check the mbr at each level and make appropriate
 	 * adjustments.
 	 */
+	trace = &tcx->tc_trace[level];
+	node = evt_off2node(tcx, trace->tr_node);
+	evt_vcache_invalidate(tcx, evt_node_rect_at(tcx, node, trace->tr_at));
+
 	while (1) {
 		int	count;
 
@@ -3143,3 +3417,261 @@ out:
 	tcx->tc_creds = 0;
 	return rc;
 }
+
+/** Trees with more extents than this are not packed by evt_pack */
+#define EVT_PACK_MAX	(1 << 14)
+
+/** Sort by extent start, the first dimension of the tiles */
+static int
+evt_pack_cmp_ex(const void *p1, const void *p2)
+{
+	const struct evt_node_entry	*ne1 = p1;
+	const struct evt_node_entry	*ne2 = p2;
+
+	return evt_rect_cmp(&ne1->ne_rect, &ne2->ne_rect);
+}
+
+/** Sort by epoch, the second dimension of the tiles */
+static int
+evt_pack_cmp_epc(const void *p1, const void *p2)
+{
+	const struct evt_node_entry	*ne1 = p1;
+	const struct evt_node_entry	*ne2 = p2;
+
+	if (ne1->ne_rect.rc_epc < ne2->ne_rect.rc_epc)
+		return -1;
+	if (ne1->ne_rect.rc_epc > ne2->ne_rect.rc_epc)
+		return 1;
+
+	return evt_rect_cmp(&ne1->ne_rect, &ne2->ne_rect);
+}
+
+/**
+ * Count the nodes and leaf records of the subtree \a nd_off, and copy the
+ * leaf records to \a ents if it's not NULL.
+ */
+static void
+evt_pack_scan(struct evt_context *tcx, umem_off_t nd_off,
+	      struct evt_node_entry *ents, int *ent_nr, int *node_nr)
+{
+	struct evt_node	*nd = evt_off2node(tcx, nd_off);
+	int		 i;
+
+	(*node_nr)++;
+	if (!evt_node_is_leaf(tcx, nd)) {
+		for (i = 0; i < nd->tn_nr; i++)
+			evt_pack_scan(tcx, evt_node_child_at(tcx, nd, i), ents,
+				      ent_nr, node_nr);
+		return;
+	}
+
+	if (ents != NULL)
+		memcpy(&ents[*ent_nr], evt_node_entry_at(tcx, nd, 0),
+		       sizeof(ents[0]) * nd->tn_nr);
+	*ent_nr += nd->tn_nr;
+}
+
+/** Free the nodes of the subtree \a nd_off, but not the leaf records */
+static int
+evt_pack_free(struct evt_context *tcx, umem_off_t nd_off)
+{
+	struct evt_node	*nd = evt_off2node(tcx, nd_off);
+	int		 i;
+	int		 rc;
+
+	if (!evt_node_is_leaf(tcx, nd)) {
+		for (i = 0; i < nd->tn_nr; i++) {
+			rc = evt_pack_free(tcx, evt_node_child_at(tcx, nd, i));
+			if (rc != 0)
+				return rc;
+		}
+	}
+	return evt_node_free(tcx, nd_off);
+}
+
+/**
+ * Allocate a node for \a nr entries, and store them in the order of the tree
+ * policy. Returns the entry for the parent node in \a parent.
+ */
+static int
+evt_pack_node(struct evt_context *tcx, unsigned int flags,
+	      struct evt_node_entry *ents, int nr,
+	      struct evt_node_entry *parent)
+{
+	struct evt_node_entry	*ne;
+	struct evt_node_entry	 tmp;
+	struct evt_rect		*mbr;
+	cmp_rect_cb		*cmp;
+	struct evt_node		*nd;
+	umem_off_t		 nd_off;
+	int			 i;
+	int			 j;
+	int			 rc;
+
+	D_ASSERT(nr > 0 && nr <= tcx->tc_order);
+	rc = evt_node_alloc(tcx, flags, &nd_off);
+	if (rc != 0)
+		return rc;
+
+	nd = evt_off2node(tcx, nd_off);
+	nd->tn_nr = nr;
+	ne = evt_node_entry_at(tcx, nd, 0);
+	memcpy(ne, ents, sizeof(ents[0]) * nr);
+	evt_node_mbr_cal(tcx, nd);
+
+	/* The policy orders entries against the final MBR, so sort them once
+	 * it is known. Nodes are small, insertion sort is enough.
+	 */
+	cmp = tcx->tc_ops->po_cmp_rect;
+	mbr = evt_node_mbr_get(tcx, nd);
+	for (i = 1; i < nr; i++) {
+		tmp = ne[i];
+		for (j = i; j > 0; j--) {
+			if (cmp(tcx, mbr, &ne[j - 1].ne_rect,
+				&tmp.ne_rect) <= 0)
+				break;
+			ne[j] = ne[j - 1];
+		}
+		ne[j] = tmp;
+	}
+
+	parent->ne_rect = nd->tn_mbr;
+	parent->ne_child = nd_off;
+	return 0;
+}
+
+/**
+ * Pack \a nr entries into nodes of \a fill entries with Sort-Tile-Recursive:
+ * entries are sorted by extent into vertical slices, then each slice is
+ * sorted by epoch and cut into nodes. The entries for the parent level are
+ * stored back to the head of \a ents.
+ */
+static int
+evt_pack_level(struct evt_context *tcx, bool leaf, int fill,
+	       struct evt_node_entry *ents, int *nr)
+{
+	struct evt_node_entry	 parent;
+	int			 node_nr;
+	int			 slices;
+	int			 slice;
+	int			 cnt;
+	int			 i;
+	int			 j;
+	int			 k;
+	int			 rc;
+
+	node_nr = (*nr + fill - 1) / fill;
+	for (slices = 1; slices * slices < node_nr; slices++)
+		;
+	slice = slices * fill;
+
+	qsort(ents, *nr, sizeof(ents[0]), evt_pack_cmp_ex);
+
+	/* NB: parent entries are stored in place of the packed ones, which
+	 * never overtakes the entries still to be packed.
+	 */
+	for (i = k = 0; i < *nr; i += slice) {
+		cnt = min(slice, *nr - i);
+		qsort(&ents[i], cnt, sizeof(ents[0]), evt_pack_cmp_epc);
+
+		for (j = i; j < i + cnt; j += fill) {
+			rc = evt_pack_node(tcx, leaf ? EVT_NODE_LEAF : 0,
+					   &ents[j], min(fill, i + cnt - j),
+					   &parent);
+			if (rc != 0)
+				return rc;
+			ents[k++] = parent;
+		}
+	}
+
+	*nr = k;
+	return 0;
+}
+
+/**
+ * Rebuild the tree bottom up from its leaf records.
+ * Please check API comment in evtree.h for the details.
+ */
+int
+evt_pack(daos_handle_t toh, unsigned int fill)
+{
+	struct evt_context	*tcx;
+	struct evt_root		*root;
+	struct evt_node_entry	*ents;
+	struct evt_node_entry	 top;
+	umem_off_t		 old_node;
+	bool			 leaf = true;
+	int			 fill_nr;
+	int			 packed_nr;
+	int			 node_nr = 0;
+	int			 nr = 0;
+	int			 cnt;
+	int			 depth;
+	int			 rc;
+
+	tcx = evt_hdl2tcx(toh);
+	if (tcx == NULL)
+		return -DER_NO_HDL;
+
+	if (fill == 0 || fill > 100)
+		return -DER_INVAL;
+
+	root = tcx->tc_root;
+	if (evt_root_empty(tcx) || root->tr_depth == 1)
+		return 0;
+
+	fill_nr = max(tcx->tc_order * fill / 100, 2);
+
+	evt_pack_scan(tcx, root->tr_node, NULL, &nr, &node_nr);
+	if (nr > EVT_PACK_MAX)
+		return 0;
+
+	/* Leave the tree alone if it can't lose a quarter of its nodes */
+	packed_nr = 1;
+	for (cnt = nr; cnt > tcx->tc_order; packed_nr += cnt)
+		cnt = (cnt + fill_nr - 1) / fill_nr;
+	if (packed_nr > node_nr - node_nr / 4)
+		return 0;
+
+	D_ALLOC_ARRAY(ents, nr);
+	if (ents == NULL)
+		return -DER_NOMEM;
+
+	nr = node_nr = 0;
+	evt_pack_scan(tcx, root->tr_node, ents, &nr, &node_nr);
+
+	rc = evt_tx_begin(tcx);
+	if (rc != 0)
+		goto out;
+
+	for (depth = 1; nr > tcx->tc_order; depth++) {
+		rc = evt_pack_level(tcx, leaf, fill_nr, ents, &nr);
+		if (rc != 0)
+			goto tx_end;
+		leaf = false;
+	}
+
+	rc = evt_pack_node(tcx, EVT_NODE_ROOT | (leaf ? EVT_NODE_LEAF : 0),
+			   ents, nr, &top);
+	if (rc != 0)
+		goto tx_end;
+
+	rc = evt_root_tx_add(tcx);
+	if (rc != 0)
+		goto tx_end;
+
+	old_node = root->tr_node;
+	root->tr_node = top.ne_child;
+	root->tr_depth = depth;
+	evt_tcx_set_dep(tcx, depth);
+
+	rc = evt_pack_free(tcx, old_node);
+	if (rc == 0)
+		D_DEBUG(DB_TRACE, "Packed %d nodes into %d, depth %d\n",
+			node_nr, packed_nr, depth);
+tx_end:
+	rc = evt_tx_end(tcx, rc);
+out:
+	D_FREE(ents);
+	return rc;
+}
@@ -43,6 +43,9 @@
 
 #include <daos_srv/evtree.h>
 #include <daos_srv/bio.h>
+#include <daos_srv/vos.h>
+#include <vos_internal.h>
+#include <evt_priv.h>
 #include <daos/tests_lib.h>
 #include <daos_pool.h>
 #include <utest_common.h>
@@ -2277,6 +2280,379 @@ test_evt_outer_punch(void **state)
 	assert_int_equal(rc, 0);
 }
 
+static void
+test_evt_pack_internal(void **state)
+{
+	struct test_arg		*arg = *state;
+	struct evt_entry_array	 before;
+	struct evt_entry_array	 after;
+	struct evt_entry	*ent;
+	struct evt_entry	*ent2;
+	struct evt_entry_in	 entry = {0};
+	struct evt_extent	 extent;
+	daos_epoch_range_t	 epr;
+	daos_handle_t		 toh;
+	uint64_t		 root_node;
+	int			 depth;
+	int			 epoch;
+	int			 count;
+	int			 sum = 1;
+	int			 rc;
+	int			 i;
+
+	rc = evt_create(arg->ta_root, ts_feats, ORDER_DEF_INTERNAL, arg->ta_uma,
+			&ts_evt_desc_nofree_cbs, &toh);
+	assert_int_equal(rc, 0);
+
+	/* Overlapping extents of different widths at each epoch */
+	for (epoch = 1; epoch <= NUM_EPOCHS; epoch++) {
+		for (count = 0; count < NUM_EXTENTS; count++) {
+			entry.ei_rect.rc_ex.ex_lo = count * NUM_EXTENTS +
+						    epoch % 7;
+			entry.ei_rect.rc_ex.ex_hi = entry.ei_rect.rc_ex.ex_lo +
+						    epoch % 13 + NUM_EXTENTS;
+			entry.ei_rect.rc_epc = epoch;
+			entry.ei_ver = 0;
+			entry.ei_inob = sizeof(sum);
+			rc = bio_alloc_init(arg->ta_utx, &entry.ei_addr, &sum,
+					    sizeof(sum));
+			assert_int_equal(rc, 0);
+
+			rc = evt_insert(toh, &entry);
+			assert_int_equal(rc, 0);
+		}
+	}
+
+	extent.ex_lo = 0;
+	extent.ex_hi = NUM_EXTENTS * NUM_EXTENTS * 2;
+	epr.epr_lo = 0;
+	epr.epr_hi = NUM_EPOCHS;
+	rc = evt_find(toh, &epr, &extent, &before);
+	assert_int_equal(rc, 0);
+
+	/* Nodes split by in order inserts are about half full, so the pack
+	 * must go through, and rebuild both leaf and internal levels.
+	 */
+	depth = arg->ta_root->tr_depth;
+	assert_true(depth >= 3);
+	root_node = arg->ta_root->tr_node;
+	rc = evt_pack(toh, 100);
+	assert_int_equal(rc, 0);
+	print_message("Depth %d after pack, was %d\n",
+		      arg->ta_root->tr_depth, depth);
+	assert_true(arg->ta_root->tr_node != root_node);
+	assert_true(arg->ta_root->tr_depth >= 2);
+	assert_true(arg->ta_root->tr_depth <= depth);
+
+	/* Packing keeps the records, so the visible extents are the same */
+	rc = evt_find(toh, &epr, &extent, &after);
+	assert_int_equal(rc, 0);
+	assert_int_equal(before.ea_ent_nr, after.ea_ent_nr);
+
+	i = 0;
+	evt_ent_array_for_each(ent, &before) {
+		ent2 = evt_ent_array_get(&after, i++);
+		assert_int_equal(ent->en_epoch, ent2->en_epoch);
+		assert_int_equal(ent->en_sel_ext.ex_lo, ent2->en_sel_ext.ex_lo);
+		assert_int_equal(ent->en_sel_ext.ex_hi, ent2->en_sel_ext.ex_hi);
+		assert_int_equal(ent->en_addr.ba_off, ent2->en_addr.ba_off);
+	}
+	evt_ent_array_fini(&before);
+	evt_ent_array_fini(&after);
+
+	/* Packing a packed tree changes nothing */
+	depth = arg->ta_root->tr_depth;
+	root_node = arg->ta_root->tr_node;
+	rc = evt_pack(toh, 100);
+	assert_int_equal(rc, 0);
+	assert_int_equal(arg->ta_root->tr_depth, depth);
+	assert_true(arg->ta_root->tr_node == root_node);
+
+	/* The packed nodes are in policy order, so full nodes still split,
+	 * and a newer extent covering all the others is the only visible one.
+	 */
+	entry.ei_rect.rc_ex = extent;
+	entry.ei_rect.rc_epc = NUM_EPOCHS + 1;
+	rc = bio_alloc_init(arg->ta_utx, &entry.ei_addr, &sum, sizeof(sum));
+	assert_int_equal(rc, 0);
+	rc = evt_insert(toh, &entry);
+	assert_int_equal(rc, 0);
+
+	epr.epr_hi = NUM_EPOCHS + 1;
+	rc = evt_find(toh, &epr, &extent, &after);
+	assert_int_equal(rc, 0);
+	assert_int_equal(after.ea_ent_nr, 1);
+	ent = evt_ent_array_get(&after, 0);
+	assert_int_equal(ent->en_epoch, NUM_EPOCHS + 1);
+	evt_ent_array_fini(&after);
+
+	rc = evt_destroy(toh);
+	assert_int_equal(rc, 0);
+}
+
+#define VC_EXT_LEN	16
+
+/* The extent reported as uncommitted by ts_evt_log_status() */
+static umem_off_t	ts_vc_dirty_off = UMOFF_NULL;
+static int		ts_vc_dirty_rc;
+
+static int
+ts_evt_log_status(struct umem_instance *umm, struct evt_desc *desc,
+		  int intent, void *args)
+{
+	if (!UMOFF_IS_NULL(ts_vc_dirty_off) &&
+	    desc->dc_ex_addr.ba_off == ts_vc_dirty_off)
+		return ts_vc_dirty_rc;
+	return ALB_AVAILABLE_CLEAN;
+}
+
+static struct evt_desc_cbs	ts_evt_vcache_cbs = {
+	.dc_bio_free_cb		= ts_evt_bio_free,
+	.dc_log_status_cb	= ts_evt_log_status,
+};
+
+static int
+setup_vcache(void **state)
+{
+	int	rc;
+
+	rc = vos_init();
+	if (rc != 0) {
+		print_message("Failed to initialize VOS: "DF_RC"\n",
+			      DP_RC(rc));
+		return 1;
+	}
+
+	rc = setup_builtin(state);
+	if (rc != 0)
+		vos_fini();
+	return rc;
+}
+
+static int
+teardown_vcache(void **state)
+{
+	int	rc;
+
+	rc = teardown_builtin(state);
+	vos_fini();
+	return rc;
+}
+
+static uint64_t
+vcache_hits(void)
+{
+	return vos_tls_get()->vtl_imems_inst.vis_evt_vcache->vc_hits;
+}
+
+static void
+vcache_insert(struct test_arg *arg, daos_handle_t toh, int lo, int hi,
+	      int epoch, char val, umem_off_t *off)
+{
+	struct evt_entry_in	entry = {0};
+	char			buf[VC_EXT_LEN];
+	int			rc;
+
+	memset(buf, val, sizeof(buf));
+	entry.ei_rect.rc_ex.ex_lo = lo;
+	entry.ei_rect.rc_ex.ex_hi = hi;
+	entry.ei_rect.rc_epc = epoch;
+	entry.ei_inob = 1;
+	rc = bio_alloc_init(arg->ta_utx, &entry.ei_addr, buf, hi - lo + 1);
+	assert_int_equal(rc, 0);
+	if (off != NULL)
+		*off = entry.ei_addr.ba_off;
+
+	rc = evt_insert(toh, &entry);
+	assert_int_equal(rc, 0);
+}
+
+/* Read [0, VC_EXT_LEN - 1] at @epoch, and compare it with @exp */
+static void
+vcache_check(struct test_arg *arg, daos_handle_t toh, int epoch,
+	     const char *exp)
+{
+	struct evt_entry_array	 ent_array;
+	struct evt_entry	*ent;
+	struct evt_extent	 extent;
+	daos_epoch_range_t	 epr;
+	char			 buf[VC_EXT_LEN + 1];
+	char			*data;
+	int			 rc;
+	int			 i;
+
+	memset(buf, '-', VC_EXT_LEN);
+	buf[VC_EXT_LEN] = '\0';
+	epr.epr_lo = 0;
+	epr.epr_hi = epoch;
+	extent.ex_lo = 0;
+	extent.ex_hi = VC_EXT_LEN - 1;
+
+	evt_ent_array_init(&ent_array);
+	rc = evt_find(toh, &epr, &extent, &ent_array);
+	assert_int_equal(rc, 0);
+
+	evt_ent_array_for_each(ent, &ent_array) {
+		if (bio_addr_is_hole(&ent->en_addr))
+			continue;
+		data = utest_off2ptr(arg->ta_utx, ent->en_addr.ba_off);
+		for (i = ent->en_sel_ext.ex_lo; i <= ent->en_sel_ext.ex_hi;
+		     i++)
+			buf[i] = data[i - ent->en_ext.ex_lo];
+	}
+	evt_ent_array_fini(&ent_array);
+
+	if (strcmp(buf, exp) != 0)
+		fail_msg("read %s at epoch %d, expected %s", buf, epoch, exp);
+}
+
+/* Delete the extent at @epoch like aggregation, by the raw iterator */
+static void
+vcache_iter_delete(daos_handle_t toh, int epoch)
+{
+	struct evt_entry	ent;
+	daos_handle_t		ih;
+	unsigned int		inob;
+	int			rc;
+
+	rc = evt_iter_prepare(toh, 0, NULL, &ih);
+	assert_int_equal(rc, 0);
+
+	rc = evt_iter_probe(ih, EVT_ITER_FIRST, NULL, NULL);
+	while (rc == 0) {
+		rc = evt_iter_fetch(ih, &inob, &ent, NULL);
+		assert_int_equal(rc, 0);
+		if (ent.en_epoch == epoch) {
+			rc = evt_iter_delete(ih, NULL);
+			assert_int_equal(rc, 0);
+			break;
+		}
+		rc = evt_iter_next(ih);
+	}
+	assert_int_equal(rc, 0);
+
+	rc = evt_iter_finish(ih);
+	assert_int_equal(rc, 0);
+}
+
+static void
+test_evt_vcache(void **state)
+{
+	struct test_arg		*arg = *state;
+	daos_handle_t		 toh;
+	uint64_t		 hits;
+	int			 rc;
+
+	ts_evt_vcache_cbs.dc_bio_free_args = arg;
+	rc = evt_create(arg->ta_root, ts_feats, ORDER_DEF_INTERNAL, arg->ta_uma,
+			&ts_evt_vcache_cbs, &toh);
+	assert_int_equal(rc, 0);
+
+	/* The second read of the same range is served by the cache */
+	vcache_insert(arg, toh, 0, VC_EXT_LEN - 1, 1, 'a', NULL);
+	vcache_check(arg, toh, 10, "aaaaaaaaaaaaaaaa");
+	hits = vcache_hits();
+	vcache_check(arg, toh, 10, "aaaaaaaaaaaaaaaa");
+	assert_int_equal(vcache_hits(), hits + 1);
+
+	/* Overwrite inside the cached range */
+	vcache_insert(arg, toh, 4, 7, 2, 'b', NULL);
+	vcache_check(arg, toh, 10, "aaaabbbbaaaaaaaa");
+	hits = vcache_hits();
+	vcache_check(arg, toh, 10, "aaaabbbbaaaaaaaa");
+	assert_int_equal(vcache_hits(), hits + 1);
+
+	/* Overwrite at an epoch the cached query can't see */
+	vcache_insert(arg, toh, 0, 3, 20, 'x', NULL);
+	hits = vcache_hits();
+	vcache_check(arg, toh, 10, "aaaabbbbaaaaaaaa");
+	assert_int_equal(vcache_hits(), hits + 1);
+
+	/* Aggregation deletes the overwrite by the iterator */
+	vcache_iter_delete(toh, 2);
+	vcache_check(arg, toh, 10, "aaaaaaaaaaaaaaaa");
+
+	/* Results with uncommitted extents are not cached */
+	ts_vc_dirty_rc = ALB_AVAILABLE_DIRTY;
+	vcache_insert(arg, toh, 8, 11, 3, 'c', &ts_vc_dirty_off);
+	vcache_check(arg, toh, 10, "aaaaaaaaccccaaaa");
+	hits = vcache_hits();
+	vcache_check(arg, toh, 10, "aaaaaaaaccccaaaa");
+	assert_int_equal(vcache_hits(), hits);
+
+	/* Abort: the extent is invisible without touching the tree */
+	ts_vc_dirty_rc = ALB_UNAVAILABLE;
+	vcache_check(arg, toh, 10, "aaaaaaaaaaaaaaaa");
+	vcache_check(arg, toh, 10, "aaaaaaaaaaaaaaaa");
+	assert_int_equal(vcache_hits(), hits);
+
+	/* Commit: the extent is visible and the result is cached again */
+	ts_vc_dirty_off = UMOFF_NULL;
+	vcache_check(arg, toh, 10, "aaaaaaaaccccaaaa");
+	vcache_check(arg, toh, 10, "aaaaaaaaccccaaaa");
+	assert_int_equal(vcache_hits(), hits + 1);
+
+	rc = evt_destroy(toh);
+	assert_int_equal(rc, 0);
+}
+
+/* Reads at increasing epochs, like fetches at fresh HLC epochs, hit */
+static void
+test_evt_vcache_epochs(void **state)
+{
+	struct test_arg		*arg = *state;
+	daos_handle_t		 toh;
+	uint64_t		 hits;
+	int			 rc;
+
+	ts_evt_vcache_cbs.dc_bio_free_args = arg;
+	rc = evt_create(arg->ta_root, ts_feats, ORDER_DEF_INTERNAL, arg->ta_uma,
+			&ts_evt_vcache_cbs, &toh);
+	assert_int_equal(rc, 0);
+
+	vcache_insert(arg, toh, 0, VC_EXT_LEN - 1, 5, 'a', NULL);
+	vcache_insert(arg, toh, 8, 11, 30, 'c', NULL);
+
+	/* Served up to the epoch before the extent above the first read */
+	vcache_check(arg, toh, 10, "aaaaaaaaaaaaaaaa");
+	hits = vcache_hits();
+	vcache_check(arg, toh, 11, "aaaaaaaaaaaaaaaa");
+	vcache_check(arg, toh, 20, "aaaaaaaaaaaaaaaa");
+	vcache_check(arg, toh, 29, "aaaaaaaaaaaaaaaa");
+	assert_int_equal(vcache_hits(), hits + 3);
+
+	/* and from the latest extent the result covers */
+	vcache_check(arg, toh, 5, "aaaaaaaaaaaaaaaa");
+	assert_int_equal(vcache_hits(), hits + 4);
+
+	vcache_check(arg, toh, 30, "aaaaaaaaccccaaaa");
+	assert_int_equal(vcache_hits(), hits + 4);
+	vcache_check(arg, toh, 31, "aaaaaaaaccccaaaa");
+	vcache_check(arg, toh, 100, "aaaaaaaaccccaaaa");
+	assert_int_equal(vcache_hits(), hits + 6);
+
+	/* A newer overwrite caps the result below its epoch */
+	vcache_insert(arg, toh, 4, 7, 35, 'b', NULL);
+	vcache_check(arg, toh, 34, "aaaaaaaaccccaaaa");
+	assert_int_equal(vcache_hits(), hits + 7);
+	vcache_check(arg, toh, 35, "aaaabbbbccccaaaa");
+	assert_int_equal(vcache_hits(), hits + 7);
+	vcache_check(arg, toh, 36, "aaaabbbbccccaaaa");
+	vcache_check(arg, toh, 1000, "aaaabbbbccccaaaa");
+	assert_int_equal(vcache_hits(), hits + 9);
+
+	/* An overwrite the results can see drops them */
+	vcache_insert(arg, toh, 0, 3, 32, 'x', NULL);
+	vcache_check(arg, toh, 40, "xxxxbbbbccccaaaa");
+	vcache_check(arg, toh, 33, "xxxxaaaaccccaaaa");
+	assert_int_equal(vcache_hits(), hits + 9);
+	vcache_check(arg, toh, 20, "aaaaaaaaaaaaaaaa");
+	assert_int_equal(vcache_hits(), hits + 10);
+
+	rc = evt_destroy(toh);
+	assert_int_equal(rc, 0);
+}
+
 static int
 run_internal_tests(void)
 {
@@ -2313,6 +2689,15 @@ run_internal_tests(void)
 		{ "EVT019: evt_overlap_split_internal",
 			test_evt_overlap_split_internal,
 			setup_builtin, teardown_builtin},
+		{ "EVT020: evt_pack_internal",
+			test_evt_pack_internal,
+			setup_builtin, teardown_builtin},
+		{ "EVT021: evt_vcache",
+			test_evt_vcache,
+			setup_vcache, teardown_vcache},
+		{ "EVT022: evt_vcache_epochs",
+			test_evt_vcache_epochs,
+			setup_vcache, teardown_vcache},
 		{ NULL, NULL, NULL, NULL }
 	};
 
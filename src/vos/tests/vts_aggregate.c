@@ -1707,10 +1707,10 @@ print_space_info(vos_pool_info_t *pi, char *desc)
 	VERBOSE_MSG("  NVMe allocator statistics:\n");
 	VERBOSE_MSG("    free_p: "DF_U64", \tfree_t: "DF_U64", "
 		    "\tfrags_large: "DF_U64", \tfrags_small: "DF_U64", "
-		    "\tmax_frag_blks: %u\n",
+		    "\tmax_frag_blks: %u, \tfrag_idx: %u\n",
 		    stat->vs_free_persistent, stat->vs_free_transient,
 		    stat->vs_large_frags, stat->vs_small_frags,
-		    stat->vs_largest_blks);
+		    stat->vs_largest_blks, stat->vs_frag_idx);
 	VERBOSE_MSG("    resrv_hit: "DF_U64", \tresrv_large: "DF_U64", "
 		    "\tresrv_small: "DF_U64"\n", stat->vs_resrv_hint,
 		    stat->vs_resrv_large, stat->vs_resrv_small);
@@ -1842,6 +1842,121 @@ aggregate_16(void **state)
 	agg_punches_test(state, DAOS_IOD_ARRAY, false);
 }
 
+/* Fragmentation index of NVMe free space, with aged free extents included */
+static unsigned int
+nvme_frag_index(struct io_test_args *arg)
+{
+	struct vea_space_info *vsi;
+
+	vsi = vos_hdl2pool(arg->ctx.tc_po_hdl)->vp_vea_info;
+	vea_flush(vsi);
+	return vea_frag_index(vsi);
+}
+
+/*
+ * Fragment NVMe free space by interleaving small extents of two akeys and
+ * freeing the extents of one, then verify aggregation relocates the other.
+ */
+static void
+aggregate_17(void **state)
+{
+	struct io_test_args	*arg = *state;
+	vos_pool_info_t		 pool_info;
+	daos_epoch_t		 epoch = 1;
+	daos_epoch_range_t	 epr;
+	daos_unit_oid_t		 oid;
+	daos_recx_t		 recx;
+	daos_size_t		 iod_size = (1UL << 10);
+	daos_size_t		 fill_size;
+	uint64_t		 ext_nr = 64, i, cnt;
+	unsigned int		 frag_before, frag_after;
+	char			 dkey[UPDATE_DKEY_SIZE] = { 0 };
+	char			 akey[2][UPDATE_AKEY_SIZE] = { 0 };
+	char			*buf, *buf_f;
+	int			 rc;
+
+	rc = vos_pool_query(arg->ctx.tc_po_hdl, &pool_info);
+	assert_int_equal(rc, 0);
+	if (pool_info.pif_vea_attr.va_tot_blks == 0) {
+		print_message("NVMe isn't enabled, skip test\n");
+		skip();
+	}
+	print_space_info(&pool_info, "INIT");
+
+	/* Fill 3/4 of the free space, each akey takes half of it */
+	fill_size = pool_info.pif_nvme_free / 8 * 3;
+	cnt = fill_size / (ext_nr * iod_size);
+	assert_true(cnt > 0);
+
+	D_ALLOC(buf, ext_nr * iod_size);
+	assert_non_null(buf);
+	D_ALLOC(buf_f, ext_nr * iod_size);
+	assert_non_null(buf_f);
+
+	oid = dts_unit_oid_gen(0, 0, 0);
+	dts_key_gen(dkey, UPDATE_DKEY_SIZE, UPDATE_DKEY);
+	dts_key_gen(akey[0], UPDATE_AKEY_SIZE, UPDATE_AKEY);
+	dts_key_gen(akey[1], UPDATE_AKEY_SIZE, UPDATE_AKEY);
+
+	/* Leave gaps between the extents so they can't be merged */
+	arg->ta_flags |= TF_USE_VAL;
+	recx.rx_nr = ext_nr;
+	for (i = 0; i < cnt; i++) {
+		recx.rx_idx = i * ext_nr * 2;
+		memset(buf, 'a' + i % 26, ext_nr * iod_size);
+		update_value(arg, oid, epoch++, dkey, akey[0], DAOS_IOD_ARRAY,
+			     iod_size, &recx, buf);
+		update_value(arg, oid, epoch++, dkey, akey[1], DAOS_IOD_ARRAY,
+			     iod_size, &recx, buf);
+	}
+
+	/* Punch all the extents of the second akey */
+	arg->ta_flags |= TF_PUNCH;
+	for (i = 0; i < cnt; i++) {
+		recx.rx_idx = i * ext_nr * 2;
+		update_value(arg, oid, epoch++, dkey, akey[1], DAOS_IOD_ARRAY,
+			     iod_size, &recx, buf);
+	}
+	arg->ta_flags &= ~(TF_PUNCH | TF_USE_VAL);
+
+	/* The first pass frees the punched extents */
+	epr.epr_lo = 0;
+	epr.epr_hi = epoch;
+	rc = vos_aggregate(arg->ctx.tc_co_hdl, &epr);
+	assert_int_equal(rc, 0);
+
+	frag_before = nvme_frag_index(arg);
+	rc = vos_pool_query(arg->ctx.tc_po_hdl, &pool_info);
+	assert_int_equal(rc, 0);
+	print_space_info(&pool_info, "PUNCHED");
+	print_message("Fragmentation index after punch: %u\n", frag_before);
+	assert_true(frag_before >= VOS_AGG_DEFRAG_THRESH);
+
+	/* The second pass relocates the extents of the first akey */
+	rc = vos_aggregate(arg->ctx.tc_co_hdl, &epr);
+	assert_int_equal(rc, 0);
+
+	frag_after = nvme_frag_index(arg);
+	rc = vos_pool_query(arg->ctx.tc_po_hdl, &pool_info);
+	assert_int_equal(rc, 0);
+	print_space_info(&pool_info, "DEFRAGMENTED");
+	print_message("Fragmentation index after defrag: %u\n", frag_after);
+	assert_true(frag_after < frag_before);
+
+	/* The relocated data is intact */
+	recx.rx_nr = ext_nr;
+	for (i = 0; i < cnt; i += (cnt + 15) / 16) {
+		recx.rx_idx = i * ext_nr * 2;
+		memset(buf, 'a' + i % 26, ext_nr * iod_size);
+		fetch_value(arg, oid, epoch, dkey, akey[0], DAOS_IOD_ARRAY,
+			    iod_size, &recx, buf_f);
+		assert_memory_equal(buf, buf_f, ext_nr * iod_size);
+	}
+
+	D_FREE(buf);
+	D_FREE(buf_f);
+}
+
 static int
 agg_tst_teardown(void **state)
 {
@@ -1916,6 +2031,8 @@ static const struct CMUnitTest aggregate_tests[] = {
 	  aggregate_15, NULL, agg_tst_teardown },
 	{ "VOS416: Aggregate many object/key punches array",
 	  aggregate_16, NULL, agg_tst_teardown },
+	{ "VOS417: Aggregate EV defragments NVMe free space",
+	  aggregate_17, NULL, agg_tst_teardown },
 };
 
 int
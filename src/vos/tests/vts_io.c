@@ -871,6 +871,113 @@ io_obj_cache_test(void **state)
 	vos_obj_cache_destroy(occ);
 }
 
+/* Hold and release @oids in turn, @nr of them, for @lookups lookups */
+static void
+cycle_objects(struct daos_lru_cache *occ, daos_handle_t coh,
+	      daos_unit_oid_t *oids, int nr, int lookups, bool no_create)
+{
+	struct vos_object	*obj;
+	daos_epoch_range_t	 epr = {0, 1};
+	int			 i, rc;
+
+	for (i = 0; i < lookups; i++) {
+		rc = vos_obj_hold(occ, vos_hdl2cont(coh), oids[i % nr], &epr,
+				  no_create, no_create ? DAOS_INTENT_DEFAULT :
+				  DAOS_INTENT_UPDATE, true, &obj);
+		assert_int_equal(rc, 0);
+		vos_obj_release(occ, obj, false);
+	}
+}
+
+static void
+io_obj_cache_adapt_test(void **state)
+{
+	struct io_test_args		*arg = *state;
+	struct vos_test_ctx		*ctx = &arg->ctx;
+	struct daos_lru_cache		*occ = vos_obj_cache_current();
+	struct vos_imem_strts		*imem = &vos_tls_get()->vtl_imems_inst;
+	struct vos_obj_cache_stats	 stats;
+	uint32_t			 saved_max = vos_obj_cache_max;
+	uint32_t			 saved_size = occ->dlc_csize;
+	uint32_t			 resizes;
+	uint64_t			 evictions;
+	daos_unit_oid_t			*oids;
+	char				*po_name;
+	uuid_t				 pool_uuid;
+	daos_handle_t			 l_poh, l_coh;
+	int				 nr = 4 * VOS_OC_SIZE_MIN;
+	int				 i, rc;
+
+	D_ALLOC_ARRAY(oids, nr);
+	assert_non_null(oids);
+	for (i = 0; i < nr; i++)
+		oids[i] = gen_oid(arg->ofeat);
+
+	rc = vts_alloc_gen_fname(&po_name);
+	assert_int_equal(rc, 0);
+
+	uuid_generate_time_safe(pool_uuid);
+	rc = vos_pool_create(po_name, pool_uuid, VPOOL_16M, 0);
+	assert_int_equal(rc, 0);
+
+	rc = vos_pool_open(po_name, pool_uuid, &l_poh);
+	assert_int_equal(rc, 0);
+
+	rc = vos_cont_create(l_poh, ctx->tc_co_uuid);
+	assert_int_equal(rc, 0);
+
+	rc = vos_cont_open(l_poh, ctx->tc_co_uuid, &l_coh);
+	assert_int_equal(rc, 0);
+
+	/* Create the objects with a fixed size cache, then start from an
+	 * empty cache of the minimum size at the beginning of a window.
+	 */
+	vos_obj_cache_max = 0;
+	cycle_objects(occ, l_coh, oids, nr, nr, false);
+	vos_obj_cache_evict(occ, NULL);
+	daos_lru_cache_resize(occ, VOS_OC_SIZE_MIN);
+	imem->vis_oc_base = occ->dlc_stats;
+	vos_obj_cache_max = 2 * VOS_OC_SIZE_MIN;
+
+	vos_obj_cache_stats_get(&stats);
+	resizes = stats.ocs_resizes;
+	evictions = stats.ocs_evictions;
+
+	/* A working set four times the cache size evicts on each lookup,
+	 * the cache doubles after one window and then stays at the max.
+	 */
+	cycle_objects(occ, l_coh, oids, nr, 2 * VOS_OC_WINDOW, true);
+	vos_obj_cache_stats_get(&stats);
+	assert_true(stats.ocs_evictions > evictions);
+	assert_int_equal(stats.ocs_size, vos_obj_cache_max);
+	assert_int_equal(stats.ocs_resizes, resizes + 1);
+
+	/* A few objects in an otherwise empty cache never evict, the cache
+	 * halves after one window and then stays at the min.
+	 */
+	vos_obj_cache_evict(occ, vos_hdl2cont(l_coh));
+	cycle_objects(occ, l_coh, oids, 8, 2 * VOS_OC_WINDOW, true);
+	vos_obj_cache_stats_get(&stats);
+	assert_int_equal(stats.ocs_size, VOS_OC_SIZE_MIN);
+	assert_int_equal(stats.ocs_resizes, resizes + 2);
+	assert_true(stats.ocs_cached <= 8);
+
+	vos_obj_cache_evict(occ, vos_hdl2cont(l_coh));
+	vos_obj_cache_max = saved_max;
+	daos_lru_cache_resize(occ, saved_size);
+	imem->vis_oc_base = occ->dlc_stats;
+
+	rc = vos_cont_close(l_coh);
+	assert_int_equal(rc, 0);
+	rc = vos_cont_destroy(l_poh, ctx->tc_co_uuid);
+	assert_int_equal(rc, 0);
+	rc = vos_pool_close(l_poh);
+	assert_int_equal(rc, 0);
+	rc = vos_pool_destroy(po_name, pool_uuid);
+	assert_int_equal(rc, 0);
+	D_FREE(oids);
+}
+
 static void
 io_multiple_dkey_test(void **state, unsigned int flags)
 {
@@ -2431,6 +2538,8 @@ static const struct CMUnitTest io_tests[] = {
 		io_sgl_fetch, NULL, NULL},
 	{ "VOS208: Extent hole test",
 		io_fetch_hole, NULL, NULL},
+	{ "VOS209: Adaptive object cache sizing test",
+		io_obj_cache_adapt_test, NULL, NULL},
 	{ "VOS220: 100K update/fetch/verify test",
 		io_multiple_dkey, NULL, NULL},
 	{ "VOS222: overwrite test",
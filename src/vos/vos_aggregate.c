@@ -125,6 +125,10 @@ struct agg_merge_window {
 	unsigned int		 mw_lgc_cnt;
 	/* I/O context for transfering data on flush */
 	struct agg_io_context	 mw_io_ctxt;
+	/* Number of window flushes in the current akey */
+	unsigned int		 mw_flush_cnt;
+	/* Bytes left for relocating NVMe extents to defragment free space */
+	daos_size_t		 mw_defrag_left;
 };
 
 struct vos_agg_param {
@@ -340,6 +344,7 @@ vos_agg_akey(daos_handle_t ih, vos_iter_entry_t *entry,
 
 	/* Reset the max epoch for low-level SV tree iteration */
 	agg_param->ap_max_epoch = 0;
+	agg_param->ap_window.mw_flush_cnt = 0;
 	/* The merge window for EV tree aggregation should have been closed */
 	if (merge_window_status(&agg_param->ap_window) != MW_CLOSED)
 		D_ASSERTF(false, "Merge window isn't closed.\n");
@@ -946,6 +951,44 @@ clear_merge_window(struct agg_merge_window *mw)
 	mw->mw_phy_cnt = 0;
 }
 
+/*
+ * When the free space of NVMe is badly fragmented, the already aggregated
+ * window consisting of small NVMe extents will be relocated, so that the
+ * scattered small extents will be freed and coalesced with their neighbors,
+ * and the data will be packed in the sequentially reserved new location.
+ */
+static bool
+need_defrag(struct agg_merge_window *mw)
+{
+	struct agg_phy_ent	*phy_ent;
+	daos_size_t		 size, nvme_size = 0;
+
+	if (mw->mw_defrag_left == 0)
+		return false;
+
+	d_list_for_each_entry(phy_ent, &mw->mw_phy_ents, pe_link) {
+		if (phy_ent->pe_addr.ba_type != DAOS_MEDIA_NVME ||
+		    bio_addr_is_hole(&phy_ent->pe_addr))
+			continue;
+
+		size = evt_rect_width(&phy_ent->pe_rect) * mw->mw_rsize;
+		/* Large extent doesn't contribute to the fragmentation */
+		if (size >= VOS_AGG_DEFRAG_EXT)
+			return false;
+
+		nvme_size += size;
+	}
+
+	if (nvme_size == 0)
+		return false;
+
+	mw->mw_defrag_left -= min(mw->mw_defrag_left, nvme_size);
+	D_DEBUG(DB_EPC, "Relocate window "DF_EXT", "DF_U64" bytes left\n",
+		DP_EXT(&mw->mw_ext), mw->mw_defrag_left);
+
+	return true;
+}
+
 static bool
 need_flush(struct agg_merge_window *mw)
 {
@@ -980,6 +1023,9 @@ need_flush(struct agg_merge_window *mw)
 	if (mw->mw_lgc_cnt != mw->mw_phy_cnt)
 		return true;
 
+	if (need_defrag(mw))
+		return true;
+
 	clear_merge_window(mw);
 	D_DEBUG(DB_EPC, "Skip window flush "DF_EXT"\n", DP_EXT(&mw->mw_ext));
 
@@ -994,9 +1040,9 @@ flush_merge_window(daos_handle_t ih, struct agg_merge_window *mw,
 
 	/*
 	 * If no new updates in an already aggregated window, window flush will
-	 * be skipped, otherwise, all the data within the window will be
-	 * migrated to a new location, such batch data migration is good for
-	 * anti-fragmentaion.
+	 * be skipped (unless the NVMe free space needs be defragmented),
+	 * otherwise, all the data within the window will be migrated to a new
+	 * location, such batch data migration is good for anti-fragmentaion.
 	 */
 	if (!need_flush(mw))
 		return 0;
@@ -1024,6 +1070,7 @@ flush_merge_window(daos_handle_t ih, struct agg_merge_window *mw,
 			DP_EXT(&mw->mw_ext), DP_RC(rc));
 		goto out;
 	}
+	mw->mw_flush_cnt++;
 out:
 	cleanup_segments(ih, mw, rc);
 	return rc;
@@ -1492,8 +1539,18 @@ vos_aggregate_post_cb(daos_handle_t ih, vos_iter_entry_t *entry,
 		rc = oi_iter_aggregate(ih, agg_param->ap_discard);
 		break;
 	case VOS_ITER_DKEY:
+		rc = vos_obj_iter_aggregate(ih, agg_param->ap_discard);
+		break;
 	case VOS_ITER_AKEY:
 		rc = vos_obj_iter_aggregate(ih, agg_param->ap_discard);
+		/*
+		 * Merged extents were re-inserted one by one, rebuild the
+		 * tree with packed nodes if the akey is still there.
+		 */
+		if (rc == 0 && agg_param->ap_window.mw_flush_cnt != 0) {
+			agg_param->ap_window.mw_flush_cnt = 0;
+			rc = vos_obj_iter_pack(ih, VOS_AGG_EVT_FILL);
+		}
 		break;
 	case VOS_ITER_SINGLE:
 		return 0;
@@ -1554,6 +1611,7 @@ vos_aggregate(daos_handle_t coh, daos_epoch_range_t *epr)
 	vos_iter_param_t	 iter_param = { 0 };
 	struct vos_agg_param	 agg_param = { 0 };
 	struct vos_iter_anchors	 anchors = { 0 };
+	struct vea_space_info	*vsi = cont->vc_pool->vp_vea_info;
 	int			 rc;
 
 	D_ASSERT(epr != NULL);
@@ -1586,6 +1644,10 @@ vos_aggregate(daos_handle_t coh, daos_epoch_range_t *epr)
 	agg_param.ap_discard = false;
 	merge_window_init(&agg_param.ap_window);
 
+	/* Relocate small NVMe extents when the free space is fragmented */
+	if (vsi != NULL && vea_frag_index(vsi) >= VOS_AGG_DEFRAG_THRESH)
+		agg_param.ap_window.mw_defrag_left = VOS_AGG_DEFRAG_MAX;
+
 	iter_param.ip_flags |= VOS_IT_FOR_PURGE;
 	rc = vos_iterate(&iter_param, VOS_ITER_OBJ, true, &anchors,
 			 vos_aggregate_pre_cb, vos_aggregate_post_cb,
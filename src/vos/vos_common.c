@@ -109,8 +109,22 @@ vos_bio_addr_free(struct vos_pool *pool, bio_addr_t *addr, daos_size_t nob)
 static inline void
 vos_imem_strts_destroy(struct vos_imem_strts *imem_inst)
 {
-	if (imem_inst->vis_ocache)
+	struct daos_lru_stats	stats;
+
+	if (imem_inst->vis_ocache) {
+		daos_lru_cache_stats(imem_inst->vis_ocache, &stats);
+		D_INFO("Object cache hits "DF_U64" misses "DF_U64" evictions "
+		       DF_U64" size %u resizes %u\n", stats.dls_hits,
+		       stats.dls_misses, stats.dls_evictions,
+		       imem_inst->vis_ocache->dlc_csize,
+		       imem_inst->vis_oc_resizes);
 		vos_obj_cache_destroy(imem_inst->vis_ocache);
+	}
+
+	if (imem_inst->vis_evt_vcache)
+		evt_vcache_destroy(imem_inst->vis_evt_vcache);
+
+	dbtree_ncache_fini();
 
 	if (imem_inst->vis_pool_hhash)
 		d_uhash_destroy(imem_inst->vis_pool_hhash);
@@ -131,6 +145,13 @@ vos_imem_strts_create(struct vos_imem_strts *imem_inst)
 		return rc;
 	}
 
+	rc = evt_vcache_create(&imem_inst->vis_evt_vcache);
+	if (rc) {
+		D_ERROR("Error in creating evtree visible extent cache: "
+			DF_RC"\n", DP_RC(rc));
+		goto failed;
+	}
+
 	rc = d_uhash_create(0 /* no locking */, VOS_POOL_HHASH_BITS,
 			    &imem_inst->vis_pool_hhash);
 	if (rc) {
@@ -207,6 +228,8 @@ vos_mod_init(void)
 {
 	int	 rc = 0;
 
+	vos_obj_cache_setup();
+
 	rc = vos_cont_tab_register();
 	if (rc) {
 		D_ERROR("VOS CI btree initialization error\n");
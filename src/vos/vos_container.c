@@ -433,6 +433,8 @@ vos_cont_open(daos_handle_t poh, uuid_t co_uuid, daos_handle_t *coh)
 					rc);
 				goto exit;
 			}
+			vea_hint_set_cache(cont->vc_hint_ctxt[i],
+					   VOS_HINT_CACHE_BLKS);
 		}
 	}
 
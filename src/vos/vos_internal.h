@@ -60,6 +60,8 @@ extern struct dss_module_key vos_module_key;
 #define VOS_BLK_SHIFT		12	/* 4k */
 #define VOS_BLK_SZ		(1UL << VOS_BLK_SHIFT) /* bytes */
 #define VOS_BLOB_HDR_BLKS	1	/* block */
+/* Blocks pre-reserved for the I/O stream with reservations in flight */
+#define VOS_HINT_CACHE_BLKS	256	/* 1MB */
 
 /** hash seed for murmur hash */
 #define VOS_BTR_MUR_SEED	0xC0FFEE
@@ -72,6 +74,22 @@ extern struct dss_module_key vos_module_key;
 /* Force aggregation/discard ULT yield on certain amount of tight loops */
 #define VOS_AGG_CREDITS_MAX	256
 
+/*
+ * Aggregation relocates the small NVMe extents when the fragmentation index
+ * of NVMe free space reaches this threshold, at most VOS_AGG_DEFRAG_MAX bytes
+ * are relocated in one aggregation pass.
+ */
+#define VOS_AGG_DEFRAG_THRESH	50		/* percent */
+#define VOS_AGG_DEFRAG_MAX	(1ULL << 26)	/* 64MB */
+/*
+ * Only the windows made of NVMe extents smaller than this are relocated, it
+ * is the size bound of the smallest size class of VEA free extents.
+ */
+#define VOS_AGG_DEFRAG_EXT	(1ULL << 20)	/* 1MB */
+
+/* Node fill percentage of the evtrees rebuilt by aggregation */
+#define VOS_AGG_EVT_FILL	90
+
 static inline uint32_t vos_byte2blkcnt(uint64_t bytes)
 {
 	D_ASSERT(bytes != 0);
@@ -206,6 +224,12 @@ struct vos_imem_strts {
 	 * object table
 	 */
 	struct daos_lru_cache	*vis_ocache;
+	/** Object cache counters at the start of the adaptive sizing window */
+	struct daos_lru_stats	 vis_oc_base;
+	/** Number of object cache resizes */
+	uint32_t		 vis_oc_resizes;
+	/** Cache of visible extents returned by evt_find */
+	struct evt_vcache	*vis_evt_vcache;
 	/** Hash table to refcount VOS handles */
 	/** (container/pool, etc.,) */
 	struct d_hash_table	*vis_pool_hhash;
@@ -943,6 +967,14 @@ void
 vos_evt_desc_cbs_init(struct evt_desc_cbs *cbs, struct vos_pool *pool,
 		      daos_handle_t coh);
 
+/* evtree.c */
+struct evt_vcache;
+
+int
+evt_vcache_create(struct evt_vcache **vcp);
+void
+evt_vcache_destroy(struct evt_vcache *vc);
+
 /* vos_obj.c */
 int
 key_tree_prepare(struct vos_object *obj, daos_handle_t toh,
@@ -1029,4 +1061,16 @@ oi_iter_aggregate(daos_handle_t ih, bool discard);
 int
 vos_obj_iter_aggregate(daos_handle_t ih, bool discard);
 
+/**
+ * Rebuild the array value tree of the current entry of the akey iterator
+ * with packed nodes, see evt_pack()
+ *
+ * \param ih[IN]	Iterator handle
+ * \param fill[IN]	Percentage of the tree order to fill nodes with
+ *
+ * \return		Zero on Success, negative value otherwise
+ */
+int
+vos_obj_iter_pack(daos_handle_t ih, unsigned int fill);
+
 #endif /* __VOS_INTERNAL_H__ */
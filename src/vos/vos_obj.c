@@ -1491,6 +1491,43 @@ exit:
 
 }
 
+int
+vos_obj_iter_pack(daos_handle_t ih, unsigned int fill)
+{
+	struct vos_iterator	*iter = vos_hdl2iter(ih);
+	struct vos_obj_iter	*oiter = vos_iter2oiter(iter);
+	struct vos_object	*obj = oiter->it_obj;
+	struct vos_krec_df	*krec;
+	struct vos_rec_bundle	 rbund;
+	struct evt_desc_cbs	 cbs;
+	daos_key_t		 key;
+	daos_handle_t		 toh;
+	int			 rc;
+
+	D_ASSERTF(iter->it_type == VOS_ITER_AKEY,
+		  "Only array value trees can be packed\n");
+
+	rc = key_iter_fetch_helper(oiter, &rbund, &key, NULL);
+	D_ASSERTF(rc != -DER_NONEXIST,
+		  "Iterator should probe before packing\n");
+	if (rc != 0)
+		return rc;
+
+	krec = rbund.rb_krec;
+	if (!(krec->kr_bmap & KREC_BF_EVT) || evt_is_empty(&krec->kr_evt))
+		return 0;
+
+	vos_evt_desc_cbs_init(&cbs, vos_obj2pool(obj),
+			      vos_cont2hdl(obj->obj_cont));
+	rc = evt_open(&krec->kr_evt, vos_obj2uma(obj), &cbs, &toh);
+	if (rc != 0)
+		return rc;
+
+	rc = evt_pack(toh, fill);
+	evt_close(toh);
+	return rc;
+}
+
 static int
 vos_obj_iter_delete(struct vos_iterator *iter, void *args)
 {
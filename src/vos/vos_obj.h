@@ -129,6 +129,23 @@ int vos_obj_evict_by_oid(struct daos_lru_cache *occ, struct vos_container *cont,
 int
 vos_obj_cache_create(int32_t cache_size, struct daos_lru_cache **occ_p);
 
+/**
+ * Read the object cache tunables from the environment.  Setting
+ * DAOS_OBJ_CACHE_MB to a per-target DRAM budget enables adaptive sizing,
+ * which grows or shrinks the cache of each target within the budget
+ * depending on how often cached objects have to be evicted.
+ */
+void
+vos_obj_cache_setup(void);
+
+/** Maximum object cache size for adaptive sizing, 0 if disabled */
+extern uint32_t vos_obj_cache_max;
+
+/** Number of lookups between two adaptive sizing decisions */
+#define VOS_OC_WINDOW		(1 << 14)
+/** Adaptive sizing never shrinks the cache below this */
+#define VOS_OC_SIZE_MIN		(1 << 10)
+
 /**
  * Destroy an object cache, and release all cached object references.
  *
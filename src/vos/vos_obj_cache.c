@@ -138,17 +138,118 @@ static struct daos_llink_ops obj_lru_ops = {
 	.lop_print_key	=  obj_lop_print_key,
 };
 
+/** Estimated DRAM used by a cached object, including its open trees */
+#define VOS_OC_OBJ_COST		(sizeof(struct vos_object) + 1024)
+
+uint32_t vos_obj_cache_max;
+
+void
+vos_obj_cache_setup(void)
+{
+	unsigned int	budget = 0;
+	uint64_t	max;
+
+	d_getenv_int("DAOS_OBJ_CACHE_MB", &budget);
+	if (budget == 0)
+		return;
+
+	max = ((uint64_t)budget << 20) / VOS_OC_OBJ_COST;
+	if (max < VOS_OC_SIZE_MIN)
+		max = VOS_OC_SIZE_MIN;
+	if (max > (1U << 31))
+		max = 1U << 31;
+
+	vos_obj_cache_max = max;
+	D_INFO("Adaptive object cache sizing, up to %u objects per target\n",
+	       vos_obj_cache_max);
+}
+
+/**
+ * Once per window of lookups, double the cache if a significant part of
+ * them evicted an idle object (the working set does not fit, so objects are
+ * repeatedly dropped and reloaded from SCM), or halve it if nothing was
+ * evicted and it is less than a quarter full.
+ */
+static void
+obj_cache_adapt(struct daos_lru_cache *occ)
+{
+	struct vos_imem_strts	*imem = &vos_tls_get()->vtl_imems_inst;
+	struct daos_lru_stats	*base = &imem->vis_oc_base;
+	struct daos_lru_stats	*cur = &occ->dlc_stats;
+	uint64_t		 lookups;
+	uint64_t		 evictions;
+	uint64_t		 size = occ->dlc_csize;
+	uint32_t		 cached;
+
+	lookups = cur->dls_hits + cur->dls_misses -
+		  base->dls_hits - base->dls_misses;
+	if (lookups < VOS_OC_WINDOW)
+		return;
+
+	evictions = cur->dls_evictions - base->dls_evictions;
+	cached = occ->dlc_busy_nr + occ->dlc_idle_nr;
+
+	if (evictions > lookups / 16 && size < vos_obj_cache_max)
+		size = min(size * 2, vos_obj_cache_max);
+	else if (evictions == 0 && cached < size / 4 && size > VOS_OC_SIZE_MIN)
+		size = max(size / 2, VOS_OC_SIZE_MIN);
+
+	if (size != occ->dlc_csize) {
+		D_INFO("Resize object cache %u -> "DF_U64", lookups "DF_U64
+		       " misses "DF_U64" evictions "DF_U64" cached %u\n",
+		       occ->dlc_csize, size, lookups,
+		       cur->dls_misses - base->dls_misses, evictions, cached);
+		daos_lru_cache_resize(occ, size);
+		imem->vis_oc_resizes++;
+	}
+	*base = *cur;
+}
+
+void
+vos_obj_cache_stats_get(struct vos_obj_cache_stats *stats)
+{
+	struct vos_imem_strts	*imem = &vos_tls_get()->vtl_imems_inst;
+	struct daos_lru_cache	*occ = imem->vis_ocache;
+	struct daos_lru_stats	 lstats;
+
+	daos_lru_cache_stats(occ, &lstats);
+	stats->ocs_hits = lstats.dls_hits;
+	stats->ocs_misses = lstats.dls_misses;
+	stats->ocs_evictions = lstats.dls_evictions;
+	stats->ocs_size = occ->dlc_csize;
+	stats->ocs_cached = occ->dlc_busy_nr + occ->dlc_idle_nr;
+	stats->ocs_resizes = imem->vis_oc_resizes;
+}
+
 int
 vos_obj_cache_create(int32_t cache_size, struct daos_lru_cache **occ)
 {
+	int32_t	bits = cache_size;
 	int	rc;
 
-	D_DEBUG(DB_TRACE, "Creating an object cache %d\n", (1 << cache_size));
-	rc = daos_lru_cache_create(cache_size, D_HASH_FT_NOLOCK,
+	/* The hash table can't grow, so with adaptive sizing it is created
+	 * for the max capacity and the cache is shrunk to its initial size.
+	 */
+	while (vos_obj_cache_max != 0 && bits < 31 &&
+	       (1U << bits) < vos_obj_cache_max)
+		bits++;
+
+	D_DEBUG(DB_TRACE, "Creating an object cache %d, hash for %d\n",
+		(1 << cache_size), (1 << bits));
+	/* Objects are held and released on every I/O, CLOCK replacement saves
+	 * moving them between the busy and idle lists each time.
+	 */
+	rc = daos_lru_cache_create(bits, D_HASH_FT_NOLOCK | DAOS_LRU_FT_CLOCK,
 				   &obj_lru_ops, occ);
-	if (rc)
+	if (rc) {
 		D_ERROR("Error in creating lru cache: "DF_RC"\n", DP_RC(rc));
-	return rc;
+		return rc;
+	}
+
+	if (vos_obj_cache_max != 0)
+		daos_lru_cache_resize(*occ, min(1U << cache_size,
+						vos_obj_cache_max));
+	return 0;
 }
 
 void
@@ -226,6 +327,8 @@ vos_obj_hold(struct daos_lru_cache *occ, struct vos_container *cont,
 	lkey.olk_oid = oid;
 
 	rc = daos_lru_ref_hold(occ, &lkey, sizeof(lkey), cont, &lret);
+	if (vos_obj_cache_max != 0 && occ == vos_obj_cache_current())
+		obj_cache_adapt(occ);
 	if (rc)
 		D_GOTO(failed_2, rc);
 
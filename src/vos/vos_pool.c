@@ -729,6 +729,48 @@ vos_pool_query(daos_handle_t poh, vos_pool_info_t *pinfo)
 	return 0;
 }
 
+int
+vos_pool_scm_map(daos_handle_t poh, void **addr, daos_size_t *size)
+{
+	struct vos_pool	*pool;
+
+	pool = vos_hdl2pool(poh);
+	if (pool == NULL)
+		return -DER_NO_HDL;
+
+	/* Data is stored in DRAM, see umem_get_type() */
+	if (pool->vp_umm.umm_id == UMEM_CLASS_VMEM)
+		return -DER_NOSYS;
+
+	*addr = (void *)pool->vp_umm.umm_base;
+	*size = pool->vp_pool_df->pd_scm_sz;
+	return 0;
+}
+
+int
+vos_pool_tx_begin(daos_handle_t poh)
+{
+	struct vos_pool	*pool;
+
+	pool = vos_hdl2pool(poh);
+	if (pool == NULL)
+		return -DER_NO_HDL;
+
+	/* Same stage data as vos_update_end(), which nests in this one */
+	return umem_tx_begin(vos_pool2umm(pool), vos_txd_get());
+}
+
+int
+vos_pool_tx_end(daos_handle_t poh, int err)
+{
+	struct vos_pool	*pool;
+
+	pool = vos_hdl2pool(poh);
+	D_ASSERT(pool != NULL);
+
+	return umem_tx_end(vos_pool2umm(pool), err);
+}
+
 int
 vos_pool_ctl(daos_handle_t poh, enum vos_pool_opc opc)
 {
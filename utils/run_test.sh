@@ -91,6 +91,8 @@ if [ -d "/mnt/daos" ]; then
     run_test src/common/tests/btree.sh dyn perf ukey -s 20000
     run_test build/src/common/tests/umem_test
     run_test build/src/common/tests/sched
+    run_test build/src/common/tests/lru 4 100
+    run_test build/src/common/tests/lru 4 100 clock
     run_test build/src/common/tests/drpc_tests
     run_test build/src/client/api/tests/eq_tests
     run_test build/src/bio/smd/tests/smd_ut
@@ -114,6 +116,7 @@ if [ -d "/mnt/daos" ]; then
     run_test build/src/iosrv/tests/drpc_progress_tests
     run_test build/src/iosrv/tests/drpc_handler_tests
     run_test build/src/iosrv/tests/drpc_listener_tests
+    run_test build/src/iosrv/tests/sched_tests
     run_test build/src/mgmt/tests/srv_drpc_tests
     run_test "${SL_PREFIX}/bin/vos_size"
     run_test "${SL_PREFIX}/bin/vos_size.py" \